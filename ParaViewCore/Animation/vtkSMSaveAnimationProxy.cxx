@@ -26,6 +26,7 @@
 #include "vtkPVRenderingCapabilitiesInformation.h"
 #include "vtkPVServerInformation.h"
 #include "vtkPVXMLElement.h"
+#include "vtkProcessModule.h"
 #include "vtkSMAnimationScene.h"
 #include "vtkSMAnimationSceneWriter.h"
 #include "vtkSMParaViewPipelineController.h"
@@ -37,13 +38,278 @@
 #include "vtkSMTrace.h"
 #include "vtkSMViewLayoutProxy.h"
 #include "vtkSMViewProxy.h"
-
+#include "vtkTimerLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 namespace vtkSMSaveAnimationProxyNS
 {
 
+// Runs the encoding of the captured frames on a pool of threads so that the
+// next frames can be rendered meanwhile. The queue is bounded, Push() blocks
+// while it is full. Frames are taken in order, so with a single thread they
+// are also encoded in order.
+class FrameEncoder
+{
+public:
+  // A job gets the index of the thread running it.
+  typedef std::function<bool(int)> Job;
+
+  FrameEncoder()
+    : MaxQueueLength(1)
+    , Done(false)
+    , Failed(false)
+  {
+  }
+
+  ~FrameEncoder() { this->Finish(); }
+
+  static int GetDefaultNumberOfThreads()
+  {
+    const int numCores = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(1, std::min(numCores - 1, 4));
+  }
+
+  void Start(int numThreads)
+  {
+    this->Finish();
+    this->Done = false;
+    this->Failed = false;
+    this->MaxQueueLength = static_cast<size_t>(2 * numThreads);
+    for (int cc = 0; cc < numThreads; ++cc)
+    {
+      this->Threads.push_back(std::thread(&FrameEncoder::Encode, this, cc));
+    }
+  }
+
+  /**
+   * Queues a job. Returns false if a previous job failed. Jobs are run right
+   * away when no thread was started.
+   */
+  bool Push(const Job& job)
+  {
+    if (this->Threads.empty())
+    {
+      return job(0);
+    }
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->SpaceAvailable.wait(
+      lock, [this]() { return this->Failed || this->Queue.size() < this->MaxQueueLength; });
+    if (this->Failed)
+    {
+      return false;
+    }
+    this->Queue.push_back(job);
+    this->JobAvailable.notify_one();
+    return true;
+  }
+
+  /**
+   * Waits for the queued jobs and stops the threads. Returns false if any
+   * job failed.
+   */
+  bool Finish()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Done = true;
+    }
+    this->JobAvailable.notify_all();
+    for (size_t cc = 0; cc < this->Threads.size(); ++cc)
+    {
+      this->Threads[cc].join();
+    }
+    this->Threads.clear();
+    return !this->Failed;
+  }
+
+private:
+  void Encode(int threadIdx)
+  {
+    while (true)
+    {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(this->Mutex);
+        this->JobAvailable.wait(lock, [this]() { return this->Done || !this->Queue.empty(); });
+        if (this->Queue.empty())
+        {
+          return;
+        }
+        job = this->Queue.front();
+        this->Queue.pop_front();
+        this->SpaceAvailable.notify_one();
+        if (this->Failed)
+        {
+          // don't bother encoding frames of a failed save.
+          continue;
+        }
+      }
+      if (!job(threadIdx))
+      {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Failed = true;
+        this->SpaceAvailable.notify_all();
+      }
+    }
+  }
+
+  std::deque<Job> Queue;
+  size_t MaxQueueLength;
+  bool Done;
+  bool Failed;
+  std::mutex Mutex;
+  std::condition_variable JobAvailable;
+  std::condition_variable SpaceAvailable;
+  std::vector<std::thread> Threads;
+};
+
+// Hands out the frames of an animation to the time compartments, groups of
+// processes that each run their own pipelines (see
+// vtkProcessModule::CreateTimeCompartments). Frames are handed out in rounds
+// of decreasing size. Each round is split in consecutive ranges, one per
+// compartment, in proportion to the rate at which the compartments rendered
+// frames in the previous rounds. Only the first process of each compartment
+// talks to the other compartments, through `roots`. NextRound() is collective
+// on all the processes of all the compartments.
+class FrameScheduler
+{
+public:
+  FrameScheduler(vtkMultiProcessController* compartment, vtkMultiProcessController* roots)
+    : Compartment(compartment)
+    , Roots(roots)
+    , CompartmentIndex(0)
+    , NextFrame(0)
+    , LastFrame(-1)
+    , RoundFrames(0)
+    , Failed(false)
+  {
+    int layout[2] = { 0, 1 };
+    if (roots)
+    {
+      layout[0] = roots->GetLocalProcessId();
+      layout[1] = roots->GetNumberOfProcesses();
+    }
+    compartment->Broadcast(layout, 2, 0);
+    this->CompartmentIndex = layout[0];
+    this->Frames.resize(layout[1], 0.0);
+    this->Seconds.resize(layout[1], 0.0);
+  }
+
+  int GetNumberOfCompartments() const { return static_cast<int>(this->Frames.size()); }
+  int GetCompartmentIndex() const { return this->CompartmentIndex; }
+
+  /**
+   * Returns true if any compartment failed to save its frames.
+   */
+  bool GetFailed() const { return this->Failed; }
+
+  void SetFrameRange(int first, int last)
+  {
+    this->NextFrame = first;
+    this->LastFrame = last;
+  }
+
+  /**
+   * Reports the status and the time spent on the frames of the previous
+   * round and gets the range of frames this compartment must save in the
+   * next round, which may be empty. Returns false once all the frames have
+   * been handed out or when a compartment failed.
+   */
+  bool NextRound(bool failed, double seconds, int& first, int& last)
+  {
+    const int numCompartments = this->GetNumberOfCompartments();
+
+    // the processes of a compartment render the same frames, the slowest one
+    // gives the time of the compartment.
+    double local[2] = { failed ? 1.0 : 0.0, seconds };
+    double compartmentStatus[2];
+    this->Compartment->AllReduce(local, compartmentStatus, 2, vtkCommunicator::MAX_OP);
+
+    std::vector<double> statuses(3 * numCompartments);
+    if (this->Roots)
+    {
+      double status[3] = { compartmentStatus[0], static_cast<double>(this->RoundFrames),
+        compartmentStatus[1] };
+      this->Roots->AllGather(status, &statuses[0], 3);
+    }
+    this->Compartment->Broadcast(&statuses[0], 3 * numCompartments, 0);
+
+    double knownRates = 0.0;
+    int numKnownRates = 0;
+    for (int cc = 0; cc < numCompartments; ++cc)
+    {
+      this->Failed = this->Failed || statuses[3 * cc] != 0.0;
+      this->Frames[cc] += statuses[3 * cc + 1];
+      this->Seconds[cc] += statuses[3 * cc + 2];
+      if (this->Frames[cc] > 0 && this->Seconds[cc] > 0)
+      {
+        knownRates += this->Frames[cc] / this->Seconds[cc];
+        ++numKnownRates;
+      }
+    }
+
+    const int remaining = this->LastFrame - this->NextFrame + 1;
+    if (this->Failed || remaining <= 0)
+    {
+      this->RoundFrames = 0;
+      return false;
+    }
+
+    // compartments that did not render any frame yet are assumed to be as
+    // fast as the average.
+    std::vector<double> rates(numCompartments, 1.0);
+    for (int cc = 0; cc < numCompartments; ++cc)
+    {
+      if (this->Frames[cc] > 0 && this->Seconds[cc] > 0)
+      {
+        rates[cc] = this->Frames[cc] / this->Seconds[cc];
+      }
+      else if (numKnownRates > 0)
+      {
+        rates[cc] = knownRates / numKnownRates;
+      }
+    }
+    double totalRate = 0.0;
+    double startRate = 0.0;
+    for (int cc = 0; cc < numCompartments; ++cc)
+    {
+      startRate += cc < this->CompartmentIndex ? rates[cc] : 0.0;
+      totalRate += rates[cc];
+    }
+    const double endRate = startRate + rates[this->CompartmentIndex];
+
+    // hand out half of the remaining frames, and at least one frame per
+    // compartment, so that the last rounds can correct the imbalance.
+    const int roundSize = std::min(remaining, std::max(numCompartments, remaining / 2));
+    first = this->NextFrame + static_cast<int>(std::floor(roundSize * startRate / totalRate + 0.5));
+    last = this->NextFrame + static_cast<int>(std::floor(roundSize * endRate / totalRate + 0.5)) - 1;
+    this->NextFrame += roundSize;
+    this->RoundFrames = std::max(0, last - first + 1);
+    return true;
+  }
+
+private:
+  vtkMultiProcessController* Compartment;
+  vtkMultiProcessController* Roots;
+  int CompartmentIndex;
+  int NextFrame;
+  int LastFrame;
+  int RoundFrames;
+  bool Failed;
+  std::vector<double> Frames;
+  std::vector<double> Seconds;
+};
+
 class SceneGrabber
 {
 public:
@@ -72,6 +338,40 @@ public:
   void SetWriter(T* writer) { this->Writer = writer; }
   T* GetWriter() { return this->Writer; }
 
+  /**
+   * Saves the frames handed out to this time compartment by the scheduler
+   * instead of playing the whole animation. `frameTimes` gives the animation
+   * time of each frame.
+   */
+  bool SaveScheduledFrames(FrameScheduler& scheduler, const std::vector<double>& frameTimes)
+  {
+    vtkSMAnimationScene* scene = this->AnimationScene;
+    const bool cachingFlag = scene->GetForceDisableCaching();
+    scene->SetForceDisableCaching(true);
+
+    bool failed = !this->SaveInitialize(this->StartFileCount);
+    double seconds = 0.0;
+    int first, last;
+    while (scheduler.NextRound(failed, seconds, first, last))
+    {
+      const double start = vtkTimerLog::GetUniversalTime();
+      for (int frame = first; frame <= last; ++frame)
+      {
+        // keep rendering after a failure, the other processes of the
+        // compartment still expect to take part in the renders.
+        const double time = frameTimes[frame];
+        scene->SetSceneTime(time);
+        this->SeekFrame(frame);
+        failed = !this->SaveFrame(time) || failed;
+      }
+      seconds = vtkTimerLog::GetUniversalTime() - start;
+    }
+
+    const bool status = this->SaveFinalize() && !scheduler.GetFailed();
+    scene->SetForceDisableCaching(cachingFlag);
+    return status;
+  }
+
 protected:
   SceneImageWriter() {}
   ~SceneImageWriter() {}
@@ -110,6 +410,14 @@ protected:
 
   virtual bool WriteFrameImage(double time, vtkImageData* data) = 0;
 
+  /**
+   * Called before saving the given frame when frames are not saved in
+   * sequence.
+   */
+  virtual void SeekFrame(int vtkNotUsed(frame)) {}
+
+  FrameEncoder Encoder;
+
 private:
   SceneImageWriter(const SceneImageWriter&) = delete;
   void operator=(const SceneImageWriter&) = delete;
@@ -133,6 +441,9 @@ protected:
     if (auto* writer = this->GetWriter())
     {
       writer->SetFileName(this->GetFileName());
+      // A movie is a single stream, a single thread encodes the frames in
+      // order while the following ones are rendered.
+      this->Encoder.Start(1);
       return this->Superclass::SaveInitialize(startCount);
     }
     this->Started = false;
@@ -142,6 +453,12 @@ protected:
   bool WriteFrameImage(double vtkNotUsed(time), vtkImageData* data) override
   {
     assert(data);
+    vtkSmartPointer<vtkImageData> image = data;
+    return this->Encoder.Push([this, image](int) { return this->EncodeFrame(image); });
+  }
+
+  bool EncodeFrame(vtkImageData* data)
+  {
     auto* writer = this->GetWriter();
     writer->SetInputData(data);
     if (!this->Started)
@@ -156,12 +473,13 @@ protected:
 
   bool SaveFinalize() override
   {
+    const bool status = this->Encoder.Finish();
     if (this->Started)
     {
       this->GetWriter()->End();
     }
     this->Started = false;
-    return this->Superclass::SaveFinalize();
+    return this->Superclass::SaveFinalize() && status;
   }
 
 private:
@@ -183,6 +501,11 @@ public:
   vtkSetStringMacro(SuffixFormat);
   vtkGetStringMacro(SuffixFormat);
 
+  /**
+   * Add a writer, configured like the main one, to write frames concurrently.
+   */
+  void AddEncoderWriter(vtkImageWriter* writer) { this->EncoderWriters.push_back(writer); }
+
 protected:
   SceneImageWriterImageSeries()
     : Counter(0)
@@ -198,29 +521,47 @@ protected:
     auto prefix = vtksys::SystemTools::GetFilenameWithoutLastExtension(this->FileName);
     this->Prefix = path.empty() ? prefix : path + "/" + prefix;
     this->Extension = vtksys::SystemTools::GetFilenameLastExtension(this->FileName);
+    // one thread per writer, each file is written independently.
+    this->Encoder.Start(1 + static_cast<int>(this->EncoderWriters.size()));
     return this->Superclass::SaveInitialize(startCount);
   }
 
   bool WriteFrameImage(double vtkNotUsed(time), vtkImageData* data) override
   {
-    auto writer = this->GetWriter();
     assert(data);
     assert(this->SuffixFormat);
-    assert(writer);
 
     char buffer[1024];
-    snprintf(buffer, 1024, this->SuffixFormat, this->Counter);
+    snprintf(buffer, 1024, this->SuffixFormat, this->Counter++);
 
     std::ostringstream str;
     str << this->Prefix << buffer << this->Extension;
+    const std::string filename = str.str();
+    vtkSmartPointer<vtkImageData> image = data;
+    return this->Encoder.Push([this, image, filename](int threadIdx) {
+      return this->EncodeFrame(threadIdx, image, filename);
+    });
+  }
+
+  void SeekFrame(int frame) override { this->Counter = frame; }
+
+  bool EncodeFrame(int threadIdx, vtkImageData* data, const std::string& filename)
+  {
+    vtkImageWriter* writer =
+      threadIdx == 0 ? this->GetWriter() : this->EncoderWriters[threadIdx - 1].GetPointer();
+    assert(writer);
+
     writer->SetInputData(data);
-    writer->SetFileName(str.str().c_str());
+    writer->SetFileName(filename.c_str());
     writer->Write();
     writer->SetInputData(nullptr);
+    return writer->GetErrorCode() == vtkErrorCode::NoError;
+  }
 
-    const bool success = writer->GetErrorCode() == vtkErrorCode::NoError;
-    this->Counter += success ? 1 : 0;
-    return success;
+  bool SaveFinalize() override
+  {
+    const bool status = this->Encoder.Finish();
+    return this->Superclass::SaveFinalize() && status;
   }
 
 private:
@@ -230,6 +571,7 @@ private:
   char* SuffixFormat;
   std::string Prefix;
   std::string Extension;
+  std::vector<vtkSmartPointer<vtkImageWriter> > EncoderWriters;
 };
 vtkStandardNewMacro(SceneImageWriterImageSeries);
 }
@@ -366,6 +708,7 @@ bool vtkSMSaveAnimationProxy::WriteAnimationLocally(const char* filename)
   }
 
   vtkSmartPointer<vtkSMAnimationSceneWriter> writer;
+  vtkSMSaveAnimationProxyNS::SceneImageWriterImageSeries* imageSeriesWriter = nullptr;
 
   vtkSMProxy* sceneProxy = this->GetAnimationScene();
   auto formatProxy = this->GetFormatProxy(filename);
@@ -390,7 +733,28 @@ bool vtkSMSaveAnimationProxy::WriteAnimationLocally(const char* filename)
     realWriter->SetWriter(imgWriter);
     realWriter->SetSuffixFormat(vtkSMPropertyHelper(formatProxy, "SuffixFormat").GetAsString());
     realWriter->SetHelper(this);
+
+    // Additional writers, configured like the format proxy, to compress
+    // several frames at once while the next ones are being rendered.
+    vtkSMSessionProxyManager* pxm = this->GetSessionProxyManager();
+    const int numThreads = vtkSMSaveAnimationProxyNS::FrameEncoder::GetDefaultNumberOfThreads();
+    for (int cc = 1; cc < numThreads; ++cc)
+    {
+      vtkSmartPointer<vtkSMProxy> clone;
+      clone.TakeReference(pxm->NewProxy(formatProxy->GetXMLGroup(), formatProxy->GetXMLName()));
+      if (!clone)
+      {
+        break;
+      }
+      clone->Copy(formatProxy);
+      clone->UpdateVTKObjects();
+      if (auto cloneWriter = vtkImageWriter::SafeDownCast(clone->GetClientSideObject()))
+      {
+        realWriter->AddEncoderWriter(cloneWriter);
+      }
+    }
     writer = realWriter;
+    imageSeriesWriter = realWriter;
   }
   else if (auto movieWriter = vtkGenericMovieWriter::SafeDownCast(formatObj))
   {
@@ -421,6 +785,7 @@ bool vtkSMSaveAnimationProxy::WriteAnimationLocally(const char* filename)
   int frameWindow[2] = { 0, 0 };
   vtkSMPropertyHelper(this, "FrameWindow").Get(frameWindow, 2);
   double playbackTimeWindow[2] = { -1, 0 };
+  std::vector<double> frameTimes;
   switch (vtkSMPropertyHelper(sceneProxy, "PlayMode").GetAsInt())
   {
     case vtkCompositeAnimationPlayer::SEQUENCE:
@@ -434,6 +799,11 @@ bool vtkSMSaveAnimationProxy::WriteAnimationLocally(const char* filename)
         startTime + ((endTime - startTime) * frameWindow[0]) / (numFrames - 1);
       playbackTimeWindow[1] =
         startTime + ((endTime - startTime) * frameWindow[1]) / (numFrames - 1);
+      for (int cc = 0; cc < numFrames; ++cc)
+      {
+        frameTimes.push_back(
+          numFrames > 1 ? startTime + ((endTime - startTime) * cc) / (numFrames - 1) : startTime);
+      }
     }
     break;
     case vtkCompositeAnimationPlayer::SNAP_TO_TIMESTEPS:
@@ -445,6 +815,7 @@ bool vtkSMSaveAnimationProxy::WriteAnimationLocally(const char* filename)
       frameWindow[1] = frameWindow[1] >= numTS ? numTS - 1 : frameWindow[1];
       playbackTimeWindow[0] = tsValuesHelper.GetAsDouble(frameWindow[0]);
       playbackTimeWindow[1] = tsValuesHelper.GetAsDouble(frameWindow[1]);
+      frameTimes = tsValuesHelper.GetDoubleArray();
     }
 
     break;
@@ -456,6 +827,31 @@ bool vtkSMSaveAnimationProxy::WriteAnimationLocally(const char* filename)
   writer->SetStartFileCount(frameWindow[0]);
   writer->SetPlaybackTimeWindow(playbackTimeWindow);
 
+  // When the processes were split into time compartments with
+  // --time-compartments, every compartment runs this code with its own
+  // pipelines and saves a part of the frames. Scripts that split the
+  // processes themselves save all the frames in each of their groups.
+  vtkMultiProcessController* compartment = vtkProcessModule::GetTimeCompartmentController();
+  if (vtkProcessModule::GetProcessModule()->GetSymmetricMPIMode() && compartment &&
+    compartment == vtkMultiProcessController::GetGlobalController())
+  {
+    vtkSMSaveAnimationProxyNS::FrameScheduler scheduler(
+      compartment, vtkProcessModule::GetTimeCompartmentRootsController());
+    bool status = true;
+    if (imageSeriesWriter)
+    {
+      scheduler.SetFrameRange(frameWindow[0], frameWindow[1]);
+      status = imageSeriesWriter->SaveScheduledFrames(scheduler, frameTimes);
+    }
+    else if (scheduler.GetCompartmentIndex() == 0)
+    {
+      // a movie is a single stream, the first compartment saves all of it.
+      status = writer->Save();
+    }
+    this->Cleanup();
+    return status;
+  }
+
   // register with progress handler so we monitor progress events.
   this->GetSession()->GetProgressHandler()->RegisterProgressEvent(
     writer.Get(), static_cast<int>(this->GetGlobalID()));
@@ -21,6 +21,14 @@
  * configure when saving animations. Once those properties are setup, one
  * calls vtkSMSaveAnimationProxy::WriteAnimation` to save out the animation.
  *
+ * In symmetric batch mode, when the processes have been split into time
+ * compartments with the `--time-compartments` option of pvbatch (see
+ * vtkProcessModule::CreateTimeCompartments), each compartment renders a
+ * different part of the frames with its own pipelines and the root of each
+ * compartment writes its frames directly. Frames are handed out in rounds, in
+ * proportion to the measured rendering rate of each compartment. Movies are a
+ * single stream and are saved by the first compartment only.
+ *
  */
 
 #ifndef vtkSMSaveAnimationProxy_h
@@ -25,8 +25,17 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 namespace
 {
@@ -100,6 +109,186 @@ std::vector<vtkSmartPointer<T> > PyListToVectorOfVTKObjects(vtkSmartPyObject pyo
   }
   return layers;
 }
+
+// Values for a parameter in a query, as raw tokens i.e. strings keep their
+// quotes. `IsList` is true when the values were specified as a list.
+struct ParameterValues
+{
+  bool IsList;
+  std::vector<std::string> Tokens;
+  ParameterValues()
+    : IsList(false)
+  {
+  }
+  bool operator==(const ParameterValues& other) const
+  {
+    return this->IsList == other.IsList && this->Tokens == other.Tokens;
+  }
+  bool operator!=(const ParameterValues& other) const { return !(*this == other); }
+};
+typedef std::map<std::string, ParameterValues> ParsedQuery;
+
+void SkipCharacters(const std::string& str, size_t& pos, const char* chars)
+{
+  while (pos < str.size() && (isspace(str[pos]) || (str[pos] != 0 && strchr(chars, str[pos]))))
+  {
+    ++pos;
+  }
+}
+
+// Reads a token starting at `pos`, either a quoted string or a run of
+// characters up to the next delimiter.
+bool ReadToken(const std::string& str, size_t& pos, std::string& token)
+{
+  const size_t start = pos;
+  if (pos < str.size() && (str[pos] == '\'' || str[pos] == '"'))
+  {
+    const size_t end = str.find(str[pos], pos + 1);
+    if (end == std::string::npos)
+    {
+      return false;
+    }
+    pos = end + 1;
+  }
+  else
+  {
+    while (pos < str.size() && !isspace(str[pos]) && strchr(",:[]{}", str[pos]) == NULL)
+    {
+      ++pos;
+    }
+  }
+  token = str.substr(start, pos - start);
+  return !token.empty();
+}
+
+std::string Unquote(const std::string& token)
+{
+  if (token.size() >= 2 && (token[0] == '\'' || token[0] == '"') &&
+    token[token.size() - 1] == token[0])
+  {
+    return token.substr(1, token.size() - 2);
+  }
+  return token;
+}
+
+// Parses queries of the form `{'param' : [value, ...], 'param' : value, ...}`
+// as built by vtkCinemaDatabaseReader and vtkCinemaLayerRepresentation.
+bool ParseQuery(const std::string& query, ParsedQuery& result)
+{
+  size_t pos = 0;
+  SkipCharacters(query, pos, "{,");
+  while (pos < query.size() && query[pos] != '}')
+  {
+    std::string key;
+    if (!ReadToken(query, pos, key))
+    {
+      return false;
+    }
+    SkipCharacters(query, pos, "");
+    if (pos >= query.size() || query[pos] != ':')
+    {
+      return false;
+    }
+    ++pos;
+    SkipCharacters(query, pos, "");
+
+    ParameterValues& values = result[Unquote(key)];
+    std::string token;
+    if (pos < query.size() && query[pos] == '[')
+    {
+      values.IsList = true;
+      ++pos;
+      SkipCharacters(query, pos, ",");
+      while (pos < query.size() && query[pos] != ']')
+      {
+        if (!ReadToken(query, pos, token))
+        {
+          return false;
+        }
+        values.Tokens.push_back(token);
+        SkipCharacters(query, pos, ",");
+      }
+      if (pos >= query.size())
+      {
+        return false;
+      }
+      ++pos;
+    }
+    else if (ReadToken(query, pos, token))
+    {
+      values.Tokens.push_back(token);
+    }
+    else
+    {
+      return false;
+    }
+    SkipCharacters(query, pos, ",");
+  }
+  return true;
+}
+
+// Returns a string that uniquely identifies the parameter values in a query,
+// irrespective of formatting and parameter order.
+std::string GetQueryKey(const ParsedQuery& query)
+{
+  std::ostringstream key;
+  for (ParsedQuery::const_iterator iter = query.begin(); iter != query.end(); ++iter)
+  {
+    key << iter->first << "=";
+    for (size_t cc = 0; cc < iter->second.Tokens.size(); ++cc)
+    {
+      key << (cc > 0 ? "," : "") << Unquote(iter->second.Tokens[cc]);
+    }
+    key << ";";
+  }
+  return key.str();
+}
+
+std::string BuildQueryString(const ParsedQuery& query)
+{
+  std::ostringstream str;
+  str << "{";
+  for (ParsedQuery::const_iterator iter = query.begin(); iter != query.end(); ++iter)
+  {
+    str << (iter != query.begin() ? ", " : "") << "'" << iter->first << "' : ";
+    str << (iter->second.IsList ? "[" : "");
+    for (size_t cc = 0; cc < iter->second.Tokens.size(); ++cc)
+    {
+      str << (cc > 0 ? ", " : "") << iter->second.Tokens[cc];
+    }
+    str << (iter->second.IsList ? "]" : "");
+  }
+  str << "}";
+  return str.str();
+}
+
+// Returns the index of `token` in `values`, or -1.
+int FindParameterValue(const std::vector<std::string>& values, const std::string& token)
+{
+  const std::string value = Unquote(token);
+  for (size_t cc = 0; cc < values.size(); ++cc)
+  {
+    if (values[cc] == value)
+    {
+      return static_cast<int>(cc);
+    }
+  }
+  // values may be formatted differently, try comparing as numbers.
+  char* end = NULL;
+  const double dvalue = strtod(value.c_str(), &end);
+  if (end == value.c_str() || *end != 0)
+  {
+    return -1;
+  }
+  for (size_t cc = 0; cc < values.size(); ++cc)
+  {
+    if (atof(values[cc].c_str()) == dvalue)
+    {
+      return static_cast<int>(cc);
+    }
+  }
+  return -1;
+}
 }
 
 class vtkCinemaDatabase::vtkInternals
@@ -423,16 +612,392 @@ public:
   }
 };
 
+//****************************************************************************
+// LRU cache of layers for queries, with a worker thread that prefetches
+// layers for queries neighboring the most recent one.
+class vtkCinemaDatabase::vtkQueryCache
+{
+public:
+  vtkQueryCache(vtkCinemaDatabase::vtkInternals* internals)
+    : Internals(internals)
+    , SizeLimit(256 * 1024)
+    , Size(0)
+    , Prefetch(true)
+    , Hits(0)
+    , Misses(0)
+    , Prefetched(0)
+    , PrefetchPending(false)
+    , Stop(false)
+    , Generation(0)
+    , ParameterValuesGeneration(0)
+  {
+  }
+
+  ~vtkQueryCache() { this->StopWorker(); }
+
+  /**
+   * Stops the prefetching worker, if running, and waits for it to finish. It
+   * is restarted by the next query. Must be called before the database held
+   * by Internals changes.
+   */
+  void StopWorker()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Stop = true;
+      this->PrefetchRequested.notify_all();
+    }
+    if (this->Worker.joinable())
+    {
+#ifdef VTK_PYTHON_FULL_THREADSAFE
+      this->Worker.join();
+#else
+      // the worker may be waiting for the GIL held by this thread.
+      PyThreadState* state = PyEval_SaveThread();
+      this->Worker.join();
+      PyEval_RestoreThread(state);
+#endif
+    }
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Stop = false;
+  }
+
+  void SetDatabase(const std::string& fname)
+  {
+    if (this->FileName != fname)
+    {
+      this->Clear();
+      this->FileName = fname;
+    }
+  }
+
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Entries.clear();
+    this->Index.clear();
+    this->Size = 0;
+    this->Hits = this->Misses = this->Prefetched = 0;
+    this->PrefetchPending = false;
+    this->LastQuery.clear();
+    this->Generation++;
+  }
+
+  void SetSizeLimit(unsigned long kilobytes)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->SizeLimit = kilobytes;
+    this->Evict();
+  }
+  unsigned long GetSizeLimit() const { return this->SizeLimit; }
+
+  void SetPrefetch(bool val) { this->Prefetch = val; }
+  bool GetPrefetch() const { return this->Prefetch; }
+
+  vtkIdType GetHits() const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return this->Hits;
+  }
+  vtkIdType GetMisses() const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return this->Misses;
+  }
+  vtkIdType GetPrefetched() const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return this->Prefetched;
+  }
+  double GetHitRate() const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    const vtkIdType total = this->Hits + this->Misses;
+    return total > 0 ? static_cast<double>(this->Hits) / total : 0.0;
+  }
+
+  std::vector<vtkSmartPointer<vtkImageData> > TranslateQuery(const std::string& query)
+  {
+    ParsedQuery parsed;
+    if (!ParseQuery(query, parsed))
+    {
+      // not a query we understand; don't bother caching.
+      return this->Internals->TranslateQuery(query);
+    }
+
+    const std::string key = GetQueryKey(parsed);
+    std::vector<vtkSmartPointer<vtkImageData> > layers;
+    bool found = false;
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      found = this->Find(key, layers);
+      if (found)
+      {
+        ++this->Hits;
+      }
+      else
+      {
+        ++this->Misses;
+      }
+    }
+    if (!found)
+    {
+      // Note that we don't wait on the worker, even if it is currently loading
+      // this very query, since it may need the Python GIL held by this thread.
+      layers = this->Internals->TranslateQuery(query);
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Insert(key, layers);
+    }
+
+    if (this->Prefetch && this->SizeLimit > 0)
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      if (!this->PrefetchPending || this->PendingQuery != parsed)
+      {
+        this->PendingPreviousQuery = this->LastQuery;
+        this->PendingQuery = parsed;
+        this->PrefetchPending = true;
+        this->PrefetchRequested.notify_all();
+      }
+      if (!this->Worker.joinable())
+      {
+#ifndef VTK_PYTHON_FULL_THREADSAFE
+        // this thread holds the GIL; make sure it is handed over to the worker
+        // whenever the interpreter runs.
+        PyEval_InitThreads();
+#endif
+        this->Worker = std::thread(&vtkQueryCache::PrefetchLoop, this);
+      }
+    }
+    this->LastQuery = parsed;
+    return layers;
+  }
+
+private:
+  struct EntryType
+  {
+    std::string Key;
+    std::vector<vtkSmartPointer<vtkImageData> > Layers;
+    unsigned long Size;
+  };
+
+  // Must be called with Mutex locked.
+  bool Find(const std::string& key, std::vector<vtkSmartPointer<vtkImageData> >& layers)
+  {
+    IndexType::iterator iter = this->Index.find(key);
+    if (iter == this->Index.end())
+    {
+      return false;
+    }
+    this->Entries.splice(this->Entries.begin(), this->Entries, iter->second);
+    layers = iter->second->Layers;
+    return true;
+  }
+
+  // Must be called with Mutex locked.
+  void Insert(const std::string& key, const std::vector<vtkSmartPointer<vtkImageData> >& layers)
+  {
+    if (layers.empty() || this->Index.find(key) != this->Index.end())
+    {
+      return;
+    }
+    EntryType entry;
+    entry.Key = key;
+    entry.Layers = layers;
+    entry.Size = 0;
+    for (size_t cc = 0; cc < layers.size(); ++cc)
+    {
+      entry.Size += layers[cc] ? layers[cc]->GetActualMemorySize() : 0;
+    }
+    this->Entries.push_front(entry);
+    this->Index[key] = this->Entries.begin();
+    this->Size += entry.Size;
+    this->Evict();
+  }
+
+  // Must be called with Mutex locked.
+  void Evict()
+  {
+    while (this->Size > this->SizeLimit && !this->Entries.empty())
+    {
+      this->Size -= this->Entries.back().Size;
+      this->Index.erase(this->Entries.back().Key);
+      this->Entries.pop_back();
+    }
+  }
+
+  // Returns the values for a parameter as known to the database. Called on
+  // the worker thread only.
+  const std::vector<std::string>& GetParameterValues(const std::string& name)
+  {
+    std::map<std::string, std::vector<std::string> >::iterator iter =
+      this->ParameterValuesCache.find(name);
+    if (iter == this->ParameterValuesCache.end())
+    {
+      iter = this->ParameterValuesCache
+               .insert(std::make_pair(name, this->Internals->GetControlParameterValues(name)))
+               .first;
+    }
+    return iter->second;
+  }
+
+  // Builds the list of queries to prefetch given the current and previous
+  // queries. The parameter that changed between the two is explored first,
+  // in the direction it changed, followed by the immediate neighbors for all
+  // other single valued parameters.
+  std::vector<ParsedQuery> GetNeighbors(const ParsedQuery& query, const ParsedQuery& previous)
+  {
+    std::vector<ParsedQuery> first;
+    std::vector<ParsedQuery> others;
+    for (ParsedQuery::const_iterator iter = query.begin(); iter != query.end(); ++iter)
+    {
+      // the visible objects and the camera pose are not parameters with a
+      // natural ordering to explore.
+      if (iter->second.Tokens.size() != 1 || iter->first == "vis" || iter->first == "pose")
+      {
+        continue;
+      }
+      const std::vector<std::string>& values = this->GetParameterValues(iter->first);
+      const int index = FindParameterValue(values, iter->second.Tokens[0]);
+      if (index < 0)
+      {
+        continue;
+      }
+
+      int direction = 0;
+      ParsedQuery::const_iterator piter = previous.find(iter->first);
+      if (piter != previous.end() && piter->second.Tokens.size() == 1)
+      {
+        const int pindex = FindParameterValue(values, piter->second.Tokens[0]);
+        direction = (pindex < 0 || pindex == index) ? 0 : (index > pindex ? 1 : -1);
+      }
+
+      const bool quoted = iter->second.Tokens[0] != Unquote(iter->second.Tokens[0]);
+      const int offsets[] = { direction != 0 ? direction : 1, direction != 0 ? 2 * direction : -1,
+        direction != 0 ? -direction : 0 };
+      for (int cc = 0; cc < 3; ++cc)
+      {
+        const int nindex = index + offsets[cc];
+        if (offsets[cc] == 0 || nindex < 0 || nindex >= static_cast<int>(values.size()))
+        {
+          continue;
+        }
+        ParsedQuery neighbor = query;
+        neighbor[iter->first].Tokens[0] = quoted ? "'" + values[nindex] + "'" : values[nindex];
+        (direction != 0 ? first : others).push_back(neighbor);
+      }
+    }
+    first.insert(first.end(), others.begin(), others.end());
+    return first;
+  }
+
+  void PrefetchLoop()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (!this->Stop)
+    {
+      this->PrefetchRequested.wait(lock, [this]() { return this->Stop || this->PrefetchPending; });
+      if (this->Stop)
+      {
+        break;
+      }
+      const ParsedQuery query = this->PendingQuery;
+      const ParsedQuery previous = this->PendingPreviousQuery;
+      const unsigned int generation = this->Generation;
+      this->PrefetchPending = false;
+      if (this->ParameterValuesGeneration != generation)
+      {
+        // a different database may have been loaded.
+        this->ParameterValuesCache.clear();
+        this->ParameterValuesGeneration = generation;
+      }
+
+      lock.unlock();
+      std::vector<ParsedQuery> neighbors;
+      {
+        // Internals only acquires the GIL itself when Python is built
+        // thread-safe, so always acquire it explicitly on this thread.
+        vtkPythonScopeGilEnsurer gilEnsurer(true);
+        neighbors = this->GetNeighbors(query, previous);
+      }
+      lock.lock();
+
+      for (size_t cc = 0; cc < neighbors.size(); ++cc)
+      {
+        // stop as soon as a newer query comes along, its neighbors are more
+        // relevant.
+        if (this->Stop || this->PrefetchPending || this->Generation != generation)
+        {
+          break;
+        }
+        const std::string key = GetQueryKey(neighbors[cc]);
+        if (this->Index.find(key) != this->Index.end())
+        {
+          continue;
+        }
+
+        lock.unlock();
+        std::vector<vtkSmartPointer<vtkImageData> > layers;
+        {
+          vtkPythonScopeGilEnsurer gilEnsurer(true);
+          layers = this->Internals->TranslateQuery(BuildQueryString(neighbors[cc]));
+        }
+        lock.lock();
+
+        if (this->Generation == generation && !layers.empty())
+        {
+          this->Insert(key, layers);
+          ++this->Prefetched;
+        }
+      }
+    }
+  }
+
+  vtkCinemaDatabase::vtkInternals* Internals;
+  std::string FileName;
+
+  typedef std::list<EntryType> EntriesType;
+  typedef std::unordered_map<std::string, EntriesType::iterator> IndexType;
+  EntriesType Entries;
+  IndexType Index;
+  unsigned long SizeLimit; // in KiB
+  unsigned long Size;      // in KiB
+  bool Prefetch;
+
+  vtkIdType Hits;
+  vtkIdType Misses;
+  vtkIdType Prefetched;
+
+  ParsedQuery LastQuery;
+  ParsedQuery PendingQuery;
+  ParsedQuery PendingPreviousQuery;
+  bool PrefetchPending;
+  bool Stop;
+  unsigned int Generation;
+
+  // only accessed on the worker thread.
+  unsigned int ParameterValuesGeneration;
+  std::map<std::string, std::vector<std::string> > ParameterValuesCache;
+
+  mutable std::mutex Mutex;
+  std::condition_variable PrefetchRequested;
+  std::thread Worker;
+};
+
 vtkStandardNewMacro(vtkCinemaDatabase);
 //----------------------------------------------------------------------------
 vtkCinemaDatabase::vtkCinemaDatabase()
 {
   this->Internals = new vtkCinemaDatabase::vtkInternals();
+  this->Cache = new vtkCinemaDatabase::vtkQueryCache(this->Internals);
 }
 
 //----------------------------------------------------------------------------
 vtkCinemaDatabase::~vtkCinemaDatabase()
 {
+  // the cache's worker uses Internals, so stop it first.
+  delete this->Cache;
+  this->Cache = NULL;
   delete this->Internals;
   this->Internals = NULL;
 }
@@ -442,6 +1007,9 @@ bool vtkCinemaDatabase::Load(const char* fname)
 {
   if (fname && fname[0] != 0)
   {
+    // the worker must not be using the FileStore while it's replaced.
+    this->Cache->StopWorker();
+    this->Cache->SetDatabase(fname);
     return this->Internals->LoadDatabase(fname);
   }
 
@@ -525,10 +1093,72 @@ bool vtkCinemaDatabase::GetFieldValueRange(
 std::vector<vtkSmartPointer<vtkImageData> > vtkCinemaDatabase::TranslateQuery(
   const std::string& query) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->TranslateQuery(query)
+  return this->Internals->IsLoaded() ? this->Cache->TranslateQuery(query)
                                      : std::vector<vtkSmartPointer<vtkImageData> >();
 }
 
+//----------------------------------------------------------------------------
+void vtkCinemaDatabase::SetCacheSizeLimit(unsigned long megabytes)
+{
+  if (this->Cache->GetSizeLimit() != megabytes * 1024)
+  {
+    this->Cache->SetSizeLimit(megabytes * 1024);
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkCinemaDatabase::GetCacheSizeLimit() const
+{
+  return this->Cache->GetSizeLimit() / 1024;
+}
+
+//----------------------------------------------------------------------------
+void vtkCinemaDatabase::SetPrefetch(bool val)
+{
+  if (this->Cache->GetPrefetch() != val)
+  {
+    this->Cache->SetPrefetch(val);
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkCinemaDatabase::GetPrefetch() const
+{
+  return this->Cache->GetPrefetch();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCinemaDatabase::GetNumberOfCacheHits() const
+{
+  return this->Cache->GetHits();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCinemaDatabase::GetNumberOfCacheMisses() const
+{
+  return this->Cache->GetMisses();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCinemaDatabase::GetNumberOfPrefetchedQueries() const
+{
+  return this->Cache->GetPrefetched();
+}
+
+//----------------------------------------------------------------------------
+double vtkCinemaDatabase::GetCacheHitRate() const
+{
+  return this->Cache->GetHitRate();
+}
+
+//----------------------------------------------------------------------------
+void vtkCinemaDatabase::ClearCache()
+{
+  this->Cache->Clear();
+}
+
 //----------------------------------------------------------------------------
 std::vector<vtkSmartPointer<vtkCamera> > vtkCinemaDatabase::Cameras(
   const std::string& timestep) const
@@ -599,4 +1229,9 @@ std::string vtkCinemaDatabase::GetNearestParameterValue(
 void vtkCinemaDatabase::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheSizeLimit: " << this->GetCacheSizeLimit() << endl;
+  os << indent << "Prefetch: " << this->GetPrefetch() << endl;
+  os << indent << "NumberOfCacheHits: " << this->GetNumberOfCacheHits() << endl;
+  os << indent << "NumberOfCacheMisses: " << this->GetNumberOfCacheMisses() << endl;
+  os << indent << "NumberOfPrefetchedQueries: " << this->GetNumberOfPrefetchedQueries() << endl;
 }
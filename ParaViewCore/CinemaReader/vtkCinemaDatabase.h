@@ -109,9 +109,52 @@ public:
 
   /**
    * Get the layers for a specific query.
+   *
+   * Layers are cached, keyed by the parameter values in the query, so
+   * repeated queries don't need to load and decode images again. When
+   * prefetching is enabled, layers for the neighboring values of the
+   * parameters in the query are loaded on a worker thread, starting with the
+   * parameter that changed between the last two queries.
    */
   std::vector<vtkSmartPointer<vtkImageData> > TranslateQuery(const std::string& query) const;
 
+  //@{
+  /**
+   * Get/Set the maximum amount of memory, in megabytes, used to cache layers.
+   * Least recently used queries are evicted first. Set to 0 to disable
+   * caching. Default is 256.
+   */
+  void SetCacheSizeLimit(unsigned long megabytes);
+  unsigned long GetCacheSizeLimit() const;
+  //@}
+
+  //@{
+  /**
+   * Enable/disable prefetching of layers for queries neighboring the most
+   * recent one. Unless Python is built with VTK_PYTHON_FULL_THREADSAFE, the
+   * worker thread only makes progress while the main thread releases the GIL,
+   * e.g. while it runs Python code. Default is true.
+   */
+  void SetPrefetch(bool);
+  bool GetPrefetch() const;
+  //@}
+
+  //@{
+  /**
+   * Cache statistics. A query for which layers were being prefetched but
+   * weren't available yet counts as a miss.
+   */
+  vtkIdType GetNumberOfCacheHits() const;
+  vtkIdType GetNumberOfCacheMisses() const;
+  vtkIdType GetNumberOfPrefetchedQueries() const;
+  double GetCacheHitRate() const;
+  //@}
+
+  /**
+   * Clears all cached layers and statistics.
+   */
+  void ClearCache();
+
   /**
    * Get cameras
    */
@@ -143,6 +186,9 @@ private:
 
   class vtkInternals;
   vtkInternals* Internals;
+
+  class vtkQueryCache;
+  vtkQueryCache* Cache;
 };
 
 #endif
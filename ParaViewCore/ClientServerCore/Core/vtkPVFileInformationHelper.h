@@ -139,6 +139,22 @@ public:
   vtkSetMacro(ReadDetailedFileInformation, bool);
   //@}
 
+  //@{
+  /**
+   * Get/Set the range of the directory listing to return when DirectoryListing
+   * is on. When ListingPageSize is greater than 0, only ListingPageSize entries
+   * starting at ListingOffset are returned, which lets clients fetch large
+   * listings in pages. vtkPVFileInformation::GetTotalNumberOfContents() gives
+   * the number of entries in the complete listing. The grouped listing is
+   * cached on the server so requesting subsequent pages doesn't list the
+   * directory again. Defaults to 0 and 0 i.e. the complete listing.
+   */
+  vtkGetMacro(ListingOffset, int);
+  vtkSetClampMacro(ListingOffset, int, 0, VTK_INT_MAX);
+  vtkGetMacro(ListingPageSize, int);
+  vtkSetClampMacro(ListingPageSize, int, 0, VTK_INT_MAX);
+  //@}
+
 protected:
   vtkPVFileInformationHelper();
   ~vtkPVFileInformationHelper() override;
@@ -150,6 +166,8 @@ protected:
   int FastFileTypeDetection;
 
   bool ReadDetailedFileInformation;
+  int ListingOffset;
+  int ListingPageSize;
   char* PathSeparator;
   vtkSetStringMacro(PathSeparator);
 
@@ -58,9 +58,11 @@ vtkPVOptions::vtkPVOptions()
   this->MultiServerMode = 0;
   this->RenderServerMode = 0;
   this->SymmetricMPIMode = 0;
+  this->NumberOfTimeCompartments = 1;
   this->TellVersion = 0;
   this->EnableStreaming = 0;
   this->SatelliteMessageIds = 0;
+  this->BroadcastDefinitions = 0;
   this->PrintMonitors = 0;
   this->ServerURL = 0;
   this->ReverseConnection = 0;
@@ -234,6 +236,12 @@ void vtkPVOptions::Initialize()
     "When specified, the python script is processed symmetrically on all processes.",
     vtkPVOptions::PVBATCH);
 
+  this->AddArgument("--time-compartments", 0, &this->NumberOfTimeCompartments,
+    "Split the processes into this number of groups, each processing the python "
+    "script with its own pipelines. Animations are then saved in parallel over "
+    "time, each group rendering a part of the frames. Requires --symmetric.",
+    vtkPVOptions::PVBATCH);
+
   this->AddBooleanArgument("--enable-streaming", 0, &this->EnableStreaming,
     "EXPERIMENTAL: When specified, view-based streaming is enabled for certain "
     "views and representation types.",
@@ -244,6 +252,12 @@ void vtkPVOptions::Initialize()
     "When specified, server side messages shown on client show rank of originating process",
     vtkPVOptions::PVSERVER);
 
+  this->AddBooleanArgument("--broadcast-definitions", 0, &this->BroadcastDefinitions,
+    "When specified, configuration XML loaded at startup is parsed on the root process "
+    "only and broadcast to all other processes.",
+    vtkPVOptions::PVSERVER | vtkPVOptions::PVDATA_SERVER | vtkPVOptions::PVRENDER_SERVER |
+      vtkPVOptions::PVBATCH);
+
   this->AddArgument("--test-plugin", 0, &this->TestPlugin,
     "Specify the name of the plugin to load for testing", vtkPVOptions::ALLPROCESS);
 
@@ -354,6 +368,12 @@ int vtkPVOptions::PostProcess(int, const char* const*)
   }
 #endif // PARAVIEW_ALWAYS_SECURE_CONNECTION
 
+  if (this->NumberOfTimeCompartments > 1 && !this->SymmetricMPIMode)
+  {
+    this->SetErrorMessage("--time-compartments requires --symmetric.");
+    return 0;
+  }
+
   // do this here for simplicity since it's
   // a universal option. The current kwsys implementation
   // is for POSIX compliant OS's, and a NOOP on others
@@ -516,12 +536,14 @@ void vtkPVOptions::PrintSelf(ostream& os, vtkIndent indent)
      << endl;
   os << indent << "LogFileName: " << (this->LogFileName ? this->LogFileName : "(none)") << endl;
   os << indent << "SymmetricMPIMode: " << this->SymmetricMPIMode << endl;
+  os << indent << "NumberOfTimeCompartments: " << this->NumberOfTimeCompartments << endl;
   os << indent << "ServerURL: " << (this->ServerURL ? this->ServerURL : "(none)") << endl;
   os << indent << "EnableStreaming:" << (this->EnableStreaming ? "yes" : "no") << endl;
 
   os << indent << "EnableStackTrace:" << (this->EnableStackTrace ? "yes" : "no") << endl;
 
   os << indent << "SatelliteMessageIds " << this->SatelliteMessageIds << std::endl;
+  os << indent << "BroadcastDefinitions " << this->BroadcastDefinitions << std::endl;
   os << indent << "PrintMonitors: " << this->PrintMonitors << std::endl;
   os << indent << "DisableXDisplayTests: " << this->DisableXDisplayTests << endl;
   os << indent << "ForceNoMPIInitOnClient: " << this->ForceNoMPIInitOnClient << endl;
@@ -153,6 +153,18 @@ public:
   vtkSetMacro(SymmetricMPIMode, int);
   //@}
 
+  //@{
+  /**
+   * Number of time compartments, groups of processes that each run the python
+   * script with their own pipelines, to split the processes into. Animations
+   * are then saved in parallel over time, each compartment rendering a part
+   * of the frames. Only applicable to PVBATCH processes in symmetric mode.
+   * Default is 1, the processes are not split.
+   */
+  vtkGetMacro(NumberOfTimeCompartments, int);
+  vtkSetMacro(NumberOfTimeCompartments, int);
+  //@}
+
   //@{
   /**
    * Should this run print the version numbers and exit.
@@ -190,6 +202,16 @@ public:
   vtkGetMacro(SatelliteMessageIds, int);
   //@}
 
+  //@{
+  /**
+   * When set, server-manager XML loaded at startup is parsed on the root
+   * process only and broadcast to the satellites, instead of having every
+   * process parse it. Disabled by default.
+   */
+  vtkSetMacro(BroadcastDefinitions, int);
+  vtkGetMacro(BroadcastDefinitions, int);
+  //@}
+
   //@{
   /**
    * Should this process just print monitor information and exit?
@@ -320,6 +342,7 @@ protected:
   int MultiClientModeWithErrorMacro;
   int MultiServerMode;
   int SymmetricMPIMode;
+  int NumberOfTimeCompartments;
   char* ServersFileName;
   char* TestPlugin; // to load plugins from command line for tests
   char* TestPluginPath;
@@ -349,6 +372,7 @@ private:
   char* StereoType;
   int EnableStreaming;
   int SatelliteMessageIds;
+  int BroadcastDefinitions;
   int PrintMonitors;
   int EnableStackTrace;
   int DisableRegistry;
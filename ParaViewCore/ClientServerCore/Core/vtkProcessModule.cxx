@@ -31,6 +31,7 @@
 #include "vtkPVConfig.h"
 #include "vtkPVOptions.h"
 #include "vtkPolyData.h"
+#include "vtkProcessGroup.h"
 #include "vtkSessionIterator.h"
 #include "vtkStdString.h"
 #include "vtkTCPNetworkAccessManager.h"
@@ -103,6 +104,8 @@ bool vtkProcessModule::FinalizePython = false;
 
 vtkSmartPointer<vtkProcessModule> vtkProcessModule::Singleton;
 vtkSmartPointer<vtkMultiProcessController> vtkProcessModule::GlobalController;
+vtkSmartPointer<vtkMultiProcessController> vtkProcessModule::TimeCompartmentController;
+vtkSmartPointer<vtkMultiProcessController> vtkProcessModule::TimeCompartmentRootsController;
 
 int vtkProcessModule::DefaultMinimumGhostLevelsToRequestForUnstructuredPipelines = 1;
 int vtkProcessModule::DefaultMinimumGhostLevelsToRequestForStructuredPipelines = 0;
@@ -304,6 +307,8 @@ bool vtkProcessModule::Finalize()
   // it's really stored with a weak pointer.  We set it to null anyways
   // in case it gets changed later to reference counting the pointer
   vtkMultiProcessController::SetGlobalController(NULL);
+  vtkProcessModule::TimeCompartmentController = NULL;
+  vtkProcessModule::TimeCompartmentRootsController = NULL;
   vtkProcessModule::GlobalController->Finalize(/*finalizedExternally*/ 1);
   vtkProcessModule::GlobalController = NULL;
 
@@ -357,6 +362,7 @@ vtkProcessModule::vtkProcessModule()
   this->MaxSessionId = 0;
   this->ReportInterpreterErrors = true;
   this->SymmetricMPIMode = false;
+  this->BroadcastDefinitions = false;
   this->MultipleSessionsSupport = false; // Set MULTI-SERVER to false as DEFAULT
   this->EventCallDataSessionId = 0;
 
@@ -466,6 +472,86 @@ vtkMultiProcessController* vtkProcessModule::GetGlobalController()
   return vtkMultiProcessController::GetGlobalController();
 }
 
+//----------------------------------------------------------------------------
+vtkMultiProcessController* vtkProcessModule::GetWorldController()
+{
+  return vtkProcessModule::GlobalController;
+}
+
+//----------------------------------------------------------------------------
+bool vtkProcessModule::CreateTimeCompartments(int count)
+{
+  vtkMultiProcessController* world = vtkProcessModule::GlobalController;
+  const int numRanks = world ? world->GetNumberOfProcesses() : 1;
+  if (count <= 1)
+  {
+    return true;
+  }
+  if (count > numRanks || vtkProcessModule::TimeCompartmentController)
+  {
+    vtkGenericWarningMacro("Cannot split " << numRanks << " processes into " << count
+                                           << " time compartments.");
+    return false;
+  }
+
+  // compartments are groups of consecutive ranks, the first `remainder`
+  // compartments get one more process than the others. Creating a
+  // sub-controller is collective on all the processes, only the members of
+  // the group get one.
+  const int size = numRanks / count;
+  const int remainder = numRanks % count;
+  vtkMultiProcessController* controller = NULL;
+  vtkNew<vtkProcessGroup> roots;
+  roots->Initialize(world->GetCommunicator());
+  roots->RemoveAllProcessIds();
+  for (int cc = 0, first = 0; cc < count; ++cc)
+  {
+    const int last = first + size + (cc < remainder ? 1 : 0);
+    vtkNew<vtkProcessGroup> group;
+    group->Initialize(world->GetCommunicator());
+    group->RemoveAllProcessIds();
+    for (int rank = first; rank < last; ++rank)
+    {
+      group->AddProcessId(rank);
+    }
+    roots->AddProcessId(first);
+    if (vtkMultiProcessController* subController = world->CreateSubController(group.GetPointer()))
+    {
+      controller = subController;
+    }
+    first = last;
+  }
+  vtkMultiProcessController* rootsController = world->CreateSubController(roots.GetPointer());
+  if (!controller)
+  {
+    vtkGenericWarningMacro("Failed to create the time compartments.");
+    if (rootsController)
+    {
+      rootsController->Delete();
+    }
+    return false;
+  }
+  vtkProcessModule::TimeCompartmentController.TakeReference(controller);
+  vtkProcessModule::TimeCompartmentRootsController.TakeReference(rootsController);
+
+  // the pipelines of each compartment are created on the global controller.
+  controller->BroadcastTriggerRMIOn();
+  vtkMultiProcessController::SetGlobalController(controller);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkMultiProcessController* vtkProcessModule::GetTimeCompartmentController()
+{
+  return vtkProcessModule::TimeCompartmentController;
+}
+
+//----------------------------------------------------------------------------
+vtkMultiProcessController* vtkProcessModule::GetTimeCompartmentRootsController()
+{
+  return vtkProcessModule::TimeCompartmentRootsController;
+}
+
 //----------------------------------------------------------------------------
 int vtkProcessModule::GetNumberOfLocalPartitions()
 {
@@ -478,6 +564,26 @@ int vtkProcessModule::GetPartitionId()
   return this->GetGlobalController() ? this->GetGlobalController()->GetLocalProcessId() : 0;
 }
 
+//----------------------------------------------------------------------------
+void vtkProcessModule::InitializeBroadcastDefinitions()
+{
+  this->BroadcastDefinitions = false;
+  vtkMultiProcessController* controller = this->GetGlobalController();
+  if (!controller || controller->GetNumberOfProcesses() <= 1)
+  {
+    return;
+  }
+
+  // the root decides so that all processes agree even if their environment
+  // differs.
+  int broadcast = ((this->Options && this->Options->GetBroadcastDefinitions() != 0) ||
+                    vtksys::SystemTools::GetEnv("PV_BROADCAST_DEFINITIONS") != NULL)
+    ? 1
+    : 0;
+  controller->Broadcast(&broadcast, 1, 0);
+  this->BroadcastDefinitions = (broadcast != 0);
+}
+
 //----------------------------------------------------------------------------
 bool vtkProcessModule::IsMPIInitialized()
 {
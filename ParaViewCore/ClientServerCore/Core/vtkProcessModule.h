@@ -222,6 +222,39 @@ public:
    */
   vtkMultiProcessController* GetGlobalController();
 
+  /**
+   * Provides access to the controller for all the processes, as set up by
+   * Initialize(). This is the global controller unless the processes were
+   * split into time compartments.
+   */
+  static vtkMultiProcessController* GetWorldController();
+
+  /**
+   * Splits the processes into the given number of groups of consecutive
+   * ranks, called time compartments, and makes the controller of the group
+   * this process belongs to the global controller. Each compartment then
+   * runs its own pipelines, e.g. to save a part of the frames of an animation
+   * (see vtkSMSaveAnimationProxy). This must be called on all processes,
+   * before any session is created. It is called at startup for the
+   * `--time-compartments` option of pvbatch. Returns false if the processes
+   * could not be split.
+   */
+  static bool CreateTimeCompartments(int count);
+
+  /**
+   * Returns the controller of the time compartment this process belongs to,
+   * or NULL if the processes were not split with CreateTimeCompartments().
+   */
+  static vtkMultiProcessController* GetTimeCompartmentController();
+
+  /**
+   * Returns the controller connecting the first process of each time
+   * compartment, in the order of the compartments. It is NULL on the other
+   * processes, or if the processes were not split with
+   * CreateTimeCompartments().
+   */
+  static vtkMultiProcessController* GetTimeCompartmentRootsController();
+
   /**
    * Returns the number of processes in this process group.
    */
@@ -237,6 +270,25 @@ public:
    */
   bool IsMPIInitialized();
 
+  /**
+   * Returns true if configuration XML should be read and parsed on the root
+   * process only and broadcast to the other processes in this process group.
+   * This is the case when running in parallel with the
+   * `--broadcast-definitions` option or the PV_BROADCAST_DEFINITIONS
+   * environment variable set on the root process. The value is decided by
+   * InitializeBroadcastDefinitions() and is false until then.
+   */
+  bool GetBroadcastDefinitions() { return this->BroadcastDefinitions; }
+
+  /**
+   * Decides whether to broadcast configuration XML from the root's options
+   * and environment. Must be called collectively on all the processes of the
+   * global controller, once the options are set. vtkInitializationHelper
+   * does it during startup. No communication happens when running on a
+   * single process.
+   */
+  void InitializeBroadcastDefinitions();
+
   //@{
   /**
    * Set/Get whether to report errors from the Interpreter.
@@ -358,9 +410,13 @@ private:
 
   static vtkSmartPointer<vtkProcessModule> Singleton;
   static vtkSmartPointer<vtkMultiProcessController> GlobalController;
+  static vtkSmartPointer<vtkMultiProcessController> TimeCompartmentController;
+  static vtkSmartPointer<vtkMultiProcessController> TimeCompartmentRootsController;
 
   bool SymmetricMPIMode;
 
+  bool BroadcastDefinitions;
+
   bool MultipleSessionsSupport;
 
   vtkIdType EventCallDataSessionId;
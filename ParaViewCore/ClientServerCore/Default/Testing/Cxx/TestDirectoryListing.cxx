@@ -0,0 +1,193 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestDirectoryListing.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkClientServerStream.h"
+#include "vtkCollection.h"
+#include "vtkDirectory.h"
+#include "vtkNew.h"
+#include "vtkPVFileInformation.h"
+#include "vtkPVFileInformationHelper.h"
+#include "vtkTestUtilities.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+void CreateFile(const std::string& path)
+{
+  std::ofstream file(path.c_str());
+  file << "dummy" << std::endl;
+}
+
+int CountType(vtkPVFileInformation* info, int type)
+{
+  int count = 0;
+  vtkCollection* contents = info->GetContents();
+  for (int cc = 0; cc < contents->GetNumberOfItems(); ++cc)
+  {
+    if (vtkPVFileInformation::SafeDownCast(contents->GetItemAsObject(cc))->GetType() == type)
+    {
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::string ToLower(std::string name)
+{
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  return name;
+}
+
+// Requests all pages of the listing, adding the names of the entries to
+// `names` in the order they are listed. Returns the number of pages, or -1 if
+// the generation of the listing changed between pages.
+int PageThroughListing(vtkPVFileInformationHelper* helper, vtkPVFileInformation* info,
+  std::vector<std::string>& names)
+{
+  int pages = 0;
+  vtkTypeInt64 generation = 0;
+  for (int offset = 0; offset < 100; offset += helper->GetListingPageSize())
+  {
+    helper->SetListingOffset(offset);
+    info->CopyFromObject(helper);
+    if (pages++ > 0 && info->GetListingGeneration() != generation)
+    {
+      return -1;
+    }
+    generation = info->GetListingGeneration();
+    vtkCollection* contents = info->GetContents();
+    for (int cc = 0; cc < contents->GetNumberOfItems(); ++cc)
+    {
+      names.push_back(vtkPVFileInformation::SafeDownCast(contents->GetItemAsObject(cc))->GetName());
+    }
+    if (offset + helper->GetListingPageSize() >= info->GetTotalNumberOfContents())
+    {
+      break;
+    }
+  }
+  return pages;
+}
+
+// The listing must be in the order the file dialog shows it: the directory
+// first, then the files case-insensitively.
+bool CheckOrder(const std::vector<std::string>& names)
+{
+  if (names.size() != 5 || names[0] != "subdir")
+  {
+    return false;
+  }
+  for (size_t cc = 2; cc < names.size(); ++cc)
+  {
+    if (ToLower(names[cc]) < ToLower(names[cc - 1]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestDirectoryListing(int argc, char* argv[])
+{
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  const std::string dir = std::string(tempDir) + "/TestDirectoryListing";
+  delete[] tempDir;
+
+  // 2 file series, 2 single files and a directory. B.csv sorts before a.txt
+  // in strcmp order but not in the dialog's order.
+  vtkDirectory::DeleteDirectory(dir.c_str());
+  vtkDirectory::MakeDirectory((dir + "/subdir").c_str());
+  for (int cc = 0; cc < 50; ++cc)
+  {
+    std::ostringstream data, other;
+    data << dir << "/data_" << cc << ".vtk";
+    other << dir << "/other" << cc << ".txt";
+    CreateFile(data.str());
+    CreateFile(other.str());
+  }
+  CreateFile(dir + "/a.txt");
+  CreateFile(dir + "/B.csv");
+
+  vtkNew<vtkPVFileInformationHelper> helper;
+  helper->SetPath(dir.c_str());
+  helper->SetDirectoryListing(1);
+
+  vtkNew<vtkPVFileInformation> info;
+  info->CopyFromObject(helper.Get());
+  if (info->GetContents()->GetNumberOfItems() != 5 || info->GetTotalNumberOfContents() != 5 ||
+    CountType(info.Get(), vtkPVFileInformation::FILE_GROUP) != 2 ||
+    CountType(info.Get(), vtkPVFileInformation::SINGLE_FILE) != 2 ||
+    CountType(info.Get(), vtkPVFileInformation::DIRECTORY) != 1)
+  {
+    std::cerr << "Unexpected directory listing." << std::endl;
+    info->Print(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  // request the listing in pages, starting with an empty cache. All pages but
+  // the first one must be served from the cache.
+  vtkPVFileInformation::SetDirectoryListingCacheSize(0);
+  vtkPVFileInformation::SetDirectoryListingCacheSize(8);
+  helper->SetListingPageSize(2);
+  const vtkIdType hits = vtkPVFileInformation::GetNumberOfDirectoryListingCacheHits();
+  std::vector<std::string> names;
+  int pages = PageThroughListing(helper.Get(), info.Get(), names);
+  if (pages < 0 || !CheckOrder(names) || info->GetTotalNumberOfContents() != 5 ||
+    info->GetContents()->GetNumberOfItems() != 1)
+  {
+    std::cerr << "Unexpected paged directory listing." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (vtkPVFileInformation::GetNumberOfDirectoryListingCacheHits() - hits != pages - 1)
+  {
+    std::cerr << "Expected " << pages - 1 << " pages to be served from the cache, got "
+              << vtkPVFileInformation::GetNumberOfDirectoryListingCacheHits() - hits << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // listings with detailed information aren't cached, their pages must line
+  // up nevertheless.
+  helper->SetReadDetailedFileInformation(true);
+  names.clear();
+  if (PageThroughListing(helper.Get(), info.Get(), names) < 0 || !CheckOrder(names))
+  {
+    std::cerr << "Unexpected paged detailed directory listing." << std::endl;
+    return EXIT_FAILURE;
+  }
+  helper->SetReadDetailedFileInformation(false);
+
+  // the total number of contents and the generation must survive
+  // serialization.
+  vtkClientServerStream stream;
+  info->CopyToStream(&stream);
+  vtkNew<vtkPVFileInformation> info2;
+  info2->CopyFromStream(&stream);
+  if (info2->GetTotalNumberOfContents() != 5 || info2->GetContents()->GetNumberOfItems() != 1 ||
+    info2->GetListingGeneration() != info->GetListingGeneration())
+  {
+    std::cerr << "Failed to serialize paged directory listing." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkDirectory::DeleteDirectory(dir.c_str());
+  return EXIT_SUCCESS;
+}
@@ -50,6 +50,8 @@
 #endif
 
 #include <algorithm>
+#include <cctype>
+#include <list>
 #include <set>
 #include <string>
 #include <time.h>
@@ -351,6 +353,156 @@ class vtkPVFileInformationSet : public std::set<vtkSmartPointer<vtkPVFileInforma
 {
 };
 
+namespace
+{
+// Directory listings cached on the server, most recently used first. Entries
+// of the grouped listing are moved from Pending to Contents as their type is
+// detected, which is only done as far as the pages requested so far require.
+struct vtkPVFileInformationCachedListing
+{
+  vtkPVFileInformationCachedListing()
+    : ModificationTime(0)
+    , Listed(false)
+    , Contents(vtkSmartPointer<vtkCollection>::New())
+    , NextPending(0)
+  {
+  }
+
+  std::string Key;
+  vtkTypeInt64 ModificationTime;
+  bool Listed;
+  vtkSmartPointer<vtkCollection> Contents;
+  std::vector<vtkSmartPointer<vtkPVFileInformation> > Pending;
+  size_t NextPending;
+};
+typedef std::list<vtkPVFileInformationCachedListing> vtkPVFileInformationListingCache;
+
+vtkPVFileInformationListingCache& GetListingCache()
+{
+  static vtkPVFileInformationListingCache cache;
+  return cache;
+}
+
+int ListingCacheSize = 8;
+vtkIdType ListingCacheHits = 0;
+
+// Returns the directory modification time in nanoseconds, when the platform
+// provides it, so that changes within the same second are noticed.
+bool GetDirectoryModificationTime(const std::string& lpath, vtkTypeInt64& mtime)
+{
+  vtksys::SystemTools::Stat_t status;
+  if (vtksys::SystemTools::Stat(lpath, &status) != 0)
+  {
+    return false;
+  }
+#if defined(_WIN32)
+  mtime = static_cast<vtkTypeInt64>(status.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+  mtime = static_cast<vtkTypeInt64>(status.st_mtimespec.tv_sec) * 1000000000 +
+    status.st_mtimespec.tv_nsec;
+#else
+  mtime = static_cast<vtkTypeInt64>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+  return true;
+}
+
+// Returns the cached listing for the directory, adding an empty one to the
+// cache if needed. Returns NULL if the listing of the directory cannot be
+// cached.
+vtkPVFileInformationCachedListing* GetCachedListing(
+  const std::string& lpath, int fastFileTypeDetection, bool readDetailedFileInformation)
+{
+  vtkTypeInt64 mtime;
+  if (ListingCacheSize <= 0 || readDetailedFileInformation ||
+    !GetDirectoryModificationTime(lpath, mtime))
+  {
+    return NULL;
+  }
+  std::string key = lpath;
+  key += fastFileTypeDetection ? "|fast" : "|full";
+
+  vtkPVFileInformationListingCache& cache = GetListingCache();
+  for (vtkPVFileInformationListingCache::iterator iter = cache.begin(); iter != cache.end(); ++iter)
+  {
+    if (iter->Key == key)
+    {
+      if (iter->ModificationTime == mtime)
+      {
+        ++ListingCacheHits;
+        cache.splice(cache.begin(), cache, iter);
+        return &cache.front();
+      }
+      cache.erase(iter);
+      break;
+    }
+  }
+
+  cache.push_front(vtkPVFileInformationCachedListing());
+  cache.front().Key = key;
+  cache.front().ModificationTime = mtime;
+  while (static_cast<int>(cache.size()) > ListingCacheSize)
+  {
+    cache.pop_back();
+  }
+  return &cache.front();
+}
+
+// Orders listing entries the way the file dialog shows them: directories
+// first, then by name, case-insensitively. Names equal but for case are
+// ordered by strcmp so that the order doesn't depend on the listing.
+bool vtkPVFileInformationListingLess(const vtkSmartPointer<vtkPVFileInformation>& a,
+  const vtkSmartPointer<vtkPVFileInformation>& b)
+{
+  const bool aDir = vtkPVFileInformation::IsDirectory(a->GetType()) ||
+    a->GetType() == vtkPVFileInformation::DIRECTORY_GROUP;
+  const bool bDir = vtkPVFileInformation::IsDirectory(b->GetType()) ||
+    b->GetType() == vtkPVFileInformation::DIRECTORY_GROUP;
+  if (aDir != bDir)
+  {
+    return aDir;
+  }
+  const char* aName = a->GetName();
+  const char* bName = b->GetName();
+  for (; *aName && *bName; ++aName, ++bName)
+  {
+    const int aLower = tolower(static_cast<unsigned char>(*aName));
+    const int bLower = tolower(static_cast<unsigned char>(*bName));
+    if (aLower != bLower)
+    {
+      return aLower < bLower;
+    }
+  }
+  if (*aName || *bName)
+  {
+    return *bName != 0;
+  }
+  return strcmp(a->GetName(), b->GetName()) < 0;
+}
+}
+
+//-----------------------------------------------------------------------------
+void vtkPVFileInformation::SetDirectoryListingCacheSize(int size)
+{
+  ListingCacheSize = size;
+  vtkPVFileInformationListingCache& cache = GetListingCache();
+  while (static_cast<int>(cache.size()) > std::max(size, 0))
+  {
+    cache.pop_back();
+  }
+}
+
+//-----------------------------------------------------------------------------
+int vtkPVFileInformation::GetDirectoryListingCacheSize()
+{
+  return ListingCacheSize;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkPVFileInformation::GetNumberOfDirectoryListingCacheHits()
+{
+  return ListingCacheHits;
+}
+
 //-----------------------------------------------------------------------------
 vtkPVFileInformation::vtkPVFileInformation()
 {
@@ -370,6 +522,8 @@ vtkPVFileInformation::vtkPVFileInformation()
 #else
   this->ModificationTime = time(NULL);
 #endif
+  this->TotalNumberOfContents = 0;
+  this->ListingGeneration = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -409,6 +563,7 @@ void vtkPVFileInformation::CopyFromObject(vtkObject* object)
   if (helper->GetSpecialDirectories())
   {
     this->GetSpecialDirectories();
+    this->TotalNumberOfContents = this->Contents->GetNumberOfItems();
     return;
   }
 
@@ -466,13 +621,144 @@ void vtkPVFileInformation::CopyFromObject(vtkObject* object)
 
   if (this->IsDirectory(this->Type) && helper->GetDirectoryListing())
   {
+    const int offset = helper->GetListingOffset();
+    const int pageSize = helper->GetListingPageSize();
+    this->ListDirectory(lpath,
+      pageSize > 0 ? static_cast<int>(std::min<vtkTypeInt64>(
+                       static_cast<vtkTypeInt64>(offset) + pageSize, VTK_INT_MAX))
+                   : 0);
+    if (pageSize > 0)
+    {
+      this->SelectContents(offset, pageSize);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkPVFileInformation::ListDirectory(const std::string& lpath, int count)
+{
+  vtkPVFileInformationCachedListing uncached;
+  vtkPVFileInformationCachedListing* listing =
+    GetCachedListing(lpath, this->FastFileTypeDetection, this->ReadDetailedFileInformation);
+  if (!listing)
+  {
+    listing = &uncached;
+  }
+
+  if (!listing->Listed)
+  {
+    if (listing == &uncached)
+    {
+      GetDirectoryModificationTime(lpath, uncached.ModificationTime);
+    }
 // Since we want a directory listing, we now to platform specific listing
 // with intelligent pattern matching hee-haa.
 #if defined(_WIN32)
+    // the types of all entries are known from the listing.
     this->GetWindowsDirectoryListing();
+    vtkSmartPointer<vtkCollectionIterator> iter;
+    iter.TakeReference(this->Contents->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      listing->Pending.push_back(vtkPVFileInformation::SafeDownCast(iter->GetCurrentObject()));
+    }
+    this->Contents->RemoveAllItems();
 #else
-    this->GetDirectoryListing();
+    vtkPVFileInformationSet info_set;
+    this->GetDirectoryListing(info_set);
+    listing->Pending.assign(info_set.begin(), info_set.end());
 #endif
+    // the pages are cut from the sorted listing, so that the client doesn't
+    // need to sort them, and they line up for listings that aren't cached.
+    // Entries whose type readdir() didn't report, such as links, must be
+    // stat'ed to know if they go with the directories. File groups are sorted
+    // as files, their children are only checked when the group is reached.
+    for (size_t cc = 0; cc < listing->Pending.size(); ++cc)
+    {
+      if (listing->Pending[cc]->Type == INVALID)
+      {
+        listing->Pending[cc]->DetectType();
+      }
+    }
+    std::sort(listing->Pending.begin(), listing->Pending.end(), vtkPVFileInformationListingLess);
+    listing->Listed = true;
+  }
+  this->ListingGeneration = listing->ModificationTime;
+
+  // Detect the type of the entries needed for the requested page only.
+  while (listing->NextPending < listing->Pending.size() &&
+    (count <= 0 || listing->Contents->GetNumberOfItems() < count))
+  {
+    vtkPVFileInformation::AddListingEntry(
+      listing->Pending[listing->NextPending], listing->Contents);
+    listing->Pending[listing->NextPending] = nullptr;
+    listing->NextPending++;
+  }
+
+  // the cached items are shared with the information objects returned, which
+  // don't modify them.
+  vtkSmartPointer<vtkCollectionIterator> iter;
+  iter.TakeReference(listing->Contents->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    this->Contents->AddItem(iter->GetCurrentObject());
+  }
+
+  // Entries whose type hasn't been detected yet may be dropped, and groups
+  // dissolved into their children, so this is an upper bound until the
+  // listing is complete.
+  this->TotalNumberOfContents = this->Contents->GetNumberOfItems();
+  for (size_t cc = listing->NextPending; cc < listing->Pending.size(); ++cc)
+  {
+    vtkPVFileInformation* entry = listing->Pending[cc];
+    this->TotalNumberOfContents += entry->Type == FILE_GROUP
+      ? std::max(entry->Contents->GetNumberOfItems(), 1)
+      : 1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkPVFileInformation::AddListingEntry(vtkPVFileInformation* entry, vtkCollection* contents)
+{
+  // We dissolve any groups that contain non-file items.
+  if (entry->DetectType())
+  {
+    contents->AddItem(entry);
+    return;
+  }
+  for (int cc = 0; cc < entry->Contents->GetNumberOfItems(); cc++)
+  {
+    vtkPVFileInformation* child =
+      vtkPVFileInformation::SafeDownCast(entry->Contents->GetItemAsObject(cc));
+    if (child->DetectType())
+    {
+      contents->AddItem(child);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkPVFileInformation::SelectContents(int offset, int count)
+{
+  vtkNew<vtkCollection> selection;
+  vtkSmartPointer<vtkCollectionIterator> iter;
+  iter.TakeReference(this->Contents->NewIterator());
+  const vtkTypeInt64 end = static_cast<vtkTypeInt64>(offset) + count;
+  vtkTypeInt64 index = 0;
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal() && index < end;
+       iter->GoToNextItem(), ++index)
+  {
+    if (index >= offset)
+    {
+      selection->AddItem(iter->GetCurrentObject());
+    }
+  }
+
+  this->Contents->RemoveAllItems();
+  iter.TakeReference(selection->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    this->Contents->AddItem(iter->GetCurrentObject());
   }
 }
 
@@ -825,16 +1111,16 @@ support and glibc/Linux system headers:
 #endif
 
 //-----------------------------------------------------------------------------
-void vtkPVFileInformation::GetDirectoryListing()
+void vtkPVFileInformation::GetDirectoryListing(vtkPVFileInformationSet& info_set)
 {
 #if defined(_WIN32)
 
+  (void)info_set;
   vtkErrorMacro("GetDirectoryListing() cannot be called on Windows systems.");
   return;
 
 #else
 
-  vtkPVFileInformationSet info_set;
   std::string prefix = this->FullPath;
   vtkPVFileInformationAddTerminatingSlash(prefix);
 
@@ -893,9 +1179,19 @@ void vtkPVFileInformation::GetDirectoryListing()
       info->Type = DIRECTORY;
     }
 #else
-    if (d->d_type & DT_DIR)
+    // Use the type given by readdir() when available to avoid having to stat
+    // every entry in DetectType(). Links and entries from file systems that
+    // don't report the type are left for DetectType() to figure out.
+    switch (d->d_type)
     {
-      info->Type = DIRECTORY;
+      case DT_DIR:
+        info->Type = DIRECTORY;
+        break;
+      case DT_REG:
+        info->Type = SINGLE_FILE;
+        break;
+      default:
+        break;
     }
 #endif
 
@@ -906,31 +1202,6 @@ void vtkPVFileInformation::GetDirectoryListing()
   closedir(dir);
 
   this->OrganizeCollection(info_set);
-
-  // Now we detect the file types for items.
-  // We dissolve any groups that contain non-file items.
-
-  for (vtkPVFileInformationSet::iterator iter = info_set.begin(); iter != info_set.end(); ++iter)
-  {
-    vtkPVFileInformation* obj = (*iter);
-    if (obj->DetectType())
-    {
-      this->Contents->AddItem(obj);
-    }
-    else
-    {
-      // Add children to contents.
-      for (int cc = 0; cc < obj->Contents->GetNumberOfItems(); cc++)
-      {
-        vtkPVFileInformation* child =
-          vtkPVFileInformation::SafeDownCast(obj->Contents->GetItemAsObject(cc));
-        if (child->DetectType())
-        {
-          this->Contents->AddItem(child);
-        }
-      }
-    }
-  }
 #endif
 }
 
@@ -1093,7 +1364,7 @@ void vtkPVFileInformation::CopyToStream(vtkClientServerStream* stream)
 {
   *stream << vtkClientServerStream::Reply << this->Name << this->FullPath << this->Type
           << this->Hidden << this->Contents->GetNumberOfItems() << this->Extension << this->Size
-          << this->ModificationTime;
+          << this->ModificationTime << this->TotalNumberOfContents << this->ListingGeneration;
 
   vtkSmartPointer<vtkCollectionIterator> iter;
   iter.TakeReference(this->Contents->NewIterator());
@@ -1160,11 +1431,21 @@ void vtkPVFileInformation::CopyFromStream(const vtkClientServerStream* css)
     vtkErrorMacro("Error parsing File extension.");
     return;
   }
+  if (!css->GetArgument(0, 8, &this->TotalNumberOfContents))
+  {
+    vtkErrorMacro("Error parsing total number of contents.");
+    return;
+  }
+  if (!css->GetArgument(0, 9, &this->ListingGeneration))
+  {
+    vtkErrorMacro("Error parsing listing generation.");
+    return;
+  }
   for (int cc = 0; cc < num_of_children; cc++)
   {
     vtkPVFileInformation* child = vtkPVFileInformation::New();
     vtkClientServerStream childStream;
-    if (!css->GetArgument(0, 8 + cc, &childStream))
+    if (!css->GetArgument(0, 10 + cc, &childStream))
     {
       vtkErrorMacro("Error parsing child #" << cc);
       return;
@@ -1185,6 +1466,8 @@ void vtkPVFileInformation::Initialize()
   this->Contents->RemoveAllItems();
   this->SetExtension(0);
   this->Size = 0;
+  this->TotalNumberOfContents = 0;
+  this->ListingGeneration = 0;
 #ifdef _WIN32
   this->ModificationTime = _time64(NULL);
 #else
@@ -1256,6 +1539,7 @@ void vtkPVFileInformation::PrintSelf(ostream& os, vtkIndent indent)
   }
   os << indent << "Hidden: " << this->Hidden << endl;
   os << indent << "FastFileTypeDetection: " << this->FastFileTypeDetection << endl;
+  os << indent << "TotalNumberOfContents: " << this->TotalNumberOfContents << endl;
 
   for (int cc = 0; cc < this->Contents->GetNumberOfItems(); cc++)
   {
@@ -129,6 +129,46 @@ public:
   vtkGetMacro(ModificationTime, time_t);
   //@}
 
+  //@{
+  /**
+   * Get the number of entries in the complete directory listing. When a page
+   * of the listing was requested using
+   * vtkPVFileInformationHelper::SetListingPageSize(), Contents only has the
+   * entries in that page. Since the type of the entries is only detected as
+   * far as needed for the requested page, this is an upper bound until the
+   * last page has been requested.
+   */
+  vtkGetMacro(TotalNumberOfContents, int);
+  //@}
+
+  //@{
+  /**
+   * Get the generation of the directory listing, i.e. the modification time
+   * of the directory in nanoseconds when it was listed. The pages of a listing
+   * only line up while this doesn't change. The listing is ordered the way the
+   * file dialog shows it: directories first, then by name, case-insensitively.
+   */
+  vtkGetMacro(ListingGeneration, vtkTypeInt64);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the maximum number of grouped directory listings cached on the
+   * server. Listings are cached until the directory modification time changes.
+   * Listings with detailed file information are never cached since changes to
+   * files in a directory don't change the directory modification time.
+   * Set to 0 to disable caching. Default is 8.
+   */
+  static void SetDirectoryListingCacheSize(int size);
+  static int GetDirectoryListingCacheSize();
+  //@}
+
+  /**
+   * Returns the number of directory listings served from the cache so far in
+   * this process.
+   */
+  static vtkIdType GetNumberOfDirectoryListingCacheHits();
+
   /**
   * Returns the path to the base data directory path holding various files
   * packaged with ParaView.
@@ -160,12 +200,30 @@ protected:
   long long Size;          // File size
   time_t ModificationTime; // File modification time
 
+  int TotalNumberOfContents;
+  vtkTypeInt64 ListingGeneration;
+
   vtkSetStringMacro(Extension);
   vtkSetStringMacro(Name);
   vtkSetStringMacro(FullPath);
 
   void GetWindowsDirectoryListing();
-  void GetDirectoryListing();
+
+  // Reads and groups the entries of the directory. The type of entries
+  // readdir() doesn't report is left to be detected by AddListingEntry().
+  void GetDirectoryListing(vtkPVFileInformationSet& info_set);
+
+  // Fills Contents with the listing of the directory, detecting the type of
+  // entries only until Contents has `count` items, if positive. Listings are
+  // cached so that later pages pick up where the previous ones stopped.
+  void ListDirectory(const std::string& lpath, int count);
+
+  // Detects the type of an entry of a grouped listing and adds it, or the
+  // children of a group that has to be dissolved, to `contents`.
+  static void AddListingEntry(vtkPVFileInformation* entry, vtkCollection* contents);
+
+  // Only keeps `count` items starting at `offset` in Contents.
+  void SelectContents(int offset, int count);
 
   // Goes thru the collection of vtkPVFileInformation objects
   // are creates file groups, if possible.
@@ -56,7 +56,10 @@
 #include <vtk_jsoncpp.h>
 #include <vtksys/SystemTools.hxx>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -100,6 +103,113 @@ protected:
 };
 vtkStandardNewMacro(vtkGeometryRepresentationMultiBlockMaker);
 
+//*****************************************************************************
+// Computes a hierarchy of decimated geometries for the representation's
+// geometry on a worker thread. The worker operates on a deep copy of the
+// geometry, since even reading a dataset updates cached bounds, ranges and
+// cell traversal state that the renderer shares, and uses its own decimation
+// filters, so it never touches the representation's pipeline.
+class vtkGeometryRepresentation::vtkLODCache
+{
+public:
+  vtkLODCache()
+    : InputTime(0)
+    , NumberOfLevels(0)
+    , Resolution(-1.0)
+    , Abort(false)
+  {
+  }
+
+  ~vtkLODCache() { this->Stop(); }
+
+  /**
+   * Returns true if the cache holds (or is computing) levels for the given
+   * parameters.
+   */
+  bool IsValid(vtkDataObject* input, int numLevels, double resolution) const
+  {
+    return input != nullptr && this->InputTime == input->GetMTime() &&
+      this->NumberOfLevels == numLevels && this->Resolution == resolution;
+  }
+
+  /**
+   * Starts computing `numLevels` levels for `input`, discarding any previously
+   * computed ones.
+   */
+  void Start(vtkDataObject* input, int numLevels, double resolution)
+  {
+    this->Stop();
+    if (input == nullptr || numLevels <= 0)
+    {
+      return;
+    }
+
+    vtkSmartPointer<vtkDataObject> snapshot;
+    snapshot.TakeReference(input->NewInstance());
+    snapshot->DeepCopy(input);
+
+    this->InputTime = input->GetMTime();
+    this->NumberOfLevels = numLevels;
+    this->Resolution = resolution;
+    this->Abort = false;
+    this->Worker = std::thread(&vtkLODCache::Generate, this, snapshot, numLevels, resolution);
+  }
+
+  /**
+   * Aborts the computation, if any, and clears the cache.
+   */
+  void Stop()
+  {
+    this->Abort = true;
+    if (this->Worker.joinable())
+    {
+      this->Worker.join();
+    }
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Levels.clear();
+    this->InputTime = 0;
+    this->NumberOfLevels = 0;
+    this->Resolution = -1.0;
+  }
+
+  /**
+   * Returns the geometry for the requested level if it has been computed
+   * already, nullptr otherwise.
+   */
+  vtkDataObject* GetLevel(int level)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return level >= 0 && static_cast<int>(this->Levels.size()) > level
+      ? this->Levels[level].GetPointer()
+      : nullptr;
+  }
+
+private:
+  void Generate(vtkSmartPointer<vtkDataObject> input, int numLevels, double resolution)
+  {
+    for (int level = 0; level < numLevels && !this->Abort; ++level)
+    {
+      vtkNew<vtkGeometryRepresentation_detail::DecimationFilterType> decimator;
+      decimator->SetInputData(input);
+      decimator->SetLODFactor(resolution / (1 << level));
+      decimator->Update();
+
+      vtkSmartPointer<vtkDataObject> output = decimator->GetOutputDataObject(0);
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Levels.push_back(output);
+    }
+  }
+
+  vtkMTimeType InputTime;
+  int NumberOfLevels;
+  double Resolution;
+
+  std::thread Worker;
+  std::atomic<bool> Abort;
+  std::mutex Mutex;
+  std::vector<vtkSmartPointer<vtkDataObject> > Levels;
+};
+
 //*****************************************************************************
 
 vtkStandardNewMacro(vtkGeometryRepresentation);
@@ -149,6 +259,7 @@ vtkGeometryRepresentation::vtkGeometryRepresentation()
   this->MultiBlockMaker = vtkGeometryRepresentationMultiBlockMaker::New();
   this->Decimator = vtkGeometryRepresentation_detail::DecimationFilterType::New();
   this->LODOutlineFilter = vtkPVGeometryFilter::New();
+  this->LODCache = new vtkGeometryRepresentation::vtkLODCache();
 
   // connect progress bar
   this->GeometryFilter->AddObserver(vtkCommand::ProgressEvent, this,
@@ -209,6 +320,7 @@ vtkGeometryRepresentation::~vtkGeometryRepresentation()
   this->CacheKeeper->Delete();
   this->GeometryFilter->Delete();
   this->MultiBlockMaker->Delete();
+  delete this->LODCache;
   this->Decimator->Delete();
   this->LODOutlineFilter->Delete();
   this->Mapper->Delete();
@@ -311,6 +423,22 @@ int vtkGeometryRepresentation::ProcessViewRequest(
     // redistribute data as and when needed.
     vtkPVRenderView::MarkAsRedistributable(inInfo, this);
 
+    // If requested, start computing the LOD geometry right away so that it's
+    // ready by the time the user starts interacting. Geometry too small for
+    // the view to ever use LOD rendering for it is left alone.
+    vtkPVRenderView* view = vtkPVRenderView::SafeDownCast(inInfo->Get(vtkPVView::VIEW()));
+    vtkDataObject* geometry = this->CacheKeeper->GetOutputDataObject(0);
+    if (!this->SuppressLOD && inInfo->Has(vtkPVRenderView::LOD_LEVELS()) && view && geometry &&
+      geometry->GetActualMemorySize() / 1024.0 >= view->GetLODRenderingThreshold())
+    {
+      const int numLevels = inInfo->Get(vtkPVRenderView::LOD_LEVELS());
+      const double resolution = inInfo->Get(vtkPVRenderView::LOD_RESOLUTION());
+      if (!this->LODCache->IsValid(geometry, numLevels, resolution))
+      {
+        this->LODCache->Start(geometry, numLevels, resolution);
+      }
+    }
+
     this->ComputeVisibleDataBounds();
 
     // Tell the view if this representation needs ordered compositing. We need
@@ -360,19 +488,47 @@ int vtkGeometryRepresentation::ProcessViewRequest(
         // new geometry.
         this->LODOutlineFilter->Modified();
 
-        if (inInfo->Has(vtkPVRenderView::LOD_RESOLUTION()))
+        // Use the precomputed LOD geometry, if available. Until the worker
+        // has computed the requested level, render the full resolution
+        // geometry rather than waiting for it and let the view know so that
+        // it asks again on the next interactive render.
+        vtkDataObject* lodGeometry = nullptr;
+        if (inInfo->Has(vtkPVRenderView::LOD_LEVELS()))
         {
-          // We handle this number differently depending on decimator
-          // implementation.
-          const double factor = inInfo->Get(vtkPVRenderView::LOD_RESOLUTION());
-          this->Decimator->SetLODFactor(factor);
+          vtkDataObject* geometry = this->CacheKeeper->GetOutputDataObject(0);
+          const int numLevels = inInfo->Get(vtkPVRenderView::LOD_LEVELS());
+          const double resolution = inInfo->Get(vtkPVRenderView::LOD_RESOLUTION());
+          if (!this->LODCache->IsValid(geometry, numLevels, resolution))
+          {
+            this->LODCache->Start(geometry, numLevels, resolution);
+          }
+          lodGeometry = this->LODCache->GetLevel(inInfo->Get(vtkPVRenderView::LOD_LEVEL()));
+          if (!lodGeometry && geometry)
+          {
+            lodGeometry = geometry;
+            outInfo->Set(vtkPVRenderView::LOD_LEVEL_PENDING(), 1);
+          }
+        }
+        if (lodGeometry)
+        {
+          vtkPVRenderView::SetPieceLOD(inInfo, this, lodGeometry);
+        }
+        else
+        {
+          if (inInfo->Has(vtkPVRenderView::LOD_RESOLUTION()))
+          {
+            // We handle this number differently depending on decimator
+            // implementation.
+            const double factor = inInfo->Get(vtkPVRenderView::LOD_RESOLUTION());
+            this->Decimator->SetLODFactor(factor);
+          }
+
+          this->Decimator->Update();
+
+          // Pass along the LOD geometry to the view so that it can deliver it to
+          // the rendering node as and when needed.
+          vtkPVRenderView::SetPieceLOD(inInfo, this, this->Decimator->GetOutputDataObject(0));
         }
-
-        this->Decimator->Update();
-
-        // Pass along the LOD geometry to the view so that it can deliver it to
-        // the rendering node as and when needed.
-        vtkPVRenderView::SetPieceLOD(inInfo, this, this->Decimator->GetOutputDataObject(0));
       }
     }
   }
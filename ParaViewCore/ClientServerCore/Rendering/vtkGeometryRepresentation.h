@@ -396,6 +396,10 @@ protected:
   vtkGeometryRepresentation_detail::DecimationFilterType* Decimator;
   vtkPVGeometryFilter* LODOutlineFilter;
 
+  // Holds LOD levels computed in the background, when requested by the view.
+  class vtkLODCache;
+  vtkLODCache* LODCache;
+
   vtkMapper* Mapper;
   vtkMapper* LODMapper;
   vtkPVLODActor* Actor;
@@ -41,6 +41,7 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkProcessModule.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkSocketCommunicator.h"
 #include "vtkSocketController.h"
@@ -52,7 +53,13 @@
 #include "vtkUnstructuredGrid.h"
 
 #include "vtk_zlib.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #ifdef PARAVIEW_USE_MPI
@@ -63,6 +70,7 @@
 #include <vector>
 
 bool vtkMPIMoveData::UseZLibCompression = false;
+vtkIdType vtkMPIMoveData::CompressionChunkSize = 4 * 1024 * 1024;
 
 namespace
 {
@@ -96,6 +104,390 @@ void unsetGlobalIdsAttribute(vtkDataObject* piece)
     it->Delete();
   }
 }
+
+int vtkMPIMoveDataGetNumberOfThreads(int numberOfTasks)
+{
+  const int numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  return std::max(1, std::min(numThreads, numberOfTasks));
+}
+
+// The header for chunked buffers stores 64 bit lengths in little endian order.
+void vtkMPIMoveDataEncodeLength(char* dest, vtkTypeUInt64 value)
+{
+  for (int cc = 0; cc < 8; cc++)
+  {
+    dest[cc] = static_cast<char>(value & 0x0ff);
+    value = value >> 8;
+  }
+}
+
+vtkTypeUInt64 vtkMPIMoveDataDecodeLength(const char* src)
+{
+  vtkTypeUInt64 value = 0;
+  for (int cc = 0; cc < 8; cc++)
+  {
+    value = value | (static_cast<vtkTypeUInt64>(0xff & src[cc]) << 8 * cc);
+  }
+  return value;
+}
+
+bool vtkMPIMoveDataUncompress(
+  const char* source, vtkIdType sourceLength, char* dest, vtkIdType destLength)
+{
+  uLongf destLen = static_cast<uLongf>(destLength);
+  return uncompress(reinterpret_cast<Bytef*>(dest), &destLen,
+           reinterpret_cast<const Bytef*>(source), static_cast<uLong>(sourceLength)) == Z_OK &&
+    destLen == static_cast<uLongf>(destLength);
+}
+
+// Chunks that fail to compress are sent as is, which is recorded with a
+// compressed length of 0 since a zlib stream is never empty.
+bool vtkMPIMoveDataDecodeChunk(
+  const char* source, vtkIdType sourceLength, char* dest, vtkIdType destLength)
+{
+  if (sourceLength == 0)
+  {
+    memcpy(dest, source, destLength);
+    return true;
+  }
+  return vtkMPIMoveDataUncompress(source, sourceLength, dest, destLength);
+}
+
+// Writes `data` to a binary string. Caller must delete the returned writer.
+vtkDataWriter* vtkMPIMoveDataSerialize(vtkDataObject* data)
+{
+  vtkImageData* imageData = vtkImageData::SafeDownCast(data);
+
+  // Copy input to isolate reader from the pipeline.
+  vtkDataWriter* writer = vtkGenericDataObjectWriter::New();
+  writer->SetInputData(data);
+  if (imageData)
+  {
+    // We add the image extents to the header, since the writer doesn't preserve
+    // the extents.
+    int* extent = imageData->GetExtent();
+    double* origin = imageData->GetOrigin();
+    std::ostringstream stream;
+    stream << "EXTENT " << extent[0] << " " << extent[1] << " " << extent[2] << " " << extent[3]
+           << " " << extent[4] << " " << extent[5];
+    stream << " ORIGIN " << origin[0] << " " << origin[1] << " " << origin[2];
+    writer->SetHeader(stream.str().c_str());
+  }
+
+  writer->SetFileTypeToBinary();
+  writer->WriteToOutputStringOn();
+  writer->Write();
+  return writer;
+}
+
+// Compresses a buffer in fixed size chunks using a pool of threads. Chunks
+// can be retrieved, in order, as soon as they are ready. When `maxAhead` is
+// non-zero, at most that many chunks beyond the oldest one that hasn't been
+// released are compressed at any time, which bounds the memory used for the
+// compressed chunks when they are consumed in order.
+class vtkMPIMoveDataChunkCompressor
+{
+public:
+  vtkMPIMoveDataChunkCompressor(
+    const char* data, vtkIdType length, vtkIdType chunkSize, int maxAhead = 0)
+    : Data(data)
+    , Length(length)
+    , ChunkSize(chunkSize)
+    , MaxAhead(maxAhead)
+    , Released(0)
+    , Abort(false)
+    , NextChunk(0)
+    , StartTime(0)
+    , EndTime(0)
+  {
+    const int count = static_cast<int>((length + chunkSize - 1) / chunkSize);
+    this->Chunks.resize(count);
+    this->Ready.resize(count, false);
+    this->Remaining = count;
+  }
+
+  ~vtkMPIMoveDataChunkCompressor()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Abort = true;
+      this->ChunkReleased.notify_all();
+    }
+    for (size_t cc = 0; cc < this->Threads.size(); ++cc)
+    {
+      this->Threads[cc].join();
+    }
+  }
+
+  int GetNumberOfChunks() const { return static_cast<int>(this->Chunks.size()); }
+
+  vtkIdType GetChunkLength(int idx) const
+  {
+    return std::min(this->ChunkSize, this->Length - idx * this->ChunkSize);
+  }
+
+  void Start()
+  {
+    this->StartTime = vtkTimerLog::GetUniversalTime();
+    this->EndTime = this->StartTime;
+    const int numThreads = vtkMPIMoveDataGetNumberOfThreads(this->GetNumberOfChunks());
+    for (int cc = 0; cc < numThreads && this->GetNumberOfChunks() > 0; ++cc)
+    {
+      this->Threads.push_back(std::thread(&vtkMPIMoveDataChunkCompressor::Compress, this));
+    }
+  }
+
+  /**
+   * Blocks until chunk `idx` has been compressed.
+   */
+  const std::vector<char>& WaitForChunk(int idx)
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->ChunkReady.wait(lock, [this, idx]() { return this->Ready[idx]; });
+    return this->Chunks[idx];
+  }
+
+  /**
+   * Returns the data to send for chunk `idx` once it is ready: the compressed
+   * chunk, or the chunk itself when it failed to compress.
+   */
+  const char* GetChunkPayload(int idx) const
+  {
+    return this->Chunks[idx].empty() ? this->Data + idx * this->ChunkSize
+                                     : this->Chunks[idx].data();
+  }
+  vtkIdType GetChunkPayloadLength(int idx) const
+  {
+    return this->Chunks[idx].empty() ? this->GetChunkLength(idx)
+                                     : static_cast<vtkIdType>(this->Chunks[idx].size());
+  }
+
+  /**
+   * Frees the memory for a chunk that has been consumed. Chunks must be
+   * released in order.
+   */
+  void ReleaseChunk(int idx)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::vector<char>().swap(this->Chunks[idx]);
+    this->Released = idx + 1;
+    this->ChunkReleased.notify_all();
+  }
+
+  /**
+   * Wall clock time to compress all the chunks. Only valid once all chunks
+   * have been waited on.
+   */
+  double GetCompressTime() const { return this->EndTime - this->StartTime; }
+
+private:
+  void Compress()
+  {
+    for (int idx = this->NextChunk++; idx < this->GetNumberOfChunks(); idx = this->NextChunk++)
+    {
+      if (this->MaxAhead > 0)
+      {
+        std::unique_lock<std::mutex> lock(this->Mutex);
+        this->ChunkReleased.wait(
+          lock, [this, idx]() { return this->Abort || idx < this->Released + this->MaxAhead; });
+        if (this->Abort)
+        {
+          return;
+        }
+      }
+
+      const vtkIdType length = this->GetChunkLength(idx);
+      std::vector<char> buffer(compressBound(static_cast<uLong>(length)));
+      uLongf outSize = static_cast<uLongf>(buffer.size());
+      if (compress2(reinterpret_cast<Bytef*>(buffer.data()), &outSize,
+            reinterpret_cast<const Bytef*>(this->Data + idx * this->ChunkSize),
+            static_cast<uLong>(length), Z_DEFAULT_COMPRESSION) == Z_OK)
+      {
+        buffer.resize(outSize);
+      }
+      else
+      {
+        // an empty chunk is sent uncompressed.
+        std::vector<char>().swap(buffer);
+      }
+
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Chunks[idx].swap(buffer);
+      this->Ready[idx] = true;
+      if (--this->Remaining == 0)
+      {
+        this->EndTime = vtkTimerLog::GetUniversalTime();
+      }
+      this->ChunkReady.notify_all();
+    }
+  }
+
+  const char* Data;
+  vtkIdType Length;
+  vtkIdType ChunkSize;
+  int MaxAhead;
+  int Released;
+  bool Abort;
+  std::vector<std::vector<char> > Chunks;
+  std::vector<bool> Ready;
+  int Remaining;
+  std::atomic<int> NextChunk;
+  double StartTime;
+  double EndTime;
+  std::mutex Mutex;
+  std::condition_variable ChunkReady;
+  std::condition_variable ChunkReleased;
+  std::vector<std::thread> Threads;
+};
+
+// Decompresses chunks into their final location using a pool of threads
+// while more chunks are being received.
+class vtkMPIMoveDataChunkDecompressor
+{
+public:
+  vtkMPIMoveDataChunkDecompressor()
+    : MaxQueueLength(1)
+    , Done(false)
+    , Failed(false)
+    , StartTime(0)
+    , EndTime(0)
+  {
+  }
+
+  ~vtkMPIMoveDataChunkDecompressor() { this->Finish(); }
+
+  void Start(int numberOfChunks)
+  {
+    this->StartTime = vtkTimerLog::GetUniversalTime();
+    this->MaxQueueLength = static_cast<size_t>(2 * vtkMPIMoveDataGetNumberOfThreads(numberOfChunks));
+    const int numThreads = vtkMPIMoveDataGetNumberOfThreads(numberOfChunks);
+    for (int cc = 0; cc < numThreads && numberOfChunks > 0; ++cc)
+    {
+      this->Threads.push_back(std::thread(&vtkMPIMoveDataChunkDecompressor::Decompress, this));
+    }
+  }
+
+  /**
+   * Queues a compressed chunk to be decompressed to `dest`. Blocks when
+   * too many chunks are already queued to bound memory use.
+   */
+  void Push(std::vector<char>& chunk, char* dest, vtkIdType destLength)
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->QueueChanged.wait(
+      lock, [this]() { return this->Queue.size() < this->MaxQueueLength || this->Failed; });
+    TaskType task;
+    task.Source.swap(chunk);
+    task.Destination = dest;
+    task.DestinationLength = destLength;
+    this->Queue.push_back(task);
+    this->QueueChanged.notify_all();
+  }
+
+  /**
+   * Waits for all queued chunks to be decompressed. Returns false if any
+   * chunk failed to decompress.
+   */
+  bool Finish()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Done = true;
+      this->QueueChanged.notify_all();
+    }
+    for (size_t cc = 0; cc < this->Threads.size(); ++cc)
+    {
+      this->Threads[cc].join();
+    }
+    if (!this->Threads.empty())
+    {
+      this->EndTime = vtkTimerLog::GetUniversalTime();
+    }
+    this->Threads.clear();
+    return !this->Failed;
+  }
+
+  double GetDecompressTime() const { return this->EndTime - this->StartTime; }
+
+private:
+  struct TaskType
+  {
+    std::vector<char> Source;
+    char* Destination;
+    vtkIdType DestinationLength;
+  };
+
+  void Decompress()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (true)
+    {
+      this->QueueChanged.wait(lock, [this]() { return this->Done || !this->Queue.empty(); });
+      if (this->Queue.empty())
+      {
+        break;
+      }
+      TaskType task;
+      task.Source.swap(this->Queue.front().Source);
+      task.Destination = this->Queue.front().Destination;
+      task.DestinationLength = this->Queue.front().DestinationLength;
+      this->Queue.pop_front();
+      this->QueueChanged.notify_all();
+
+      lock.unlock();
+      const bool success = vtkMPIMoveDataDecodeChunk(task.Source.data(),
+        static_cast<vtkIdType>(task.Source.size()), task.Destination, task.DestinationLength);
+      lock.lock();
+      if (!success)
+      {
+        this->Failed = true;
+      }
+    }
+  }
+
+  std::deque<TaskType> Queue;
+  size_t MaxQueueLength;
+  bool Done;
+  bool Failed;
+  double StartTime;
+  double EndTime;
+  std::mutex Mutex;
+  std::condition_variable QueueChanged;
+  std::vector<std::thread> Threads;
+};
+
+// Decompresses the chunks of a "zlbc" buffer in parallel.
+class vtkMPIMoveDataDecompressWorker
+{
+public:
+  const char* Source;
+  char* Destination;
+  std::vector<vtkIdType> SourceOffsets;
+  std::vector<vtkIdType> SourceLengths;
+  std::vector<vtkIdType> DestinationOffsets;
+  std::vector<vtkIdType> DestinationLengths;
+  std::atomic<bool> Failed;
+
+  vtkMPIMoveDataDecompressWorker()
+    : Source(NULL)
+    , Destination(NULL)
+    , Failed(false)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType idx = begin; idx < end; ++idx)
+    {
+      if (!vtkMPIMoveDataDecodeChunk(this->Source + this->SourceOffsets[idx],
+            this->SourceLengths[idx], this->Destination + this->DestinationOffsets[idx],
+            this->DestinationLengths[idx]))
+      {
+        this->Failed = true;
+      }
+    }
+  }
+};
 };
 
 vtkStandardNewMacro(vtkMPIMoveData);
@@ -132,6 +524,12 @@ vtkMPIMoveData::vtkMPIMoveData()
   this->UpdatePiece = 0;
 
   this->SkipDataServerGatherToZero = false;
+
+  this->MarshalTime = 0;
+  this->CompressTime = 0;
+  this->TransferTime = 0;
+  this->DecompressTime = 0;
+  this->UnmarshalTime = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -194,6 +592,18 @@ bool vtkMPIMoveData::GetUseZLibCompression()
   return vtkMPIMoveData::UseZLibCompression;
 }
 
+//----------------------------------------------------------------------------
+void vtkMPIMoveData::SetCompressionChunkSize(vtkIdType size)
+{
+  vtkMPIMoveData::CompressionChunkSize = std::max(static_cast<vtkIdType>(0), size);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkMPIMoveData::GetCompressionChunkSize()
+{
+  return vtkMPIMoveData::CompressionChunkSize;
+}
+
 //----------------------------------------------------------------------------
 int vtkMPIMoveData::FillInputPortInformation(int, vtkInformation* info)
 {
@@ -389,6 +799,12 @@ int vtkMPIMoveData::RequestData(
     }
   }
 
+  this->MarshalTime = 0;
+  this->CompressTime = 0;
+  this->TransferTime = 0;
+  this->DecompressTime = 0;
+  this->UnmarshalTime = 0;
+
   this->UpdatePiece = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER());
   this->UpdateNumberOfPieces =
     outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES());
@@ -791,12 +1207,7 @@ void vtkMPIMoveData::DataServerSendToRenderServer(vtkDataObject* output)
 
   // int fixme;
   // We might be able to eliminate this marshal.
-  this->ClearBuffer();
-  this->MarshalDataToBuffer(output);
-
-  com->Send(&(this->NumberOfBuffers), 1, 1, 23480);
-  com->Send(this->BufferLengths, this->NumberOfBuffers, 1, 23481);
-  com->Send(this->Buffers, this->BufferTotalLength, 1, 23482);
+  this->SendData(com, output, 1, 23480);
 }
 
 //-----------------------------------------------------------------------------
@@ -810,24 +1221,8 @@ void vtkMPIMoveData::RenderServerReceiveFromDataServer(vtkDataObject* output)
     return;
   }
 
-  this->ClearBuffer();
-  com->Receive(&(this->NumberOfBuffers), 1, 1, 23480);
-  this->BufferLengths = new vtkIdType[this->NumberOfBuffers];
-  com->Receive(this->BufferLengths, this->NumberOfBuffers, 1, 23481);
-  // Compute additional buffer information.
-  this->BufferOffsets = new vtkIdType[this->NumberOfBuffers];
-  this->BufferTotalLength = 0;
-  for (int idx = 0; idx < this->NumberOfBuffers; ++idx)
-  {
-    this->BufferOffsets[idx] = this->BufferTotalLength;
-    this->BufferTotalLength += this->BufferLengths[idx];
-  }
-  this->Buffers = new char[this->BufferTotalLength];
-  com->Receive(this->Buffers, this->BufferTotalLength, 1, 23482);
-
   // int fixme;  // Can we avoid this?
-  this->ReconstructDataFromBuffer(output);
-  this->ClearBuffer();
+  this->ReceiveData(com, output, 1, 23480);
 }
 
 //-----------------------------------------------------------------------------
@@ -848,12 +1243,7 @@ void vtkMPIMoveData::DataServerZeroSendToRenderServerZero(vtkDataObject* data)
 
     // int fixme;
     // We might be able to eliminate this marshal.
-    this->ClearBuffer();
-    this->MarshalDataToBuffer(data);
-    com->Send(&(this->NumberOfBuffers), 1, 1, 23480);
-    com->Send(this->BufferLengths, this->NumberOfBuffers, 1, 23481);
-    com->Send(this->Buffers, this->BufferTotalLength, 1, 23482);
-    this->ClearBuffer();
+    this->SendData(com, data, 1, 23480);
   }
 }
 
@@ -872,24 +1262,8 @@ void vtkMPIMoveData::RenderServerZeroReceiveFromDataServerZero(vtkDataObject* da
       return;
     }
 
-    this->ClearBuffer();
-    com->Receive(&(this->NumberOfBuffers), 1, 1, 23480);
-    this->BufferLengths = new vtkIdType[this->NumberOfBuffers];
-    com->Receive(this->BufferLengths, this->NumberOfBuffers, 1, 23481);
-    // Compute additional buffer information.
-    this->BufferOffsets = new vtkIdType[this->NumberOfBuffers];
-    this->BufferTotalLength = 0;
-    for (int idx = 0; idx < this->NumberOfBuffers; ++idx)
-    {
-      this->BufferOffsets[idx] = this->BufferTotalLength;
-      this->BufferTotalLength += this->BufferLengths[idx];
-    }
-    this->Buffers = new char[this->BufferTotalLength];
-    com->Receive(this->Buffers, this->BufferTotalLength, 1, 23482);
-
     // int fixme;  // Can we avoid this?
-    this->ReconstructDataFromBuffer(data);
-    this->ClearBuffer();
+    this->ReceiveData(com, data, 1, 23480);
   }
 }
 
@@ -906,13 +1280,7 @@ void vtkMPIMoveData::DataServerSendToClient(vtkDataObject* output)
   if (myId == 0)
   {
     vtkTimerLog::MarkStartEvent("Dataserver sending to client");
-    this->ClearBuffer();
-    this->MarshalDataToBuffer(output);
-    this->ClientDataServerSocketController->Send(&(this->NumberOfBuffers), 1, 1, 23490);
-    this->ClientDataServerSocketController->Send(
-      this->BufferLengths, this->NumberOfBuffers, 1, 23491);
-    this->ClientDataServerSocketController->Send(this->Buffers, this->BufferTotalLength, 1, 23492);
-    this->ClearBuffer();
+    this->SendData(this->ClientDataServerSocketController->GetCommunicator(), output, 1, 23490);
     vtkTimerLog::MarkEndEvent("Dataserver sending to client");
   }
 }
@@ -928,21 +1296,151 @@ void vtkMPIMoveData::ClientReceiveFromDataServer(vtkDataObject* output)
     return;
   }
 
+  this->ReceiveData(com, output, 1, 23490);
+}
+
+//-----------------------------------------------------------------------------
+void vtkMPIMoveData::SendData(vtkCommunicator* com, vtkDataObject* data, int remote, int tag)
+{
+  // header[1] tells the receiver whether chunks are streamed.
+  int header[2] = { 1, 0 };
+  double startTime;
+  if (!vtkMPIMoveData::UseZLibCompression || vtkMPIMoveData::CompressionChunkSize <= 0)
+  {
+    this->ClearBuffer();
+    this->MarshalDataToBuffer(data);
+    header[0] = this->NumberOfBuffers;
+    startTime = vtkTimerLog::GetUniversalTime();
+    com->Send(header, 2, remote, tag);
+    com->Send(this->BufferLengths, this->NumberOfBuffers, remote, tag + 1);
+    com->Send(this->Buffers, this->BufferTotalLength, remote, tag + 2);
+    this->TransferTime += vtkTimerLog::GetUniversalTime() - startTime;
+    this->ClearBuffer();
+    return;
+  }
+
+  startTime = vtkTimerLog::GetUniversalTime();
+  vtkDataWriter* writer = vtkMPIMoveDataSerialize(data);
+  this->MarshalTime += vtkTimerLog::GetUniversalTime() - startTime;
+
+  // Send each chunk as soon as it's compressed while the following ones are
+  // still being compressed. Compression only runs a few chunks ahead of the
+  // send so that compressed chunks don't pile up when the network is the
+  // bottleneck.
+  vtkTimerLog::MarkStartEvent("Zlib compress and send chunks");
+  vtkMPIMoveDataChunkCompressor compressor(writer->GetOutputString(),
+    writer->GetOutputStringLength(), vtkMPIMoveData::CompressionChunkSize,
+    2 * vtkMPIMoveDataGetNumberOfThreads(VTK_INT_MAX));
+  compressor.Start();
+
+  header[1] = 1;
+  vtkIdType info[2] = { writer->GetOutputStringLength(), compressor.GetNumberOfChunks() };
+  startTime = vtkTimerLog::GetUniversalTime();
+  com->Send(header, 2, remote, tag);
+  com->Send(info, 2, remote, tag + 1);
+  this->TransferTime += vtkTimerLog::GetUniversalTime() - startTime;
+  for (int idx = 0; idx < compressor.GetNumberOfChunks(); ++idx)
+  {
+    const std::vector<char>& chunk = compressor.WaitForChunk(idx);
+    vtkIdType lengths[2] = { compressor.GetChunkLength(idx),
+      static_cast<vtkIdType>(chunk.size()) };
+    startTime = vtkTimerLog::GetUniversalTime();
+    com->Send(lengths, 2, remote, tag + 1);
+    com->Send(compressor.GetChunkPayload(idx), compressor.GetChunkPayloadLength(idx), remote,
+      tag + 2);
+    this->TransferTime += vtkTimerLog::GetUniversalTime() - startTime;
+    compressor.ReleaseChunk(idx);
+  }
+  this->CompressTime += compressor.GetCompressTime();
+  vtkTimerLog::MarkEndEvent("Zlib compress and send chunks");
+  writer->Delete();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMPIMoveData::ReceiveData(vtkCommunicator* com, vtkDataObject* data, int remote, int tag)
+{
   this->ClearBuffer();
-  com->Receive(&(this->NumberOfBuffers), 1, 1, 23490);
-  this->BufferLengths = new vtkIdType[this->NumberOfBuffers];
-  com->Receive(this->BufferLengths, this->NumberOfBuffers, 1, 23491);
-  // Compute additional buffer information.
-  this->BufferOffsets = new vtkIdType[this->NumberOfBuffers];
-  this->BufferTotalLength = 0;
-  for (int idx = 0; idx < this->NumberOfBuffers; ++idx)
+
+  int header[2] = { 0, 0 };
+  double startTime = vtkTimerLog::GetUniversalTime();
+  com->Receive(header, 2, remote, tag);
+  this->NumberOfBuffers = header[0];
+  if (header[1] == 0)
   {
-    this->BufferOffsets[idx] = this->BufferTotalLength;
-    this->BufferTotalLength += this->BufferLengths[idx];
+    this->BufferLengths = new vtkIdType[this->NumberOfBuffers];
+    com->Receive(this->BufferLengths, this->NumberOfBuffers, remote, tag + 1);
+    // Compute additional buffer information.
+    this->BufferOffsets = new vtkIdType[this->NumberOfBuffers];
+    this->BufferTotalLength = 0;
+    for (int idx = 0; idx < this->NumberOfBuffers; ++idx)
+    {
+      this->BufferOffsets[idx] = this->BufferTotalLength;
+      this->BufferTotalLength += this->BufferLengths[idx];
+    }
+    this->Buffers = new char[this->BufferTotalLength];
+    com->Receive(this->Buffers, this->BufferTotalLength, remote, tag + 2);
+    this->TransferTime += vtkTimerLog::GetUniversalTime() - startTime;
+    this->ReconstructDataFromBuffer(data);
+    this->ClearBuffer();
+    return;
   }
+
+  // Chunks are streamed. Decompress them in place while receiving the next
+  // ones.
+  vtkIdType info[2] = { 0, 0 };
+  com->Receive(info, 2, remote, tag + 1);
+  this->TransferTime += vtkTimerLog::GetUniversalTime() - startTime;
+
+  this->NumberOfBuffers = 1;
+  this->BufferLengths = new vtkIdType[1];
+  this->BufferLengths[0] = info[0];
+  this->BufferOffsets = new vtkIdType[1];
+  this->BufferOffsets[0] = 0;
+  this->BufferTotalLength = info[0];
   this->Buffers = new char[this->BufferTotalLength];
-  com->Receive(this->Buffers, this->BufferTotalLength, 1, 23492);
-  this->ReconstructDataFromBuffer(output);
+
+  vtkTimerLog::MarkStartEvent("Zlib receive and uncompress chunks");
+  vtkMPIMoveDataChunkDecompressor decompressor;
+  decompressor.Start(static_cast<int>(info[1]));
+  vtkIdType offset = 0;
+  bool valid = true;
+  for (vtkIdType idx = 0; idx < info[1]; ++idx)
+  {
+    vtkIdType lengths[2] = { 0, 0 };
+    startTime = vtkTimerLog::GetUniversalTime();
+    com->Receive(lengths, 2, remote, tag + 1);
+    // chunks that failed to compress are sent as is.
+    std::vector<char> chunk(lengths[1] > 0 ? lengths[1] : lengths[0]);
+    com->Receive(chunk.data(), static_cast<vtkIdType>(chunk.size()), remote, tag + 2);
+    this->TransferTime += vtkTimerLog::GetUniversalTime() - startTime;
+    if (offset + lengths[0] > this->BufferTotalLength)
+    {
+      // keep receiving to stay in sync with the sender.
+      valid = false;
+      continue;
+    }
+    if (lengths[1] == 0)
+    {
+      memcpy(this->Buffers + offset, chunk.data(), lengths[0]);
+    }
+    else
+    {
+      decompressor.Push(chunk, this->Buffers + offset, lengths[0]);
+    }
+    offset += lengths[0];
+  }
+  valid = decompressor.Finish() && valid && offset == this->BufferTotalLength;
+  this->DecompressTime += decompressor.GetDecompressTime();
+  vtkTimerLog::MarkEndEvent("Zlib receive and uncompress chunks");
+
+  if (!valid)
+  {
+    vtkErrorMacro("Failed to uncompress received data.");
+    this->ClearBuffer();
+    data->Initialize();
+    return;
+  }
+  this->ReconstructDataFromBuffer(data);
   this->ClearBuffer();
 }
 
@@ -1029,7 +1527,6 @@ void vtkMPIMoveData::ClearBuffer()
 void vtkMPIMoveData::MarshalDataToBuffer(vtkDataObject* data)
 {
   vtkDataSet* dataSet = vtkDataSet::SafeDownCast(data);
-  vtkImageData* imageData = vtkImageData::SafeDownCast(data);
   vtkGraph* graph = vtkGraph::SafeDownCast(data);
 
   // Protect from empty data.
@@ -1039,30 +1536,49 @@ void vtkMPIMoveData::MarshalDataToBuffer(vtkDataObject* data)
     this->NumberOfBuffers = 0;
   }
 
-  // Copy input to isolate reader from the pipeline.
-  vtkDataWriter* writer = vtkGenericDataObjectWriter::New();
-  writer->SetInputData(data);
-  if (imageData)
-  {
-    // We add the image extents to the header, since the writer doesn't preserve
-    // the extents.
-    int* extent = imageData->GetExtent();
-    double* origin = imageData->GetOrigin();
-    std::ostringstream stream;
-    stream << "EXTENT " << extent[0] << " " << extent[1] << " " << extent[2] << " " << extent[3]
-           << " " << extent[4] << " " << extent[5];
-    stream << " ORIGIN " << origin[0] << " " << origin[1] << " " << origin[2];
-    writer->SetHeader(stream.str().c_str());
-  }
-
-  writer->SetFileTypeToBinary();
-  writer->WriteToOutputStringOn();
-  writer->Write();
+  double startTime = vtkTimerLog::GetUniversalTime();
+  vtkDataWriter* writer = vtkMPIMoveDataSerialize(data);
+  this->MarshalTime += vtkTimerLog::GetUniversalTime() - startTime;
 
   char* buffer = NULL;
   vtkIdType buffer_length = 0;
 
-  if (vtkMPIMoveData::UseZLibCompression)
+  startTime = vtkTimerLog::GetUniversalTime();
+  if (vtkMPIMoveData::UseZLibCompression && vtkMPIMoveData::CompressionChunkSize > 0)
+  {
+    // Compress chunks in parallel. The buffer starts with "zlbc", the
+    // uncompressed length and the number of chunks, followed by the
+    // uncompressed and compressed length of each chunk and then the chunks.
+    vtkTimerLog::MarkStartEvent("Zlib compress chunks");
+    vtkMPIMoveDataChunkCompressor compressor(writer->GetOutputString(),
+      writer->GetOutputStringLength(), vtkMPIMoveData::CompressionChunkSize);
+    compressor.Start();
+    const int numChunks = compressor.GetNumberOfChunks();
+    const vtkIdType header_length = 4 + 8 + 8 + 16 * static_cast<vtkIdType>(numChunks);
+    buffer_length = header_length;
+    for (int idx = 0; idx < numChunks; ++idx)
+    {
+      compressor.WaitForChunk(idx);
+      buffer_length += compressor.GetChunkPayloadLength(idx);
+    }
+    buffer = new char[buffer_length];
+    memcpy(buffer, "zlbc", 4);
+    vtkMPIMoveDataEncodeLength(buffer + 4, writer->GetOutputStringLength());
+    vtkMPIMoveDataEncodeLength(buffer + 12, numChunks);
+    vtkIdType offset = header_length;
+    for (int idx = 0; idx < numChunks; ++idx)
+    {
+      const std::vector<char>& chunk = compressor.WaitForChunk(idx);
+      vtkMPIMoveDataEncodeLength(buffer + 20 + 16 * idx, compressor.GetChunkLength(idx));
+      vtkMPIMoveDataEncodeLength(buffer + 28 + 16 * idx, chunk.size());
+      memcpy(
+        buffer + offset, compressor.GetChunkPayload(idx), compressor.GetChunkPayloadLength(idx));
+      offset += compressor.GetChunkPayloadLength(idx);
+      compressor.ReleaseChunk(idx);
+    }
+    vtkTimerLog::MarkEndEvent("Zlib compress chunks");
+  }
+  else if (vtkMPIMoveData::UseZLibCompression)
   {
     vtkTimerLog::MarkStartEvent("Zlib compress");
     // Use z-lib compression.
@@ -1070,27 +1586,42 @@ void vtkMPIMoveData::MarshalDataToBuffer(vtkDataObject* data)
     buffer = new char[out_size + 8];
     memcpy(buffer, "zlib0000", 8);
 
-    compress2(reinterpret_cast<Bytef*>(buffer + 8), &out_size,
+    const int status = compress2(reinterpret_cast<Bytef*>(buffer + 8), &out_size,
       reinterpret_cast<const Bytef*>(writer->GetOutputString()), writer->GetOutputStringLength(),
       /* compression_level */ Z_DEFAULT_COMPRESSION);
     vtkTimerLog::MarkEndEvent("Zlib compress");
-    int in_size = static_cast<int>(writer->GetOutputStringLength());
-    for (int cc = 0; cc < 4; cc++)
+    if (status == Z_OK)
+    {
+      int in_size = static_cast<int>(writer->GetOutputStringLength());
+      for (int cc = 0; cc < 4; cc++)
+      {
+        // the first 4 bytes in the header are "zlib" which helps the receiver
+        // identify that zlib compression has been used.
+        // the next 4 bytes are the original length since zlib doesn't provide
+        // that to the receiver.
+        buffer[4 + cc] = (in_size & 0x0ff);
+        in_size = in_size >> 8;
+      }
+      buffer_length = out_size + 8;
+    }
+    else
     {
-      // the first 4 bytes in the header are "zlib" which helps the receiver
-      // identify that zlib compression has been used.
-      // the next 4 bytes are the original length since zlib doesn't provide
-      // that to the receiver.
-      buffer[4 + cc] = (in_size & 0x0ff);
-      in_size = in_size >> 8;
+      // send the data uncompressed, the receiver checks the header.
+      vtkWarningMacro("Failed to compress data, sending it uncompressed.");
+      delete[] buffer;
+      buffer_length = writer->GetOutputStringLength();
+      buffer = writer->RegisterAndGetOutputString();
     }
-    buffer_length = out_size + 8;
   }
   else
   {
     buffer_length = writer->GetOutputStringLength();
     buffer = writer->RegisterAndGetOutputString();
   }
+  if (vtkMPIMoveData::UseZLibCompression)
+  {
+    this->CompressTime += vtkTimerLog::GetUniversalTime() - startTime;
+  }
 
   // Get string.
   this->NumberOfBuffers = 1;
@@ -1123,7 +1654,59 @@ void vtkMPIMoveData::ReconstructDataFromBuffer(vtkDataObject* data)
     vtkIdType bufferLength = this->BufferLengths[idx];
 
     char* realBuffer = 0;
-    if (bufferLength > 4 && strncmp(bufferArray, "zlib", 4) == 0)
+    double startTime = vtkTimerLog::GetUniversalTime();
+    if (bufferLength > 20 && strncmp(bufferArray, "zlbc", 4) == 0)
+    {
+      // sender compressed the data in chunks. Decompress them in parallel.
+      const vtkIdType uncompressed_length =
+        static_cast<vtkIdType>(vtkMPIMoveDataDecodeLength(bufferArray + 4));
+      const vtkIdType numChunks =
+        static_cast<vtkIdType>(vtkMPIMoveDataDecodeLength(bufferArray + 12));
+      if (numChunks < 0 || numChunks > (bufferLength - 20) / 16)
+      {
+        vtkErrorMacro("Invalid chunked buffer received.");
+        continue;
+      }
+      vtkMPIMoveDataDecompressWorker worker;
+      worker.Source = bufferArray;
+      vtkIdType sourceOffset = 20 + 16 * numChunks;
+      vtkIdType destinationOffset = 0;
+      for (vtkIdType cc = 0; cc < numChunks && sourceOffset <= bufferLength; ++cc)
+      {
+        worker.DestinationOffsets.push_back(destinationOffset);
+        worker.DestinationLengths.push_back(
+          static_cast<vtkIdType>(vtkMPIMoveDataDecodeLength(bufferArray + 20 + 16 * cc)));
+        worker.SourceOffsets.push_back(sourceOffset);
+        worker.SourceLengths.push_back(
+          static_cast<vtkIdType>(vtkMPIMoveDataDecodeLength(bufferArray + 28 + 16 * cc)));
+        destinationOffset += worker.DestinationLengths.back();
+        // chunks with a compressed length of 0 are stored as is.
+        sourceOffset += worker.SourceLengths.back() > 0 ? worker.SourceLengths.back()
+                                                        : worker.DestinationLengths.back();
+      }
+      if (sourceOffset != bufferLength || destinationOffset != uncompressed_length)
+      {
+        vtkErrorMacro("Invalid chunked buffer received.");
+        continue;
+      }
+
+      realBuffer = new char[uncompressed_length];
+      worker.Destination = realBuffer;
+      vtkTimerLog::MarkStartEvent("Zlib uncompress chunks");
+      vtkSMPTools::For(0, numChunks, 1, worker);
+      vtkTimerLog::MarkEndEvent("Zlib uncompress chunks");
+      if (worker.Failed)
+      {
+        vtkErrorMacro("Failed to uncompress received data.");
+        delete[] realBuffer;
+        continue;
+      }
+
+      bufferArray = realBuffer;
+      bufferLength = uncompressed_length;
+      this->DecompressTime += vtkTimerLog::GetUniversalTime() - startTime;
+    }
+    else if (bufferLength > 4 && strncmp(bufferArray, "zlib", 4) == 0)
     {
       // sender used zlib compression. Decompress it.
       vtkIdType compressed_length = bufferLength - 8; // remove the zlib header.
@@ -1143,9 +1726,11 @@ void vtkMPIMoveData::ReconstructDataFromBuffer(vtkDataObject* data)
 
       bufferArray = realBuffer;
       bufferLength = uncompressed_length;
+      this->DecompressTime += vtkTimerLog::GetUniversalTime() - startTime;
     }
 
     // Setup a reader.
+    startTime = vtkTimerLog::GetUniversalTime();
     vtkDataReader* reader = vtkGenericDataObjectReader::New();
     reader->ReadFromInputStringOn();
 
@@ -1194,9 +1779,12 @@ void vtkMPIMoveData::ReconstructDataFromBuffer(vtkDataObject* data)
     reader = NULL;
     delete[] realBuffer;
     realBuffer = 0;
+    this->UnmarshalTime += vtkTimerLog::GetUniversalTime() - startTime;
   }
 
+  const double startTime = vtkTimerLog::GetUniversalTime();
   vtkMPIMoveDataMerge(pieces, data);
+  this->UnmarshalTime += vtkTimerLog::GetUniversalTime() - startTime;
 }
 
 //-----------------------------------------------------------------------------
@@ -1207,6 +1795,11 @@ void vtkMPIMoveData::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Server: " << this->Server << endl;
   os << indent << "MoveMode: " << this->MoveMode << endl;
   os << indent << "SkipDataServerGatherToZero: " << this->SkipDataServerGatherToZero << endl;
+  os << indent << "MarshalTime: " << this->MarshalTime << endl;
+  os << indent << "CompressTime: " << this->CompressTime << endl;
+  os << indent << "TransferTime: " << this->TransferTime << endl;
+  os << indent << "DecompressTime: " << this->DecompressTime << endl;
+  os << indent << "UnmarshalTime: " << this->UnmarshalTime << endl;
   os << indent << "OutputDataType: ";
   if (this->OutputDataType == VTK_POLY_DATA)
   {
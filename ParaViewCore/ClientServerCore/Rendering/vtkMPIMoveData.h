@@ -21,6 +21,13 @@
  * processes. It can redistributed polydata from M to N processors.
  * Update: This filter can now support delivering vtkUniformGridAMR datasets in
  * PASS_THROUGH and/or COLLECT modes.
+ *
+ * When zlib compression is enabled and CompressionChunkSize is non-zero, the
+ * serialized data is split into chunks that are compressed on multiple
+ * threads. For point-to-point deliveries (data server to client or to render
+ * server) each chunk is sent as soon as it has been compressed, and the
+ * receiver decompresses chunks while the following ones are still in
+ * flight.
 */
 
 #ifndef vtkMPIMoveData_h
@@ -29,6 +36,7 @@
 #include "vtkPVClientServerCoreRenderingModule.h" //needed for exports
 #include "vtkPassInputTypeAlgorithm.h"
 
+class vtkCommunicator;
 class vtkMultiProcessController;
 class vtkSocketController;
 class vtkMPIMToNSocketConnection;
@@ -113,6 +121,32 @@ public:
   static bool GetUseZLibCompression();
   //@}
 
+  //@{
+  /**
+   * Size, in bytes, of the chunks the serialized data is split into when zlib
+   * compression is used. Chunks are compressed in parallel and, when
+   * delivering to a single remote process, sent as soon as they are ready.
+   * Set to 0 to compress the data as a single buffer. Default is 4 MiB.
+   */
+  static void SetCompressionChunkSize(vtkIdType size);
+  static vtkIdType GetCompressionChunkSize();
+  //@}
+
+  //@{
+  /**
+   * Time, in seconds, spent in each stage of the last delivery on this
+   * process: serializing the data, compressing, sending/receiving,
+   * decompressing and deserializing. When chunks are pipelined, compression
+   * and decompression overlap with the transfer and these report the wall
+   * clock time for the stage as a whole.
+   */
+  vtkGetMacro(MarshalTime, double);
+  vtkGetMacro(CompressTime, double);
+  vtkGetMacro(TransferTime, double);
+  vtkGetMacro(DecompressTime, double);
+  vtkGetMacro(UnmarshalTime, double);
+  //@}
+
   /**
    * vtkMPIMoveData doesn't necessarily generate a valid output data on all the
    * involved processes (depending on the MoveMode and Server ivars). This
@@ -164,6 +198,17 @@ protected:
   void DataServerSendToClient(vtkDataObject* output);
   void ClientReceiveFromDataServer(vtkDataObject* output);
 
+  /**
+   * Marshals `data` and sends it to `remote` using tags `tag` to `tag + 2`.
+   * Chunks are streamed when chunked compression is enabled.
+   */
+  void SendData(vtkCommunicator* com, vtkDataObject* data, int remote, int tag);
+
+  /**
+   * Receives data sent with SendData() and reconstructs it in `data`.
+   */
+  void ReceiveData(vtkCommunicator* com, vtkDataObject* data, int remote, int tag);
+
   int NumberOfBuffers;
   vtkIdType* BufferLengths;
   vtkIdType* BufferOffsets;
@@ -188,6 +233,12 @@ protected:
 
   int OutputDataType;
 
+  double MarshalTime;
+  double CompressTime;
+  double TransferTime;
+  double DecompressTime;
+  double UnmarshalTime;
+
 private:
   int UpdateNumberOfPieces;
   int UpdatePiece;
@@ -196,6 +247,7 @@ private:
   void operator=(const vtkMPIMoveData&) = delete;
 
   static bool UseZLibCompression;
+  static vtkIdType CompressionChunkSize;
 };
 
 #endif
@@ -15,9 +15,14 @@
 #include "vtkPVDataDeliveryManager.h"
 
 #include "vtkAlgorithmOutput.h"
+#include "vtkBoundingBox.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
 #include "vtkDataObject.h"
+#include "vtkDataSet.h"
 #include "vtkExtentTranslator.h"
 #include "vtkKdTreeManager.h"
+#include "vtkMath.h"
 #include "vtkMPIMoveData.h"
 #include "vtkMultiProcessController.h"
 #include "vtkNew.h"
@@ -33,12 +38,36 @@
 #include "vtkTimerLog.h"
 #include "vtkWeakPointer.h"
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <queue>
 #include <sstream>
 #include <utility>
 
+namespace
+{
+void AddBounds(vtkDataObject* dobj, vtkBoundingBox& bbox)
+{
+  if (vtkDataSet* ds = vtkDataSet::SafeDownCast(dobj))
+  {
+    if (ds->GetNumberOfPoints() > 0)
+    {
+      bbox.AddBounds(ds->GetBounds());
+    }
+  }
+  else if (vtkCompositeDataSet* cd = vtkCompositeDataSet::SafeDownCast(dobj))
+  {
+    vtkSmartPointer<vtkCompositeDataIterator> iter;
+    iter.TakeReference(cd->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      AddBounds(iter->GetCurrentDataObject(), bbox);
+    }
+  }
+}
+}
+
 //*****************************************************************************
 class vtkPVDataDeliveryManager::vtkInternals
 {
@@ -118,6 +147,10 @@ public:
     // example.
     vtkSmartPointer<vtkDataObject> RedistributedDataObject;
 
+    // Distributor kept around so that it can reuse the routes from the
+    // previous redistribution when only attribute arrays change.
+    vtkSmartPointer<vtkOrderedCompositeDistributor> Redistributor;
+
     // Data object for a streamed piece.
     vtkSmartPointer<vtkDataObject> StreamedPiece;
 
@@ -139,6 +172,7 @@ public:
       , DataObject{}
       , DeliveredDataObjects{}
       , RedistributedDataObject{}
+      , Redistributor{}
       , StreamedPiece{}
       , TimeStamp(0)
       , ActualMemorySize(0)
@@ -211,11 +245,17 @@ public:
      * needed. Currently, we only support redistribution when data_distribution_mode is
      * PASS_THROUGH or COLLECT_AND_PASS_THROUGH i.e. remote rendering is being employed.
      *
+     * When `reuse_topology` is true, routes from the previous redistribution
+     * are reused if only the attribute arrays changed; `attributes_only` is
+     * set to indicate if that was the case.
+     *
      * @returns false if redistribution was skipped (or not needed) and true if
      *          data was redistributed.
      */
-    bool Redistribute(int data_distribution_mode, vtkPKdTree* tree, const std::string debugName)
+    bool Redistribute(int data_distribution_mode, vtkPKdTree* tree, bool reuse_topology,
+      const std::string debugName, bool& attributes_only)
     {
+      attributes_only = false;
       assert(tree != nullptr);
 
       const int real_mode = this->GetItemDataDistributionMode(data_distribution_mode);
@@ -244,14 +284,30 @@ public:
 
         vtkTimerLog::FormatAndMarkEvent("do-redistribution: %s", debugName.c_str());
 
-        vtkNew<vtkOrderedCompositeDistributor> redistributor;
-        redistributor->SetController(vtkMultiProcessController::GetGlobalController());
+        if (this->Redistributor == nullptr || !reuse_topology)
+        {
+          this->Redistributor = vtkSmartPointer<vtkOrderedCompositeDistributor>::New();
+          this->Redistributor->SetController(vtkMultiProcessController::GetGlobalController());
+          this->Redistributor->SetPassThrough(0);
+        }
+        vtkOrderedCompositeDistributor* redistributor = this->Redistributor;
         redistributor->SetInputData(deliveredDataObject);
         redistributor->SetPKdTree(tree);
-        redistributor->SetPassThrough(0);
         redistributor->SetBoundaryMode(this->RedistributionMode);
+        redistributor->SetReuseTopology(reuse_topology);
         redistributor->Update();
-        this->RedistributedDataObject = redistributor->GetOutputDataObject(0);
+        attributes_only = redistributor->GetLastExecutionReusedTopology();
+
+        // hand out a copy so that the next redistribution does not modify the
+        // data being rendered in place.
+        vtkDataObject* output = redistributor->GetOutputDataObject(0);
+        this->RedistributedDataObject.TakeReference(output->NewInstance());
+        this->RedistributedDataObject->ShallowCopy(output);
+        redistributor->SetInputData(nullptr);
+        if (!reuse_topology)
+        {
+          this->Redistributor = nullptr;
+        }
         return true;
       }
 
@@ -261,7 +317,11 @@ public:
     /**
      * cleanup the redistributed data object, on demand.
      */
-    void ClearRedistributedData() { this->RedistributedDataObject = nullptr; }
+    void ClearRedistributedData()
+    {
+      this->RedistributedDataObject = nullptr;
+      this->Redistributor = nullptr;
+    }
 
     vtkDataObject* GetDeliveredDataObject(int data_distribution_mode) const
     {
@@ -415,8 +475,12 @@ public:
 vtkStandardNewMacro(vtkPVDataDeliveryManager);
 //----------------------------------------------------------------------------
 vtkPVDataDeliveryManager::vtkPVDataDeliveryManager()
-  : Internals(new vtkInternals())
+  : KdTreeReuseTolerance(0.05)
+  , ReuseRedistributionTopology(false)
+  , Internals(new vtkInternals())
 {
+  vtkMath::UninitializeBounds(this->KdTreeBounds);
+  this->ResetRedistributionCounters();
 }
 
 //----------------------------------------------------------------------------
@@ -773,6 +837,8 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
     // something significant changed.
     std::ostringstream token_stream;
     vtkNew<vtkKdTreeManager> cutsGenerator;
+    bool structured = false;
+    vtkBoundingBox localBounds;
     for (auto iter = this->Internals->ItemsMap.begin(); iter != this->Internals->ItemsMap.end();
          ++iter)
     {
@@ -790,6 +856,7 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
           const vtkInternals::vtkOrderedCompositingInfo& info = item.OrderedCompositingInfo;
           cutsGenerator->SetStructuredDataInformation(
             info.Translator, info.WholeExtent, info.Origin, info.Spacing);
+          structured = true;
         }
         else if (item.Redistributable)
         {
@@ -801,6 +868,7 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
           //   << item.GetDeliveredDataObject()
           //   << endl;
           cutsGenerator->AddDataObject(item.GetDeliveredDataObject(mode));
+          AddBounds(item.GetDeliveredDataObject(mode), localBounds);
         }
       }
     }
@@ -808,9 +876,27 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
     if (this->LastCutsGeneratorToken != token_stream.str())
     {
       vtkTimerLogScope tlevent("regenerate kd-tree");
-      cutsGenerator->GenerateKdTree();
-      this->KdTree = cutsGenerator->GetKdTree();
+      const double startTime = vtkTimerLog::GetUniversalTime();
+      double bounds[6];
+      vtkMath::UninitializeBounds(bounds);
+      if (!structured)
+      {
+        this->ComputeGlobalBounds(localBounds, bounds);
+      }
+      if (!structured && this->CanReuseKdTree(bounds))
+      {
+        vtkTimerLog::FormatAndMarkEvent("reusing kd-tree (bounds within tolerance).");
+        this->NumberOfKdTreeReuses++;
+      }
+      else
+      {
+        cutsGenerator->GenerateKdTree();
+        this->KdTree = cutsGenerator->GetKdTree();
+        std::copy(bounds, bounds + 6, this->KdTreeBounds);
+        this->NumberOfKdTreeGenerations++;
+      }
       this->LastCutsGeneratorToken = token_stream.str();
+      this->KdTreeGenerationTime += vtkTimerLog::GetUniversalTime() - startTime;
     }
     else
     {
@@ -836,7 +922,25 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
 
     const auto debugName = this->GetRepresentation(id)->GetDebugName();
     vtkInternals::vtkItem& item = use_lod ? iter->second.second : iter->second.first;
-    anything_moved = item.Redistribute(mode, this->KdTree, debugName) || anything_moved;
+    const double startTime = vtkTimerLog::GetUniversalTime();
+    bool attributes_only = false;
+    if (item.Redistribute(
+          mode, this->KdTree, this->ReuseRedistributionTopology, debugName, attributes_only))
+    {
+      anything_moved = true;
+      const double elapsed = vtkTimerLog::GetUniversalTime() - startTime;
+      if (attributes_only)
+      {
+        vtkTimerLog::FormatAndMarkEvent("redistributed attributes only: %s", debugName.c_str());
+        this->AttributeRedistributionTime += elapsed;
+        this->NumberOfAttributeRedistributions++;
+      }
+      else
+      {
+        this->RedistributionTime += elapsed;
+        this->NumberOfRedistributions++;
+      }
+    }
   }
 
   if (!anything_moved)
@@ -845,6 +949,82 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkPVDataDeliveryManager::ComputeGlobalBounds(
+  const vtkBoundingBox& localBounds, double bounds[6])
+{
+  double localMin[3] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX };
+  double localMax[3] = { VTK_DOUBLE_MIN, VTK_DOUBLE_MIN, VTK_DOUBLE_MIN };
+  if (localBounds.IsValid())
+  {
+    localBounds.GetMinPoint(localMin[0], localMin[1], localMin[2]);
+    localBounds.GetMaxPoint(localMax[0], localMax[1], localMax[2]);
+  }
+
+  double globalMin[3], globalMax[3];
+  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  if (controller && controller->GetNumberOfProcesses() > 1)
+  {
+    controller->AllReduce(localMin, globalMin, 3, vtkCommunicator::MIN_OP);
+    controller->AllReduce(localMax, globalMax, 3, vtkCommunicator::MAX_OP);
+  }
+  else
+  {
+    std::copy(localMin, localMin + 3, globalMin);
+    std::copy(localMax, localMax + 3, globalMax);
+  }
+
+  vtkBoundingBox bbox;
+  bbox.SetMinPoint(globalMin);
+  bbox.SetMaxPoint(globalMax);
+  if (bbox.IsValid())
+  {
+    bbox.GetBounds(bounds);
+  }
+  else
+  {
+    vtkMath::UninitializeBounds(bounds);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVDataDeliveryManager::CanReuseKdTree(const double bounds[6]) const
+{
+  if (this->KdTree == nullptr ||
+    !vtkMath::AreBoundsInitialized(const_cast<double*>(this->KdTreeBounds)) ||
+    !vtkMath::AreBoundsInitialized(const_cast<double*>(bounds)))
+  {
+    return false;
+  }
+
+  // the previous partition must cover the data and must not have become much
+  // larger than it, since that would leave processes with little to render.
+  vtkBoundingBox previous(this->KdTreeBounds);
+  const double slack = this->KdTreeReuseTolerance * previous.GetDiagonalLength();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const double minDelta = bounds[2 * axis] - this->KdTreeBounds[2 * axis];
+    const double maxDelta = this->KdTreeBounds[2 * axis + 1] - bounds[2 * axis + 1];
+    if (minDelta < 0 || maxDelta < 0 || minDelta > slack || maxDelta > slack)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVDataDeliveryManager::ResetRedistributionCounters()
+{
+  this->KdTreeGenerationTime = 0.0;
+  this->NumberOfKdTreeGenerations = 0;
+  this->NumberOfKdTreeReuses = 0;
+  this->RedistributionTime = 0.0;
+  this->NumberOfRedistributions = 0;
+  this->AttributeRedistributionTime = 0.0;
+  this->NumberOfAttributeRedistributions = 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkPVDataDeliveryManager::ClearRedistributedData(bool use_lod)
 {
@@ -981,6 +1161,16 @@ void vtkPVDataDeliveryManager::DeliverStreamedPieces(unsigned int size, unsigned
 void vtkPVDataDeliveryManager::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "KdTreeReuseTolerance: " << this->KdTreeReuseTolerance << endl;
+  os << indent << "ReuseRedistributionTopology: " << this->ReuseRedistributionTopology << endl;
+  os << indent << "KdTreeGenerationTime: " << this->KdTreeGenerationTime << endl;
+  os << indent << "NumberOfKdTreeGenerations: " << this->NumberOfKdTreeGenerations << endl;
+  os << indent << "NumberOfKdTreeReuses: " << this->NumberOfKdTreeReuses << endl;
+  os << indent << "RedistributionTime: " << this->RedistributionTime << endl;
+  os << indent << "NumberOfRedistributions: " << this->NumberOfRedistributions << endl;
+  os << indent << "AttributeRedistributionTime: " << this->AttributeRedistributionTime << endl;
+  os << indent << "NumberOfAttributeRedistributions: " << this->NumberOfAttributeRedistributions
+     << endl;
 }
 
 //----------------------------------------------------------------------------
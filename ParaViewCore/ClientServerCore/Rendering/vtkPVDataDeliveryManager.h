@@ -33,6 +33,7 @@
 #include "vtkWeakPointer.h"                       // needed for iVar.
 
 class vtkAlgorithmOutput;
+class vtkBoundingBox;
 class vtkDataObject;
 class vtkExtentTranslator;
 class vtkPKdTree;
@@ -170,6 +171,52 @@ public:
    */
   void ClearRedistributedData(bool use_load);
 
+  //@{
+  /**
+   * When the data changes, the kd-tree used for ordered compositing is
+   * regenerated only if the new global data bounds are no longer covered by
+   * the previous partition or have shrunk, on any side, by more than this
+   * fraction of the previous bounds' diagonal. Set to 0 to reuse the kd-tree
+   * only when the bounds are unchanged. Default is 0.05.
+   */
+  vtkSetClampMacro(KdTreeReuseTolerance, double, 0.0, 1.0);
+  vtkGetMacro(KdTreeReuseTolerance, double);
+  //@}
+
+  //@{
+  /**
+   * When on, redistribution for ordered compositing remembers where points
+   * and cells were sent so that, when only the attribute arrays of the data
+   * change (e.g. across timesteps with a static mesh) and the kd-tree was
+   * reused, only the attribute arrays are exchanged. Telling that the
+   * geometry didn't change means comparing it with a copy of the previous
+   * one, which costs memory and time when it does change, so this is off by
+   * default.
+   * @sa vtkOrderedCompositeDistributor::SetReuseTopology
+   */
+  vtkSetMacro(ReuseRedistributionTopology, bool);
+  vtkGetMacro(ReuseRedistributionTopology, bool);
+  vtkBooleanMacro(ReuseRedistributionTopology, bool);
+  //@}
+
+  //@{
+  /**
+   * Counters for the stages of redistribution for ordered compositing: time,
+   * in seconds, and number of times the kd-tree was generated, the number of
+   * times it was reused, and time spent / number of items redistributed
+   * fully or by exchanging attribute arrays only. Use
+   * ResetRedistributionCounters() to reset them.
+   */
+  vtkGetMacro(KdTreeGenerationTime, double);
+  vtkGetMacro(NumberOfKdTreeGenerations, int);
+  vtkGetMacro(NumberOfKdTreeReuses, int);
+  vtkGetMacro(RedistributionTime, double);
+  vtkGetMacro(NumberOfRedistributions, int);
+  vtkGetMacro(AttributeRedistributionTime, double);
+  vtkGetMacro(NumberOfAttributeRedistributions, int);
+  void ResetRedistributionCounters();
+  //@}
+
   /**
    * Pass the structured-meta-data for determining rendering order for ordered
    * compositing.
@@ -238,12 +285,37 @@ protected:
    */
   int GetViewDataDistributionMode(bool use_lod);
 
+  /**
+   * Reduces the local data bounds across all processes.
+   */
+  void ComputeGlobalBounds(const vtkBoundingBox& localBounds, double bounds[6]);
+
+  /**
+   * Returns true if the current kd-tree can still be used for data with the
+   * given global bounds. @sa SetKdTreeReuseTolerance.
+   */
+  bool CanReuseKdTree(const double bounds[6]) const;
+
   vtkWeakPointer<vtkPVRenderView> RenderView;
   vtkSmartPointer<vtkPKdTree> KdTree;
 
   vtkTimeStamp RedistributionTimeStamp;
   std::string LastCutsGeneratorToken;
 
+  // global data bounds the current kd-tree was generated for. Invalid when
+  // the kd-tree was generated from structured data information.
+  double KdTreeBounds[6];
+  double KdTreeReuseTolerance;
+  bool ReuseRedistributionTopology;
+
+  double KdTreeGenerationTime;
+  int NumberOfKdTreeGenerations;
+  int NumberOfKdTreeReuses;
+  double RedistributionTime;
+  int NumberOfRedistributions;
+  double AttributeRedistributionTime;
+  int NumberOfAttributeRedistributions;
+
 private:
   vtkPVDataDeliveryManager(const vtkPVDataDeliveryManager&) = delete;
   void operator=(const vtkPVDataDeliveryManager&) = delete;
@@ -108,6 +108,7 @@
 #include "vtkOSPRayRendererNode.h"
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <set>
@@ -310,6 +311,9 @@ vtkStandardNewMacro(vtkPVRenderView);
 vtkInformationKeyMacro(vtkPVRenderView, USE_LOD, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, USE_OUTLINE_FOR_LOD, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, LOD_RESOLUTION, Double);
+vtkInformationKeyMacro(vtkPVRenderView, LOD_LEVELS, Integer);
+vtkInformationKeyMacro(vtkPVRenderView, LOD_LEVEL, Integer);
+vtkInformationKeyMacro(vtkPVRenderView, LOD_LEVEL_PENDING, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, NEED_ORDERED_COMPOSITING, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, RENDER_EMPTY_IMAGES, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, REQUEST_STREAMING_UPDATE, Request);
@@ -359,6 +363,12 @@ vtkPVRenderView::vtkPVRenderView()
   this->RemoteRenderingThreshold = 0;
   this->LODRenderingThreshold = 0;
   this->LODResolution = 0.5;
+  this->GenerateLODInBackground = false;
+  this->NumberOfLODLevels = 1;
+  this->LODLevel = 0;
+  this->SuggestedLODLevel = 0;
+  this->LODLevelPending = false;
+  this->TargetInteractiveFrameTime = 0.0;
   this->UseOutlineForLODRendering = false;
   this->UseLightKit = false;
   this->Interactor = 0;
@@ -1222,6 +1232,14 @@ void vtkPVRenderView::Update()
   this->DiscreteCameras = NULL;
   this->PreviousDiscreteCameraIndex = -1;
 
+  // let representations start computing LOD geometry as soon as the full
+  // resolution geometry is available.
+  if (this->GenerateLODInBackground && !this->UseOutlineForLODRendering)
+  {
+    this->RequestInformation->Set(LOD_LEVELS(), this->NumberOfLODLevels);
+    this->RequestInformation->Set(LOD_RESOLUTION(), this->LODResolution);
+  }
+
   this->Superclass::Update();
 
   // Update camera zoom manipulators based on whether we have discrete position.
@@ -1310,6 +1328,12 @@ void vtkPVRenderView::UpdateLOD()
   {
     this->RequestInformation->Set(USE_OUTLINE_FOR_LOD(), 1);
   }
+  else if (this->GenerateLODInBackground)
+  {
+    this->RequestInformation->Set(LOD_LEVELS(), this->NumberOfLODLevels);
+    this->RequestInformation->Set(
+      LOD_LEVEL(), std::min(this->LODLevel, this->NumberOfLODLevels - 1));
+  }
 
   // reset flags that representations set in REQUEST_UPDATE_LOD() pass.
   this->DistributedRenderingRequiredLOD = false;
@@ -1318,6 +1342,20 @@ void vtkPVRenderView::UpdateLOD()
   this->CallProcessViewRequest(
     vtkPVView::REQUEST_UPDATE_LOD(), this->RequestInformation, this->ReplyInformationVector);
 
+  // Check if any representation is still waiting for its LOD geometry.
+  vtkIdType lodLevelPending = 0;
+  int num_reprs = this->ReplyInformationVector->GetNumberOfInformationObjects();
+  for (int cc = 0; cc < num_reprs && lodLevelPending == 0; cc++)
+  {
+    vtkInformation* info = this->ReplyInformationVector->GetInformationObject(cc);
+    if (info->Has(LOD_LEVEL_PENDING()) && (info->Get(LOD_LEVEL_PENDING()) != 0))
+    {
+      lodLevelPending = 1;
+    }
+  }
+  this->SynchronizedWindows->Reduce(lodLevelPending, vtkPVSynchronizedRenderWindows::MAX_OP);
+  this->LODLevelPending = (lodLevelPending != 0);
+
   double local_size = this->GetDeliveryManager()->GetVisibleDataSize(true) / 1024.0;
   this->SynchronizedWindows->SynchronizeSize(local_size);
   // cout << "LOD Geometry size: " << local_size << endl;
@@ -1358,7 +1396,29 @@ void vtkPVRenderView::InteractiveRender()
   this->Internals->OSPRayCount = 0;
   this->Internals->PreRender(this->RenderView);
 
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
   this->Render(true, this->SuppressRendering);
+  timer->StopTimer();
+
+  // Pick the LOD level for subsequent interactive renders. We use a lower
+  // threshold for moving to a finer level than for moving to a coarser one to
+  // avoid switching back and forth between two levels on every render.
+  const double target = this->TargetInteractiveFrameTime;
+  if (target > 0.0 && this->GenerateLODInBackground && this->UsedLODForLastRender &&
+    !this->SuppressRendering)
+  {
+    const double elapsed = timer->GetElapsedTime();
+    if (elapsed > target && this->SuggestedLODLevel < this->NumberOfLODLevels - 1)
+    {
+      this->SuggestedLODLevel++;
+    }
+    else if (elapsed < 0.4 * target && this->SuggestedLODLevel > 0)
+    {
+      this->SuggestedLODLevel--;
+    }
+  }
+  this->SuggestedLODLevel = std::min(this->SuggestedLODLevel, this->NumberOfLODLevels - 1);
 
   vtkTimerLog::MarkEndEvent("Interactive Render");
 }
@@ -2255,6 +2315,12 @@ void vtkPVRenderView::SetOrientationAxesVisibility(bool v)
   this->OrientationWidget->SetVisibility(v);
 }
 
+//----------------------------------------------------------------------------
+void vtkPVRenderView::SetReuseRedistributionTopology(bool reuse)
+{
+  this->GetDeliveryManager()->SetReuseRedistributionTopology(reuse);
+}
+
 //----------------------------------------------------------------------------
 void vtkPVRenderView::SetOrientationAxesLabelColor(double r, double g, double b)
 {
@@ -271,6 +271,65 @@ public:
   vtkGetMacro(LODResolution, double);
   //@}
 
+  //@{
+  /**
+   * When set to true, representations that support it compute their LOD
+   * geometry in a background thread right after the full resolution geometry
+   * is updated, rather than on demand on the first interactive render. Only
+   * geometry larger than the LODRenderingThreshold is decimated. Until the
+   * requested level is ready, interactive renders use the full resolution
+   * geometry instead of waiting for it.
+   * \note CallOnAllProcesses
+   */
+  vtkSetMacro(GenerateLODInBackground, bool);
+  vtkGetMacro(GenerateLODInBackground, bool);
+  vtkBooleanMacro(GenerateLODInBackground, bool);
+  //@}
+
+  //@{
+  /**
+   * Number of LOD levels representations compute when
+   * GenerateLODInBackground is true. Level 0 uses LODResolution and each
+   * subsequent level halves the resolution.
+   * \note CallOnAllProcesses
+   */
+  vtkSetClampMacro(NumberOfLODLevels, int, 1, 8);
+  vtkGetMacro(NumberOfLODLevels, int);
+  //@}
+
+  //@{
+  /**
+   * Target time, in seconds, for interactive renders. When non-zero and
+   * multiple LOD levels are available, the view monitors the time taken by
+   * interactive renders using LOD and suggests a coarser level when renders
+   * take longer than the target, or a finer one when they are well within it.
+   * See GetSuggestedLODLevel().
+   */
+  vtkSetClampMacro(TargetInteractiveFrameTime, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(TargetInteractiveFrameTime, double);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the LOD level representations should use for the next
+   * REQUEST_UPDATE_LOD pass. This is only used when GenerateLODInBackground is
+   * true. GetSuggestedLODLevel() returns the level suggested by the most recent
+   * interactive render based on TargetInteractiveFrameTime.
+   * \note CallOnAllProcesses
+   */
+  vtkSetClampMacro(LODLevel, int, 0, 7);
+  vtkGetMacro(LODLevel, int);
+  vtkGetMacro(SuggestedLODLevel, int);
+  //@}
+
+  /**
+   * Returns true if, in the most recent UpdateLOD(), some representation
+   * delivered full resolution geometry because the requested LOD level was
+   * still being computed in the background. UpdateLOD() should then be called
+   * again before subsequent interactive renders to pick up the LOD geometry.
+   */
+  vtkGetMacro(LODLevelPending, bool);
+
   //@{
   /**
    * When set to true, instead of using simplified geometry for LOD rendering,
@@ -323,6 +382,26 @@ public:
    */
   static vtkInformationDoubleKey* LOD_RESOLUTION();
 
+  /**
+   * Indicates the number of LOD levels to generate in the background in
+   * REQUEST_UPDATE() and REQUEST_UPDATE_LOD() passes. Not set when
+   * GenerateLODInBackground is false.
+   */
+  static vtkInformationIntegerKey* LOD_LEVELS();
+
+  /**
+   * Indicates the LOD level to use in REQUEST_UPDATE_LOD() pass when LOD_LEVELS()
+   * is set.
+   */
+  static vtkInformationIntegerKey* LOD_LEVEL();
+
+  /**
+   * Representations set this key in their REQUEST_UPDATE_LOD() pass to
+   * indicate that the requested LOD level is not available yet and that they
+   * are using full resolution geometry instead.
+   */
+  static vtkInformationIntegerKey* LOD_LEVEL_PENDING();
+
   /**
    * Indicates the LOD must use outline if possible in REQUEST_UPDATE_LOD()
    * pass.
@@ -607,6 +686,10 @@ public:
   // Forwarded to center axes.
   virtual void SetCenterAxesVisibility(bool);
 
+  //*****************************************************************
+  // Forwarded to vtkPVDataDeliveryManager.
+  void SetReuseRedistributionTopology(bool);
+
   //*****************************************************************
   // Forward to vtkPVInteractorStyle instances.
   virtual void SetCenterOfRotation(double x, double y, double z);
@@ -1143,6 +1226,12 @@ protected:
   vtkNew<vtkFXAAOptions> FXAAOptions;
 
   double LODResolution;
+  bool GenerateLODInBackground;
+  int NumberOfLODLevels;
+  int LODLevel;
+  int SuggestedLODLevel;
+  bool LODLevelPending;
+  double TargetInteractiveFrameTime;
   bool UseLightKit;
 
   bool UsedLODForLastRender;
@@ -18,15 +18,18 @@
 #include "vtkCSVExporter.h"
 #include "vtkCharArray.h"
 #include "vtkClientServerMoveData.h"
+#include "vtkCommunicator.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
 #include "vtkDataSetAttributes.h"
+#include "vtkDummyController.h"
 #include "vtkFieldData.h"
 #include "vtkInformation.h"
 #include "vtkMarkSelectedRows.h"
 #include "vtkMemberFunctionCommand.h"
 #include "vtkMultiProcessController.h"
 #include "vtkMultiProcessStream.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVMergeTables.h"
 #include "vtkPVSynchronizedRenderWindows.h"
@@ -40,19 +43,40 @@
 #include "vtkVariant.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 namespace
 {
+// Columns shown first, in this order. These are never projected out since
+// they are needed to identify rows.
+const char* OrderedColumnNames[] = { "vtkOriginalProcessIds", "vtkCompositeIndexArray",
+  "vtkOriginalIndices", "vtkOriginalCellIds", "vtkOriginalPointIds", "vtkOriginalRowIds",
+  "Structured Coordinates", NULL };
+
+bool IsOrderedColumn(const char* name)
+{
+  for (int cc = 0; name != NULL && OrderedColumnNames[cc] != NULL; cc++)
+  {
+    if (strcmp(name, OrderedColumnNames[cc]) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 struct OrderByNames : std::binary_function<vtkAbstractArray*, vtkAbstractArray*, bool>
 {
   bool operator()(vtkAbstractArray* a1, vtkAbstractArray* a2)
   {
-    const char* order[] = { "vtkOriginalProcessIds", "vtkCompositeIndexArray", "vtkOriginalIndices",
-      "vtkOriginalCellIds", "vtkOriginalPointIds", "vtkOriginalRowIds", "Structured Coordinates",
-      NULL };
+    const char** order = OrderedColumnNames;
     std::string a1Name = a1->GetName() ? a1->GetName() : "";
     std::string a2Name = a2->GetName() ? a2->GetName() : "";
     int a1Index = VTK_INT_MAX, a2Index = VTK_INT_MAX;
@@ -144,6 +168,184 @@ const char* get_userfriendly_name(
   }
   return name;
 }
+
+/**
+ * Extracts blocks from a private copy of the data shown in the view on a
+ * worker thread, so that the blocks adjacent to the ones being shown are ready
+ * before they are requested. vtkSortedTableStreamer is collective, so this is
+ * only used on processes that have all of the data.
+ */
+class vtkSpreadSheetViewPrefetcher
+{
+public:
+  vtkSpreadSheetViewPrefetcher()
+    : Stop(false)
+    , SourceTime(0)
+  {
+  }
+  ~vtkSpreadSheetViewPrefetcher() { this->Reset(); }
+
+  /**
+   * Stops the worker, drops the prefetched blocks and the copy of the data.
+   */
+  void Reset()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Stop = true;
+    }
+    this->Condition.notify_all();
+    if (this->Worker.joinable())
+    {
+      this->Worker.join();
+    }
+    this->Stop = false;
+    this->Wanted.clear();
+    this->Pending.clear();
+    this->Blocks.clear();
+    this->Streamer = nullptr;
+    this->Source = nullptr;
+    this->SourceTime = 0;
+  }
+
+  /**
+   * Returns true if the blocks are being prefetched from `source` as it is now.
+   */
+  bool IsCurrent(vtkDataObject* source) const
+  {
+    return source != nullptr && this->Source == source && this->SourceTime == source->GetMTime();
+  }
+
+  /**
+   * Removes and returns a prefetched block, or nullptr if it isn't ready.
+   */
+  vtkSmartPointer<vtkTable> Take(vtkIdType blockId)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto iter = this->Blocks.find(blockId);
+    if (iter == this->Blocks.end())
+    {
+      return nullptr;
+    }
+    vtkSmartPointer<vtkTable> block = iter->second;
+    this->Blocks.erase(iter);
+    return block;
+  }
+
+  /**
+   * Sets the blocks to prefetch from `source`, sorted and split into blocks
+   * the same way as `streamer` does. Prefetched blocks that are not in
+   * `blockIds` are dropped.
+   */
+  void Request(
+    vtkDataObject* source, vtkSortedTableStreamer* streamer, const std::vector<vtkIdType>& blockIds)
+  {
+    if (!this->IsCurrent(source))
+    {
+      this->Reset();
+      if (source == nullptr || blockIds.empty())
+      {
+        return;
+      }
+      this->Source = source;
+      this->SourceTime = source->GetMTime();
+
+      // the worker pipeline must not share anything the main thread may
+      // modify. The sorted column is copied since its range is cached in it.
+      vtkSmartPointer<vtkDataObject> input;
+      input.TakeReference(source->NewInstance());
+      input->ShallowCopy(source);
+      vtkTable* table = vtkTable::SafeDownCast(input);
+      vtkAbstractArray* column =
+        table ? table->GetColumnByName(streamer->GetColumnNameToSort()) : nullptr;
+      if (column)
+      {
+        vtkSmartPointer<vtkAbstractArray> copy;
+        copy.TakeReference(column->NewInstance());
+        copy->DeepCopy(column);
+        table->GetRowData()->AddArray(copy);
+      }
+
+      this->Streamer = vtkSmartPointer<vtkSortedTableStreamer>::New();
+      vtkNew<vtkDummyController> controller;
+      this->Streamer->SetController(controller);
+      this->Streamer->SetColumnNameToSort(streamer->GetColumnNameToSort());
+      this->Streamer->SetInvertOrder(streamer->GetInvertOrder());
+      this->Streamer->SetBlockSize(streamer->GetBlockSize());
+      this->Streamer->SetSelectedComponent(streamer->GetSelectedComponent());
+      this->Streamer->SetInputDataObject(input);
+      this->Worker = std::thread(&vtkSpreadSheetViewPrefetcher::Run, this);
+    }
+
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Wanted.assign(blockIds.begin(), blockIds.end());
+    this->Pending.clear();
+    for (vtkIdType blockId : blockIds)
+    {
+      if (this->Blocks.find(blockId) == this->Blocks.end())
+      {
+        this->Pending.push_back(blockId);
+      }
+    }
+    for (auto iter = this->Blocks.begin(); iter != this->Blocks.end();)
+    {
+      if (std::find(blockIds.begin(), blockIds.end(), iter->first) == blockIds.end())
+      {
+        iter = this->Blocks.erase(iter);
+      }
+      else
+      {
+        ++iter;
+      }
+    }
+    this->Condition.notify_all();
+  }
+
+private:
+  void Run()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (true)
+    {
+      this->Condition.wait(lock, [this] { return this->Stop || !this->Pending.empty(); });
+      if (this->Stop)
+      {
+        return;
+      }
+      const vtkIdType blockId = this->Pending.front();
+      this->Pending.pop_front();
+      lock.unlock();
+
+      this->Streamer->SetBlock(blockId);
+      this->Streamer->Modified();
+      this->Streamer->Update();
+      vtkSmartPointer<vtkTable> block = vtkSmartPointer<vtkTable>::New();
+      block->ShallowCopy(this->Streamer->GetOutputDataObject(0));
+
+      lock.lock();
+      if (std::find(this->Wanted.begin(), this->Wanted.end(), blockId) != this->Wanted.end())
+      {
+        this->Blocks[blockId] = block;
+      }
+    }
+  }
+
+  std::thread Worker;
+  std::mutex Mutex;
+  std::condition_variable Condition;
+  bool Stop;
+
+  // Blocks to keep, blocks left to extract and blocks extracted.
+  std::vector<vtkIdType> Wanted;
+  std::deque<vtkIdType> Pending;
+  std::map<vtkIdType, vtkSmartPointer<vtkTable> > Blocks;
+
+  // Only used by the worker while it runs.
+  vtkSmartPointer<vtkSortedTableStreamer> Streamer;
+
+  vtkDataObject* Source;
+  vtkMTimeType SourceTime;
+};
 }
 
 class vtkSpreadSheetView::vtkInternals
@@ -198,20 +400,109 @@ class vtkSpreadSheetView::vtkInternals
   {
   public:
     vtkSmartPointer<vtkTable> Dataobject;
-    vtkTimeStamp RecentUseTime;
+    std::list<vtkIdType>::iterator RecentUseIterator;
+
+    // Columns that were not delivered for this block. Their values are not
+    // valid.
+    std::set<std::string> ProjectedColumns;
   };
 
   typedef std::map<vtkIdType, CacheInfo> CacheType;
   CacheType CachedBlocks;
 
+  // Cached block ids, most recently used first.
+  std::list<vtkIdType> RecentlyUsedBlocks;
+
+  // Block with all the columns, used to fill in columns that are projected
+  // out in other blocks.
+  vtkSmartPointer<vtkTable> ColumnPrototypes;
+
+  void RemoveFromCache(CacheType::iterator iter)
+  {
+    this->RecentlyUsedBlocks.erase(iter->second.RecentUseIterator);
+    this->CachedBlocks.erase(iter);
+  }
+
+  // Removes blocks with projected columns that are no longer hidden.
+  void RemoveStaleBlocks(vtkSpreadSheetView* self)
+  {
+    for (CacheType::iterator iter = this->CachedBlocks.begin(); iter != this->CachedBlocks.end();)
+    {
+      bool stale = false;
+      for (const auto& name : iter->second.ProjectedColumns)
+      {
+        if (!self->IsColumnHiddenByName(name.c_str()) &&
+          !self->IsColumnHiddenByLabel(self->GetColumnLabel(name.c_str())))
+        {
+          stale = true;
+          break;
+        }
+      }
+      CacheType::iterator next = iter;
+      ++next;
+      if (stale)
+      {
+        this->RemoveFromCache(iter);
+      }
+      iter = next;
+    }
+    this->HiddenColumnsModified = false;
+  }
+
 public:
   void ClearCache()
   {
     this->CachedBlocks.clear();
+    this->RecentlyUsedBlocks.clear();
+    this->ColumnPrototypes = nullptr;
     this->ColumnMetaData.clear();
     this->ColumnIndexMap.clear();
+    this->Prefetcher.Reset();
+    this->CollectiveBlocks.clear();
+    this->CollectiveSource = nullptr;
+    this->CollectiveSourceTime = 0;
+  }
+
+  /**
+   * Removes and returns a block extracted ahead of time by all the processes
+   * of a parallel server together, or nullptr if there is none. All the
+   * processes must make the same choice, so the blocks are only used when
+   * they were extracted from the current data on every process, and they are
+   * dropped everywhere otherwise.
+   */
+  vtkSmartPointer<vtkTable> TakeCollectiveBlock(
+    vtkDataObject* source, vtkIdType blockId, vtkMultiProcessController* controller)
+  {
+    int current = 0;
+    if (source != nullptr && this->CollectiveSource == source &&
+      this->CollectiveSourceTime == source->GetMTime())
+    {
+      current = 1;
+    }
+    int allCurrent = 0;
+    controller->AllReduce(&current, &allCurrent, 1, vtkCommunicator::MIN_OP);
+    if (!allCurrent)
+    {
+      this->CollectiveBlocks.clear();
+      this->CollectiveSource = source;
+      this->CollectiveSourceTime = source ? source->GetMTime() : 0;
+      return nullptr;
+    }
+    auto iter = this->CollectiveBlocks.find(blockId);
+    if (iter == this->CollectiveBlocks.end())
+    {
+      return nullptr;
+    }
+    vtkSmartPointer<vtkTable> block = iter->second;
+    this->CollectiveBlocks.erase(iter);
+    return block;
   }
 
+  /**
+   * Returns true when blocks can be fetched without the hidden columns.
+   */
+  bool CanProjectColumns() const { return this->ColumnPrototypes != nullptr; }
+
   vtkIdType GetNumberOfColumns(vtkSpreadSheetView* self)
   {
     if (this->ActiveRepresentation != nullptr && this->ColumnMetaData.size() == 0)
@@ -241,39 +532,47 @@ public:
     return aname;
   }
 
-  vtkTable* GetDataObject(vtkIdType blockId)
+  vtkTable* GetDataObject(vtkIdType blockId, vtkSpreadSheetView* self)
   {
+    if (this->HiddenColumnsModified)
+    {
+      this->RemoveStaleBlocks(self);
+    }
     CacheType::iterator iter = this->CachedBlocks.find(blockId);
     if (iter != this->CachedBlocks.end())
     {
-      iter->second.RecentUseTime.Modified();
+      this->RecentlyUsedBlocks.splice(
+        this->RecentlyUsedBlocks.begin(), this->RecentlyUsedBlocks, iter->second.RecentUseIterator);
       this->MostRecentlyAccessedBlock = blockId;
       return iter->second.Dataobject.GetPointer();
     }
     return NULL;
   }
 
-  void AddToCache(vtkIdType blockId, vtkTable* data, vtkIdType max)
+  /**
+   * Returns true if the value of `column` in the cached block `blockId` was
+   * not delivered.
+   */
+  bool IsProjected(vtkIdType blockId, const char* column) const
+  {
+    CacheType::const_iterator iter = this->CachedBlocks.find(blockId);
+    return column != nullptr && iter != this->CachedBlocks.end() &&
+      iter->second.ProjectedColumns.find(column) != iter->second.ProjectedColumns.end();
+  }
+
+  void AddToCache(vtkIdType blockId, vtkTable* data, int max)
   {
     CacheType::iterator iter = this->CachedBlocks.find(blockId);
     if (iter != this->CachedBlocks.end())
     {
-      this->CachedBlocks.erase(iter);
+      this->RemoveFromCache(iter);
     }
 
-    if (static_cast<vtkIdType>(this->CachedBlocks.size()) == max)
+    while (!this->RecentlyUsedBlocks.empty() &&
+      static_cast<int>(this->CachedBlocks.size()) >= std::max(max, 1))
     {
       // remove least-recent-used block.
-      iter = this->CachedBlocks.begin();
-      CacheType::iterator iterToRemove = this->CachedBlocks.begin();
-      for (; iter != this->CachedBlocks.end(); ++iter)
-      {
-        if (iterToRemove->second.RecentUseTime > iter->second.RecentUseTime)
-        {
-          iterToRemove = iter;
-        }
-      }
-      this->CachedBlocks.erase(iterToRemove);
+      this->RemoveFromCache(this->CachedBlocks.find(this->RecentlyUsedBlocks.back()));
     }
 
     CacheInfo info;
@@ -288,6 +587,31 @@ public:
         arrays.push_back(data->GetColumn(cc));
       }
     }
+
+    // add placeholders for the columns that were projected out so that the
+    // columns don't change. Their values are left uninitialized.
+    std::vector<vtkSmartPointer<vtkAbstractArray> > placeholders;
+    if (this->ColumnPrototypes)
+    {
+      const vtkIdType numRows = data->GetNumberOfRows();
+      for (vtkIdType cc = 0; cc < this->ColumnPrototypes->GetNumberOfColumns(); cc++)
+      {
+        vtkAbstractArray* prototype = this->ColumnPrototypes->GetColumn(cc);
+        if (data->GetColumnByName(prototype->GetName()) == nullptr)
+        {
+          vtkSmartPointer<vtkAbstractArray> placeholder;
+          placeholder.TakeReference(prototype->NewInstance());
+          placeholder->SetName(prototype->GetName());
+          placeholder->SetNumberOfComponents(prototype->GetNumberOfComponents());
+          placeholder->CopyInformation(prototype->GetInformation());
+          placeholder->SetNumberOfTuples(numRows);
+          placeholders.push_back(placeholder);
+          arrays.push_back(placeholder);
+          info.ProjectedColumns.insert(prototype->GetName());
+        }
+      }
+    }
+
     std::sort(arrays.begin(), arrays.end(), OrderByNames());
     for (std::vector<vtkAbstractArray*>::iterator viter = arrays.begin(); viter != arrays.end();
          ++viter)
@@ -296,16 +620,66 @@ public:
     }
     info.Dataobject = clone;
     clone->FastDelete();
-    info.RecentUseTime.Modified();
+
+    info.RecentUseIterator =
+      this->RecentlyUsedBlocks.insert(this->RecentlyUsedBlocks.begin(), blockId);
     this->CachedBlocks[blockId] = info;
     this->MostRecentlyAccessedBlock = blockId;
 
-    if (this->CachedBlocks.size() == 1)
+    if (this->ColumnPrototypes == nullptr)
     {
       this->UpdateColumnMetaData(clone);
+      this->ColumnPrototypes = clone;
+    }
+  }
+
+  /**
+   * Fills `output` with the columns of `input` that are not hidden. Columns
+   * needed to identify rows and internal columns are always kept.
+   */
+  void ProjectColumns(vtkTable* input, vtkTable* output, vtkSpreadSheetView* self)
+  {
+    output->Initialize();
+    if (input == nullptr)
+    {
+      return;
+    }
+    output->GetFieldData()->ShallowCopy(input->GetFieldData());
+    for (vtkIdType cc = 0; cc < input->GetNumberOfColumns(); cc++)
+    {
+      vtkAbstractArray* column = input->GetColumn(cc);
+      const char* name = column ? column->GetName() : nullptr;
+      if (name == nullptr || self->IsColumnInternal(name) || ::IsOrderedColumn(name) ||
+        (!self->IsColumnHiddenByName(name) &&
+          !self->IsColumnHiddenByLabel(this->GetColumnLabel(column, self))))
+      {
+        output->AddColumn(column);
+      }
     }
   }
 
+  /**
+   * Same as vtkSpreadSheetView::GetColumnLabel() but using the information
+   * on the column itself, for processes that don't have the column metadata.
+   */
+  static std::string GetColumnLabel(vtkAbstractArray* column, vtkSpreadSheetView* self)
+  {
+    bool cleaned = false;
+    const char* cleanedname = ::get_userfriendly_name(column->GetName(), self, &cleaned);
+    if (cleaned)
+    {
+      return cleanedname;
+    }
+    vtkInformation* colInfo = column->GetInformation();
+    if (colInfo->Has(vtkSplitColumnComponents::ORIGINAL_ARRAY_NAME()) &&
+      colInfo->Has(vtkSplitColumnComponents::ORIGINAL_COMPONENT_NUMBER()) &&
+      colInfo->Get(vtkSplitColumnComponents::ORIGINAL_COMPONENT_NUMBER()) >= 0)
+    {
+      return colInfo->Get(vtkSplitColumnComponents::ORIGINAL_ARRAY_NAME());
+    }
+    return column->GetName();
+  }
+
   /**
    * A convenient method to get some block. It returns either a cached block
    * or the most recently accessed block, if possible. This method will avoid a
@@ -314,7 +688,7 @@ public:
   vtkTable* GetSomeBlock(vtkSpreadSheetView* self)
   {
     const auto mrbId = this->GetMostRecentlyAccessedBlock(self);
-    if (auto table = this->GetDataObject(mrbId))
+    if (auto table = this->GetDataObject(mrbId, self))
     {
       return table;
     }
@@ -335,6 +709,18 @@ public:
 
   std::set<std::string> HiddenColumnsByName;
   std::set<std::string> HiddenColumnsByLabel;
+  bool HiddenColumnsModified;
+
+  // Table delivered instead of the reduced table when projecting columns.
+  vtkNew<vtkTable> ProjectedTable;
+
+  vtkSpreadSheetViewPrefetcher Prefetcher;
+
+  // Blocks extracted ahead of time on a parallel server, the same on all the
+  // processes, and the data they were extracted from.
+  std::map<vtkIdType, vtkSmartPointer<vtkTable> > CollectiveBlocks;
+  vtkDataObject* CollectiveSource;
+  vtkMTimeType CollectiveSourceTime;
 };
 
 namespace
@@ -345,11 +731,12 @@ void FetchRMI(void* localArg, void* remoteArg, int remoteArgLength, int)
   stream.SetRawData(reinterpret_cast<unsigned char*>(remoteArg), remoteArgLength);
   unsigned int id = 0;
   int blockid = -1;
-  stream >> id >> blockid;
+  int projectColumns = 0;
+  stream >> id >> blockid >> projectColumns;
   vtkSpreadSheetView* self = reinterpret_cast<vtkSpreadSheetView*>(localArg);
   if (self->GetIdentifier() == id)
   {
-    self->FetchBlockCallback(blockid);
+    self->FetchBlockCallback(blockid, projectColumns != 0);
   }
 }
 void FetchRMIBogus(void*, void*, int, int)
@@ -434,6 +821,12 @@ vtkSpreadSheetView::vtkSpreadSheetView()
 
   this->Internals = new vtkInternals();
   this->Internals->MostRecentlyAccessedBlock = -1;
+  this->Internals->HiddenColumnsModified = false;
+  this->Internals->CollectiveSource = nullptr;
+  this->Internals->CollectiveSourceTime = 0;
+  this->CacheSize = 10;
+  this->NumberOfPrefetchBlocks = 1;
+  this->ColumnProjection = true;
 
   this->Internals->Observer =
     vtkMakeMemberFunctionCommand(*this, &vtkSpreadSheetView::OnRepresentationUpdated);
@@ -485,6 +878,7 @@ void vtkSpreadSheetView::HideColumnByName(const char* columnName)
   {
     auto& internals = *this->Internals;
     internals.HiddenColumnsByName.insert(columnName);
+    internals.HiddenColumnsModified = true;
   }
 }
 
@@ -493,6 +887,7 @@ void vtkSpreadSheetView::ClearHiddenColumnsByName()
 {
   auto& internals = *this->Internals;
   internals.HiddenColumnsByName.clear();
+  internals.HiddenColumnsModified = true;
 }
 
 //----------------------------------------------------------------------------
@@ -511,6 +906,7 @@ void vtkSpreadSheetView::HideColumnByLabel(const char* columnLabel)
   {
     auto& internals = *this->Internals;
     internals.HiddenColumnsByLabel.insert(columnLabel);
+    internals.HiddenColumnsModified = true;
   }
 }
 
@@ -519,6 +915,7 @@ void vtkSpreadSheetView::ClearHiddenColumnsByLabel()
 {
   auto& internals = *this->Internals;
   internals.HiddenColumnsByLabel.clear();
+  internals.HiddenColumnsModified = true;
 }
 
 //----------------------------------------------------------------------------
@@ -560,6 +957,9 @@ bool vtkSpreadSheetView::IsColumnInternal(const char* columnName)
 void vtkSpreadSheetView::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheSize: " << this->CacheSize << endl;
+  os << indent << "NumberOfPrefetchBlocks: " << this->NumberOfPrefetchBlocks << endl;
+  os << indent << "ColumnProjection: " << this->ColumnProjection << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -663,18 +1063,24 @@ void vtkSpreadSheetView::OnRepresentationUpdated()
 //----------------------------------------------------------------------------
 vtkTable* vtkSpreadSheetView::FetchBlock(vtkIdType blockindex)
 {
-  vtkTable* block = this->Internals->GetDataObject(blockindex);
+  vtkTable* block = this->Internals->GetDataObject(blockindex, this);
   if (!block)
   {
-    block = this->FetchBlockCallback(blockindex);
-    this->Internals->AddToCache(blockindex, block, 10);
+    const bool projectColumns = this->ColumnProjection && this->Internals->CanProjectColumns();
+    block = this->FetchBlockCallback(blockindex, projectColumns);
+    if (!block)
+    {
+      return NULL;
+    }
+    this->Internals->AddToCache(blockindex, block, this->CacheSize);
     this->InvokeEvent(vtkCommand::UpdateEvent, &blockindex);
+    block = this->Internals->GetDataObject(blockindex, this);
   }
   return block;
 }
 
 //----------------------------------------------------------------------------
-vtkTable* vtkSpreadSheetView::FetchBlockCallback(vtkIdType blockindex)
+vtkTable* vtkSpreadSheetView::FetchBlockCallback(vtkIdType blockindex, bool projectColumns)
 {
   // Sanity Check
   if (!this->Internals->ActiveRepresentation)
@@ -684,15 +1090,108 @@ vtkTable* vtkSpreadSheetView::FetchBlockCallback(vtkIdType blockindex)
 
   // cout << "FetchBlockCallback" << endl;
   vtkMultiProcessStream stream;
-  stream << this->Identifier << static_cast<int>(blockindex);
+  stream << this->Identifier << static_cast<int>(blockindex) << (projectColumns ? 1 : 0);
   this->SynchronizedWindows->TriggerRMI(stream, FETCH_BLOCK_TAG);
 
   this->TableStreamer->SetBlock(blockindex);
   this->TableStreamer->Modified();
   this->TableSelectionMarker->SetFieldAssociation(this->FieldAssociation);
   this->ReductionFilter->Modified();
-  this->DeliveryFilter->Modified();
+  if (this->DeliveryFilter->GetNumberOfInputConnections(0) == 0)
+  {
+    // nothing to deliver from this process.
+    this->DeliveryFilter->Modified();
+    this->DeliveryFilter->Update();
+    return vtkTable::SafeDownCast(this->DeliveryFilter->GetOutput());
+  }
+
+  // vtkSortedTableStreamer is collective, so blocks are only prefetched on a
+  // worker thread when this process has all the data. On a parallel server,
+  // all the processes prefetch them together once the block is delivered.
+  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  const bool collective = controller != nullptr && controller->GetNumberOfProcesses() > 1;
+  const bool prefetch = this->NumberOfPrefetchBlocks > 0;
+  vtkDataObject* source = nullptr;
+  vtkSmartPointer<vtkTable> block;
+  if (prefetch)
+  {
+    this->TableSelectionMarker->Update();
+    source = this->TableSelectionMarker->GetOutputDataObject(0);
+    if (collective)
+    {
+      block = this->Internals->TakeCollectiveBlock(source, blockindex, controller);
+    }
+    else if (this->Internals->Prefetcher.IsCurrent(source))
+    {
+      block = this->Internals->Prefetcher.Take(blockindex);
+    }
+  }
+  if (!block)
+  {
+    this->ReductionFilter->Update();
+    block = vtkTable::SafeDownCast(this->ReductionFilter->GetOutputDataObject(0));
+  }
+  if (projectColumns)
+  {
+    // only deliver the columns that are not hidden.
+    this->Internals->ProjectColumns(block, this->Internals->ProjectedTable, this);
+    block = this->Internals->ProjectedTable.GetPointer();
+  }
+
+  this->DeliveryFilter->SetInputDataObject(block);
   this->DeliveryFilter->Update();
+  this->DeliveryFilter->SetInputConnection(this->ReductionFilter->GetOutputPort());
+
+  if (prefetch)
+  {
+    const vtkIdType blockSize = this->TableStreamer->GetBlockSize();
+    const vtkIdType numBlocks = (this->GetNumberOfRows() + blockSize - 1) / blockSize;
+    std::vector<vtkIdType> neighbors;
+    for (vtkIdType delta = 1; delta <= this->NumberOfPrefetchBlocks; ++delta)
+    {
+      if (blockindex + delta < numBlocks)
+      {
+        neighbors.push_back(blockindex + delta);
+      }
+      if (blockindex - delta >= 0)
+      {
+        neighbors.push_back(blockindex - delta);
+      }
+    }
+    if (!collective)
+    {
+      this->Internals->Prefetcher.Request(source, this->TableStreamer, neighbors);
+      return vtkTable::SafeDownCast(this->DeliveryFilter->GetOutput());
+    }
+
+    // the client shows the delivered block meanwhile. The blocks kept are the
+    // same on all the processes since they all go through the same requests.
+    auto& blocks = this->Internals->CollectiveBlocks;
+    for (auto iter = blocks.begin(); iter != blocks.end();)
+    {
+      if (std::find(neighbors.begin(), neighbors.end(), iter->first) == neighbors.end())
+      {
+        iter = blocks.erase(iter);
+      }
+      else
+      {
+        ++iter;
+      }
+    }
+    for (vtkIdType neighbor : neighbors)
+    {
+      if (blocks.find(neighbor) == blocks.end())
+      {
+        this->TableStreamer->SetBlock(neighbor);
+        this->TableStreamer->Modified();
+        this->ReductionFilter->Update();
+        vtkSmartPointer<vtkTable> prefetched = vtkSmartPointer<vtkTable>::New();
+        prefetched->ShallowCopy(this->ReductionFilter->GetOutputDataObject(0));
+        blocks[neighbor] = prefetched;
+      }
+    }
+    this->TableStreamer->SetBlock(blockindex);
+  }
   return vtkTable::SafeDownCast(this->DeliveryFilter->GetOutput());
 }
 
@@ -740,6 +1239,11 @@ vtkVariant vtkSpreadSheetView::GetValue(vtkIdType row, vtkIdType col)
   vtkIdType blockIndex = row / blockSize;
   vtkTable* block = this->FetchBlock(blockIndex);
   vtkIdType blockOffset = row - (blockIndex * blockSize);
+  vtkAbstractArray* column = block->GetColumn(col);
+  if (column && this->Internals->IsProjected(blockIndex, column->GetName()))
+  {
+    return vtkVariant();
+  }
   return block->GetValue(blockOffset, col);
 }
 
@@ -750,6 +1254,10 @@ vtkVariant vtkSpreadSheetView::GetValueByName(vtkIdType row, const char* columnN
   vtkIdType blockIndex = row / blockSize;
   vtkTable* block = this->FetchBlock(blockIndex);
   vtkIdType blockOffset = row - (blockIndex * blockSize);
+  if (this->Internals->IsProjected(blockIndex, columnName))
+  {
+    return vtkVariant();
+  }
   return block->GetValueByName(blockOffset, columnName);
 }
 
@@ -774,7 +1282,7 @@ bool vtkSpreadSheetView::IsAvailable(vtkIdType row)
 {
   vtkIdType blockSize = this->TableStreamer->GetBlockSize();
   vtkIdType blockIndex = row / blockSize;
-  return this->Internals->GetDataObject(blockIndex) != NULL;
+  return this->Internals->GetDataObject(blockIndex, this) != NULL;
 }
 
 //----------------------------------------------------------------------------
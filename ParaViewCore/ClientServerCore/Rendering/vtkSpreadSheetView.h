@@ -202,8 +202,45 @@ public:
    */
   void ClearCache();
 
+  //@{
+  /**
+   * Get/Set the maximum number of blocks cached on the client. The least
+   * recently used block is evicted when the cache is full. Default is 10.
+   */
+  vtkSetClampMacro(CacheSize, int, 1, VTK_INT_MAX);
+  vtkGetMacro(CacheSize, int);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the number of blocks on each side of the last fetched block that
+   * are extracted ahead of time. When one process has all of the data, this
+   * is done on a worker thread. On a parallel server, where the blocks are
+   * sorted across all processes, all processes extract them together right
+   * after the fetched block has been delivered, while the client shows it.
+   * The blocks still have to be delivered to the client when they are
+   * fetched. 0 disables prefetching. Default is 1.
+   */
+  vtkSetClampMacro(NumberOfPrefetchBlocks, int, 0, VTK_INT_MAX);
+  vtkGetMacro(NumberOfPrefetchBlocks, int);
+  //@}
+
+  //@{
+  /**
+   * When on, columns hidden using HideColumnByLabel() (or HideColumnByName())
+   * on all processes are not delivered to the client once the columns of the
+   * data are known. They are replaced by placeholder columns on the client
+   * so that the columns reported by the view don't change. GetValue() returns
+   * an invalid vtkVariant for placeholder values. On by default.
+   * \note CallOnClient
+   */
+  vtkSetMacro(ColumnProjection, bool);
+  vtkGetMacro(ColumnProjection, bool);
+  vtkBooleanMacro(ColumnProjection, bool);
+  //@}
+
   // INTERNAL METHOD. Don't call directly.
-  vtkTable* FetchBlockCallback(vtkIdType blockindex);
+  vtkTable* FetchBlockCallback(vtkIdType blockindex, bool projectColumns = false);
 
 protected:
   vtkSpreadSheetView();
@@ -228,6 +265,9 @@ protected:
   vtkReductionFilter* ReductionFilter;
   vtkClientServerMoveData* DeliveryFilter;
   vtkIdType NumberOfRows;
+  int CacheSize;
+  int NumberOfPrefetchBlocks;
+  bool ColumnProjection;
 
   enum
   {
@@ -724,6 +724,157 @@ void vtkPVXMLElement::CopyTo(vtkPVXMLElement* other)
   }
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+const vtkTypeUInt32 vtkPVXMLElementNullString = 0xffffffff;
+
+void vtkPVXMLElementWriteUInt32(ostream& os, vtkTypeUInt32 value)
+{
+  char bytes[4];
+  for (int cc = 0; cc < 4; ++cc)
+  {
+    bytes[cc] = static_cast<char>(value & 0xff);
+    value = value >> 8;
+  }
+  os.write(bytes, 4);
+}
+
+void vtkPVXMLElementWriteString(ostream& os, const char* str, size_t length)
+{
+  if (str == NULL)
+  {
+    vtkPVXMLElementWriteUInt32(os, vtkPVXMLElementNullString);
+    return;
+  }
+  vtkPVXMLElementWriteUInt32(os, static_cast<vtkTypeUInt32>(length));
+  os.write(str, length);
+}
+
+bool vtkPVXMLElementReadUInt32(const char* buffer, size_t length, size_t& pos, vtkTypeUInt32& value)
+{
+  if (pos + 4 > length)
+  {
+    return false;
+  }
+  value = 0;
+  for (int cc = 0; cc < 4; ++cc)
+  {
+    value = value | (static_cast<vtkTypeUInt32>(0xff & buffer[pos + cc]) << 8 * cc);
+  }
+  pos += 4;
+  return true;
+}
+
+bool vtkPVXMLElementReadString(
+  const char* buffer, size_t length, size_t& pos, std::string& str, bool& isNull)
+{
+  vtkTypeUInt32 size;
+  if (!vtkPVXMLElementReadUInt32(buffer, length, pos, size))
+  {
+    return false;
+  }
+  isNull = (size == vtkPVXMLElementNullString);
+  if (isNull)
+  {
+    str.clear();
+    return true;
+  }
+  if (pos + size > length)
+  {
+    return false;
+  }
+  str.assign(buffer + pos, size);
+  pos += size;
+  return true;
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkPVXMLElement::WriteBinary(ostream& os)
+{
+  vtkPVXMLElementWriteString(os, this->Name, this->Name ? strlen(this->Name) : 0);
+  vtkPVXMLElementWriteString(os, this->Id, this->Id ? strlen(this->Id) : 0);
+
+  const size_t numAttributes = this->Internal->AttributeNames.size();
+  vtkPVXMLElementWriteUInt32(os, static_cast<vtkTypeUInt32>(numAttributes));
+  for (size_t i = 0; i < numAttributes; ++i)
+  {
+    const std::string& aName = this->Internal->AttributeNames[i];
+    const std::string& aValue = this->Internal->AttributeValues[i];
+    vtkPVXMLElementWriteString(os, aName.c_str(), aName.size());
+    vtkPVXMLElementWriteString(os, aValue.c_str(), aValue.size());
+  }
+
+  vtkPVXMLElementWriteString(
+    os, this->Internal->CharacterData.c_str(), this->Internal->CharacterData.size());
+
+  const size_t numNested = this->Internal->NestedElements.size();
+  vtkPVXMLElementWriteUInt32(os, static_cast<vtkTypeUInt32>(numNested));
+  for (size_t i = 0; i < numNested; ++i)
+  {
+    this->Internal->NestedElements[i]->WriteBinary(os);
+  }
+}
+
+//----------------------------------------------------------------------------
+size_t vtkPVXMLElement::ReadBinary(const char* buffer, size_t length)
+{
+  size_t pos = 0;
+  std::string str;
+  bool isNull;
+  if (!vtkPVXMLElementReadString(buffer, length, pos, str, isNull))
+  {
+    return 0;
+  }
+  this->SetName(isNull ? NULL : str.c_str());
+  if (!vtkPVXMLElementReadString(buffer, length, pos, str, isNull))
+  {
+    return 0;
+  }
+  this->SetId(isNull ? NULL : str.c_str());
+
+  vtkTypeUInt32 numAttributes;
+  if (!vtkPVXMLElementReadUInt32(buffer, length, pos, numAttributes))
+  {
+    return 0;
+  }
+  this->Internal->AttributeNames.resize(numAttributes);
+  this->Internal->AttributeValues.resize(numAttributes);
+  for (vtkTypeUInt32 i = 0; i < numAttributes; ++i)
+  {
+    if (!vtkPVXMLElementReadString(buffer, length, pos, this->Internal->AttributeNames[i], isNull) ||
+      !vtkPVXMLElementReadString(buffer, length, pos, this->Internal->AttributeValues[i], isNull))
+    {
+      return 0;
+    }
+  }
+
+  if (!vtkPVXMLElementReadString(buffer, length, pos, this->Internal->CharacterData, isNull))
+  {
+    return 0;
+  }
+
+  vtkTypeUInt32 numNested;
+  if (!vtkPVXMLElementReadUInt32(buffer, length, pos, numNested))
+  {
+    return 0;
+  }
+  this->Internal->NestedElements.reserve(numNested);
+  for (vtkTypeUInt32 i = 0; i < numNested; ++i)
+  {
+    vtkSmartPointer<vtkPVXMLElement> nested = vtkSmartPointer<vtkPVXMLElement>::New();
+    const size_t consumed = nested->ReadBinary(buffer + pos, length - pos);
+    if (consumed == 0)
+    {
+      return 0;
+    }
+    pos += consumed;
+    this->AddNestedElement(nested);
+  }
+  return pos;
+}
+
 //----------------------------------------------------------------------------
 void vtkPVXMLElement::CopyAttributesTo(vtkPVXMLElement* other)
 {
@@ -257,6 +257,19 @@ public:
    */
   void CopyAttributesTo(vtkPVXMLElement* other);
 
+  //@{
+  /**
+   * Serialize the element, with its attributes and nested elements, in a
+   * compact binary form and rebuild it from that form. This is faster than
+   * going through vtkPVXMLParser and is used to cache parsed XML, e.g. proxy
+   * definitions. ReadBinary() must be called on an empty element and returns
+   * the number of bytes consumed from `buffer`, or 0 on error. The format is
+   * not meant to be stable across ParaView versions.
+   */
+  void WriteBinary(ostream& os);
+  size_t ReadBinary(const char* buffer, size_t length);
+  //@}
+
 protected:
   vtkPVXMLElement();
   ~vtkPVXMLElement() override;
@@ -17,6 +17,7 @@
 #include "vtkCollection.h"
 #include "vtkCollectionIterator.h"
 #include "vtkCommand.h"
+#include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVConfig.h"
@@ -35,6 +36,9 @@
 #include "vtkTimerLog.h"
 
 #include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
 #include <map>
 #include <set>
 #include <sstream>
@@ -42,6 +46,16 @@
 #include <vector>
 
 #include <vtksys/RegularExpression.hxx>
+#include <vtksys/SystemInformation.hxx>
+#include <vtksys/SystemTools.hxx>
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VTK_SI_DEFINITION_CACHE_USE_MMAP
+#endif
 
 //****************************************************************************/
 //                    Internal Classes and typedefs
@@ -410,6 +424,416 @@ private:
   bool InvalidCustomIterator;
 };
 
+//****************************************************************************/
+// Parses server-manager XML, going through the binary cache of parsed XML if
+// enabled and, when requested, parsing on the root process only and
+// broadcasting the result to the other processes. Broadcasting is only done
+// while SetCollective(true) is in effect, i.e. for XML that all processes are
+// known to be loading together.
+// The cache file starts with a header identifying the format and ParaView
+// version, followed by entries each made of a key identifying the XML content
+// and the vtkPVXMLElement::WriteBinary() form of the parsed tree.
+class vtkSIProxyDefinitionManager::vtkDefinitionCache
+{
+public:
+  static std::string& GetFileName()
+  {
+    static std::string fileName =
+      getenv("PV_PROXY_DEFINITION_CACHE") ? getenv("PV_PROXY_DEFINITION_CACHE") : "";
+    return fileName;
+  }
+
+  static bool& GetBroadcastUsed()
+  {
+    static bool used = false;
+    return used;
+  }
+
+  // Must be called collectively when definitions are broadcast.
+  vtkDefinitionCache()
+    : ParseTime(0)
+    , BroadcastTime(0)
+    , RegisterTime(0)
+    , Controller(NULL)
+    , Collective(false)
+    , Data(NULL)
+    , Length(0)
+    , Mapped(false)
+  {
+    this->FileName = vtkDefinitionCache::GetFileName();
+
+    // Whether to broadcast was decided by the root during startup. Only the
+    // first definition manager, created while all the processes start up
+    // together, broadcasts; later ones, e.g. for sessions created on the
+    // root only, parse locally and make no collective call.
+    vtkProcessModule* pm = vtkProcessModule::GetProcessModule();
+    if (pm && pm->GetBroadcastDefinitions() && !vtkDefinitionCache::GetBroadcastUsed())
+    {
+      vtkDefinitionCache::GetBroadcastUsed() = true;
+      this->Controller = pm->GetGlobalController();
+    }
+
+    // satellites get the parsed XML from the root, they don't need the cache.
+    if (this->Controller && this->Controller->GetLocalProcessId() > 0)
+    {
+      this->FileName.clear();
+    }
+    if (!this->FileName.empty())
+    {
+      vtkTimerLog::MarkStartEvent("vtkSIProxyDefinitionManager Load Cache");
+      this->Open();
+      vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Load Cache");
+    }
+  }
+
+  ~vtkDefinitionCache() { this->Close(); }
+
+  bool IsEnabled() const { return !this->FileName.empty(); }
+
+  /**
+   * Set to true while loading XML on all processes together, e.g. the
+   * definitions from plugins already loaded when the definition manager is
+   * created. Other loads, such as plugins loaded later on some processes
+   * only, are always parsed locally.
+   */
+  void SetCollective(bool val) { this->Collective = val; }
+
+  /**
+   * Returns the parsed tree for the given XML, or NULL on parse error.
+   */
+  vtkSmartPointer<vtkPVXMLElement> Parse(const char* xmlContent)
+  {
+    if (this->Controller && this->Collective)
+    {
+      return this->ParseOnRootAndBroadcast(xmlContent, this->Controller);
+    }
+    return this->ParseLocally(xmlContent);
+  }
+
+  double ParseTime;
+  double BroadcastTime;
+  double RegisterTime;
+
+  /**
+   * Returns the tree for the given XML from the cache, or NULL.
+   */
+  vtkSmartPointer<vtkPVXMLElement> Find(const char* xmlContent)
+  {
+    std::map<std::string, std::pair<const char*, size_t> >::iterator iter =
+      this->Entries.find(vtkDefinitionCache::GetKey(xmlContent));
+    if (iter == this->Entries.end())
+    {
+      return NULL;
+    }
+    vtkSmartPointer<vtkPVXMLElement> root = vtkSmartPointer<vtkPVXMLElement>::New();
+    if (root->ReadBinary(iter->second.first, iter->second.second) != iter->second.second)
+    {
+      return NULL;
+    }
+    return root;
+  }
+
+  /**
+   * Adds the parsed tree for the given XML, to be written on the next Save().
+   */
+  void Add(const char* xmlContent, vtkPVXMLElement* root)
+  {
+    std::ostringstream payload;
+    root->WriteBinary(payload);
+    this->Pending.push_back(std::make_pair(vtkDefinitionCache::GetKey(xmlContent), payload.str()));
+  }
+
+  /**
+   * Rewrites the cache file with the new entries, if any. The file is written
+   * to a temporary file first and then renamed so other processes never see
+   * a partial file.
+   */
+  void Save()
+  {
+    if (this->Pending.empty())
+    {
+      return;
+    }
+    vtkProcessModule* pm = vtkProcessModule::GetProcessModule();
+    if (pm && pm->GetPartitionId() > 0)
+    {
+      this->Pending.clear();
+      return;
+    }
+
+    vtksys::SystemInformation sysinfo;
+    std::ostringstream tmpName;
+    tmpName << this->FileName << "." << sysinfo.GetProcessId() << ".tmp";
+    std::ofstream file(tmpName.str().c_str(), std::ios::out | std::ios::binary);
+    if (!file)
+    {
+      this->Pending.clear();
+      return;
+    }
+    if (this->Entries.empty())
+    {
+      const std::string header = vtkDefinitionCache::GetHeader();
+      file.write(header.c_str(), header.size());
+    }
+    else
+    {
+      // existing entries are still valid, copy them as is.
+      file.write(this->Data, this->Length);
+    }
+    for (size_t cc = 0; cc < this->Pending.size(); ++cc)
+    {
+      vtkDefinitionCache::WriteEntry(file, this->Pending[cc].first, this->Pending[cc].second);
+    }
+    file.close();
+    this->Pending.clear();
+
+    if (!file || !vtksys::SystemTools::RenameFile(tmpName.str().c_str(), this->FileName.c_str()))
+    {
+      vtksys::SystemTools::RemoveFile(tmpName.str());
+      return;
+    }
+
+    // use the new file from now on, so further entries get appended to it.
+    this->Close();
+    this->Open();
+  }
+
+private:
+  vtkSmartPointer<vtkPVXMLElement> ParseLocally(const char* xmlContent)
+  {
+    vtkTimerLog::MarkStartEvent("vtkSIProxyDefinitionManager Parse XML");
+    const double startTime = vtkTimerLog::GetUniversalTime();
+    vtkSmartPointer<vtkPVXMLElement> root = this->IsEnabled() ? this->Find(xmlContent) : NULL;
+    if (!root)
+    {
+      vtkNew<vtkPVXMLParser> parser;
+      if (parser->Parse(xmlContent) != 0)
+      {
+        root = parser->GetRootElement();
+        if (this->IsEnabled())
+        {
+          this->Add(xmlContent, root);
+        }
+      }
+    }
+    this->ParseTime += vtkTimerLog::GetUniversalTime() - startTime;
+    vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Parse XML");
+    return root;
+  }
+
+  // Must be called collectively. The root parses the XML and broadcasts the
+  // binary form of the tree along with the key for the XML, which lets
+  // satellites detect when they were not asked to load the same XML.
+  vtkSmartPointer<vtkPVXMLElement> ParseOnRootAndBroadcast(
+    const char* xmlContent, vtkMultiProcessController* controller)
+  {
+    const bool isRoot = controller->GetLocalProcessId() == 0;
+    vtkSmartPointer<vtkPVXMLElement> root;
+    std::string buffer;
+    vtkIdType sizes[2] = { 0, 0 };
+    if (isRoot)
+    {
+      root = this->ParseLocally(xmlContent);
+      const std::string key = vtkDefinitionCache::GetKey(xmlContent);
+      std::ostringstream payload;
+      if (root)
+      {
+        root->WriteBinary(payload);
+      }
+      buffer = key + payload.str();
+      sizes[0] = static_cast<vtkIdType>(key.size());
+      sizes[1] = static_cast<vtkIdType>(buffer.size() - key.size());
+    }
+
+    vtkTimerLog::MarkStartEvent("vtkSIProxyDefinitionManager Broadcast XML");
+    const double startTime = vtkTimerLog::GetUniversalTime();
+    controller->Broadcast(sizes, 2, 0);
+    buffer.resize(static_cast<size_t>(sizes[0] + sizes[1]));
+    if (!buffer.empty())
+    {
+      controller->Broadcast(&buffer[0], static_cast<vtkIdType>(buffer.size()), 0);
+    }
+    this->BroadcastTime += vtkTimerLog::GetUniversalTime() - startTime;
+    vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Broadcast XML");
+
+    if (isRoot)
+    {
+      return root;
+    }
+    if (buffer.compare(0, static_cast<size_t>(sizes[0]), vtkDefinitionCache::GetKey(xmlContent)) !=
+      0)
+    {
+      vtkGenericWarningMacro("XML received from root process doesn't match the local one. "
+                             "Parsing it locally.");
+      return this->ParseLocally(xmlContent);
+    }
+    if (sizes[1] == 0)
+    {
+      // failed to parse on the root too.
+      return NULL;
+    }
+    const double readStartTime = vtkTimerLog::GetUniversalTime();
+    root = vtkSmartPointer<vtkPVXMLElement>::New();
+    const size_t length = static_cast<size_t>(sizes[1]);
+    if (root->ReadBinary(buffer.c_str() + sizes[0], length) != length)
+    {
+      root = NULL;
+    }
+    this->ParseTime += vtkTimerLog::GetUniversalTime() - readStartTime;
+    return root;
+  }
+
+  static std::string GetHeader()
+  {
+    std::ostringstream header;
+    header << "PVDEFCACHE 1 " << PARAVIEW_VERSION_FULL << "\n";
+    return header.str();
+  }
+
+  // FNV-1a hash of the content, along with its length.
+  static std::string GetKey(const char* xmlContent)
+  {
+    vtkTypeUInt64 hash = 14695981039346656037ull;
+    size_t length = 0;
+    for (const char* ptr = xmlContent; *ptr; ++ptr, ++length)
+    {
+      hash = (hash ^ static_cast<unsigned char>(*ptr)) * 1099511628211ull;
+    }
+    std::ostringstream key;
+    key << std::hex << hash << ":" << std::dec << length;
+    return key.str();
+  }
+
+  static void WriteSize(ostream& os, vtkTypeUInt64 size)
+  {
+    char bytes[8];
+    for (int cc = 0; cc < 8; ++cc)
+    {
+      bytes[cc] = static_cast<char>(size & 0xff);
+      size = size >> 8;
+    }
+    os.write(bytes, 8);
+  }
+
+  static bool ReadSize(const char* buffer, size_t length, size_t& pos, vtkTypeUInt64& size)
+  {
+    if (pos + 8 > length)
+    {
+      return false;
+    }
+    size = 0;
+    for (int cc = 0; cc < 8; ++cc)
+    {
+      size = size | (static_cast<vtkTypeUInt64>(0xff & buffer[pos + cc]) << 8 * cc);
+    }
+    pos += 8;
+    return true;
+  }
+
+  static void WriteEntry(ostream& os, const std::string& key, const std::string& payload)
+  {
+    vtkDefinitionCache::WriteSize(os, key.size());
+    os.write(key.c_str(), key.size());
+    vtkDefinitionCache::WriteSize(os, payload.size());
+    os.write(payload.c_str(), payload.size());
+  }
+
+  void Open()
+  {
+#ifdef VTK_SI_DEFINITION_CACHE_USE_MMAP
+    int fd = open(this->FileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+      void* data = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        this->Data = static_cast<const char*>(data);
+        this->Length = static_cast<size_t>(info.st_size);
+        this->Mapped = true;
+      }
+    }
+    close(fd);
+#else
+    std::ifstream file(this->FileName.c_str(), std::ios::in | std::ios::binary);
+    if (file)
+    {
+      this->Buffer.assign(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      this->Data = this->Buffer.empty() ? NULL : &this->Buffer[0];
+      this->Length = this->Buffer.size();
+    }
+#endif
+    if (!this->Index())
+    {
+      // invalid or from another version, it will be overwritten.
+      this->Entries.clear();
+    }
+  }
+
+  bool Index()
+  {
+    const std::string header = vtkDefinitionCache::GetHeader();
+    if (this->Data == NULL || this->Length < header.size() ||
+      strncmp(this->Data, header.c_str(), header.size()) != 0)
+    {
+      return false;
+    }
+    size_t pos = header.size();
+    while (pos < this->Length)
+    {
+      vtkTypeUInt64 keySize, payloadSize;
+      if (!vtkDefinitionCache::ReadSize(this->Data, this->Length, pos, keySize) ||
+        pos + keySize > this->Length)
+      {
+        return false;
+      }
+      const std::string key(this->Data + pos, static_cast<size_t>(keySize));
+      pos += static_cast<size_t>(keySize);
+      if (!vtkDefinitionCache::ReadSize(this->Data, this->Length, pos, payloadSize) ||
+        pos + payloadSize > this->Length)
+      {
+        return false;
+      }
+      this->Entries[key] = std::make_pair(this->Data + pos, static_cast<size_t>(payloadSize));
+      pos += static_cast<size_t>(payloadSize);
+    }
+    return true;
+  }
+
+  void Close()
+  {
+#ifdef VTK_SI_DEFINITION_CACHE_USE_MMAP
+    if (this->Mapped)
+    {
+      munmap(const_cast<char*>(this->Data), this->Length);
+    }
+#else
+    this->Buffer.clear();
+#endif
+    this->Data = NULL;
+    this->Length = 0;
+    this->Mapped = false;
+    this->Entries.clear();
+  }
+
+  std::string FileName;
+  vtkMultiProcessController* Controller;
+  bool Collective;
+  const char* Data;
+  size_t Length;
+  bool Mapped;
+#ifndef VTK_SI_DEFINITION_CACHE_USE_MMAP
+  std::vector<char> Buffer;
+#endif
+  std::map<std::string, std::pair<const char*, size_t> > Entries;
+  std::vector<std::pair<std::string, std::string> > Pending;
+};
+
 //****************************************************************************/
 vtkStandardNewMacro(vtkSIProxyDefinitionManager) vtkStandardNewMacro(vtkInternalDefinitionIterator)
   //---------------------------------------------------------------------------
@@ -417,9 +841,14 @@ vtkStandardNewMacro(vtkSIProxyDefinitionManager) vtkStandardNewMacro(vtkInternal
 {
   this->Internals = new vtkInternals;
   this->InternalsFlatten = new vtkInternals;
+  this->DefinitionCache = new vtkDefinitionCache;
 
   vtkPVPluginTracker* tracker = vtkPVPluginTracker::GetInstance();
 
+  // All processes create the definition manager and load the same plugins
+  // here, so the XML can be parsed on the root only.
+  this->DefinitionCache->SetCollective(true);
+
   // Load the core xmls.
   // These are loaded from the vtkPVInitializerPlugin plugin.
   for (unsigned int cc = 0; cc < tracker->GetNumberOfPlugins(); cc++)
@@ -444,6 +873,8 @@ vtkStandardNewMacro(vtkSIProxyDefinitionManager) vtkStandardNewMacro(vtkInternal
 
     this->HandlePlugin(plugin);
   }
+  this->DefinitionCache->SetCollective(false);
+  this->DefinitionCache->Save();
 
   // Register with the plugin tracker, so that when new plugins are loaded,
   // we parse the XML if provided and automatically add it to the proxy
@@ -457,6 +888,20 @@ vtkSIProxyDefinitionManager::~vtkSIProxyDefinitionManager()
 {
   delete this->Internals;
   delete this->InternalsFlatten;
+  delete this->DefinitionCache;
+}
+
+//----------------------------------------------------------------------------
+void vtkSIProxyDefinitionManager::SetDefinitionCacheFileName(const char* fname)
+{
+  vtkDefinitionCache::GetFileName() = fname ? fname : "";
+}
+
+//----------------------------------------------------------------------------
+const char* vtkSIProxyDefinitionManager::GetDefinitionCacheFileName()
+{
+  const std::string& fname = vtkDefinitionCache::GetFileName();
+  return fname.empty() ? NULL : fname.c_str();
 }
 
 //----------------------------------------------------------------------------
@@ -761,9 +1206,36 @@ bool vtkSIProxyDefinitionManager::LoadConfigurationXMLFromString(const char* xml
 bool vtkSIProxyDefinitionManager::LoadConfigurationXMLFromString(
   const char* xmlContent, bool attachHints)
 {
-  vtkNew<vtkPVXMLParser> parser;
-  return (parser->Parse(xmlContent) != 0) &&
-    this->LoadConfigurationXML(parser->GetRootElement(), attachHints);
+  vtkSmartPointer<vtkPVXMLElement> root = this->DefinitionCache->Parse(xmlContent);
+  if (!root)
+  {
+    return false;
+  }
+
+  vtkTimerLog::MarkStartEvent("vtkSIProxyDefinitionManager Register Definitions");
+  const double startTime = vtkTimerLog::GetUniversalTime();
+  const bool status = this->LoadConfigurationXML(root, attachHints);
+  this->DefinitionCache->RegisterTime += vtkTimerLog::GetUniversalTime() - startTime;
+  vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Register Definitions");
+  return status;
+}
+
+//---------------------------------------------------------------------------
+double vtkSIProxyDefinitionManager::GetParseTime()
+{
+  return this->DefinitionCache->ParseTime;
+}
+
+//---------------------------------------------------------------------------
+double vtkSIProxyDefinitionManager::GetBroadcastTime()
+{
+  return this->DefinitionCache->BroadcastTime;
+}
+
+//---------------------------------------------------------------------------
+double vtkSIProxyDefinitionManager::GetRegisterTime()
+{
+  return this->DefinitionCache->RegisterTime;
 }
 
 //---------------------------------------------------------------------------
@@ -819,6 +1291,14 @@ bool vtkSIProxyDefinitionManager::LoadConfigurationXML(vtkPVXMLElement* root, bo
 void vtkSIProxyDefinitionManager::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DefinitionCacheFileName: "
+     << (vtkSIProxyDefinitionManager::GetDefinitionCacheFileName()
+            ? vtkSIProxyDefinitionManager::GetDefinitionCacheFileName()
+            : "(none)")
+     << endl;
+  os << indent << "ParseTime: " << this->GetParseTime() << endl;
+  os << indent << "BroadcastTime: " << this->GetBroadcastTime() << endl;
+  os << indent << "RegisterTime: " << this->GetRegisterTime() << endl;
 }
 //---------------------------------------------------------------------------
 // vtkSIProxyDefinitionManager::ALL_DEFINITIONS    = 0
@@ -1166,6 +1646,7 @@ void vtkSIProxyDefinitionManager::Push(vtkSMMessage* msg)
 void vtkSIProxyDefinitionManager::OnPluginLoaded(vtkObject*, unsigned long, void* calldata)
 {
   this->HandlePlugin(reinterpret_cast<vtkPVPlugin*>(calldata));
+  this->DefinitionCache->Save();
 }
 
 //---------------------------------------------------------------------------
@@ -37,6 +37,14 @@
  * \li \c vtkCommand::UnRegisterEvent - Fired when a proxy definition is
  * removed. Since this class only support removing custom proxies, this event is
  * fired only when a custom proxy is removed.
+ *
+ * Parsing the server-manager XML on startup can be avoided by setting a
+ * definition cache file (see SetDefinitionCacheFileName()). Parsed XML
+ * trees are saved to it in a binary form and rebuilt from it on subsequent
+ * runs. When vtkProcessModule::GetBroadcastDefinitions() is true, the XML
+ * loaded when the first definition manager is created is only parsed on the
+ * root process and the parsed trees are broadcast to the other processes.
+ * Otherwise no collective call is made.
 */
 
 #ifndef vtkSIProxyDefinitionManager_h
@@ -157,6 +165,33 @@ public:
   bool LoadConfigurationXMLFromString(const char* xmlContent);
   //@}
 
+  //@{
+  /**
+   * Set the file used to cache parsed server-manager XML across runs. XML
+   * (from ParaView itself or from plugins) already in the cache is rebuilt
+   * from its binary form, which is memory mapped, instead of being parsed;
+   * XML not yet in the cache is appended to it. The cache is versioned and is
+   * rebuilt when it was generated by a different ParaView version. Only the
+   * first process of a parallel job updates the file. Default is the value of
+   * the PV_PROXY_DEFINITION_CACHE environment variable, if any. Must be set
+   * before the definition manager is created to be effective.
+   */
+  static void SetDefinitionCacheFileName(const char* fname);
+  static const char* GetDefinitionCacheFileName();
+  //@}
+
+  //@{
+  /**
+   * Time, in seconds, spent so far loading configuration XML: parsing it (or
+   * reading it from the definition cache), broadcasting it from the root
+   * process and registering the definitions it contains. These are also
+   * reported as events in the timer log.
+   */
+  double GetParseTime();
+  double GetBroadcastTime();
+  double GetRegisterTime();
+  //@}
+
   enum Events
   {
     ProxyDefinitionsUpdated = 2000,
@@ -328,6 +363,9 @@ private:
   class vtkInternals;
   vtkInternals* Internals;
   vtkInternals* InternalsFlatten;
+
+  class vtkDefinitionCache;
+  vtkDefinitionCache* DefinitionCache;
 };
 
 #endif
@@ -0,0 +1,161 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestProxyDefinitionCache.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkPVPlugin.h"
+#include "vtkPVPluginTracker.h"
+#include "vtkPVServerManagerPluginInterface.h"
+#include "vtkPVXMLElement.h"
+#include "vtkPVXMLParser.h"
+#include "vtkProcessModule.h"
+#include "vtkSIProxyDefinitionManager.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Compares startup costs of parsing the core server-manager XML against
+// rebuilding it from the binary definition cache, and checks both produce the
+// same definitions.
+int TestProxyDefinitionCache(int argc, char* argv[])
+{
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+
+  std::vector<std::string> xmls;
+  vtkPVPluginTracker* tracker = vtkPVPluginTracker::GetInstance();
+  for (unsigned int cc = 0; cc < tracker->GetNumberOfPlugins(); cc++)
+  {
+    vtkPVPlugin* plugin = tracker->GetPlugin(cc);
+    vtkPVServerManagerPluginInterface* smplugin =
+      dynamic_cast<vtkPVServerManagerPluginInterface*>(plugin);
+    if (smplugin && strcmp(plugin->GetPluginName(), "vtkPVInitializerPlugin") == 0)
+    {
+      smplugin->GetXMLs(xmls);
+    }
+  }
+  if (xmls.empty())
+  {
+    cerr << "Failed to locate core server-manager XMLs." << endl;
+    vtkInitializationHelper::Finalize();
+    return EXIT_FAILURE;
+  }
+
+  // Parse vs. binary round trip for the core XMLs.
+  vtkNew<vtkTimerLog> timer;
+  std::vector<vtkSmartPointer<vtkPVXMLElement> > parsed;
+  timer->StartTimer();
+  for (size_t cc = 0; cc < xmls.size(); ++cc)
+  {
+    vtkNew<vtkPVXMLParser> parser;
+    parser->Parse(xmls[cc].c_str());
+    parsed.push_back(parser->GetRootElement());
+  }
+  timer->StopTimer();
+  const double parseTime = timer->GetElapsedTime();
+
+  std::vector<std::string> binaries;
+  for (size_t cc = 0; cc < parsed.size(); ++cc)
+  {
+    std::ostringstream stream;
+    parsed[cc]->WriteBinary(stream);
+    binaries.push_back(stream.str());
+  }
+
+  std::vector<vtkSmartPointer<vtkPVXMLElement> > rebuilt;
+  timer->StartTimer();
+  for (size_t cc = 0; cc < binaries.size(); ++cc)
+  {
+    vtkSmartPointer<vtkPVXMLElement> root = vtkSmartPointer<vtkPVXMLElement>::New();
+    if (root->ReadBinary(binaries[cc].c_str(), binaries[cc].size()) != binaries[cc].size())
+    {
+      cerr << "Failed to read binary form for XML " << cc << endl;
+      vtkInitializationHelper::Finalize();
+      return EXIT_FAILURE;
+    }
+    rebuilt.push_back(root);
+  }
+  timer->StopTimer();
+  const double readTime = timer->GetElapsedTime();
+
+  for (size_t cc = 0; cc < parsed.size(); ++cc)
+  {
+    if (!parsed[cc]->Equals(rebuilt[cc]))
+    {
+      cerr << "Binary form doesn't match parsed XML " << cc << endl;
+      vtkInitializationHelper::Finalize();
+      return EXIT_FAILURE;
+    }
+  }
+  cout << "Parsing " << xmls.size() << " XMLs: " << parseTime << " s" << endl;
+  cout << "Reading binary form: " << readTime << " s" << endl;
+
+  // Definition manager startup without and with a populated cache.
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  if (!tempDir)
+  {
+    cerr << "Could not determine temporary directory.\n";
+    vtkInitializationHelper::Finalize();
+    return EXIT_FAILURE;
+  }
+  std::string path = tempDir;
+  path += "/TestProxyDefinitionCache.bin";
+  delete[] tempDir;
+  remove(path.c_str());
+
+  vtkSIProxyDefinitionManager::SetDefinitionCacheFileName(path.c_str());
+  timer->StartTimer();
+  vtkSmartPointer<vtkSIProxyDefinitionManager> cold =
+    vtkSmartPointer<vtkSIProxyDefinitionManager>::New();
+  timer->StopTimer();
+  const double coldTime = timer->GetElapsedTime();
+
+  if (!std::ifstream(path.c_str()))
+  {
+    cerr << "Definition cache was not written." << endl;
+    vtkSIProxyDefinitionManager::SetDefinitionCacheFileName(NULL);
+    vtkInitializationHelper::Finalize();
+    return EXIT_FAILURE;
+  }
+
+  timer->StartTimer();
+  vtkSmartPointer<vtkSIProxyDefinitionManager> warm =
+    vtkSmartPointer<vtkSIProxyDefinitionManager>::New();
+  timer->StopTimer();
+  const double warmTime = timer->GetElapsedTime();
+  vtkSIProxyDefinitionManager::SetDefinitionCacheFileName(NULL);
+
+  cout << "Definition manager startup, cold cache: " << coldTime << " s" << endl;
+  cout << "Definition manager startup, warm cache: " << warmTime << " s" << endl;
+
+  vtkPVXMLElement* expected = cold->GetProxyDefinition("sources", "SphereSource");
+  vtkPVXMLElement* actual = warm->GetProxyDefinition("sources", "SphereSource");
+  if (!expected || !actual || !expected->Equals(actual))
+  {
+    cerr << "Definitions loaded from the cache don't match." << endl;
+    vtkInitializationHelper::Finalize();
+    return EXIT_FAILURE;
+  }
+
+  cold = NULL;
+  warm = NULL;
+  vtkInitializationHelper::Finalize();
+  return EXIT_SUCCESS;
+}
@@ -99,6 +99,16 @@ int TestSettings(int argc, char* argv[])
     cerr << "Could not get Radius property\n";
   }
 
+  // Lookups must reflect settings changed after earlier lookups.
+  settings->SetSetting(".sources.SphereSource.Radius", 3.5);
+  if (settings->GetSettingAsDouble(".sources.SphereSource.Radius", 0.0) != 3.5 ||
+    settings->GetSettingAsDouble("sources.SphereSource.Center", 2, 0.0) != 3.0 ||
+    settings->HasSetting(".sources.SphereSource.Radius", 0.5))
+  {
+    cerr << "Failed at " << __LINE__ << endl;
+    return EXIT_FAILURE;
+  }
+
   // Test saving different number of repeatable property values
   vtkSmartPointer<vtkSMProxy> contour;
   contour.TakeReference(pxm->NewProxy("filters", "Contour"));
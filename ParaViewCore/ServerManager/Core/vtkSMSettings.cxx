@@ -39,6 +39,7 @@
 #include <cfloat>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #define vtkSMSettingsDebugMacro(x)                                                                 \
   {                                                                                                \
@@ -53,11 +54,158 @@
 //----------------------------------------------------------------------------
 namespace
 {
+// Converts a setting name to the canonical form used as key in the
+// SettingsCollection index, i.e. ".name" for members and "[n]" for array
+// elements. The name is parsed the same way Json::Path does. Returns false if
+// the name uses Json::Path features the index doesn't support.
+bool GetCanonicalSettingName(const char* settingName, std::string& key)
+{
+  key.clear();
+  const char* current = settingName;
+  while (*current)
+  {
+    if (*current == '[')
+    {
+      ++current;
+      if (*current < '0' || *current > '9')
+      {
+        return false;
+      }
+      // skip leading zeros so that "[01]" and "[1]" give the same key.
+      while (*current == '0' && current[1] >= '0' && current[1] <= '9')
+      {
+        ++current;
+      }
+      key += '[';
+      for (; *current >= '0' && *current <= '9'; ++current)
+      {
+        key += *current;
+      }
+      if (*current != ']')
+      {
+        return false;
+      }
+      key += ']';
+      ++current;
+    }
+    else if (*current == '%')
+    {
+      return false;
+    }
+    else if (*current == '.' || *current == ']')
+    {
+      ++current;
+    }
+    else
+    {
+      const char* beginName = current;
+      while (*current && *current != '[' && *current != '.')
+      {
+        ++current;
+      }
+      key += '.';
+      key.append(beginName, current);
+    }
+  }
+  return true;
+}
+
 class SettingsCollection
 {
 public:
   Json::Value Value;
   double Priority;
+
+  SettingsCollection()
+    : Priority(0.0)
+    , IndexIsValid(false)
+  {
+  }
+
+  // The index refers to nodes of Value, it is not copied.
+  SettingsCollection(const SettingsCollection& other)
+    : Value(other.Value)
+    , Priority(other.Priority)
+    , IndexIsValid(false)
+  {
+  }
+
+  SettingsCollection& operator=(const SettingsCollection& other)
+  {
+    this->Value = other.Value;
+    this->Priority = other.Priority;
+    this->InvalidateIndex();
+    return *this;
+  }
+
+  //----------------------------------------------------------------------------
+  // Description:
+  // Returns the setting with the given canonical name, null if not defined.
+  // The index of all settings in the collection is built on demand.
+  const Json::Value& Resolve(const std::string& key)
+  {
+    if (!this->IndexIsValid)
+    {
+      this->Index.clear();
+      std::string prefix;
+      this->BuildIndex(this->Value, prefix);
+      this->IndexIsValid = true;
+    }
+    std::unordered_map<std::string, const Json::Value*>::const_iterator iter =
+      this->Index.find(key);
+    return iter != this->Index.end() ? *iter->second : Json::Value::nullSingleton();
+  }
+
+  //----------------------------------------------------------------------------
+  // Description:
+  // Must be called whenever Value is modified.
+  void InvalidateIndex()
+  {
+    this->IndexIsValid = false;
+    this->Index.clear();
+  }
+
+private:
+  void BuildIndex(const Json::Value& value, std::string& key)
+  {
+    if (value.isNull())
+    {
+      return;
+    }
+    this->Index[key] = &value;
+
+    const size_t length = key.size();
+    if (value.isObject())
+    {
+      for (Json::Value::const_iterator iter = value.begin(); iter != value.end(); ++iter)
+      {
+        // names Json::Path cannot refer to are skipped.
+        const std::string name = iter.name();
+        if (name.empty() || name[0] == ']' || name.find_first_of(".[") != std::string::npos)
+        {
+          continue;
+        }
+        key += '.';
+        key += name;
+        this->BuildIndex(*iter, key);
+        key.resize(length);
+      }
+    }
+    else if (value.isArray())
+    {
+      for (Json::Value::ArrayIndex i = 0; i < value.size(); ++i)
+      {
+        std::ostringstream index;
+        index << "[" << i << "]";
+        key += index.str();
+        this->BuildIndex(value[i], key);
+        key.resize(length);
+      }
+    }
+  }
+
+  std::unordered_map<std::string, const Json::Value*> Index;
+  bool IndexIsValid;
 };
 
 bool SortByPriority(const SettingsCollection& r1, const SettingsCollection& r2)
@@ -97,9 +245,22 @@ public:
     // Sort the settings roots by priority (highest to lowest)
     std::stable_sort(
       this->SettingCollections.begin(), this->SettingCollections.end(), SortByPriority);
+    for (size_t i = 0; i < this->SettingCollections.size(); ++i)
+    {
+      this->SettingCollections[i].InvalidateIndex();
+    }
     this->SettingCollectionsAreSorted = true;
   }
 
+  //----------------------------------------------------------------------------
+  // Description:
+  // Returns the root of the highest-priority collection for modification.
+  Json::Value& GetHighestPriorityValue()
+  {
+    this->SettingCollections[0].InvalidateIndex();
+    return this->SettingCollections[0].Value;
+  }
+
   //----------------------------------------------------------------------------
   // Description:
   // Splits a JSON path into branch and leaf components. This is needed
@@ -146,45 +307,52 @@ public:
   //----------------------------------------------------------------------------
   const Json::Value& GetSettingBelowPriority(const char* settingName, double priority)
   {
-    this->SortCollectionsIfNeeded();
-
-    // Iterate over settings, checking higher priority settings first
-    for (size_t i = 0; i < this->SettingCollections.size(); ++i)
-    {
-      if (this->SettingCollections[i].Priority >= priority)
-      {
-        continue;
-      }
-
-      Json::Path settingPath(settingName);
-      const Json::Value& setting = settingPath.resolve(this->SettingCollections[i].Value);
-      if (!setting.isNull())
-      {
-        return setting;
-      }
-    }
-
-    return Json::Value::nullSingleton();
+    return this->GetSettingInPriorityRange(settingName, priority, false);
   }
 
   //----------------------------------------------------------------------------
   const Json::Value& GetSettingAtOrBelowPriority(const char* settingName, double maxPriority)
+  {
+    return this->GetSettingInPriorityRange(settingName, maxPriority, true);
+  }
+
+  //----------------------------------------------------------------------------
+  // Description:
+  // Returns the highest-priority setting defined in collections with a
+  // priority below (or equal to, if inclusive is true) maxPriority.
+  const Json::Value& GetSettingInPriorityRange(
+    const char* settingName, double maxPriority, bool inclusive)
   {
     this->SortCollectionsIfNeeded();
 
+    std::string key;
+    const bool indexed = GetCanonicalSettingName(settingName, key);
+
     // Iterate over settings, checking higher priority settings first
     for (size_t i = 0; i < this->SettingCollections.size(); ++i)
     {
-      if (this->SettingCollections[i].Priority > maxPriority)
+      SettingsCollection& collection = this->SettingCollections[i];
+      if (collection.Priority > maxPriority || (!inclusive && collection.Priority == maxPriority))
       {
         continue;
       }
 
-      Json::Path settingPath(settingName);
-      const Json::Value& setting = settingPath.resolve(this->SettingCollections[i].Value);
-      if (!setting.isNull())
+      if (indexed)
+      {
+        const Json::Value& setting = collection.Resolve(key);
+        if (!setting.isNull())
+        {
+          return setting;
+        }
+      }
+      else
       {
-        return setting;
+        Json::Path settingPath(settingName);
+        const Json::Value& setting = settingPath.resolve(collection.Value);
+        if (!setting.isNull())
+        {
+          return setting;
+        }
       }
     }
 
@@ -516,7 +684,7 @@ public:
     this->GetSetting(settingName, previousValues, VTK_DOUBLE_MAX);
 
     Json::Path settingPath(root.c_str());
-    Json::Value& jsonValue = settingPath.make(this->SettingCollections[0].Value);
+    Json::Value& jsonValue = settingPath.make(this->GetHighestPriorityValue());
     jsonValue[leaf] = Json::Value::nullSingleton();
 
     if (values.size() > 1)
@@ -546,7 +714,7 @@ public:
   bool SetPropertySetting(const char* settingName, vtkSMIntVectorProperty* property)
   {
     Json::Path valuePath(settingName);
-    Json::Value& jsonValue = valuePath.make(this->SettingCollections[0].Value);
+    Json::Value& jsonValue = valuePath.make(this->GetHighestPriorityValue());
     if (property->GetNumberOfElements() == 1)
     {
       if (jsonValue.isArray())
@@ -589,7 +757,7 @@ public:
   bool SetPropertySetting(const char* settingName, vtkSMDoubleVectorProperty* property)
   {
     Json::Path valuePath(settingName);
-    Json::Value& jsonValue = valuePath.make(this->SettingCollections[0].Value);
+    Json::Value& jsonValue = valuePath.make(this->GetHighestPriorityValue());
     if (property->GetNumberOfElements() == 1)
     {
       if (jsonValue.isArray())
@@ -632,7 +800,7 @@ public:
   bool SetPropertySetting(const char* settingName, vtkSMStringVectorProperty* property)
   {
     Json::Path valuePath(settingName);
-    Json::Value& jsonValue = valuePath.make(this->SettingCollections[0].Value);
+    Json::Value& jsonValue = valuePath.make(this->GetHighestPriorityValue());
     if (property->GetNumberOfElements() == 1)
     {
       if (jsonValue.isArray())
@@ -739,7 +907,7 @@ public:
     const char* settingCString = settingString.c_str();
 
     Json::Path valuePath(settingCString);
-    Json::Value& proxyValue = valuePath.make(this->SettingCollections[0].Value);
+    Json::Value& proxyValue = valuePath.make(this->GetHighestPriorityValue());
 
     bool propertySet = false;
     vtkSmartPointer<vtkSMPropertyIterator> iter;
@@ -823,7 +991,7 @@ public:
     if (!propertySet)
     {
       Json::Path parentPath(settingPrefix);
-      Json::Value& parentValue = parentPath.make(this->SettingCollections[0].Value);
+      Json::Value& parentValue = parentPath.make(this->GetHighestPriorityValue());
       parentValue.removeMember(proxyName);
 
       if (parentValue.empty())
@@ -835,12 +1003,12 @@ public:
         // Json::Path::make() doesn't appear to handle it correctly.
         if (parentRoot == ".")
         {
-          this->SettingCollections[0].Value.removeMember(parentLeaf);
+          this->GetHighestPriorityValue().removeMember(parentLeaf);
         }
         else
         {
           Json::Path parentRootPath(parentRoot);
-          Json::Value& parentRootValue = parentRootPath.make(this->SettingCollections[0].Value);
+          Json::Value& parentRootValue = parentRootPath.make(this->GetHighestPriorityValue());
           parentRootValue.removeMember(parentLeaf);
         }
       }
@@ -1399,7 +1567,7 @@ void vtkSMSettings::SetProxySettings(const char* prefix, vtkSMProxy* proxy,
 void vtkSMSettings::SetSettingDescription(const char* settingName, const char* description)
 {
   Json::Path settingPath(settingName);
-  Json::Value& settingValue = settingPath.make(this->Internal->SettingCollections[0].Value);
+  Json::Value& settingValue = settingPath.make(this->Internal->GetHighestPriorityValue());
   settingValue.setComment(std::string(description), Json::commentBefore);
 }
 
@@ -0,0 +1,73 @@
+# Writes a sphere with a serial writer in groups of 1 and 2 processes and
+# checks the pieces listed in the index written by the first process, that
+# they hold all the cells and that the file dialog does not take them for a
+# time series.
+from __future__ import print_function
+import json
+import os
+from paraview.simple import *
+from paraview import smtesting
+from vtkmodules.vtkPVVTKExtensionsDefault import vtkFileSequenceParser
+smtesting.ProcessCommandLineArguments()
+
+numProcs = servermanager.ActiveConnection.GetNumberOfDataPartitions()
+sphere = Sphere(ThetaResolution=32, PhiResolution=32)
+
+def write(name, groupSize):
+    fname = os.path.join(smtesting.TempDir, name + ".stl")
+    writer = servermanager.writers.PSTLWriter(Input=sphere, FileName=fname,
+                                              IOGroupSize=groupSize)
+    writer.UpdatePipeline()
+    del writer
+    return fname
+
+def numberOfCells(fname):
+    reader = STLReader(FileNames=[fname])
+    reader.UpdatePipeline()
+    count = reader.GetDataInformation().GetNumberOfCells()
+    Delete(reader)
+    return count
+
+expectedCells = numberOfCells(write("ParallelSerialWriterIOGroups", 0))
+if expectedCells == 0:
+    raise RuntimeError("The single file is empty.")
+
+for groupSize in [1, 2]:
+    name = "ParallelSerialWriterIOGroups%d" % groupSize
+    fname = write(name, groupSize)
+    if groupSize >= numProcs:
+        # a single group writes a single file, without an index.
+        if not os.path.exists(fname) or numberOfCells(fname) != expectedCells:
+            raise RuntimeError("IOGroupSize=%d: expected a single file." % groupSize)
+        continue
+
+    # the first process writes the index once all the groups are done.
+    with open(os.path.join(smtesting.TempDir, name + ".pieces.json")) as index:
+        pieces = json.load(index)["pieces"]
+    numGroups = (numProcs + groupSize - 1) // groupSize
+    if len(pieces) != numGroups:
+        raise RuntimeError("IOGroupSize=%d: expected %d pieces, got %d." %
+                           (groupSize, numGroups, len(pieces)))
+
+    parser = vtkFileSequenceParser()
+    fnames = []
+    series = set()
+    for group, piece in enumerate(pieces):
+        if piece["first-rank"] != group * groupSize or \
+           piece["number-of-ranks"] != min(groupSize, numProcs - group * groupSize):
+            raise RuntimeError("IOGroupSize=%d: wrong ranks for piece %d." % (groupSize, group))
+        fnames.append(os.path.join(smtesting.TempDir, piece["name"]))
+        if not os.path.exists(fnames[-1]):
+            raise RuntimeError("IOGroupSize=%d: missing %s." % (groupSize, piece["name"]))
+        if parser.ParseFileSequence(piece["name"]):
+            if parser.GetSequenceName() in series:
+                raise RuntimeError("IOGroupSize=%d: pieces are grouped as a time series." %
+                                   groupSize)
+            series.add(parser.GetSequenceName())
+
+    if os.path.exists(fname):
+        raise RuntimeError("IOGroupSize=%d: %s should not be written." % (groupSize, fname))
+    count = sum(numberOfCells(piece) for piece in fnames)
+    if count != expectedCells:
+        raise RuntimeError("IOGroupSize=%d: expected %d cells in the pieces, got %d." %
+                           (groupSize, expectedCells, count))
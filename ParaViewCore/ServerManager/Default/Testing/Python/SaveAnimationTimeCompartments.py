@@ -0,0 +1,43 @@
+# Saves an animation after the processes were split into time compartments
+# with the --time-compartments option of pvbatch and checks that all the
+# frames were written by the compartments together.
+from __future__ import print_function
+import os
+from paraview.simple import *
+from paraview import smtesting
+smtesting.ProcessCommandLineArguments()
+
+world = servermanager.vtkProcessModule.GetWorldController()
+compartment = servermanager.vtkProcessModule.GetTimeCompartmentController()
+if world.GetNumberOfProcesses() > 1 and compartment is None:
+    raise RuntimeError("The processes were not split into time compartments.")
+
+source = TimeSource(XAmplitude=1.0, YAmplitude=1.0)
+renderView1 = CreateView('RenderView')
+renderView1.ViewSize = [200, 200]
+Show(source, renderView1)
+Render(renderView1)
+
+animationScene1 = GetAnimationScene()
+animationScene1.UpdateAnimationUsingDataTimeSteps()
+
+prefix = os.path.join(smtesting.TempDir, "SaveAnimationTimeCompartments")
+SaveAnimation(prefix + ".png", renderView1, ImageResolution=[200, 200])
+
+# every compartment must be done writing before the frames are checked.
+world.Barrier()
+
+if world.GetLocalProcessId() == 0:
+    from paraview.vtk.vtkIOImage import vtkPNGReader
+    numFrames = len(source.TimestepValues)
+    for frame in range(numFrames):
+        filename = "%s.%04d.png" % (prefix, frame)
+        if not os.path.exists(filename):
+            raise RuntimeError("Frame %d was not saved." % frame)
+        reader = vtkPNGReader()
+        reader.SetFileName(filename)
+        reader.Update()
+        if reader.GetOutput().GetDimensions()[0:2] != (200, 200):
+            raise RuntimeError("Frame %d has the wrong size." % frame)
+    if os.path.exists("%s.%04d.png" % (prefix, numFrames)):
+        raise RuntimeError("More frames than timesteps were saved.")
@@ -0,0 +1,86 @@
+# Tests the block cache, the prefetching and the column projection of the
+# spreadsheet view. When run on more than one rank, blocks are prefetched by
+# all the ranks together.
+
+from paraview.simple import *
+from paraview import smtesting
+
+smtesting.ProcessCommandLineArguments()
+
+sphere = Sphere(ThetaResolution=32, PhiResolution=32)
+elevation = Elevation(Input=sphere)
+
+view = CreateView("SpreadSheetView")
+view.BlockSize = 100
+view.CacheSize = 2
+view.NumberOfPrefetchBlocks = 0
+Show(elevation, view)
+Render(view)
+
+ssview = view.GetClientSideObject()
+numRows = ssview.GetNumberOfRows()
+if numRows < 400:
+    raise RuntimeError("Expected at least 400 rows, got %d." % numRows)
+
+fetches = [0]
+def countFetches(caller, event):
+    fetches[0] += 1
+ssview.AddObserver("UpdateEvent", countFetches)
+
+columns = [ssview.GetColumnName(cc) for cc in range(ssview.GetNumberOfColumns())]
+normals = [name for name in columns if name.startswith("Normals")][0]
+def readBlock(block):
+    values = []
+    for row in range(block * 100, min((block + 1) * 100, numRows)):
+        values.append([ssview.GetValueByName(row, name).ToString() for name in columns])
+    return values
+
+def expectFetches(blocks, expected, label):
+    fetches[0] = 0
+    for block in blocks:
+        readBlock(block)
+    if fetches[0] != expected:
+        raise RuntimeError("%s: expected %d fetches, got %d." % (label, expected, fetches[0]))
+
+# the least recently used block is evicted when the cache is full.
+ssview.ClearCache()
+expectFetches([0, 1, 0], 2, "Cached blocks")
+expectFetches([2], 1, "New block")
+expectFetches([0], 0, "Recently used block")
+expectFetches([1], 1, "Evicted block")
+
+# prefetched blocks are the same as the blocks fetched on demand.
+view.CacheSize = 10
+ssview.ClearCache()
+reference = [readBlock(block) for block in range(4)]
+view.NumberOfPrefetchBlocks = 2
+ssview.ClearCache()
+for block in [0, 1, 2, 3, 2, 1, 0]:
+    if readBlock(block) != reference[block]:
+        raise RuntimeError("Prefetched block %d differs." % block)
+
+# hidden columns are not delivered once the columns are known, the values of
+# the others are.
+view.NumberOfPrefetchBlocks = 0
+view.ColumnProjection = 1
+view.HiddenColumnLabels = ["Elevation"]
+ssview.ClearCache()
+readBlock(0)
+if not ssview.GetValueByName(150, normals).IsValid() or \
+   ssview.GetValueByName(150, "Elevation").IsValid():
+    raise RuntimeError("Hidden column was delivered.")
+
+# without projection, or once the column is shown again, it is delivered.
+view.ColumnProjection = 0
+ssview.ClearCache()
+readBlock(0)
+if not ssview.GetValueByName(150, "Elevation").IsValid():
+    raise RuntimeError("Column was not delivered without projection.")
+
+view.ColumnProjection = 1
+ssview.ClearCache()
+readBlock(0)
+readBlock(1)
+view.HiddenColumnLabels = []
+if readBlock(1) != reference[1]:
+    raise RuntimeError("Shown column has invalid values.")
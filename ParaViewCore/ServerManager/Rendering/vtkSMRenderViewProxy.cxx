@@ -245,6 +245,23 @@ vtkTypeUInt32 vtkSMRenderViewProxy::PreRender(bool interactive)
 
   if (interactive && rv->GetUseLODForInteractiveRender())
   {
+    if (rv->GetGenerateLODInBackground() && rv->GetSuggestedLODLevel() != rv->GetLODLevel())
+    {
+      // the view suggested a different LOD level based on the time taken by
+      // the previous interactive renders; switch to it on all processes.
+      vtkClientServerStream stream;
+      stream << vtkClientServerStream::Invoke << VTKOBJECT(this) << "SetLODLevel"
+             << rv->GetSuggestedLODLevel() << vtkClientServerStream::End;
+      this->ExecuteStream(stream);
+      this->NeedsUpdateLOD = true;
+    }
+    else if (rv->GetGenerateLODInBackground() && rv->GetLODLevelPending())
+    {
+      // some representations were still computing their LOD geometry in the
+      // background the last time around; check if it's ready now.
+      this->NeedsUpdateLOD = true;
+    }
+
     // for interactive renders, we need to determine if we are going to use LOD.
     // If so, we may need to update the LOD geometries.
     this->UpdateLOD();
@@ -229,6 +229,16 @@ void vtkInitializationHelper::Initialize(int argc, char** argv, int type, vtkPVO
 
   vtkProcessModule::GetProcessModule()->SetOptions(options);
 
+  // split the processes before any session gets the global controller.
+  if (options->GetSymmetricMPIMode() && options->GetNumberOfTimeCompartments() > 1)
+  {
+    vtkProcessModule::CreateTimeCompartments(options->GetNumberOfTimeCompartments());
+  }
+
+  // all processes go through here together, decide once whether the
+  // definitions are broadcast instead of in each session.
+  vtkProcessModule::GetProcessModule()->InitializeBroadcastDefinitions();
+
   // this has to happen after process module is initialized and options have
   // been set.
   PARAVIEW_INITIALIZE();
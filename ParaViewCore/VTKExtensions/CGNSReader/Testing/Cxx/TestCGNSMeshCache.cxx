@@ -0,0 +1,138 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestCGNSMeshCache.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Reads multi-zone files with and without the mesh cache, checks that a
+// second execution reuses the cached points and connectivity and that the
+// output matches the uncached one.
+#include "vtkCGNSReader.h"
+#include "vtkCellArray.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkDataArray.h"
+#include "vtkFieldData.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define vtk_assert(x)                                                                              \
+  if (!(x))                                                                                        \
+  {                                                                                                \
+    cerr << "On line " << __LINE__ << " ERROR: Condition FAILED!! : " << #x << endl;               \
+    return false;                                                                                  \
+  }
+
+namespace
+{
+std::vector<vtkPointSet*> GetLeaves(vtkMultiBlockDataSet* mb)
+{
+  std::vector<vtkPointSet*> leaves;
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(mb->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    if (vtkPointSet* ps = vtkPointSet::SafeDownCast(iter->GetCurrentDataObject()))
+    {
+      leaves.push_back(ps);
+    }
+  }
+  return leaves;
+}
+
+bool SameData(vtkDataArray* a, vtkDataArray* b)
+{
+  const size_t size =
+    static_cast<size_t>(a->GetNumberOfTuples()) * a->GetNumberOfComponents() * a->GetDataTypeSize();
+  return a->GetDataType() == b->GetDataType() &&
+    a->GetNumberOfTuples() == b->GetNumberOfTuples() &&
+    (size == 0 || memcmp(a->GetVoidPointer(0), b->GetVoidPointer(0), size) == 0);
+}
+
+bool TestFile(int argc, char* argv[], const char* name)
+{
+  char* fname = vtkTestUtilities::ExpandDataFileName(argc, argv, name);
+  const std::string filename = fname ? fname : "";
+  delete[] fname;
+
+  vtkNew<vtkCGNSReader> uncached;
+  uncached->SetFileName(filename.c_str());
+  uncached->CacheMeshOff();
+  uncached->UpdateInformation();
+  uncached->EnableAllCellArrays();
+  uncached->EnableAllPointArrays();
+  uncached->Update();
+
+  vtkNew<vtkCGNSReader> cached;
+  cached->SetFileName(filename.c_str());
+  cached->CacheMeshOn();
+  cached->UpdateInformation();
+  cached->EnableAllCellArrays();
+  cached->EnableAllPointArrays();
+  cached->Update();
+
+  std::vector<vtkSmartPointer<vtkPoints> > firstPoints;
+  std::vector<vtkPointSet*> leaves = GetLeaves(cached->GetOutput());
+  for (size_t cc = 0; cc < leaves.size(); ++cc)
+  {
+    firstPoints.push_back(leaves[cc]->GetPoints());
+  }
+
+  // Re-execute, the mesh should come from the cache.
+  cached->Modified();
+  cached->Update();
+
+  leaves = GetLeaves(cached->GetOutput());
+  std::vector<vtkPointSet*> expected = GetLeaves(uncached->GetOutput());
+  vtk_assert(!leaves.empty());
+  vtk_assert(leaves.size() == expected.size());
+  vtk_assert(leaves.size() == firstPoints.size());
+  for (size_t cc = 0; cc < leaves.size(); ++cc)
+  {
+    // Patches of structured zones are extracted from the zone, only the
+    // zone points themselves are cached.
+    vtkDataArray* isPatch = leaves[cc]->GetFieldData()->GetArray("ispatch");
+    if (!isPatch || isPatch->GetComponent(0, 0) == 0 ||
+      vtkUnstructuredGrid::SafeDownCast(leaves[cc]))
+    {
+      vtk_assert(leaves[cc]->GetPoints() == firstPoints[cc]);
+    }
+    vtk_assert(leaves[cc]->GetNumberOfCells() == expected[cc]->GetNumberOfCells());
+    vtk_assert(SameData(leaves[cc]->GetPoints()->GetData(), expected[cc]->GetPoints()->GetData()));
+
+    vtkUnstructuredGrid* ug = vtkUnstructuredGrid::SafeDownCast(leaves[cc]);
+    vtkUnstructuredGrid* expectedUG = vtkUnstructuredGrid::SafeDownCast(expected[cc]);
+    if (ug && expectedUG && ug->GetCells())
+    {
+      vtk_assert(SameData(ug->GetCells()->GetData(), expectedUG->GetCells()->GetData()));
+    }
+  }
+  return true;
+}
+}
+
+int TestCGNSMeshCache(int argc, char* argv[])
+{
+  if (!TestFile(argc, argv, "VisItBridge/5blocks.cgns") ||
+    !TestFile(argc, argv, "channelBump_solution.cgns"))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
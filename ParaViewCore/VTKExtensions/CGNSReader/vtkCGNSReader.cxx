@@ -46,6 +46,7 @@
 #include "vtkPVInformationKeys.h"
 #include "vtkPointData.h"
 #include "vtkPolyhedron.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
 #include "vtkTypeInt32Array.h"
@@ -357,6 +358,69 @@ public:
       readCurvilinearZone(base, zone, cellDim, physicalDim, zsize, voi, self);
     return vtkDataSet::SafeDownCast(zoneDO);
   }
+
+  /**
+   * Key of the mesh cached for a zone. The points are cached along with the
+   * name of their grid coordinates node, so that moving meshes
+   * (GridCoordinatesPointers naming a different node at each timestep) are
+   * read again and replace the cached points.
+   */
+  static std::string GetMeshCacheKey(int base, int zone, vtkCGNSReader* self)
+  {
+    const CGNSRead::BaseInformation& baseInfo = self->Internal->GetBase(base);
+    return std::string(baseInfo.name) + "/" + baseInfo.zones[zone].name + "/" + gridCoordName;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Mesh points and connectivities read for previous timesteps, see CacheMesh.
+class vtkCGNSReader::vtkMeshCache
+{
+public:
+  vtkMeshCache()
+    : FileTime(0)
+    , FileLength(0)
+    , DoublePrecisionMesh(-1)
+  {
+  }
+
+  // Drop everything cached for another file or point precision, or when the
+  // file has been modified since it was cached.
+  void Validate(const char* fileName, int doublePrecisionMesh)
+  {
+    const std::string name = fileName ? fileName : "";
+    const long fileTime = vtksys::SystemTools::ModifiedTime(name);
+    const unsigned long fileLength = vtksys::SystemTools::FileLength(name);
+    if (name != this->FileName || fileTime != this->FileTime || fileLength != this->FileLength ||
+      doublePrecisionMesh != this->DoublePrecisionMesh)
+    {
+      this->Clear();
+      this->FileName = name;
+      this->FileTime = fileTime;
+      this->FileLength = fileLength;
+      this->DoublePrecisionMesh = doublePrecisionMesh;
+    }
+  }
+
+  void Clear()
+  {
+    this->Points.ClearCache();
+    this->Connectivities.ClearCache();
+    this->FileName.clear();
+    this->FileTime = 0;
+    this->FileLength = 0;
+    this->DoublePrecisionMesh = -1;
+  }
+
+  CGNSRead::vtkCGNSCache<vtkPoints> Points;
+  // Unstructured grids holding only the cells of a zone.
+  CGNSRead::vtkCGNSCache<vtkUnstructuredGrid> Connectivities;
+
+private:
+  std::string FileName;
+  long FileTime;
+  unsigned long FileLength;
+  int DoublePrecisionMesh;
 };
 
 //----------------------------------------------------------------------------
@@ -378,6 +442,8 @@ vtkCGNSReader::vtkCGNSReader()
   this->CreateEachSolutionAsBlock = 0;
   this->IgnoreFlowSolutionPointers = false;
   this->DistributeBlocks = true;
+  this->CacheMesh = true;
+  this->MeshCache = new vtkMeshCache();
   this->IgnoreSILChangeEvents = false;
 
   // Setup the selection callback to modify this object when an array
@@ -413,6 +479,9 @@ vtkCGNSReader::~vtkCGNSReader()
 
   delete this->Internal;
   this->Internal = NULL;
+
+  delete this->MeshCache;
+  this->MeshCache = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -1208,7 +1277,7 @@ int vtkCGNSReader::vtkPrivate::AttachReferenceValue(
 
 //------------------------------------------------------------------------------
 vtkSmartPointer<vtkDataObject> vtkCGNSReader::vtkPrivate::readCurvilinearZone(int base,
-  int vtkNotUsed(zone), int cellDim, int physicalDim, const cgsize_t* zsize, const int* voi,
+  int zone, int cellDim, int physicalDim, const cgsize_t* zsize, const int* voi,
   vtkCGNSReader* self)
 {
   int rind[6];
@@ -1235,8 +1304,24 @@ vtkSmartPointer<vtkDataObject> vtkCGNSReader::vtkPrivate::readCurvilinearZone(in
 
   vtkPrivate::getGridAndSolutionNames(base, gridCoordName, solutionNames, self);
 
-  vtkPrivate::getCoordsIdAndFillRind(
-    gridCoordName, physicalDim, nCoordsArray, gridChildId, rind, self);
+  // Sub-extents (boundary patches) are not cached.
+  std::string meshKey;
+  vtkSmartPointer<vtkPoints> points;
+  if (self->CacheMesh && voi == nullptr)
+  {
+    meshKey = vtkPrivate::GetMeshCacheKey(base, zone, self);
+    points = self->MeshCache->Points.Find(meshKey, gridCoordName);
+  }
+
+  if (points)
+  {
+    std::fill(rind, rind + 6, 0);
+  }
+  else
+  {
+    vtkPrivate::getCoordsIdAndFillRind(
+      gridCoordName, physicalDim, nCoordsArray, gridChildId, rind, self);
+  }
 
   // Rind was parsed (or not) then populate dimensions :
   // Compute structured grid coordinate range
@@ -1292,32 +1377,40 @@ vtkSmartPointer<vtkDataObject> vtkCGNSReader::vtkPrivate::readCurvilinearZone(in
   // will be filling every 3 chunks in memory
   memEnd[0] *= 3;
 
-  // Set up points
-  vtkNew<vtkPoints> points;
-  //
-  // vtkPoints assumes float data type
-  //
-  if (self->GetDoublePrecisionMesh() != 0)
+  if (!points)
   {
-    points->SetDataTypeToDouble();
-  }
-  //
-  // Resize vtkPoints to fit data
-  //
-  points->SetNumberOfPoints(nPts);
+    // Set up points
+    points = vtkSmartPointer<vtkPoints>::New();
+    //
+    // vtkPoints assumes float data type
+    //
+    if (self->GetDoublePrecisionMesh() != 0)
+    {
+      points->SetDataTypeToDouble();
+    }
+    //
+    // Resize vtkPoints to fit data
+    //
+    points->SetNumberOfPoints(nPts);
 
-  //
-  // Populate the coordinates.  Put in 3D points with z=0 if the mesh is 2D.
-  //
-  if (self->GetDoublePrecisionMesh() != 0) // DOUBLE PRECISION MESHPOINTS
-  {
-    CGNSRead::get_XYZ_mesh<double, float>(self->cgioNum, gridChildId, nCoordsArray, cellDim, nPts,
-      srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points.Get());
-  }
-  else // SINGLE PRECISION MESHPOINTS
-  {
-    CGNSRead::get_XYZ_mesh<float, double>(self->cgioNum, gridChildId, nCoordsArray, cellDim, nPts,
-      srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points.Get());
+    //
+    // Populate the coordinates.  Put in 3D points with z=0 if the mesh is 2D.
+    //
+    if (self->GetDoublePrecisionMesh() != 0) // DOUBLE PRECISION MESHPOINTS
+    {
+      CGNSRead::get_XYZ_mesh<double, float>(self->cgioNum, gridChildId, nCoordsArray, cellDim,
+        nPts, srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points.Get());
+    }
+    else // SINGLE PRECISION MESHPOINTS
+    {
+      CGNSRead::get_XYZ_mesh<float, double>(self->cgioNum, gridChildId, nCoordsArray, cellDim,
+        nPts, srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points.Get());
+    }
+
+    if (!meshKey.empty())
+    {
+      self->MeshCache->Points.Insert(meshKey, points, gridCoordName);
+    }
   }
 
   //----------------------------------------------------------------------------
@@ -1509,8 +1602,23 @@ int vtkCGNSReader::GetUnstructuredZone(
 
   vtkPrivate::getGridAndSolutionNames(base, gridCoordName, solutionNames, this);
 
-  vtkPrivate::getCoordsIdAndFillRind(
-    gridCoordName, physicalDim, nCoordsArray, gridChildId, rind, this);
+  std::string meshKey;
+  vtkSmartPointer<vtkPoints> cachedPoints;
+  if (this->CacheMesh)
+  {
+    meshKey = vtkPrivate::GetMeshCacheKey(base, zone, this);
+    cachedPoints = this->MeshCache->Points.Find(meshKey, gridCoordName);
+  }
+
+  if (cachedPoints)
+  {
+    std::fill(rind, rind + 6, 0);
+  }
+  else
+  {
+    vtkPrivate::getCoordsIdAndFillRind(
+      gridCoordName, physicalDim, nCoordsArray, gridChildId, rind, this);
+  }
 
   // Rind was parsed or not then populate dimensions :
   // get grid coordinate range
@@ -1531,35 +1639,44 @@ int vtkCGNSReader::GetUnstructuredZone(
   assert(nPts == zsize[0]);
 
   // Set up points
-  vtkPoints* points = vtkPoints::New();
-
-  //
-  // wacky hack ...
-  memEnd[0] *= 3; // for memory aliasing
-  //
-  // vtkPoints assumes float data type
-  //
-  if (this->DoublePrecisionMesh != 0)
+  vtkSmartPointer<vtkPoints> points = cachedPoints;
+  if (!points)
   {
-    points->SetDataTypeToDouble();
-  }
-  //
-  // Resize vtkPoints to fit data
-  //
-  points->SetNumberOfPoints(nPts);
+    points = vtkSmartPointer<vtkPoints>::New();
 
-  //
-  // Populate the coordinates. Put in 3D points with z=0 if the mesh is 2D.
-  //
-  if (this->DoublePrecisionMesh != 0) // DOUBLE PRECISION MESHPOINTS
-  {
-    CGNSRead::get_XYZ_mesh<double, float>(this->cgioNum, gridChildId, nCoordsArray, cellDim, nPts,
-      srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points);
-  }
-  else // SINGLE PRECISION MESHPOINTS
-  {
-    CGNSRead::get_XYZ_mesh<float, double>(this->cgioNum, gridChildId, nCoordsArray, cellDim, nPts,
-      srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points);
+    //
+    // wacky hack ...
+    memEnd[0] *= 3; // for memory aliasing
+    //
+    // vtkPoints assumes float data type
+    //
+    if (this->DoublePrecisionMesh != 0)
+    {
+      points->SetDataTypeToDouble();
+    }
+    //
+    // Resize vtkPoints to fit data
+    //
+    points->SetNumberOfPoints(nPts);
+
+    //
+    // Populate the coordinates. Put in 3D points with z=0 if the mesh is 2D.
+    //
+    if (this->DoublePrecisionMesh != 0) // DOUBLE PRECISION MESHPOINTS
+    {
+      CGNSRead::get_XYZ_mesh<double, float>(this->cgioNum, gridChildId, nCoordsArray, cellDim,
+        nPts, srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points);
+    }
+    else // SINGLE PRECISION MESHPOINTS
+    {
+      CGNSRead::get_XYZ_mesh<float, double>(this->cgioNum, gridChildId, nCoordsArray, cellDim,
+        nPts, srcStart, srcEnd, srcStride, memStart, memEnd, memStride, memDims, points);
+    }
+
+    if (!meshKey.empty())
+    {
+      this->MeshCache->Points.Insert(meshKey, points, gridCoordName);
+    }
   }
 
   this->UpdateProgress(0.2);
@@ -1776,8 +1893,26 @@ int vtkCGNSReader::GetUnstructuredZone(
   vtkUnstructuredGrid* ugrid = vtkUnstructuredGrid::New();
   ugrid->SetPoints(points);
 
+  // The connectivity of a zone is the same for all timesteps.
+  std::string connectivityKey;
+  vtkUnstructuredGrid* cachedCells = nullptr;
+  if (this->CacheMesh)
+  {
+    connectivityKey = vtkPrivate::GetMeshCacheKey(base, zone, this);
+    cachedCells = this->MeshCache->Connectivities.Find(connectivityKey);
+  }
+
   //
-  if (hasNGon)
+  if (cachedCells)
+  {
+    ugrid->CopyStructure(cachedCells);
+    ugrid->SetPoints(points);
+    for (std::vector<int>::iterator iter = coreSec.begin(); iter != coreSec.end(); ++iter)
+    {
+      cgio_release_id(this->cgioNum, elemIdList[*iter]);
+    }
+  }
+  else if (hasNGon)
   {
     // READ NGON CONNECTIVITY
     //
@@ -2138,16 +2273,18 @@ int vtkCGNSReader::GetUnstructuredZone(
           srcStride, memStart, memEnd, memStride, memDim, localElements);
 
         // Add numptspercell and do -1 on indexes
-        for (vtkIdType icell = 0; icell < elementSize; ++icell)
-        {
-          vtkIdType pos = icell * (numPointsPerCell + 1);
-          localElements[pos] = static_cast<vtkIdType>(numPointsPerCell);
-          for (vtkIdType ip = 0; ip < numPointsPerCell; ++ip)
+        vtkSMPTools::For(0, elementSize, [&](vtkIdType cellBegin, vtkIdType cellEnd) {
+          for (vtkIdType icell = cellBegin; icell < cellEnd; ++icell)
           {
-            pos++;
-            localElements[pos] = localElements[pos] - 1;
+            vtkIdType pos = icell * (numPointsPerCell + 1);
+            localElements[pos] = static_cast<vtkIdType>(numPointsPerCell);
+            for (vtkIdType ip = 0; ip < numPointsPerCell; ++ip)
+            {
+              pos++;
+              localElements[pos] = localElements[pos] - 1;
+            }
           }
-        }
+        });
         if (reOrderElements == true)
         {
           CGNSRead::CGNS2VTKorderMonoElem(elementSize, cellType, localElements);
@@ -2223,6 +2360,14 @@ int vtkCGNSReader::GetUnstructuredZone(
 
     delete[] cellsTypes;
   }
+
+  if (!cachedCells && !connectivityKey.empty())
+  {
+    vtkNew<vtkUnstructuredGrid> cells;
+    cells->CopyStructure(ugrid);
+    cells->SetPoints(nullptr);
+    this->MeshCache->Connectivities.Insert(connectivityKey, cells.GetPointer());
+  }
   //
   const auto sil = this->GetSIL();
   const char* basename = this->Internal->GetBase(base).name;
@@ -2478,7 +2623,6 @@ int vtkCGNSReader::GetUnstructuredZone(
     mzone->GetMetaData((unsigned int)1)->Set(vtkCompositeDataSet::NAME(), "Patches");
   }
   //
-  points->Delete();
   if (bndSec.size() > 0 && requiredPatch)
   {
     mbase->SetBlock(zone, mzone);
@@ -2639,6 +2783,15 @@ int vtkCGNSReader::RequestData(vtkInformation* vtkNotUsed(request),
 
   vtkDebugMacro(<< "CGNSReader::RequestData: Reading from file <" << this->FileName << ">...");
 
+  if (this->CacheMesh)
+  {
+    this->MeshCache->Validate(this->FileName, this->DoublePrecisionMesh);
+  }
+  else
+  {
+    this->MeshCache->Clear();
+  }
+
   // Opening with cgio layer
   ier = cgio_open_file(this->FileName, CGIO_MODE_READ, 0, &(this->cgioNum));
   if (ier != CG_OK)
@@ -3010,6 +3163,7 @@ void vtkCGNSReader::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "CreateEachSolutionAsBlock: " << this->CreateEachSolutionAsBlock << endl;
   os << indent << "IgnoreFlowSolutionPointers: " << this->IgnoreFlowSolutionPointers << endl;
   os << indent << "DistributeBlocks: " << this->DistributeBlocks << endl;
+  os << indent << "CacheMesh: " << this->CacheMesh << endl;
   os << indent << "Controller: " << this->Controller << endl;
 }
 
@@ -209,6 +209,20 @@ public:
   vtkGetMacro(DistributeBlocks, bool);
   vtkBooleanMacro(DistributeBlocks, bool);
 
+  //@{
+  /**
+   * When set to true (default), the points of each zone and the connectivity
+   * of unstructured zones are kept after being read and reused for the
+   * following timesteps of the same file. There is one entry per zone, and
+   * the points are read again and replace it when the zone refers to
+   * another grid coordinates node. The cache is cleared when the file name,
+   * modification time or size, or DoublePrecisionMesh changes.
+   */
+  vtkSetMacro(CacheMesh, bool);
+  vtkGetMacro(CacheMesh, bool);
+  vtkBooleanMacro(CacheMesh, bool);
+  //@}
+
   //@{
   /**
    * Set/get the communication object used to relay a list of files
@@ -280,6 +294,7 @@ private:
   int CreateEachSolutionAsBlock; // debug option to create
   bool IgnoreFlowSolutionPointers;
   bool DistributeBlocks;
+  bool CacheMesh;
 
   // For internal cgio calls (low level IO)
   int cgioNum;      // cgio file reference
@@ -292,6 +307,9 @@ private:
   class vtkPrivate;
   friend class vtkPrivate;
 
+  class vtkMeshCache;
+  vtkMeshCache* MeshCache;
+
   /**
    * When reading a temporal file series, we don't want to rebuild the SIL for
    * each file since it doesn't change (or is not expected to change).
@@ -190,10 +190,12 @@ int get_section_connectivity(const int cgioNum, const double cgioSectionId, cons
         std::cerr << "cgio_read_data :" << message;
         return 1;
       }
-      for (cgsize_t n = 0; n < nn; n++)
-      {
-        localElements[n] = static_cast<vtkIdType>(data[n]);
-      }
+      vtkSMPTools::For(0, static_cast<vtkIdType>(nn), [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType n = begin; n < end; n++)
+        {
+          localElements[n] = static_cast<vtkIdType>(data[n]);
+        }
+      });
       delete[] data;
     }
     else if (sizeOfCnt == sizeof(cglong_t))
@@ -213,10 +215,12 @@ int get_section_connectivity(const int cgioNum, const double cgioSectionId, cons
         std::cerr << "cgio_read_data :" << message;
         return 1;
       }
-      for (cgsize_t n = 0; n < nn; n++)
-      {
-        localElements[n] = static_cast<vtkIdType>(data[n]);
-      }
+      vtkSMPTools::For(0, static_cast<vtkIdType>(nn), [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType n = begin; n < end; n++)
+        {
+          localElements[n] = static_cast<vtkIdType>(data[n]);
+        }
+      });
       delete[] data;
     }
   }
@@ -424,29 +428,30 @@ void CGNS2VTKorderMonoElem(const vtkIdType size, const int cell_type, vtkIdType*
 {
   const int maxPointsPerCells = 27;
 
-  int tmp[maxPointsPerCells];
   const int* translator;
   translator = getTranslator(cell_type);
-  if (translator == NULL)
+  if (translator == NULL || size <= 0)
   {
     return;
   }
 
-  vtkIdType pos = 0;
-  for (vtkIdType icell = 0; icell < size; ++icell)
-  {
-    vtkIdType numPointsPerCell = elements[pos];
-    pos++;
-    for (vtkIdType ip = 0; ip < numPointsPerCell; ++ip)
-    {
-      tmp[ip] = elements[translator[ip] + pos];
-    }
-    for (vtkIdType ip = 0; ip < numPointsPerCell; ++ip)
+  // All cells have the same size, so they can be reordered independently.
+  const vtkIdType numPointsPerCell = elements[0];
+  vtkSMPTools::For(0, size, [&](vtkIdType begin, vtkIdType end) {
+    vtkIdType tmp[maxPointsPerCells];
+    for (vtkIdType icell = begin; icell < end; ++icell)
     {
-      elements[pos + ip] = tmp[ip];
+      vtkIdType pos = icell * (numPointsPerCell + 1) + 1;
+      for (vtkIdType ip = 0; ip < numPointsPerCell; ++ip)
+      {
+        tmp[ip] = elements[translator[ip] + pos];
+      }
+      for (vtkIdType ip = 0; ip < numPointsPerCell; ++ip)
+      {
+        elements[pos + ip] = tmp[ip];
+      }
     }
-    pos += numPointsPerCell;
-  }
+  });
 }
 
 //------------------------------------------------------------------------------
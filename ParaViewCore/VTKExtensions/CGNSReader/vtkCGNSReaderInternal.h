@@ -40,6 +40,7 @@
 #include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtk_cgns.h"
 
 namespace CGNSRead
@@ -318,6 +319,46 @@ private:
   bool SkipSILUpdates;
 };
 
+//------------------------------------------------------------------------------
+/**
+ * Keeps data read for a timestep (mesh points, connectivity) so it can be
+ * reused by the following ones. There is one entry per key, which also
+ * records the node the data was read from. Looking an entry up for another
+ * node misses, and the data read instead replaces it.
+ */
+template <typename CacheDataType>
+class vtkCGNSCache
+{
+public:
+  /**
+   * return the data cached for the key if it was read from node, or nullptr.
+   */
+  CacheDataType* Find(const std::string& key, const std::string& node = std::string()) const
+  {
+    typename std::map<std::string, CacheEntry>::const_iterator iter = this->CacheMapping.find(key);
+    return iter != this->CacheMapping.end() && iter->second.Node == node
+      ? iter->second.Data.GetPointer()
+      : nullptr;
+  }
+
+  void Insert(const std::string& key, CacheDataType* data, const std::string& node = std::string())
+  {
+    CacheEntry& entry = this->CacheMapping[key];
+    entry.Node = node;
+    entry.Data = data;
+  }
+
+  void ClearCache() { this->CacheMapping.clear(); }
+
+private:
+  struct CacheEntry
+  {
+    std::string Node;
+    vtkSmartPointer<CacheDataType> Data;
+  };
+  std::map<std::string, CacheEntry> CacheMapping;
+};
+
 //------------------------------------------------------------------------------
 // compare name return true if name1 == name2
 inline bool compareName(const char_33 nameOne, const char_33 nameTwo)
@@ -493,10 +534,13 @@ int get_XYZ_mesh(const int cgioNum, const std::vector<double>& gridChildId,
         std::cerr << "Buffer array cgio_read_data :" << message;
         break;
       }
-      for (vtkIdType ii = 0; ii < nPts; ++ii)
-      {
-        currentCoord[memStride[0] * ii] = static_cast<T>(dataArray[ii]);
-      }
+      const cgsize_t stride = memStride[0];
+      vtkSMPTools::For(0, nPts, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType ii = begin; ii < end; ++ii)
+        {
+          currentCoord[stride * ii] = static_cast<T>(dataArray[ii]);
+        }
+      });
       delete[] dataArray;
     }
   }
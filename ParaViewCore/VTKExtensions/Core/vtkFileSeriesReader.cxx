@@ -50,6 +50,11 @@
 #include <string>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "vtk_jsoncpp.h"
 
 //=============================================================================
@@ -70,9 +75,16 @@ public:
 
 private:
   static vtkInformationIntegerKey* INDEX();
+  void UpdateAggregateTimeInfo();
   typedef std::map<double, vtkSmartPointer<vtkInformation> > RangeMapType;
   RangeMapType RangeMap;
   std::map<int, vtkSmartPointer<vtkInformation> > InputLookup;
+
+  // The aggregate time information is restored after every RequestData, keep
+  // it around instead of going through all the inputs each time.
+  bool AggregateTimeInfoValid = false;
+  double AggregateTimeRange[2];
+  std::vector<double> AggregateTimeSteps;
 };
 
 vtkInformationKeyMacro(vtkFileSeriesReaderTimeRanges, INDEX, Integer);
@@ -82,6 +94,7 @@ void vtkFileSeriesReaderTimeRanges::Reset()
 {
   this->RangeMap.clear();
   this->InputLookup.clear();
+  this->AggregateTimeInfoValid = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -120,6 +133,7 @@ void vtkFileSeriesReaderTimeRanges::AddTimeRange(int index, vtkInformation* srcI
   }
 
   this->RangeMap[info->Get(vtkStreamingDemandDrivenPipeline::TIME_RANGE())[0]] = info;
+  this->AggregateTimeInfoValid = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -131,26 +145,43 @@ int vtkFileSeriesReaderTimeRanges::GetAggregateTimeInfo(vtkInformation* outInfo)
     return 0;
   }
 
-  double timeRange[2];
-  timeRange[0] =
-    this->RangeMap.begin()->second->Get(vtkStreamingDemandDrivenPipeline::TIME_RANGE())[0];
-  timeRange[1] =
-    (--this->RangeMap.end())->second->Get(vtkStreamingDemandDrivenPipeline::TIME_RANGE())[1];
+  if (!this->AggregateTimeInfoValid)
+  {
+    this->UpdateAggregateTimeInfo();
+  }
 
   // Special case: if the time range is a single value, suppress it.  This is
   // most likely from a data set that is a single file with no time anyway.
   // Even if it is not, how much value added is there for a single time value?
-  if (timeRange[0] >= timeRange[1])
+  if (this->AggregateTimeRange[0] >= this->AggregateTimeRange[1])
   {
     outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_RANGE());
     outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
     return 1;
   }
 
-  outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(), timeRange, 2);
+  outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(), this->AggregateTimeRange, 2);
+  if (this->AggregateTimeSteps.size() > 0)
+  {
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(), &this->AggregateTimeSteps[0],
+      static_cast<int>(this->AggregateTimeSteps.size()));
+  }
+  else
+  {
+    outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+  }
+  return 1;
+}
 
-  std::vector<double> timeSteps;
+//-----------------------------------------------------------------------------
+void vtkFileSeriesReaderTimeRanges::UpdateAggregateTimeInfo()
+{
+  this->AggregateTimeRange[0] =
+    this->RangeMap.begin()->second->Get(vtkStreamingDemandDrivenPipeline::TIME_RANGE())[0];
+  this->AggregateTimeRange[1] =
+    (--this->RangeMap.end())->second->Get(vtkStreamingDemandDrivenPipeline::TIME_RANGE())[1];
 
+  this->AggregateTimeSteps.clear();
   RangeMapType::iterator itr = this->RangeMap.begin();
   while (itr != this->RangeMap.end())
   {
@@ -167,20 +198,10 @@ int vtkFileSeriesReaderTimeRanges::GetAggregateTimeInfo(vtkInformation* outInfo)
     // Third, copy the appropriate time steps to the aggregate time steps.
     for (int i = 0; (i < numLocalSteps) && (localTimeSteps[i] < localEndTime); i++)
     {
-      timeSteps.push_back(localTimeSteps[i]);
+      this->AggregateTimeSteps.push_back(localTimeSteps[i]);
     }
   }
-
-  if (timeSteps.size() > 0)
-  {
-    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(), &timeSteps[0],
-      static_cast<int>(timeSteps.size()));
-  }
-  else
-  {
-    outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
-  }
-  return 1;
+  this->AggregateTimeInfoValid = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -357,6 +378,24 @@ public:
 private:
   void operator=(const vtkRecordMTime&);
 };
+
+// Asks the system to load fname into the file system cache in the background,
+// without reading it in this process. Does nothing where posix_fadvise is not
+// available.
+void vtkFileSeriesReadAhead(const std::string& fname)
+{
+#if defined(POSIX_FADV_WILLNEED)
+  // a pipe would block an open without O_NONBLOCK until it has a writer.
+  int fd = open(fname.c_str(), O_RDONLY | O_NONBLOCK);
+  if (fd >= 0)
+  {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+  }
+#else
+  (void)fname;
+#endif
+}
 }
 
 //=============================================================================
@@ -367,6 +406,41 @@ struct vtkFileSeriesReaderInternals
   std::vector<double> TimeValues;
   bool FileNameIsSet;
   vtkFileSeriesReaderTimeRanges* TimeRanges;
+
+  // When caching the time information, the time information reported by the
+  // reader for each file, reused until the file changes on disk.
+  struct FileTimeInfo
+  {
+    long ModifiedTime;
+    unsigned long Length;
+    vtkSmartPointer<vtkInformation> Info;
+  };
+  std::map<std::string, FileTimeInfo> TimeInfoCache;
+  vtkIdType PreviousFileIndex;
+
+  bool FindTimeInfo(const std::string& fname, vtkInformation* outInfo)
+  {
+    std::map<std::string, FileTimeInfo>::iterator iter = this->TimeInfoCache.find(fname);
+    if (iter == this->TimeInfoCache.end() ||
+      iter->second.ModifiedTime != vtksys::SystemTools::ModifiedTime(fname) ||
+      iter->second.Length != vtksys::SystemTools::FileLength(fname))
+    {
+      return false;
+    }
+    outInfo->CopyEntry(iter->second.Info, vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+    outInfo->CopyEntry(iter->second.Info, vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+    return true;
+  }
+
+  void StoreTimeInfo(const std::string& fname, vtkInformation* outInfo)
+  {
+    FileTimeInfo& entry = this->TimeInfoCache[fname];
+    entry.ModifiedTime = vtksys::SystemTools::ModifiedTime(fname);
+    entry.Length = vtksys::SystemTools::FileLength(fname);
+    entry.Info = vtkSmartPointer<vtkInformation>::New();
+    entry.Info->CopyEntry(outInfo, vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+    entry.Info->CopyEntry(outInfo, vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+  }
 };
 
 //=============================================================================
@@ -378,11 +452,14 @@ vtkFileSeriesReader::vtkFileSeriesReader()
   this->Internal = new vtkFileSeriesReaderInternals;
   this->Internal->FileNameIsSet = false;
   this->Internal->TimeRanges = new vtkFileSeriesReaderTimeRanges;
+  this->Internal->PreviousFileIndex = 0;
 
   this->UseMetaFile = 0;
   this->UseJsonMetaFile = false;
 
   this->IgnoreReaderTime = false;
+  this->CacheTimeInformation = false;
+  this->ReadAhead = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -484,6 +561,13 @@ int vtkFileSeriesReader::ProcessRequest(
 
   if (this->Reader)
   {
+    // FileNameMTime is the MTime of the reader after our last pass, anything
+    // else modified the reader and may change the time information it reports.
+    if (this->Reader->GetMTime() != this->FileNameMTime)
+    {
+      this->Internal->TimeInfoCache.clear();
+    }
+
     // We want to suppress the modification time change in the Reader.  See
     // vtkFileSeriesReader::GetMTime() for details on how this works.
     this->BeforeFileNameMTime = this->GetMTime();
@@ -603,7 +687,15 @@ int vtkFileSeriesReader::RequestInformation(vtkInformation* request,
     // Query all the other files for time info.
     for (unsigned int i = 1; i < numFiles; i++)
     {
-      this->RequestInformationForInput(static_cast<int>(i), request, outputVector);
+      if (!this->CacheTimeInformation ||
+        !this->Internal->FindTimeInfo(this->GetFileName(i), outInfo))
+      {
+        this->RequestInformationForInput(static_cast<int>(i), request, outputVector);
+        if (this->CacheTimeInformation)
+        {
+          this->Internal->StoreTimeInfo(this->GetFileName(i), outInfo);
+        }
+      }
       this->Internal->TimeRanges->AddTimeRange(static_cast<int>(i), outInfo);
     }
   }
@@ -682,6 +774,19 @@ int vtkFileSeriesReader::RequestData(
     this->Internal->TimeRanges->GetAggregateTimeInfo(outInfo);
   }
 
+  if (this->ReadAhead)
+  {
+    // read ahead the next file in the direction the time steps are requested.
+    const vtkIdType numFiles = static_cast<vtkIdType>(this->GetNumberOfFileNames());
+    const vtkIdType next =
+      this->_FileIndex + (this->_FileIndex < this->Internal->PreviousFileIndex ? -1 : 1);
+    this->Internal->PreviousFileIndex = this->_FileIndex;
+    if (next >= 0 && next < numFiles)
+    {
+      vtkFileSeriesReadAhead(this->GetFileName(static_cast<unsigned int>(next)));
+    }
+  }
+
   return retVal;
 }
 
@@ -932,6 +1037,8 @@ void vtkFileSeriesReader::PrintSelf(ostream& os, vtkIndent indent)
      << endl;
   os << indent << "UseMetaFile: " << this->UseMetaFile << endl;
   os << indent << "IgnoreReaderTime: " << this->IgnoreReaderTime << endl;
+  os << indent << "CacheTimeInformation: " << this->CacheTimeInformation << endl;
+  os << indent << "ReadAhead: " << this->ReadAhead << endl;
 }
 
 //-----------------------------------------------------------------------------
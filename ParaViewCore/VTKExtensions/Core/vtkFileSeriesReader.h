@@ -151,6 +151,34 @@ public:
   vtkBooleanMacro(IgnoreReaderTime, bool);
   //@}
 
+  //@{
+  /**
+   * If true, the time information reported by the reader for each file is
+   * kept and reused until the file changes on disk or the internal reader is
+   * modified, instead of asking the reader for the time information of every
+   * file each time the pipeline information is updated. False by default.
+   */
+  vtkGetMacro(CacheTimeInformation, bool);
+  vtkSetMacro(CacheTimeInformation, bool);
+  vtkBooleanMacro(CacheTimeInformation, bool);
+  //@}
+
+  //@{
+  /**
+   * If true, once a file is read, the system is asked to load the next file,
+   * in the direction the time steps are requested, into the file system cache
+   * in the background with posix_fadvise(). This helps downstream filters
+   * that request many time steps one after the other, e.g. temporal
+   * statistics. No process reads the file itself, so running on many
+   * processes does not read it many times. Only the file named in the series
+   * is read ahead, not the pieces it references. Ignored where posix_fadvise()
+   * is not available. False by default.
+   */
+  vtkGetMacro(ReadAhead, bool);
+  vtkSetMacro(ReadAhead, bool);
+  vtkBooleanMacro(ReadAhead, bool);
+  //@}
+
 protected:
   vtkFileSeriesReader();
   ~vtkFileSeriesReader() override;
@@ -213,6 +241,8 @@ protected:
   void AddFileNameInternal(const char*);
 
   bool IgnoreReaderTime;
+  bool CacheTimeInformation;
+  bool ReadAhead;
 
   int ChooseInput(vtkInformation*);
 
@@ -14,6 +14,7 @@ PURPOSE.  See the above copyright notice for more information.
 =========================================================================*/
 #include "vtkPVPostFilter.h"
 
+#include "vtkAOSDataArrayTemplate.h"
 #include "vtkArrayIteratorIncludes.h"
 #include "vtkCellData.h"
 #include "vtkCellDataToPointData.h"
@@ -25,15 +26,26 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkDataObjectTypes.h"
 #include "vtkDataSet.h"
 #include "vtkDoubleArray.h"
+#include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationStringVectorKey.h"
 #include "vtkInformationVector.h"
+#include "vtkMappedDataArray.h"
+#include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVPostFilterExecutive.h"
 #include "vtkPointData.h"
 #include "vtkPointDataToCellData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkVariant.h"
+#include "vtkVariantCast.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
@@ -117,8 +129,643 @@ void DeMangleArrayName(const std::string& mangledName, vtkDataSet* dataSet,
   demangledName = mangledName;
   demangledComponentName = std::string();
 }
+
+//----------------------------------------------------------------------------
+// Read-only single component array which computes a component or the
+// magnitude (component -1) of the tuples of a source data array on access.
+template <class Scalar>
+class vtkPVPostFilterComponentArray : public vtkMappedDataArray<Scalar>
+{
+public:
+  vtkAbstractTemplateTypeMacro(vtkPVPostFilterComponentArray<Scalar>, vtkMappedDataArray<Scalar>)
+  vtkMappedDataArrayNewInstanceMacro(vtkPVPostFilterComponentArray<Scalar>)
+  static vtkPVPostFilterComponentArray* New();
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  typedef typename Superclass::ValueType ValueType;
+
+  void SetSourceArray(vtkDataArray* source, int component);
+
+  vtkMTimeType GetMTime() override;
+  void Initialize() override;
+  void GetTuples(vtkIdList* ptIds, vtkAbstractArray* output) override;
+  void GetTuples(vtkIdType p1, vtkIdType p2, vtkAbstractArray* output) override;
+  void Squeeze() override {}
+  void* GetVoidPointer(vtkIdType id) override;
+  void ExportToVoidPointer(void* ptr) override;
+  vtkArrayIterator* NewIterator() override;
+  vtkIdType LookupValue(vtkVariant value) override;
+  void LookupValue(vtkVariant value, vtkIdList* ids) override;
+  vtkVariant GetVariantValue(vtkIdType idx) override;
+  void ClearLookup() override {}
+  double* GetTuple(vtkIdType i) override;
+  void GetTuple(vtkIdType i, double* tuple) override;
+  vtkIdType LookupTypedValue(Scalar value) override;
+  void LookupTypedValue(Scalar value, vtkIdList* ids) override;
+  ValueType GetValue(vtkIdType idx) const override;
+  Scalar& GetValueReference(vtkIdType idx) override;
+  void GetTypedTuple(vtkIdType idx, Scalar* t) const override;
+
+  // This container is read only, the following methods only report an error.
+  int Allocate(vtkIdType, vtkIdType) override { return this->ReadOnly(0); }
+  int Resize(vtkIdType) override { return this->ReadOnly(0); }
+  void SetNumberOfTuples(vtkIdType) override { this->ReadOnly(); }
+  void SetTuple(vtkIdType, vtkIdType, vtkAbstractArray*) override { this->ReadOnly(); }
+  void SetTuple(vtkIdType, const float*) override { this->ReadOnly(); }
+  void SetTuple(vtkIdType, const double*) override { this->ReadOnly(); }
+  void InsertTuple(vtkIdType, vtkIdType, vtkAbstractArray*) override { this->ReadOnly(); }
+  void InsertTuple(vtkIdType, const float*) override { this->ReadOnly(); }
+  void InsertTuple(vtkIdType, const double*) override { this->ReadOnly(); }
+  void InsertTuples(vtkIdList*, vtkIdList*, vtkAbstractArray*) override { this->ReadOnly(); }
+  void InsertTuples(vtkIdType, vtkIdType, vtkIdType, vtkAbstractArray*) override
+  {
+    this->ReadOnly();
+  }
+  vtkIdType InsertNextTuple(vtkIdType, vtkAbstractArray*) override { return this->ReadOnly(-1); }
+  vtkIdType InsertNextTuple(const float*) override { return this->ReadOnly(-1); }
+  vtkIdType InsertNextTuple(const double*) override { return this->ReadOnly(-1); }
+  void DeepCopy(vtkAbstractArray*) override { this->ReadOnly(); }
+  void DeepCopy(vtkDataArray*) override { this->ReadOnly(); }
+  void InterpolateTuple(vtkIdType, vtkIdList*, vtkAbstractArray*, double*) override
+  {
+    this->ReadOnly();
+  }
+  void InterpolateTuple(
+    vtkIdType, vtkIdType, vtkAbstractArray*, vtkIdType, vtkAbstractArray*, double) override
+  {
+    this->ReadOnly();
+  }
+  void SetVariantValue(vtkIdType, vtkVariant) override { this->ReadOnly(); }
+  void InsertVariantValue(vtkIdType, vtkVariant) override { this->ReadOnly(); }
+  void RemoveTuple(vtkIdType) override { this->ReadOnly(); }
+  void RemoveFirstTuple() override { this->ReadOnly(); }
+  void RemoveLastTuple() override { this->ReadOnly(); }
+  void SetTypedTuple(vtkIdType, const Scalar*) override { this->ReadOnly(); }
+  void InsertTypedTuple(vtkIdType, const Scalar*) override { this->ReadOnly(); }
+  vtkIdType InsertNextTypedTuple(const Scalar*) override { return this->ReadOnly(-1); }
+  void SetValue(vtkIdType, Scalar) override { this->ReadOnly(); }
+  vtkIdType InsertNextValue(Scalar) override { return this->ReadOnly(-1); }
+  void InsertValue(vtkIdType, Scalar) override { this->ReadOnly(); }
+
+protected:
+  vtkPVPostFilterComponentArray();
+  ~vtkPVPostFilterComponentArray() override {}
+
+  // Ranges are computed in parallel directly from the source array.
+  bool ComputeScalarRange(double* ranges) override;
+  bool ComputeVectorRange(double range[2]) override;
+
+  vtkSmartPointer<vtkDataArray> Source;
+  int Component;
+
+  // Values of the source when it is a contiguous array.
+  const Scalar* Data;
+
+  // Contiguous copy of the computed values for the callers that need raw
+  // memory, computed once per modification of the view or of its source.
+  vtkSmartPointer<vtkAOSDataArrayTemplate<Scalar> > Values;
+  vtkTimeStamp ValuesTime;
+
+private:
+  vtkPVPostFilterComponentArray(const vtkPVPostFilterComponentArray&) = delete;
+  void operator=(const vtkPVPostFilterComponentArray&) = delete;
+
+  template <class T>
+  T ReadOnly(T result = T())
+  {
+    vtkErrorMacro("Read only container.");
+    return result;
+  }
+  void ReadOnly() { vtkErrorMacro("Read only container."); }
+
+  Scalar Compute(vtkIdType tupleId) const;
+  vtkAOSDataArrayTemplate<Scalar>* GetValues();
+  vtkIdType Lookup(Scalar value, vtkIdType startIndex);
+  bool ComputeRanges(double ranges[4]);
+
+  Scalar TempValue;
+  double TempDouble;
+};
+
+//----------------------------------------------------------------------------
+// Computes the range and the range of the absolute values of a component or
+// of the magnitude of an array. When data is null the values are read
+// through the vtkDataArray API.
+template <class T>
+class vtkPVPostFilterRangeFunctor
+{
+public:
+  vtkPVPostFilterRangeFunctor(const T* data, vtkDataArray* array, int component)
+    : Data(data)
+    , Array(array)
+    , NumberOfComponents(array->GetNumberOfComponents())
+    , Component(component)
+  {
+  }
+
+  void Initialize()
+  {
+    double* ranges = this->Ranges.Local().Values;
+    ranges[0] = ranges[2] = VTK_DOUBLE_MAX;
+    ranges[1] = ranges[3] = -VTK_DOUBLE_MAX;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double* ranges = this->Ranges.Local().Values;
+    for (vtkIdType tupleId = begin; tupleId < end; ++tupleId)
+    {
+      const double value = this->Value(tupleId);
+      if (vtkMath::IsNan(value))
+      {
+        continue;
+      }
+      const double absValue = std::abs(value);
+      ranges[0] = std::min(ranges[0], value);
+      ranges[1] = std::max(ranges[1], value);
+      ranges[2] = std::min(ranges[2], absValue);
+      ranges[3] = std::max(ranges[3], absValue);
+    }
+  }
+
+  void Reduce()
+  {
+    this->Result[0] = this->Result[2] = VTK_DOUBLE_MAX;
+    this->Result[1] = this->Result[3] = -VTK_DOUBLE_MAX;
+    for (typename vtkSMPThreadLocal<Range>::iterator iter = this->Ranges.begin();
+         iter != this->Ranges.end(); ++iter)
+    {
+      for (int cc = 0; cc < 4; cc += 2)
+      {
+        this->Result[cc] = std::min(this->Result[cc], iter->Values[cc]);
+        this->Result[cc + 1] = std::max(this->Result[cc + 1], iter->Values[cc + 1]);
+      }
+    }
+  }
+
+  double Result[4];
+
+private:
+  struct Range
+  {
+    double Values[4];
+  };
+
+  double Value(vtkIdType tupleId) const
+  {
+    if (this->Data)
+    {
+      const T* tuple = this->Data + tupleId * this->NumberOfComponents;
+      if (this->Component >= 0)
+      {
+        return static_cast<double>(tuple[this->Component]);
+      }
+      double mag = 0.0;
+      for (int comp = 0; comp < this->NumberOfComponents; ++comp)
+      {
+        mag += static_cast<double>(tuple[comp]) * static_cast<double>(tuple[comp]);
+      }
+      return std::sqrt(mag);
+    }
+
+    if (this->Component >= 0)
+    {
+      return this->Array->GetComponent(tupleId, this->Component);
+    }
+    double mag = 0.0;
+    for (int comp = 0; comp < this->NumberOfComponents; ++comp)
+    {
+      const double value = this->Array->GetComponent(tupleId, comp);
+      mag += value * value;
+    }
+    return std::sqrt(mag);
+  }
+
+  const T* Data;
+  vtkDataArray* Array;
+  int NumberOfComponents;
+  int Component;
+  vtkSMPThreadLocal<Range> Ranges;
+};
+
+template <class T>
+void vtkPVPostFilterComputeRanges(const T* data, vtkDataArray* array, int component, double* result)
+{
+  vtkPVPostFilterRangeFunctor<T> functor(data, array, component);
+  vtkSMPTools::For(0, array->GetNumberOfTuples(), functor);
+  std::copy(functor.Result, functor.Result + 4, result);
+}
+
+//----------------------------------------------------------------------------
+// Can't use vtkStandardNewMacro with a template.
+template <class Scalar>
+vtkPVPostFilterComponentArray<Scalar>* vtkPVPostFilterComponentArray<Scalar>::New()
+{
+  VTK_STANDARD_NEW_BODY(vtkPVPostFilterComponentArray<Scalar>)
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkPVPostFilterComponentArray<Scalar>::vtkPVPostFilterComponentArray()
+  : Component(0)
+  , Data(nullptr)
+  , TempValue(0)
+  , TempDouble(0.0)
+{
+  this->NumberOfComponents = 1;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->vtkPVPostFilterComponentArray<Scalar>::Superclass::PrintSelf(os, indent);
+  os << indent << "Source: " << this->Source.GetPointer() << endl;
+  os << indent << "Component: " << this->Component << endl;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::SetSourceArray(vtkDataArray* source, int component)
+{
+  this->Source = source;
+  this->Component = component;
+  this->Data = nullptr;
+  // Component arrays are created with the value type of their source.
+  if (component >= 0 && source->HasStandardMemoryLayout())
+  {
+    this->Data = static_cast<const Scalar*>(source->GetVoidPointer(0));
+  }
+  this->NumberOfComponents = 1;
+  this->Size = source->GetNumberOfTuples();
+  this->MaxId = this->Size - 1;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkMTimeType vtkPVPostFilterComponentArray<Scalar>::GetMTime()
+{
+  vtkMTimeType mtime = this->Superclass::GetMTime();
+  if (this->Source && this->Source->GetMTime() > mtime)
+  {
+    mtime = this->Source->GetMTime();
+  }
+  return mtime;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::Initialize()
+{
+  this->Source = nullptr;
+  this->Data = nullptr;
+  this->Values = nullptr;
+  this->MaxId = -1;
+  this->Size = 0;
+  this->NumberOfComponents = 1;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+Scalar vtkPVPostFilterComponentArray<Scalar>::Compute(vtkIdType tupleId) const
+{
+  if (this->Data)
+  {
+    return this->Data[tupleId * this->Source->GetNumberOfComponents() + this->Component];
+  }
+  if (this->Component >= 0)
+  {
+    return static_cast<Scalar>(this->Source->GetComponent(tupleId, this->Component));
+  }
+  const int numComps = this->Source->GetNumberOfComponents();
+  double mag = 0.0;
+  for (int comp = 0; comp < numComps; ++comp)
+  {
+    const double value = this->Source->GetComponent(tupleId, comp);
+    mag += value * value;
+  }
+  return static_cast<Scalar>(std::sqrt(mag));
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::GetTuples(vtkIdList* ptIds, vtkAbstractArray* output)
+{
+  vtkDataArray* outArray = vtkDataArray::FastDownCast(output);
+  if (!outArray)
+  {
+    vtkWarningMacro(<< "Input is not a vtkDataArray");
+    return;
+  }
+
+  const vtkIdType numTuples = ptIds->GetNumberOfIds();
+  outArray->SetNumberOfComponents(1);
+  outArray->SetNumberOfTuples(numTuples);
+  for (vtkIdType i = 0; i < numTuples; ++i)
+  {
+    outArray->SetComponent(i, 0, static_cast<double>(this->Compute(ptIds->GetId(i))));
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::GetTuples(
+  vtkIdType p1, vtkIdType p2, vtkAbstractArray* output)
+{
+  vtkDataArray* outArray = vtkDataArray::FastDownCast(output);
+  if (!outArray)
+  {
+    vtkErrorMacro(<< "Input is not a vtkDataArray");
+    return;
+  }
+
+  if (outArray->GetNumberOfComponents() != 1)
+  {
+    vtkErrorMacro(<< "Incorrect number of components in input array.");
+    return;
+  }
+
+  for (vtkIdType outId = 0; p1 <= p2; ++p1)
+  {
+    outArray->SetComponent(outId++, 0, static_cast<double>(this->Compute(p1)));
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkAOSDataArrayTemplate<Scalar>* vtkPVPostFilterComponentArray<Scalar>::GetValues()
+{
+  if (!this->Values || this->ValuesTime.GetMTime() < this->GetMTime())
+  {
+    // A new array is allocated so that the iterators and pointers handed out
+    // before keep the values they were given.
+    this->Values = vtkSmartPointer<vtkAOSDataArrayTemplate<Scalar> >::New();
+    this->Values->SetNumberOfTuples(this->GetNumberOfTuples());
+    this->ExportToVoidPointer(this->Values->GetPointer(0));
+    this->ValuesTime.Modified();
+  }
+  return this->Values;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void* vtkPVPostFilterComponentArray<Scalar>::GetVoidPointer(vtkIdType id)
+{
+  // Unlike vtkMappedDataArray, the copy is kept until the values change and
+  // the array is not marked modified, so filters asking for raw memory
+  // repeatedly only pay for it once.
+  return this->GetValues()->GetVoidPointer(id);
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::ExportToVoidPointer(void* ptr)
+{
+  Scalar* values = static_cast<Scalar*>(ptr);
+  if (this->Values && this->ValuesTime.GetMTime() >= this->GetMTime())
+  {
+    const Scalar* copy = this->Values->GetPointer(0);
+    std::copy(copy, copy + this->Values->GetNumberOfValues(), values);
+    return;
+  }
+  const vtkIdType numTuples = this->GetNumberOfTuples();
+  for (vtkIdType cc = 0; cc < numTuples; ++cc)
+  {
+    values[cc] = this->Compute(cc);
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkArrayIterator* vtkPVPostFilterComponentArray<Scalar>::NewIterator()
+{
+  // vtkArrayIteratorTemplate only walks contiguous memory, so it is given the
+  // copy of the computed values.
+  vtkArrayIteratorTemplate<Scalar>* iter = vtkArrayIteratorTemplate<Scalar>::New();
+  iter->Initialize(this->GetValues());
+  return iter;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkIdType vtkPVPostFilterComponentArray<Scalar>::LookupValue(vtkVariant value)
+{
+  bool valid = true;
+  Scalar val = vtkVariantCast<Scalar>(value, &valid);
+  return valid ? this->Lookup(val, 0) : -1;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::LookupValue(vtkVariant value, vtkIdList* ids)
+{
+  bool valid = true;
+  Scalar val = vtkVariantCast<Scalar>(value, &valid);
+  ids->Reset();
+  if (valid)
+  {
+    this->LookupTypedValue(val, ids);
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkVariant vtkPVPostFilterComponentArray<Scalar>::GetVariantValue(vtkIdType idx)
+{
+  return vtkVariant(this->Compute(idx));
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+double* vtkPVPostFilterComponentArray<Scalar>::GetTuple(vtkIdType i)
+{
+  this->TempDouble = static_cast<double>(this->Compute(i));
+  return &this->TempDouble;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::GetTuple(vtkIdType i, double* tuple)
+{
+  tuple[0] = static_cast<double>(this->Compute(i));
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkIdType vtkPVPostFilterComponentArray<Scalar>::LookupTypedValue(Scalar value)
+{
+  return this->Lookup(value, 0);
 }
 
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::LookupTypedValue(Scalar value, vtkIdList* ids)
+{
+  ids->Reset();
+  vtkIdType index = 0;
+  while ((index = this->Lookup(value, index)) >= 0)
+  {
+    ids->InsertNextId(index++);
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+typename vtkPVPostFilterComponentArray<Scalar>::ValueType
+vtkPVPostFilterComponentArray<Scalar>::GetValue(vtkIdType idx) const
+{
+  return this->Compute(idx);
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+Scalar& vtkPVPostFilterComponentArray<Scalar>::GetValueReference(vtkIdType idx)
+{
+  this->TempValue = this->Compute(idx);
+  return this->TempValue;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+void vtkPVPostFilterComponentArray<Scalar>::GetTypedTuple(vtkIdType idx, Scalar* t) const
+{
+  t[0] = this->Compute(idx);
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+vtkIdType vtkPVPostFilterComponentArray<Scalar>::Lookup(Scalar value, vtkIdType index)
+{
+  for (; index <= this->MaxId; ++index)
+  {
+    if (this->Compute(index) == value)
+    {
+      return index;
+    }
+  }
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+bool vtkPVPostFilterComponentArray<Scalar>::ComputeRanges(double ranges[4])
+{
+  if (!this->Source || this->Source->GetNumberOfTuples() == 0)
+  {
+    return false;
+  }
+
+  const void* data =
+    this->Source->HasStandardMemoryLayout() ? this->Source->GetVoidPointer(0) : nullptr;
+  switch (this->Source->GetDataType())
+  {
+    vtkTemplateMacro(vtkPVPostFilterComputeRanges(
+      static_cast<const VTK_TT*>(data), this->Source.GetPointer(), this->Component, ranges));
+    default:
+      vtkPVPostFilterComputeRanges(
+        static_cast<const double*>(nullptr), this->Source.GetPointer(), this->Component, ranges);
+  }
+  return ranges[0] <= ranges[1];
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+bool vtkPVPostFilterComponentArray<Scalar>::ComputeScalarRange(double* ranges)
+{
+  double result[4];
+  if (!this->ComputeRanges(result))
+  {
+    return false;
+  }
+  ranges[0] = result[0];
+  ranges[1] = result[1];
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <class Scalar>
+bool vtkPVPostFilterComponentArray<Scalar>::ComputeVectorRange(double range[2])
+{
+  double result[4];
+  if (!this->ComputeRanges(result))
+  {
+    return false;
+  }
+  range[0] = result[2];
+  range[1] = result[3];
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+vtkDataArray* NewComponentArray(T*, vtkDataArray* source, int component)
+{
+  vtkPVPostFilterComponentArray<T>* array = vtkPVPostFilterComponentArray<T>::New();
+  array->SetSourceArray(source, component);
+  return array;
+}
+}
+
+//----------------------------------------------------------------------------
+// Arrays interpolated between points and cells, keyed by the array they
+// were interpolated from. Entries are valid as long as the input of the
+// filter and the source array are not modified.
+class vtkPVPostFilter::vtkConversionCache
+{
+public:
+  vtkConversionCache()
+    : InputMTime(0)
+  {
+  }
+
+  void Validate(vtkMTimeType inputMTime)
+  {
+    if (inputMTime != this->InputMTime)
+    {
+      this->Entries.clear();
+      this->InputMTime = inputMTime;
+    }
+  }
+
+  vtkAbstractArray* Find(vtkAbstractArray* source)
+  {
+    std::map<vtkAbstractArray*, Entry>::iterator iter = this->Entries.find(source);
+    if (iter == this->Entries.end())
+    {
+      return NULL;
+    }
+    if (iter->second.SourceMTime != source->GetMTime())
+    {
+      this->Entries.erase(iter);
+      return NULL;
+    }
+    return iter->second.Result;
+  }
+
+  void Insert(vtkAbstractArray* source, vtkAbstractArray* result)
+  {
+    if (source && result)
+    {
+      Entry& entry = this->Entries[source];
+      entry.Source = source;
+      entry.SourceMTime = source->GetMTime();
+      entry.Result = result;
+    }
+  }
+
+private:
+  struct Entry
+  {
+    // Keeps the source alive so that its address is not reused.
+    vtkSmartPointer<vtkAbstractArray> Source;
+    vtkMTimeType SourceMTime;
+    vtkSmartPointer<vtkAbstractArray> Result;
+  };
+  std::map<vtkAbstractArray*, Entry> Entries;
+  vtkMTimeType InputMTime;
+};
+
 vtkStandardNewMacro(vtkPVPostFilter);
 //----------------------------------------------------------------------------
 vtkPVPostFilter::vtkPVPostFilter()
@@ -129,11 +776,14 @@ vtkPVPostFilter::vtkPVPostFilter()
 
   this->SetNumberOfInputPorts(1);
   this->SetNumberOfOutputPorts(1);
+
+  this->ConversionCache = new vtkConversionCache();
 }
 
 //----------------------------------------------------------------------------
 vtkPVPostFilter::~vtkPVPostFilter()
 {
+  delete this->ConversionCache;
 }
 
 //----------------------------------------------------------------------------
@@ -243,6 +893,7 @@ int vtkPVPostFilter::RequestData(
     }
     if (this->Information->Has(vtkPVPostFilterExecutive::POST_ARRAYS_TO_PROCESS()))
     {
+      this->ConversionCache->Validate(input->GetMTime());
       this->DoAnyNeededConversions(output);
     }
   }
@@ -381,6 +1032,13 @@ int vtkPVPostFilter::DoAnyNeededConversions(vtkDataSet* output, const char* requ
 //----------------------------------------------------------------------------
 void vtkPVPostFilter::CellDataToPointData(vtkDataSet* output, const char* name)
 {
+  vtkAbstractArray* source = output->GetCellData()->GetAbstractArray(name);
+  if (vtkAbstractArray* cached = this->ConversionCache->Find(source))
+  {
+    output->GetPointData()->AddArray(cached);
+    return;
+  }
+
   vtkDataObject* clone = output->NewInstance();
   clone->ShallowCopy(output);
 
@@ -393,11 +1051,20 @@ void vtkPVPostFilter::CellDataToPointData(vtkDataSet* output, const char* name)
   output->ShallowCopy(converter->GetOutputDataObject(0));
   converter->Delete();
   clone->Delete();
+
+  this->ConversionCache->Insert(source, output->GetPointData()->GetAbstractArray(name));
 }
 
 //----------------------------------------------------------------------------
 void vtkPVPostFilter::PointDataToCellData(vtkDataSet* output, const char* name)
 {
+  vtkAbstractArray* source = output->GetPointData()->GetAbstractArray(name);
+  if (vtkAbstractArray* cached = this->ConversionCache->Find(source))
+  {
+    output->GetCellData()->AddArray(cached);
+    return;
+  }
+
   vtkDataObject* clone = output->NewInstance();
   clone->ShallowCopy(output);
 
@@ -410,6 +1077,8 @@ void vtkPVPostFilter::PointDataToCellData(vtkDataSet* output, const char* name)
   output->ShallowCopy(converter->GetOutputDataObject(0));
   converter->Delete();
   clone->Delete();
+
+  this->ConversionCache->Insert(source, output->GetCellData()->GetAbstractArray(name));
 }
 
 //----------------------------------------------------------------------------
@@ -513,10 +1182,44 @@ int vtkPVPostFilter::ExtractComponent(vtkDataSetAttributes* dsa, const char* req
     cIndex = atoi(demangled_component_name);
   }
 
+  if (cIndex < -1 || cIndex >= numComps)
+  {
+    vtkWarningMacro("Invalid component " << demangled_component_name << " for array "
+                                         << demangled_name << ".");
+    return 0;
+  }
+
+  bool isMagnitude = (cIndex == -1);
+  vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array);
+  if (dataArray)
+  {
+    // Data arrays get a read-only view computing the component or the
+    // magnitude when accessed instead of a copy.
+    vtkDataArray* view = NULL;
+    if (isMagnitude)
+    {
+      view = ::NewComponentArray(static_cast<double*>(NULL), dataArray, cIndex);
+    }
+    else
+    {
+      switch (dataArray->GetDataType())
+      {
+        vtkTemplateMacro(
+          view = ::NewComponentArray(static_cast<VTK_TT*>(NULL), dataArray, cIndex));
+      }
+    }
+    if (view)
+    {
+      view->SetName(requested_name);
+      dsa->AddArray(view);
+      view->FastDelete();
+      return 1;
+    }
+  }
+
   // when we compute the magnitude we must place
   // the result in a double array, since we don't the size of the
   // resulting data.
-  bool isMagnitude = (cIndex == -1);
   vtkAbstractArray* newArray = isMagnitude ? vtkDoubleArray::New() : array->NewInstance();
 
   newArray->SetNumberOfComponents(1);
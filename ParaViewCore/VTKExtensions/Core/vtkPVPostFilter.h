@@ -23,6 +23,11 @@
  *
  *  Interpolate cell centered data to point data, and the inverse if needed
  * by the filter.
+ *
+ * Components and magnitudes of data arrays are not copied, they are added as
+ * read-only arrays that compute their values from the original array when
+ * accessed. The arrays interpolated between cells and points are kept and
+ * reused until the input is modified.
 */
 
 #ifndef vtkPVPostFilter_h
@@ -69,6 +74,9 @@ protected:
 private:
   vtkPVPostFilter(const vtkPVPostFilter&) = delete;
   void operator=(const vtkPVPostFilter&) = delete;
+
+  class vtkConversionCache;
+  vtkConversionCache* ConversionCache;
 };
 
 #endif
@@ -29,10 +29,15 @@
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+#include <algorithm>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
+#include "vtk_jsoncpp.h"
+
 namespace
 {
 bool vtkIsEmpty(vtkDataObject* dobj)
@@ -46,6 +51,65 @@ bool vtkIsEmpty(vtkDataObject* dobj)
   }
   return true;
 }
+
+// Replaces the extension of fname with suffix.
+std::string vtkReplaceExtension(const std::string& fname, const std::string& suffix)
+{
+  std::string path = vtksys::SystemTools::GetFilenamePath(fname);
+  if (!path.empty())
+  {
+    path += "/";
+  }
+  return path + vtksys::SystemTools::GetFilenameWithoutLastExtension(fname) + suffix;
+}
+
+// Pieces are named <name>.part<piece>of<numPieces>.<ext>. The only number
+// the file dialog may take as a file series index is numPieces, with the
+// piece in the name of the series, so the pieces are not grouped together as
+// a time series. The time steps of a piece still are.
+std::string vtkPieceFileName(const std::string& fname, int piece, int numPieces)
+{
+  std::ostringstream suffix;
+  suffix << ".part" << piece << "of" << numPieces
+         << vtksys::SystemTools::GetFilenameLastExtension(fname);
+  return vtkReplaceExtension(fname, suffix.str());
+}
+
+// Writes the JSON index of the pieces of fname, written[rank] is non-zero for
+// the first rank of the groups that wrote their piece.
+bool vtkWritePieceIndex(const std::string& fname, const std::vector<int>& written, int groupSize)
+{
+  const int numProcs = static_cast<int>(written.size());
+  const int numGroups = (numProcs + groupSize - 1) / groupSize;
+  Json::Value pieces(Json::arrayValue);
+  for (int rank = 0; rank < numProcs; rank += groupSize)
+  {
+    if (written[rank])
+    {
+      Json::Value piece;
+      piece["name"] = vtksys::SystemTools::GetFilenameName(
+        vtkPieceFileName(fname, rank / groupSize, numGroups));
+      piece["first-rank"] = rank;
+      piece["number-of-ranks"] = std::min(groupSize, numProcs - rank);
+      pieces.append(piece);
+    }
+  }
+  Json::Value root;
+  root["file-pieces-version"] = "1.0";
+  root["pieces"] = pieces;
+
+  ofstream index(vtkReplaceExtension(fname, ".pieces.json").c_str());
+  if (!index)
+  {
+    return false;
+  }
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+  writer->write(root, &index);
+  index << endl;
+  return index.good();
+}
 }
 
 vtkStandardNewMacro(vtkParallelSerialWriter);
@@ -66,6 +130,10 @@ vtkParallelSerialWriter::vtkParallelSerialWriter()
   this->Piece = 0;
   this->NumberOfPieces = 1;
   this->GhostLevel = 0;
+  this->IOGroupSize = 0;
+  this->GroupController = nullptr;
+  this->GroupParentController = nullptr;
+  this->GroupControllerSize = 0;
 
   this->PreGatherHelper = nullptr;
   this->PostGatherHelper = nullptr;
@@ -88,6 +156,10 @@ vtkParallelSerialWriter::~vtkParallelSerialWriter()
   this->SetPreGatherHelper(nullptr);
   this->SetPostGatherHelper(nullptr);
   this->SetInterpreter(nullptr);
+  if (this->GroupController)
+  {
+    this->GroupController->Delete();
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -222,9 +294,34 @@ void vtkParallelSerialWriter::WriteATimestep(vtkDataObject* input)
 void vtkParallelSerialWriter::WriteAFile(const char* filename, vtkDataObject* input)
 {
   vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  const int numProcs = controller->GetNumberOfProcesses();
+  const int rank = controller->GetLocalProcessId();
+
+  // split the processes into groups of IOGroupSize consecutive ranks, each
+  // group reducing its data to its first rank.
+  const int groupSize =
+    (this->IOGroupSize > 0 && this->IOGroupSize < numProcs) ? this->IOGroupSize : numProcs;
+  const int group = rank / groupSize;
+  vtkMultiProcessController* groupController = controller;
+  if (groupSize == 1)
+  {
+    // each process reduces its own data, without any communication.
+    groupController = nullptr;
+  }
+  else if (groupSize < numProcs)
+  {
+    groupController = this->GetGroupController(controller, groupSize);
+    if (!groupController)
+    {
+      vtkErrorMacro("Failed to create the I/O groups.");
+      return;
+    }
+  }
 
+  // the reduction helpers run even when the data is not gathered, e.g. to
+  // convert the data to a table for CSV files.
   vtkSmartPointer<vtkReductionFilter> reductionFilter = vtkSmartPointer<vtkReductionFilter>::New();
-  reductionFilter->SetController(controller);
+  reductionFilter->SetController(groupController);
   reductionFilter->SetPreGatherHelper(this->PreGatherHelper);
   reductionFilter->SetPostGatherHelper(this->PostGatherHelper);
   reductionFilter->SetInputDataObject(input);
@@ -234,40 +331,80 @@ void vtkParallelSerialWriter::WriteAFile(const char* filename, vtkDataObject* in
   outInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES(), this->NumberOfPieces);
   outInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_GHOST_LEVELS(), this->GhostLevel);
   reductionFilter->Update();
+  vtkDataObject* output =
+    (!groupController || groupController->GetLocalProcessId() == 0)
+    ? reductionFilter->GetOutputDataObject(0)
+    : nullptr;
 
-  if (controller->GetLocalProcessId() == 0)
+  std::ostringstream fname;
+  if (this->WriteAllTimeSteps)
   {
-    vtkDataObject* output = reductionFilter->GetOutputDataObject(0);
-    if (vtkIsEmpty(output) == false)
+    std::string path = vtksys::SystemTools::GetFilenamePath(filename);
+    std::string fnamenoext = vtksys::SystemTools::GetFilenameWithoutLastExtension(filename);
+    std::string ext = vtksys::SystemTools::GetFilenameLastExtension(filename);
+    if (this->FileNameSuffix && vtkFileSeriesWriter::SuffixValidation(this->FileNameSuffix))
     {
-      std::ostringstream fname;
-      if (this->WriteAllTimeSteps)
-      {
-        std::string path = vtksys::SystemTools::GetFilenamePath(filename);
-        std::string fnamenoext = vtksys::SystemTools::GetFilenameWithoutLastExtension(filename);
-        std::string ext = vtksys::SystemTools::GetFilenameLastExtension(filename);
-        if (this->FileNameSuffix && vtkFileSeriesWriter::SuffixValidation(this->FileNameSuffix))
-        {
-          // Print this->CurrentTimeIndex to a string using this->FileNameSuffix as format
-          char suffix[100];
-          snprintf(suffix, 100, this->FileNameSuffix, this->CurrentTimeIndex);
-          fname << path << "/" << fnamenoext << suffix << ext;
-        }
-        else
-        {
-          fname << path << "/" << fnamenoext << "." << this->CurrentTimeIndex << ext;
-        }
-      }
-      else
-      {
-        fname << filename;
-      }
-      this->Writer->SetInputDataObject(output);
-      this->SetWriterFileName(fname.str().c_str());
-      this->WriteInternal();
-      this->Writer->SetInputConnection(0);
+      // Print this->CurrentTimeIndex to a string using this->FileNameSuffix as format
+      char suffix[100];
+      snprintf(suffix, 100, this->FileNameSuffix, this->CurrentTimeIndex);
+      fname << path << "/" << fnamenoext << suffix << ext;
+    }
+    else
+    {
+      fname << path << "/" << fnamenoext << "." << this->CurrentTimeIndex << ext;
     }
   }
+  else
+  {
+    fname << filename;
+  }
+
+  const int numGroups = (numProcs + groupSize - 1) / groupSize;
+  int written = 0;
+  if (vtkIsEmpty(output) == false)
+  {
+    this->Writer->SetInputDataObject(output);
+    this->SetWriterFileName(groupSize < numProcs
+        ? vtkPieceFileName(fname.str(), group, numGroups).c_str()
+        : fname.str().c_str());
+    this->WriteInternal();
+    this->Writer->SetInputConnection(0);
+    written = 1;
+  }
+
+  if (groupSize < numProcs)
+  {
+    // only the root needs to know which groups wrote a piece.
+    std::vector<int> allWritten(numProcs, 0);
+    controller->Gather(&written, &allWritten[0], 1, 0);
+    if (rank == 0 && !vtkWritePieceIndex(fname.str(), allWritten, groupSize))
+    {
+      vtkErrorMacro("Failed to write the index of the pieces of " << fname.str());
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkMultiProcessController* vtkParallelSerialWriter::GetGroupController(
+  vtkMultiProcessController* controller, int groupSize)
+{
+  if (this->GroupController && this->GroupParentController == controller &&
+    this->GroupControllerSize == groupSize)
+  {
+    return this->GroupController;
+  }
+  if (this->GroupController)
+  {
+    this->GroupController->Delete();
+  }
+
+  // PartitionController() is collective, WriteAFile() is called on all the
+  // processes with the same group size.
+  const int rank = controller->GetLocalProcessId();
+  this->GroupController = controller->PartitionController(rank / groupSize, rank);
+  this->GroupParentController = controller;
+  this->GroupControllerSize = groupSize;
+  return this->GroupController;
 }
 
 //----------------------------------------------------------------------------
@@ -317,4 +454,5 @@ void vtkParallelSerialWriter::SetWriterFileName(const char* fname)
 void vtkParallelSerialWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "IOGroupSize: " << this->IOGroupSize << endl;
 }
@@ -22,6 +22,13 @@
  * and PostGatherHelper.
  * This also makes it possible to write time-series for temporal datasets using
  * simple non-time-aware writers.
+ *
+ * When IOGroupSize is set, the processes are split into groups of IOGroupSize
+ * consecutive ranks instead, the data is reduced on the first rank of each
+ * group and each group writes its own piece in parallel with the others.
+ * The pieces of name.ext are named name.part<group>of<number of groups>.ext,
+ * so that the file dialog does not take them for a time series, and the root
+ * writes name.pieces.json, a small JSON index of the pieces that were written.
 */
 
 #ifndef vtkParallelSerialWriter_h
@@ -31,6 +38,7 @@
 #include "vtkPVVTKExtensionsCoreModule.h" //needed for exports
 
 class vtkClientServerInterpreter;
+class vtkMultiProcessController;
 
 class VTKPVVTKEXTENSIONSCORE_EXPORT vtkParallelSerialWriter : public vtkDataObjectAlgorithm
 {
@@ -99,6 +107,19 @@ public:
   vtkSetMacro(GhostLevel, int);
   //@}
 
+  //@{
+  /**
+   * Get/Set the number of processes that reduce their data to a single file.
+   * With a value of 1 each process runs the reduction helpers on its own data
+   * and writes its piece without exchanging any data. Larger values trade write
+   * parallelism for fewer files and less load on the file system metadata
+   * server. 0, the default, gathers all the data to the root and writes a
+   * single file.
+   */
+  vtkSetClampMacro(IOGroupSize, int, 0, VTK_INT_MAX);
+  vtkGetMacro(IOGroupSize, int);
+  //@}
+
   //@{
   /**
    * Get/Set the pre-reduction helper. Pre-Reduction helper is an algorithm
@@ -167,6 +188,13 @@ private:
   void SetWriterFileName(const char* fname);
   void WriteInternal();
 
+  /**
+   * Returns the controller of the group of groupSize processes of controller
+   * this process belongs to, creating it on the first call.
+   */
+  vtkMultiProcessController* GetGroupController(
+    vtkMultiProcessController* controller, int groupSize);
+
   vtkAlgorithm* PreGatherHelper;
   vtkAlgorithm* PostGatherHelper;
 
@@ -175,6 +203,13 @@ private:
   int Piece;
   int NumberOfPieces;
   int GhostLevel;
+  int IOGroupSize;
+
+  // Controller of the group of IOGroupSize processes this process belongs to.
+  // It is created once for a given parent controller and group size.
+  vtkMultiProcessController* GroupController;
+  vtkMultiProcessController* GroupParentController;
+  int GroupControllerSize;
 
   int WriteAllTimeSteps;
   int NumberOfTimeSteps;
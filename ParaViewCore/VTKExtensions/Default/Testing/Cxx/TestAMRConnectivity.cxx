@@ -0,0 +1,498 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestAMRConnectivity.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Verifies the fragment labeling of vtkAMRConnectivity, within blocks and
+// resolved across blocks with the ghosts filled in, and the bulk
+// equivalences of vtkEquivalenceSet against straightforward serial
+// implementations on synthetic data.
+
+#include "vtkAMRConnectivity.h"
+#include "vtkCellData.h"
+#include "vtkDataSetAttributes.h"
+#include "vtkDoubleArray.h"
+#include "vtkDummyController.h"
+#include "vtkEquivalenceSet.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkNonOverlappingAMR.h"
+#include "vtkSmartPointer.h"
+#include "vtkStructuredData.h"
+#include "vtkUniformGrid.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+const double Threshold = 0.1;
+
+// Layout of the blocks of a single level AMR.
+struct Layout
+{
+  int Blocks[3];
+  int BlockCells;
+  int GhostLevels;
+
+  int GetNumberOfBlocks() const { return this->Blocks[0] * this->Blocks[1] * this->Blocks[2]; }
+  int GetCellDimension() const { return this->BlockCells + 2 * this->GhostLevels; }
+  vtkIdType GetCellId(int i, int j, int k) const
+  {
+    const int dim = this->GetCellDimension();
+    return i + dim * (j + static_cast<vtkIdType>(dim) * k);
+  }
+};
+
+// Builds a single level AMR with a volume fraction made of many separate
+// blobs. Blocks are numbered with x varying fastest. Every block is padded
+// with GhostLevels layers of ghost cells overlapping its neighbors.
+vtkSmartPointer<vtkNonOverlappingAMR> MakeAMR(const Layout& layout)
+{
+  vtkSmartPointer<vtkNonOverlappingAMR> amr = vtkSmartPointer<vtkNonOverlappingAMR>::New();
+  int blocksPerLevel[1] = { layout.GetNumberOfBlocks() };
+  amr->Initialize(1, blocksPerLevel);
+  amr->SetGridDescription(VTK_XYZ_GRID);
+
+  const int dim = layout.GetCellDimension();
+  const int ghosts = layout.GhostLevels;
+  int b = 0;
+  for (int bk = 0; bk < layout.Blocks[2]; ++bk)
+  {
+    for (int bj = 0; bj < layout.Blocks[1]; ++bj)
+    {
+      for (int bi = 0; bi < layout.Blocks[0]; ++bi, ++b)
+      {
+        double origin[3] = { static_cast<double>(bi * layout.BlockCells - ghosts),
+          static_cast<double>(bj * layout.BlockCells - ghosts),
+          static_cast<double>(bk * layout.BlockCells - ghosts) };
+        vtkNew<vtkUniformGrid> grid;
+        grid->SetOrigin(origin);
+        grid->SetSpacing(1.0, 1.0, 1.0);
+        grid->SetDimensions(dim + 1, dim + 1, dim + 1);
+
+        vtkIdType numCells = grid->GetNumberOfCells();
+        vtkNew<vtkDoubleArray> volume;
+        volume->SetName("Volume");
+        volume->SetNumberOfTuples(numCells);
+        vtkNew<vtkUnsignedCharArray> ghostArray;
+        ghostArray->SetName(vtkDataSetAttributes::GhostArrayName());
+        ghostArray->SetNumberOfTuples(numCells);
+        for (int k = 0; k < dim; ++k)
+        {
+          for (int j = 0; j < dim; ++j)
+          {
+            for (int i = 0; i < dim; ++i)
+            {
+              double x = origin[0] + i + 0.5;
+              double y = origin[1] + j + 0.5;
+              double z = origin[2] + k + 0.5;
+              double value = sin(0.45 * x) * sin(0.35 * y + 0.1 * x) * sin(0.4 * z);
+              bool isGhost = std::min(std::min(i, j), k) < ghosts ||
+                std::max(std::max(i, j), k) >= dim - ghosts;
+              vtkIdType cellId = layout.GetCellId(i, j, k);
+              volume->SetValue(cellId, value);
+              ghostArray->SetValue(cellId, isGhost ? vtkDataSetAttributes::DUPLICATECELL : 0);
+            }
+          }
+        }
+        grid->GetCellData()->AddArray(volume.GetPointer());
+        grid->GetCellData()->AddArray(ghostArray.GetPointer());
+        amr->SetDataSet(0, b, grid.GetPointer());
+      }
+    }
+  }
+  return amr;
+}
+
+bool IsGhost(vtkDataSet* grid, vtkIdType cellId)
+{
+  vtkDataArray* ghosts = grid->GetCellData()->GetArray(vtkDataSetAttributes::GhostArrayName());
+  return (static_cast<int>(ghosts->GetComponent(cellId, 0)) &
+           vtkDataSetAttributes::DUPLICATECELL) != 0;
+}
+
+// Labels the blocks one after the other by flooding the cells sharing a
+// point, the way fragments used to be seeded. Ghost cells are skipped.
+std::vector<vtkIdType> ReferenceLabels(
+  vtkNonOverlappingAMR* amr, const Layout& layout, vtkIdType& numRegions)
+{
+  const int dim = layout.GetCellDimension();
+  std::vector<vtkIdType> labels;
+  vtkIdType nextRegion = 1;
+  std::vector<vtkIdType> stack;
+  for (int b = 0; b < layout.GetNumberOfBlocks(); ++b)
+  {
+    vtkUniformGrid* grid = amr->GetDataSet(0, b);
+    vtkDataArray* volume = grid->GetCellData()->GetArray("Volume");
+    const vtkIdType numCells = volume->GetNumberOfTuples();
+    const vtkIdType offset = static_cast<vtkIdType>(labels.size());
+    labels.resize(offset + numCells, 0);
+    for (int i = 0; i < dim; ++i)
+    {
+      for (int j = 0; j < dim; ++j)
+      {
+        for (int k = 0; k < dim; ++k)
+        {
+          vtkIdType seed = layout.GetCellId(i, j, k);
+          if (labels[offset + seed] != 0 || volume->GetComponent(seed, 0) <= Threshold ||
+            IsGhost(grid, seed))
+          {
+            continue;
+          }
+          labels[offset + seed] = nextRegion;
+          stack.push_back(seed);
+          while (!stack.empty())
+          {
+            vtkIdType cellId = stack.back();
+            stack.pop_back();
+            int ci = cellId % dim;
+            int cj = (cellId / dim) % dim;
+            int ck = cellId / (dim * dim);
+            for (int di = -1; di <= 1; ++di)
+            {
+              for (int dj = -1; dj <= 1; ++dj)
+              {
+                for (int dk = -1; dk <= 1; ++dk)
+                {
+                  int ni = ci + di;
+                  int nj = cj + dj;
+                  int nk = ck + dk;
+                  if (ni < 0 || ni >= dim || nj < 0 || nj >= dim || nk < 0 || nk >= dim)
+                  {
+                    continue;
+                  }
+                  vtkIdType neighbor = layout.GetCellId(ni, nj, nk);
+                  if (labels[offset + neighbor] == 0 &&
+                    volume->GetComponent(neighbor, 0) > Threshold && !IsGhost(grid, neighbor))
+                  {
+                    labels[offset + neighbor] = nextRegion;
+                    stack.push_back(neighbor);
+                  }
+                }
+              }
+            }
+          }
+          ++nextRegion;
+        }
+      }
+    }
+  }
+  numRegions = nextRegion - 1;
+  return labels;
+}
+
+vtkIdType FindRoot(std::vector<vtkIdType>& parents, vtkIdType label)
+{
+  while (parents[label] != label)
+  {
+    parents[label] = parents[parents[label]];
+    label = parents[label];
+  }
+  return label;
+}
+
+// Merges the reference labels of the fragments touching through a face
+// across the boundary between two blocks, and returns the smallest label
+// of every merged fragment.
+std::vector<vtkIdType> ResolveReferenceLabels(
+  const std::vector<vtkIdType>& labels, const Layout& layout, vtkIdType numRegions)
+{
+  std::vector<vtkIdType> parents(numRegions + 1);
+  for (vtkIdType label = 0; label <= numRegions; ++label)
+  {
+    parents[label] = label;
+  }
+
+  const int dim = layout.GetCellDimension();
+  const vtkIdType blockSize = static_cast<vtkIdType>(dim) * dim * dim;
+  const int last = layout.GhostLevels + layout.BlockCells - 1;
+  const int first = layout.GhostLevels;
+  int block[3];
+  for (block[2] = 0; block[2] < layout.Blocks[2]; ++block[2])
+  {
+    for (block[1] = 0; block[1] < layout.Blocks[1]; ++block[1])
+    {
+      for (block[0] = 0; block[0] < layout.Blocks[0]; ++block[0])
+      {
+        const int b = block[0] + layout.Blocks[0] * (block[1] + layout.Blocks[1] * block[2]);
+        for (int dir = 0; dir < 3; ++dir)
+        {
+          if (block[dir] + 1 >= layout.Blocks[dir])
+          {
+            continue;
+          }
+          const int strides[3] = { 1, layout.Blocks[0], layout.Blocks[0] * layout.Blocks[1] };
+          const int n = b + strides[dir];
+          for (int u = first; u <= last; ++u)
+          {
+            for (int v = first; v <= last; ++v)
+            {
+              int ijk[3];
+              ijk[(dir + 1) % 3] = u;
+              ijk[(dir + 2) % 3] = v;
+              ijk[dir] = last;
+              vtkIdType blockLabel =
+                labels[b * blockSize + layout.GetCellId(ijk[0], ijk[1], ijk[2])];
+              ijk[dir] = first;
+              vtkIdType neighborLabel =
+                labels[n * blockSize + layout.GetCellId(ijk[0], ijk[1], ijk[2])];
+              if (blockLabel == 0 || neighborLabel == 0)
+              {
+                continue;
+              }
+              vtkIdType root1 = FindRoot(parents, blockLabel);
+              vtkIdType root2 = FindRoot(parents, neighborLabel);
+              parents[std::max(root1, root2)] = std::min(root1, root2);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<vtkIdType> resolved(labels.size());
+  for (size_t ii = 0; ii < labels.size(); ++ii)
+  {
+    resolved[ii] = FindRoot(parents, labels[ii]);
+  }
+  return resolved;
+}
+
+vtkIdTypeArray* GetRegionIds(vtkNonOverlappingAMR* output, int b)
+{
+  vtkIdTypeArray* regionIds = vtkIdTypeArray::SafeDownCast(
+    output->GetDataSet(0, b)->GetCellData()->GetArray("RegionId-Volume"));
+  if (!regionIds)
+  {
+    cerr << "Missing RegionId-Volume on block " << b << endl;
+  }
+  return regionIds;
+}
+
+bool TestConnectivity()
+{
+  Layout layout = { { 8, 1, 1 }, 32, 0 };
+  vtkSmartPointer<vtkNonOverlappingAMR> amr = MakeAMR(layout);
+
+  vtkNew<vtkAMRConnectivity> connectivity;
+  connectivity->SetInputData(amr);
+  connectivity->AddInputVolumeArrayToProcess("Volume");
+  connectivity->SetVolumeFractionSurfaceValue(Threshold);
+  connectivity->SetResolveBlocks(false);
+  connectivity->SetPropagateGhosts(false);
+
+  connectivity->Update();
+
+  vtkNonOverlappingAMR* output =
+    vtkNonOverlappingAMR::SafeDownCast(connectivity->GetOutputDataObject(0));
+  vtkIdType numRegions = 0;
+  std::vector<vtkIdType> expected = ReferenceLabels(amr, layout, numRegions);
+  vtkIdType offset = 0;
+  for (int b = 0; b < layout.GetNumberOfBlocks(); ++b)
+  {
+    vtkIdTypeArray* regionIds = GetRegionIds(output, b);
+    if (!regionIds)
+    {
+      return false;
+    }
+    for (vtkIdType cellId = 0; cellId < regionIds->GetNumberOfTuples(); ++cellId)
+    {
+      if (regionIds->GetValue(cellId) != expected[offset + cellId])
+      {
+        cerr << "Region id mismatch at cell " << cellId << " of block " << b << ": "
+             << regionIds->GetValue(cellId) << " != " << expected[offset + cellId] << endl;
+        return false;
+      }
+    }
+    offset += regionIds->GetNumberOfTuples();
+  }
+  if (numRegions < 2)
+  {
+    cerr << "Expected several fragments, got " << numRegions << endl;
+    return false;
+  }
+  return true;
+}
+
+// Checks that fragments crossing block boundaries get a single id and that
+// the ghost cells in a fragment get the id of a neighboring fragment cell.
+bool TestResolveBlocks()
+{
+  Layout layout = { { 2, 2, 2 }, 16, 1 };
+  vtkSmartPointer<vtkNonOverlappingAMR> amr = MakeAMR(layout);
+
+  vtkNew<vtkAMRConnectivity> connectivity;
+  connectivity->SetInputData(amr);
+  connectivity->AddInputVolumeArrayToProcess("Volume");
+  connectivity->SetVolumeFractionSurfaceValue(Threshold);
+  connectivity->SetResolveBlocks(true);
+  connectivity->SetPropagateGhosts(true);
+  connectivity->Update();
+
+  vtkNonOverlappingAMR* output =
+    vtkNonOverlappingAMR::SafeDownCast(connectivity->GetOutputDataObject(0));
+  vtkIdType numRegions = 0;
+  std::vector<vtkIdType> labels = ReferenceLabels(amr, layout, numRegions);
+  std::vector<vtkIdType> expected = ResolveReferenceLabels(labels, layout, numRegions);
+
+  vtkIdType numMerged = 0;
+  for (size_t ii = 0; ii < labels.size(); ++ii)
+  {
+    numMerged += expected[ii] != labels[ii] ? 1 : 0;
+  }
+  if (numMerged == 0)
+  {
+    cerr << "Expected fragments crossing block boundaries." << endl;
+    return false;
+  }
+
+  const int dim = layout.GetCellDimension();
+  vtkIdType offset = 0;
+  vtkIdType numGhostsSet = 0;
+  for (int b = 0; b < layout.GetNumberOfBlocks(); ++b)
+  {
+    vtkUniformGrid* grid = output->GetDataSet(0, b);
+    vtkDataArray* volume = grid->GetCellData()->GetArray("Volume");
+    vtkIdTypeArray* regionIds = GetRegionIds(output, b);
+    if (!regionIds)
+    {
+      return false;
+    }
+    for (int k = 0; k < dim; ++k)
+    {
+      for (int j = 0; j < dim; ++j)
+      {
+        for (int i = 0; i < dim; ++i)
+        {
+          vtkIdType cellId = layout.GetCellId(i, j, k);
+          vtkIdType regionId = regionIds->GetValue(cellId);
+          if (!IsGhost(grid, cellId))
+          {
+            if (regionId != expected[offset + cellId])
+            {
+              cerr << "Resolved region id mismatch at cell " << cellId << " of block " << b
+                   << ": " << regionId << " != " << expected[offset + cellId] << endl;
+              return false;
+            }
+            continue;
+          }
+
+          // A ghost cell in a fragment takes the id of any fragment cell
+          // sharing a point with it.
+          bool hasCandidate = false;
+          bool matchesCandidate = false;
+          if (volume->GetComponent(cellId, 0) >= Threshold)
+          {
+            for (int dk = -1; dk <= 1; ++dk)
+            {
+              for (int dj = -1; dj <= 1; ++dj)
+              {
+                for (int di = -1; di <= 1; ++di)
+                {
+                  int ni = i + di;
+                  int nj = j + dj;
+                  int nk = k + dk;
+                  if (ni < 0 || ni >= dim || nj < 0 || nj >= dim || nk < 0 || nk >= dim)
+                  {
+                    continue;
+                  }
+                  vtkIdType neighbor = layout.GetCellId(ni, nj, nk);
+                  if (neighbor != cellId && volume->GetComponent(neighbor, 0) > Threshold &&
+                    !IsGhost(grid, neighbor))
+                  {
+                    hasCandidate = true;
+                    matchesCandidate =
+                      matchesCandidate || regionId == regionIds->GetValue(neighbor);
+                  }
+                }
+              }
+            }
+          }
+          if (hasCandidate ? !matchesCandidate : regionId != 0)
+          {
+            cerr << "Wrong ghost region id " << regionId << " at cell " << cellId << " of block "
+                 << b << endl;
+            return false;
+          }
+          numGhostsSet += hasCandidate ? 1 : 0;
+        }
+      }
+    }
+    offset += regionIds->GetNumberOfTuples();
+  }
+  if (numGhostsSet == 0)
+  {
+    cerr << "Expected ghost cells in fragments." << endl;
+    return false;
+  }
+  return true;
+}
+
+bool TestEquivalenceSet()
+{
+  const int numMembers = 1000000;
+  const vtkIdType numPairs = numMembers / 2;
+
+  std::vector<int> pairs(2 * numPairs);
+  unsigned int seed = 12345;
+  for (size_t ii = 0; ii < pairs.size(); ++ii)
+  {
+    seed = 1664525u * seed + 1013904223u;
+    pairs[ii] = static_cast<int>((seed >> 8) % numMembers);
+  }
+
+  vtkNew<vtkEquivalenceSet> serial;
+  for (vtkIdType ii = 0; ii < numPairs; ++ii)
+  {
+    serial->AddEquivalence(pairs[2 * ii], pairs[2 * ii + 1]);
+  }
+  int numSerialSets = serial->ResolveEquivalences();
+
+  vtkNew<vtkEquivalenceSet> bulk;
+  bulk->AddEquivalences(&pairs[0], numPairs);
+  int numBulkSets = bulk->ResolveEquivalences();
+
+  if (numSerialSets != numBulkSets ||
+    serial->GetNumberOfMembers() != bulk->GetNumberOfMembers())
+  {
+    cerr << "Expected " << numSerialSets << " sets, got " << numBulkSets << endl;
+    return false;
+  }
+  for (int ii = 0; ii < serial->GetNumberOfMembers(); ++ii)
+  {
+    if (serial->GetEquivalentSetId(ii) != bulk->GetEquivalentSetId(ii))
+    {
+      cerr << "Set id mismatch for member " << ii << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestAMRConnectivity(int, char* [])
+{
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  int status = EXIT_SUCCESS;
+  if (!TestConnectivity() || !TestResolveBlocks() || !TestEquivalenceSet())
+  {
+    status = EXIT_FAILURE;
+  }
+
+  vtkMultiProcessController::SetGlobalController(nullptr);
+  return status;
+}
@@ -0,0 +1,184 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestAMRDualContourThreading.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Verifies that contouring the AMR blocks concurrently produces exactly the
+// same output as processing them one after the other.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkDataArray.h"
+#include "vtkDummyController.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPVAMRDualContour.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSpyPlotReader.h"
+#include "vtkTestUtilities.h"
+
+#include <cstring>
+
+namespace
+{
+bool SameArray(vtkDataArray* a, vtkDataArray* b)
+{
+  if (a == nullptr || b == nullptr)
+  {
+    return a == b;
+  }
+  if (a->GetDataType() != b->GetDataType() ||
+    a->GetNumberOfComponents() != b->GetNumberOfComponents() ||
+    a->GetNumberOfTuples() != b->GetNumberOfTuples())
+  {
+    return false;
+  }
+  const size_t size =
+    static_cast<size_t>(a->GetNumberOfTuples()) * a->GetNumberOfComponents() * a->GetDataTypeSize();
+  return size == 0 || memcmp(a->GetVoidPointer(0), b->GetVoidPointer(0), size) == 0;
+}
+
+bool SameAttributes(vtkDataSetAttributes* a, vtkDataSetAttributes* b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+  {
+    return false;
+  }
+  for (int cc = 0; cc < a->GetNumberOfArrays(); ++cc)
+  {
+    if (!SameArray(a->GetArray(cc), b->GetArray(cc)))
+    {
+      cerr << "Array '" << (a->GetArray(cc) ? a->GetArray(cc)->GetName() : "(null)")
+           << "' differs." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SameOutput(vtkDataObject* serial, vtkDataObject* threaded)
+{
+  vtkMultiBlockDataSet* serialMB = vtkMultiBlockDataSet::SafeDownCast(serial);
+  vtkMultiBlockDataSet* threadedMB = vtkMultiBlockDataSet::SafeDownCast(threaded);
+  if (!serialMB || !threadedMB)
+  {
+    cerr << "Expected multiblock outputs." << endl;
+    return false;
+  }
+
+  vtkSmartPointer<vtkCompositeDataIterator> serialIter;
+  serialIter.TakeReference(serialMB->NewIterator());
+  vtkSmartPointer<vtkCompositeDataIterator> threadedIter;
+  threadedIter.TakeReference(threadedMB->NewIterator());
+  int numPieces = 0;
+  vtkIdType numCells = 0;
+  for (serialIter->InitTraversal(), threadedIter->InitTraversal();
+       !serialIter->IsDoneWithTraversal() && !threadedIter->IsDoneWithTraversal();
+       serialIter->GoToNextItem(), threadedIter->GoToNextItem())
+  {
+    vtkPolyData* a = vtkPolyData::SafeDownCast(serialIter->GetCurrentDataObject());
+    vtkPolyData* b = vtkPolyData::SafeDownCast(threadedIter->GetCurrentDataObject());
+    if (!a || !b)
+    {
+      cerr << "Expected polydata pieces." << endl;
+      return false;
+    }
+    if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfCells() != b->GetNumberOfCells())
+    {
+      cerr << "Size mismatch: " << a->GetNumberOfPoints() << "/" << a->GetNumberOfCells()
+           << " points/cells vs " << b->GetNumberOfPoints() << "/" << b->GetNumberOfCells()
+           << endl;
+      return false;
+    }
+    if (a->GetNumberOfPoints() > 0 &&
+      !SameArray(a->GetPoints()->GetData(), b->GetPoints()->GetData()))
+    {
+      cerr << "Point coordinates differ." << endl;
+      return false;
+    }
+    if (!SameArray(a->GetPolys()->GetData(), b->GetPolys()->GetData()))
+    {
+      cerr << "Polygons differ." << endl;
+      return false;
+    }
+    if (!SameAttributes(a->GetPointData(), b->GetPointData()) ||
+      !SameAttributes(a->GetCellData(), b->GetCellData()))
+    {
+      return false;
+    }
+    ++numPieces;
+    numCells += a->GetNumberOfCells();
+  }
+  if (!serialIter->IsDoneWithTraversal() || !threadedIter->IsDoneWithTraversal())
+  {
+    cerr << "Number of pieces differ." << endl;
+    return false;
+  }
+  if (numPieces == 0 || numCells == 0)
+  {
+    cerr << "Expected a non-empty contour." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestAMRDualContourThreading(int argc, char* argv[])
+{
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  char* fname = vtkTestUtilities::ExpandDataFileName(argc, argv, "SPCTH/spcth.0");
+  vtkNew<vtkSpyPlotReader> reader;
+  reader->SetFileName(fname);
+  reader->SetGlobalController(controller.GetPointer());
+  reader->MergeXYZComponentsOn();
+  reader->DownConvertVolumeFractionOn();
+  reader->DistributeFilesOn();
+  reader->SetCellArrayStatus("Material volume fraction - 2", 1);
+  reader->Update();
+  delete[] fname;
+
+  int status = EXIT_SUCCESS;
+  for (int mergePoints = 0; mergePoints < 2; ++mergePoints)
+  {
+    vtkSmartPointer<vtkDataObject> outputs[2];
+    for (int threaded = 0; threaded < 2; ++threaded)
+    {
+      vtkNew<vtkPVAMRDualContour> contour;
+      contour->SetInputData(reader->GetOutputDataObject(0));
+      contour->SetVolumeFractionSurfaceValue(0.1);
+      contour->SetEnableMergePoints(mergePoints);
+      contour->SetEnableDegenerateCells(1);
+      contour->SetEnableCapping(1);
+      contour->SetUseThreading(threaded);
+      contour->AddInputCellArrayToProcess("Material volume fraction - 2");
+      contour->Update();
+      outputs[threaded] = contour->GetOutputDataObject(0);
+    }
+
+    if (!SameOutput(outputs[0], outputs[1]))
+    {
+      cerr << "Threaded output differs from serial output (EnableMergePoints=" << mergePoints
+           << ")." << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  vtkMultiProcessController::SetGlobalController(nullptr);
+  return status;
+}
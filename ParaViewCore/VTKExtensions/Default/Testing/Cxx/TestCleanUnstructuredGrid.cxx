@@ -0,0 +1,206 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestCleanUnstructuredGrid.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Cleans grids of hexahedra that each have their own 8 points, compares the
+// output with merging the points one at a time with vtkMergePoints, checks
+// merging points moved by less than the tolerance, and reports the timings for
+// increasing grid sizes.
+
+#include "vtkCellArray.h"
+#include "vtkCleanUnstructuredGrid.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMergePoints.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <vector>
+
+namespace
+{
+// A dim^3 grid of hexahedra, each with its own points, optionally moved by
+// up to jitter along each axis.
+vtkSmartPointer<vtkUnstructuredGrid> MakeExplodedGrid(int dim, double jitter)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  vtkNew<vtkIdTypeArray> corner;
+  corner->SetName("Corner");
+  auto grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->Allocate(dim * dim * dim);
+  const int offsets[8][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 },
+    { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+  for (int k = 0; k < dim; ++k)
+  {
+    for (int j = 0; j < dim; ++j)
+    {
+      for (int i = 0; i < dim; ++i)
+      {
+        vtkIdType ids[8];
+        for (int cc = 0; cc < 8; ++cc)
+        {
+          double x[3] = { static_cast<double>(i + offsets[cc][0]),
+            static_cast<double>(j + offsets[cc][1]), static_cast<double>(k + offsets[cc][2]) };
+          for (int axis = 0; jitter > 0.0 && axis < 3; ++axis)
+          {
+            random->Next();
+            x[axis] += random->GetRangeValue(-jitter, jitter);
+          }
+          ids[cc] = points->InsertNextPoint(x);
+          corner->InsertNextValue(cc);
+        }
+        grid->InsertNextCell(VTK_HEXAHEDRON, 8, ids);
+      }
+    }
+  }
+  grid->SetPoints(points.GetPointer());
+  grid->GetPointData()->AddArray(corner.GetPointer());
+  return grid;
+}
+
+// What vtkCleanUnstructuredGrid did before merging points in parallel.
+vtkSmartPointer<vtkUnstructuredGrid> MergeSerially(vtkUnstructuredGrid* input)
+{
+  auto output = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  output->GetPointData()->CopyAllocate(input->GetPointData());
+  vtkNew<vtkPoints> newPts;
+  vtkNew<vtkMergePoints> locator;
+  locator->InitPointInsertion(newPts.GetPointer(), input->GetBounds(), input->GetNumberOfPoints());
+  std::vector<vtkIdType> ptMap(input->GetNumberOfPoints());
+  for (vtkIdType id = 0; id < input->GetNumberOfPoints(); ++id)
+  {
+    if (locator->InsertUniquePoint(input->GetPoint(id), ptMap[id]))
+    {
+      output->GetPointData()->CopyData(input->GetPointData(), id, ptMap[id]);
+    }
+  }
+  output->SetPoints(newPts.GetPointer());
+  output->Allocate(input->GetNumberOfCells());
+  vtkNew<vtkIdList> cellPoints;
+  for (vtkIdType id = 0; id < input->GetNumberOfCells(); ++id)
+  {
+    input->GetCellPoints(id, cellPoints.GetPointer());
+    for (vtkIdType i = 0; i < cellPoints->GetNumberOfIds(); ++i)
+    {
+      cellPoints->SetId(i, ptMap[cellPoints->GetId(i)]);
+    }
+    output->InsertNextCell(input->GetCellType(id), cellPoints.GetPointer());
+  }
+  return output;
+}
+
+bool SameGrids(vtkUnstructuredGrid* expected, vtkUnstructuredGrid* result)
+{
+  if (expected->GetNumberOfPoints() != result->GetNumberOfPoints() ||
+    expected->GetNumberOfCells() != result->GetNumberOfCells())
+  {
+    cerr << "Expected " << expected->GetNumberOfPoints() << " points and "
+         << expected->GetNumberOfCells() << " cells, got " << result->GetNumberOfPoints()
+         << " and " << result->GetNumberOfCells() << endl;
+    return false;
+  }
+  vtkDataArray* expectedCorner = expected->GetPointData()->GetArray("Corner");
+  vtkDataArray* corner = result->GetPointData()->GetArray("Corner");
+  for (vtkIdType id = 0; id < expected->GetNumberOfPoints(); ++id)
+  {
+    double a[3], b[3];
+    expected->GetPoint(id, a);
+    result->GetPoint(id, b);
+    if (a[0] != b[0] || a[1] != b[1] || a[2] != b[2] ||
+      expectedCorner->GetComponent(id, 0) != corner->GetComponent(id, 0))
+    {
+      cerr << "Mismatched point " << id << endl;
+      return false;
+    }
+  }
+  vtkNew<vtkIdList> a;
+  vtkNew<vtkIdList> b;
+  for (vtkIdType id = 0; id < expected->GetNumberOfCells(); ++id)
+  {
+    expected->GetCellPoints(id, a.GetPointer());
+    result->GetCellPoints(id, b.GetPointer());
+    if (expected->GetCellType(id) != result->GetCellType(id) ||
+      a->GetNumberOfIds() != b->GetNumberOfIds())
+    {
+      cerr << "Mismatched cell " << id << endl;
+      return false;
+    }
+    for (vtkIdType i = 0; i < a->GetNumberOfIds(); ++i)
+    {
+      if (a->GetId(i) != b->GetId(i))
+      {
+        cerr << "Mismatched cell " << id << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestCleanUnstructuredGrid(int, char* [])
+{
+  vtkNew<vtkTimerLog> timer;
+  for (int dim = 10; dim <= 40; dim *= 2)
+  {
+    vtkSmartPointer<vtkUnstructuredGrid> input = MakeExplodedGrid(dim, 0.0);
+
+    timer->StartTimer();
+    vtkSmartPointer<vtkUnstructuredGrid> expected = MergeSerially(input);
+    timer->StopTimer();
+    const double serialTime = timer->GetElapsedTime();
+
+    vtkNew<vtkCleanUnstructuredGrid> clean;
+    clean->SetInputData(input);
+    timer->StartTimer();
+    clean->Update();
+    timer->StopTimer();
+
+    if (!SameGrids(expected, clean->GetOutput()))
+    {
+      return EXIT_FAILURE;
+    }
+    cout << input->GetNumberOfPoints() << " points: " << serialTime
+         << " seconds merging one point at a time, " << timer->GetElapsedTime()
+         << " seconds in parallel." << endl;
+  }
+
+  // points moved by less than half the tolerance all merge back.
+  const int dim = 10;
+  vtkSmartPointer<vtkUnstructuredGrid> jittered = MakeExplodedGrid(dim, 1e-4);
+  vtkNew<vtkCleanUnstructuredGrid> clean;
+  clean->SetInputData(jittered);
+  clean->Update();
+  if (clean->GetOutput()->GetNumberOfPoints() != jittered->GetNumberOfPoints())
+  {
+    cerr << "Expected no merge without tolerance." << endl;
+    return EXIT_FAILURE;
+  }
+  clean->SetTolerance(1e-3);
+  clean->Update();
+  const vtkIdType expectedPoints = (dim + 1) * (dim + 1) * (dim + 1);
+  if (clean->GetOutput()->GetNumberOfPoints() != expectedPoints)
+  {
+    cerr << "Expected " << expectedPoints << " points with a tolerance, got "
+         << clean->GetOutput()->GetNumberOfPoints() << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,265 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestFileSeriesReaderReadAhead.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Tests the CacheTimeInformation and ReadAhead options of vtkFileSeriesReader:
+// the time information of the files is reused until a file changes on disk or
+// the internal reader is modified, and the next file in the direction the time
+// steps are requested is read ahead.
+
+#include "vtkClientServerInterpreter.h"
+#include "vtkClientServerInterpreterInitializer.h"
+#include "vtkClientServerStream.h"
+#include "vtkDirectory.h"
+#include "vtkFileSeriesReader.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPolyDataAlgorithm.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTestUtilities.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Reader reporting the number at the end of the file name as its only time
+// step, without opening the file, and counting its RequestInformation passes.
+class vtkFileSeriesTestReader : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkFileSeriesTestReader* New();
+  vtkTypeMacro(vtkFileSeriesTestReader, vtkPolyDataAlgorithm);
+
+  vtkSetStringMacro(FileName);
+  vtkGetStringMacro(FileName);
+
+  int NumberOfInformationPasses;
+
+protected:
+  vtkFileSeriesTestReader()
+    : NumberOfInformationPasses(0)
+    , FileName(nullptr)
+  {
+    this->SetNumberOfInputPorts(0);
+  }
+  ~vtkFileSeriesTestReader() override { this->SetFileName(nullptr); }
+
+  int RequestInformation(vtkInformation*, vtkInformationVector**,
+    vtkInformationVector* outputVector) override
+  {
+    ++this->NumberOfInformationPasses;
+    const std::string fname = this->FileName ? this->FileName : "";
+    double time = std::atof(fname.substr(fname.rfind('_') + 1).c_str());
+    double range[2] = { time, time };
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(), &time, 1);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(), range, 2);
+    return 1;
+  }
+
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override
+  {
+    return 1;
+  }
+
+  char* FileName;
+
+private:
+  vtkFileSeriesTestReader(const vtkFileSeriesTestReader&) = delete;
+  void operator=(const vtkFileSeriesTestReader&) = delete;
+};
+
+vtkStandardNewMacro(vtkFileSeriesTestReader);
+
+namespace
+{
+// vtkFileSeriesReader sets the file name of its reader through the
+// interpreter, which only knows about wrapped classes.
+int vtkFileSeriesTestReaderCommand(vtkClientServerInterpreter*, vtkObjectBase* ptr,
+  const char* method, const vtkClientServerStream& msg, vtkClientServerStream& result, void*)
+{
+  vtkFileSeriesTestReader* reader = vtkFileSeriesTestReader::SafeDownCast(ptr);
+  char* fname = nullptr;
+  if (reader && !strcmp(method, "SetFileName") && msg.GetNumberOfArguments(0) == 3)
+  {
+    msg.GetArgument(0, 2, &fname);
+    reader->SetFileName(fname);
+    result.Reset();
+    return 1;
+  }
+  result.Reset();
+  result << vtkClientServerStream::Error << "Unsupported method." << vtkClientServerStream::End;
+  return 0;
+}
+
+bool CheckPasses(vtkFileSeriesTestReader* reader, int expected, const char* label)
+{
+  if (reader->NumberOfInformationPasses != expected)
+  {
+    cerr << label << ": expected " << expected << " information passes, got "
+         << reader->NumberOfInformationPasses << endl;
+    return false;
+  }
+  return true;
+}
+
+#if defined(__linux__) && defined(POSIX_FADV_WILLNEED)
+// Returns whether the file name of the directory watched by the inotify
+// instance fd was opened since the last call. The reader opens the file it
+// reads ahead to advise the system, the test reader never opens the files.
+bool WasOpened(int fd, const std::string& name)
+{
+  alignas(inotify_event) char buffer[4096];
+  bool opened = false;
+  ssize_t length;
+  while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+  {
+    for (ssize_t offset = 0; offset < length;)
+    {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      if ((event->mask & IN_OPEN) && event->len > 0 && name == event->name)
+      {
+        opened = true;
+      }
+      offset += sizeof(inotify_event) + event->len;
+    }
+  }
+  return opened;
+}
+
+bool CheckReadAhead(int fd, const std::string& name, bool expected, const char* label)
+{
+  if (WasOpened(fd, name) != expected)
+  {
+    cerr << label << ": " << name << (expected ? " was not" : " was") << " read ahead." << endl;
+    return false;
+  }
+  return true;
+}
+#endif
+}
+
+int TestFileSeriesReaderReadAhead(int argc, char* argv[])
+{
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  const std::string dir = std::string(tempDir) + "/TestFileSeriesReaderReadAhead";
+  delete[] tempDir;
+
+  vtkDirectory::DeleteDirectory(dir.c_str());
+  vtkDirectory::MakeDirectory(dir.c_str());
+
+  const int numFiles = 5;
+  std::vector<std::string> fnames;
+  for (int cc = 0; cc < numFiles; ++cc)
+  {
+    std::ostringstream fname;
+    fname << dir << "/step_" << cc;
+    fnames.push_back(fname.str());
+    std::ofstream file(fname.str().c_str());
+    file << cc << endl;
+  }
+
+  vtkClientServerInterpreterInitializer::GetGlobalInterpreter()->AddCommandFunction(
+    "vtkFileSeriesTestReader", vtkFileSeriesTestReaderCommand);
+
+  vtkNew<vtkFileSeriesTestReader> internalReader;
+  vtkNew<vtkFileSeriesReader> reader;
+  reader->SetReader(internalReader.GetPointer());
+  reader->SetFileNameMethod("SetFileName");
+  for (int cc = 0; cc < numFiles; ++cc)
+  {
+    reader->AddFileName(fnames[cc].c_str());
+  }
+  reader->CacheTimeInformationOn();
+
+  bool success = true;
+
+  // every file is queried once.
+  reader->UpdateInformation();
+  vtkInformation* outInfo = reader->GetOutputInformation(0);
+  if (outInfo->Length(vtkStreamingDemandDrivenPipeline::TIME_STEPS()) != numFiles)
+  {
+    cerr << "Expected " << numFiles << " time steps." << endl;
+    success = false;
+  }
+  success = CheckPasses(internalReader.GetPointer(), numFiles, "First pass") && success;
+
+  // only the first file, which sets up the output information, is queried
+  // again.
+  internalReader->NumberOfInformationPasses = 0;
+  reader->Modified();
+  reader->UpdateInformation();
+  success = CheckPasses(internalReader.GetPointer(), 1, "Cached pass") && success;
+
+  // a file that changed on disk is queried again.
+  {
+    std::ofstream file(fnames[3].c_str(), std::ios::app);
+    file << "more data" << endl;
+  }
+  internalReader->NumberOfInformationPasses = 0;
+  reader->Modified();
+  reader->UpdateInformation();
+  success = CheckPasses(internalReader.GetPointer(), 2, "Changed file") && success;
+
+  // modifying the internal reader may change the time information of all the
+  // files.
+  internalReader->NumberOfInformationPasses = 0;
+  internalReader->Modified();
+  reader->UpdateInformation();
+  success = CheckPasses(internalReader.GetPointer(), numFiles, "Modified reader") && success;
+
+#if defined(__linux__) && defined(POSIX_FADV_WILLNEED)
+  int fd = inotify_init1(IN_NONBLOCK);
+  if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_OPEN) < 0)
+  {
+    cerr << "Failed to watch " << dir << endl;
+    success = false;
+  }
+  else
+  {
+    // nothing is read ahead unless asked for.
+    reader->UpdateTimeStep(0);
+    success = CheckReadAhead(fd, "step_1", false, "No read-ahead") && success;
+
+    // reading forward reads the next file ahead, reading backward the
+    // previous.
+    reader->ReadAheadOn();
+    reader->UpdateTimeStep(1);
+    success = CheckReadAhead(fd, "step_2", true, "Forward") && success;
+    reader->UpdateTimeStep(4);
+    success = CheckReadAhead(fd, "step_3", false, "Last step") && success;
+    reader->UpdateTimeStep(3);
+    success = CheckReadAhead(fd, "step_2", true, "Backward") && success;
+  }
+  if (fd >= 0)
+  {
+    close(fd);
+  }
+#endif
+
+  reader->SetReader(nullptr);
+  vtkDirectory::DeleteDirectory(dir.c_str());
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
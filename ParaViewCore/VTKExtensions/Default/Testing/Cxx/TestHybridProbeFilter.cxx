@@ -0,0 +1,220 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestHybridProbeFilter.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Probes tetrahedra at moving locations and at a batch of random locations,
+// compares with vtkProbeFilter, checks that the cell locator is only rebuilt
+// when the points change, and extracts the cell containing a location.
+
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkHybridProbeFilter.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkProbeFilter.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+#include "vtkWeakPointer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+bool Compare(vtkDataSet* expected, vtkDataSet* result)
+{
+  if (expected->GetNumberOfPoints() != result->GetNumberOfPoints())
+  {
+    cerr << "Expected " << expected->GetNumberOfPoints() << " points, got "
+         << result->GetNumberOfPoints() << endl;
+    return false;
+  }
+  vtkDataArray* expectedMask = expected->GetPointData()->GetArray("vtkValidPointMask");
+  vtkDataArray* mask = result->GetPointData()->GetArray("vtkValidPointMask");
+  vtkDataArray* expectedRTData = expected->GetPointData()->GetArray("RTData");
+  vtkDataArray* rtdata = result->GetPointData()->GetArray("RTData");
+  if (!mask || !rtdata)
+  {
+    cerr << "Missing vtkValidPointMask or RTData." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < expected->GetNumberOfPoints(); ++cc)
+  {
+    if (expectedMask->GetComponent(cc, 0) != mask->GetComponent(cc, 0))
+    {
+      cerr << "Mismatched vtkValidPointMask at point " << cc << endl;
+      return false;
+    }
+    const double a = expectedRTData->GetComponent(cc, 0);
+    const double b = rtdata->GetComponent(cc, 0);
+    if (std::abs(a - b) > 1e-4 * std::max(1.0, std::abs(a)))
+    {
+      cerr << "Expected RTData " << a << " at point " << cc << ", got " << b << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ProbeAt(vtkHybridProbeFilter* probe, vtkDataSet* input, double x, double y, double z)
+{
+  probe->SetLocation(x, y, z);
+  probe->Update();
+
+  vtkNew<vtkPoints> points;
+  points->InsertNextPoint(x, y, z);
+  vtkNew<vtkPolyData> location;
+  location->SetPoints(points.GetPointer());
+  vtkNew<vtkProbeFilter> reference;
+  reference->SetInputData(location.GetPointer());
+  reference->SetSourceData(input);
+  reference->Update();
+  return Compare(
+    reference->GetOutput(), vtkDataSet::SafeDownCast(probe->GetOutputDataObject(0)));
+}
+}
+
+int TestHybridProbeFilter(int, char* [])
+{
+  vtkNew<vtkRTAnalyticSource> wavelet;
+  wavelet->SetWholeExtent(-20, 20, -20, 20, -20, 20);
+  vtkNew<vtkDataSetTriangleFilter> tetrahedralize;
+  tetrahedralize->SetInputConnection(wavelet->GetOutputPort());
+  tetrahedralize->Update();
+  vtkNew<vtkUnstructuredGrid> tets;
+  tets->ShallowCopy(tetrahedralize->GetOutput());
+
+  // moving the location reuses the locator.
+  vtkNew<vtkHybridProbeFilter> probe;
+  probe->SetInputData(tets.GetPointer());
+  probe->SetModeToInterpolateAtLocation();
+  const double locations[][3] = { { 0.5, 0.25, 0.125 }, { -7.3, 4.1, 12.9 }, { 19.5, -19.5, 0 },
+    { 30, 0, 0 } };
+  for (size_t cc = 0; cc < sizeof(locations) / sizeof(locations[0]); ++cc)
+  {
+    if (!ProbeAt(probe.GetPointer(), tets.GetPointer(), locations[cc][0], locations[cc][1],
+          locations[cc][2]))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  if (probe->GetNumberOfLocatorBuilds() != 1)
+  {
+    cerr << "Expected 1 locator build, got " << probe->GetNumberOfLocatorBuilds() << endl;
+    return EXIT_FAILURE;
+  }
+
+  // changing the attributes only reuses it too, moving the points does not.
+  tets->GetPointData()->GetArray("RTData")->Modified();
+  tets->Modified();
+  if (!ProbeAt(probe.GetPointer(), tets.GetPointer(), 1, 2, 3) ||
+    probe->GetNumberOfLocatorBuilds() != 1)
+  {
+    cerr << "Expected the locator to be reused when attributes change." << endl;
+    return EXIT_FAILURE;
+  }
+  tets->GetPoints()->Modified();
+  tets->Modified();
+  if (!ProbeAt(probe.GetPointer(), tets.GetPointer(), 1, 2, 3) ||
+    probe->GetNumberOfLocatorBuilds() != 2)
+  {
+    cerr << "Expected the locator to be rebuilt when points change." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // a batch of random locations.
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  vtkNew<vtkPoints> batch;
+  batch->SetDataTypeToDouble();
+  for (int cc = 0; cc < 100000; ++cc)
+  {
+    double x[3];
+    for (int k = 0; k < 3; ++k)
+    {
+      random->Next();
+      x[k] = random->GetRangeValue(-19.99, 19.99);
+    }
+    batch->InsertNextPoint(x);
+  }
+  vtkNew<vtkTimerLog> timer;
+  probe->SetLocations(batch.GetPointer());
+  timer->StartTimer();
+  probe->Update();
+  timer->StopTimer();
+  const double batchTime = timer->GetElapsedTime();
+
+  vtkNew<vtkPolyData> batchInput;
+  batchInput->SetPoints(batch.GetPointer());
+  vtkNew<vtkProbeFilter> reference;
+  reference->SetInputData(batchInput.GetPointer());
+  reference->SetSourceData(tets.GetPointer());
+  timer->StartTimer();
+  reference->Update();
+  timer->StopTimer();
+  if (!Compare(
+        reference->GetOutput(), vtkDataSet::SafeDownCast(probe->GetOutputDataObject(0))))
+  {
+    return EXIT_FAILURE;
+  }
+  cout << batch->GetNumberOfPoints() << " locations: " << timer->GetElapsedTime()
+       << " seconds with vtkProbeFilter, " << batchTime << " seconds with the cached locator."
+       << endl;
+
+  // extract the cell containing a location.
+  probe->SetLocations(nullptr);
+  probe->SetModeToExtractCellContainingLocation();
+  probe->SetLocation(0.5, 0.25, 0.125);
+  probe->Update();
+  vtkDataSet* cell = vtkDataSet::SafeDownCast(probe->GetOutputDataObject(0));
+  double bounds[6];
+  cell->GetBounds(bounds);
+  if (cell->GetNumberOfCells() != 1 || bounds[0] > 0.5 || bounds[1] < 0.5 ||
+    bounds[2] > 0.25 || bounds[3] < 0.25 || bounds[4] > 0.125 || bounds[5] < 0.125)
+  {
+    cerr << "Expected the cell containing the location." << endl;
+    return EXIT_FAILURE;
+  }
+  if (probe->GetNumberOfLocatorBuilds() != 2)
+  {
+    cerr << "Expected the extraction to reuse the locator." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // a new input gets its own locator, and the locator of the previous input
+  // does not keep it alive.
+  vtkWeakPointer<vtkUnstructuredGrid> previous;
+  {
+    vtkNew<vtkUnstructuredGrid> copy;
+    copy->ShallowCopy(tets.GetPointer());
+    previous = copy.GetPointer();
+    probe->SetInputData(copy.GetPointer());
+    probe->Update();
+  }
+  if (probe->GetNumberOfLocatorBuilds() != 3)
+  {
+    cerr << "Expected the locator to be rebuilt for a new input." << endl;
+    return EXIT_FAILURE;
+  }
+  probe->SetInputConnection(wavelet->GetOutputPort());
+  probe->Update();
+  if (previous.GetPointer() != nullptr || probe->GetNumberOfLocatorBuilds() != 3)
+  {
+    cerr << "Expected the locator of the previous input to be released." << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestIsoVolume.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares the single pass clip of vtkIsoVolume with clipping the input at
+// the lower threshold then at the upper threshold with vtkPVClipDataSet, on
+// image data, tetrahedra, hexahedra and a multiblock of image data and
+// tetrahedra.
+//
+// The clip array is linear so that the volumes and integrals do not depend
+// on how the cells are split. Image data and hexahedra are compared with the
+// clips of their tetrahedra. Hexahedra must also be split the way
+// vtkDataSetTriangleFilter splits them, so that neighbors share their faces.
+
+#include "vtkCellData.h"
+#include "vtkCompositeDataPipeline.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkIntegrateAttributes.h"
+#include "vtkIsoVolume.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPVClipDataSet.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+
+namespace
+{
+// The band is narrower than the range of the array on most voxels.
+const double Lower = -4.5;
+const double Upper = 6.5;
+
+vtkSmartPointer<vtkDataObject> ClipTwice(vtkDataObject* input)
+{
+  vtkSmartPointer<vtkDataObject> output = input;
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    vtkNew<vtkPVClipDataSet> clipper;
+    vtkNew<vtkCompositeDataPipeline> executive;
+    clipper->SetExecutive(executive.GetPointer());
+    clipper->UseAMRDualClipForAMROff();
+    clipper->SetInputData(output);
+    clipper->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "Linear");
+    clipper->SetValue(cc == 0 ? Lower : Upper);
+    clipper->SetInsideOut(cc == 0 ? 0 : 1);
+    clipper->Update();
+    output = clipper->GetOutputDataObject(0);
+  }
+  return output;
+}
+
+double Volume(vtkDataObject* data)
+{
+  vtkNew<vtkIntegrateAttributes> integrate;
+  integrate->SetInputData(data);
+  integrate->Update();
+  vtkDataArray* volume = integrate->GetOutput()->GetCellData()->GetArray("Volume");
+  return volume ? volume->GetComponent(0, 0) : 0.0;
+}
+
+double Integrated(vtkDataObject* data)
+{
+  vtkNew<vtkIntegrateAttributes> integrate;
+  integrate->SetInputData(data);
+  integrate->Update();
+  vtkDataArray* linear = integrate->GetOutput()->GetPointData()->GetArray("Linear");
+  return linear ? linear->GetComponent(0, 0) : 0.0;
+}
+
+vtkSmartPointer<vtkDataObject> IsoVolume(vtkDataObject* input)
+{
+  vtkNew<vtkIsoVolume> isoVolume;
+  isoVolume->SetInputData(input);
+  isoVolume->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "Linear");
+  isoVolume->ThresholdBetween(Lower, Upper);
+  isoVolume->Update();
+  return isoVolume->GetOutputDataObject(0);
+}
+
+// Clips input with vtkIsoVolume and reference, made of the same cells as
+// input or of their tetrahedra, with two clips.
+bool Compare(const char* name, vtkDataObject* input, vtkDataObject* reference)
+{
+  const double tolerance = 1e-6;
+  vtkSmartPointer<vtkDataObject> expected = ClipTwice(reference);
+  vtkSmartPointer<vtkDataObject> output = IsoVolume(input);
+  if (!output->IsA(expected->GetClassName()))
+  {
+    cerr << name << ": expected a " << expected->GetClassName() << ", got a "
+         << output->GetClassName() << endl;
+    return false;
+  }
+
+  const double expectedVolume = Volume(expected);
+  const double volume = Volume(output);
+  if (expectedVolume <= 0.0 || std::abs(volume - expectedVolume) > tolerance * expectedVolume)
+  {
+    cerr << name << ": expected a volume of " << expectedVolume << ", got " << volume << endl;
+    return false;
+  }
+
+  const double expectedIntegral = Integrated(expected);
+  const double integral = Integrated(output);
+  if (std::abs(integral - expectedIntegral) > tolerance * std::abs(expectedIntegral))
+  {
+    cerr << name << ": expected an integrated Linear of " << expectedIntegral << ", got "
+         << integral << endl;
+    return false;
+  }
+
+  if (vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(output))
+  {
+    double range[2];
+    grid->GetPointData()->GetArray("Linear")->GetRange(range);
+    const double epsilon = 1e-3 * (Upper - Lower);
+    if (range[0] < Lower - epsilon || range[1] > Upper + epsilon)
+    {
+      cerr << name << ": Linear range [" << range[0] << ", " << range[1] << "] is not within ["
+           << Lower << ", " << Upper << "]" << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// The hexahedra of the voxels of image.
+vtkSmartPointer<vtkUnstructuredGrid> Hexahedra(vtkImageData* image)
+{
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(image->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < image->GetNumberOfPoints(); ++cc)
+  {
+    points->SetPoint(cc, image->GetPoint(cc));
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> hexahedra = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  hexahedra->SetPoints(points.GetPointer());
+  hexahedra->Allocate(image->GetNumberOfCells());
+  vtkNew<vtkIdList> voxel;
+  for (vtkIdType cc = 0; cc < image->GetNumberOfCells(); ++cc)
+  {
+    image->GetCellPoints(cc, voxel.GetPointer());
+    const vtkIdType hexahedron[8] = { voxel->GetId(0), voxel->GetId(1), voxel->GetId(3),
+      voxel->GetId(2), voxel->GetId(4), voxel->GetId(5), voxel->GetId(7), voxel->GetId(6) };
+    hexahedra->InsertNextCell(VTK_HEXAHEDRON, 8, hexahedron);
+  }
+  hexahedra->GetPointData()->PassData(image->GetPointData());
+  return hexahedra;
+}
+
+// Neighbor hexahedra split their shared face along the same diagonal when
+// they are split like vtkDataSetTriangleFilter does, so the single pass clip
+// of the hexahedra and of their tetrahedra cut the same edges.
+bool CompareSplits(vtkUnstructuredGrid* hexahedra, vtkUnstructuredGrid* tets)
+{
+  vtkSmartPointer<vtkDataObject> expected = IsoVolume(tets);
+  vtkSmartPointer<vtkDataObject> output = IsoVolume(hexahedra);
+  vtkDataSet* expectedGrid = vtkDataSet::SafeDownCast(expected);
+  vtkDataSet* grid = vtkDataSet::SafeDownCast(output);
+  if (!expectedGrid || !grid || grid->GetNumberOfPoints() != expectedGrid->GetNumberOfPoints() ||
+    grid->GetNumberOfCells() != expectedGrid->GetNumberOfCells())
+  {
+    cerr << "Hexahedra: expected " << (expectedGrid ? expectedGrid->GetNumberOfPoints() : 0)
+         << " points and " << (expectedGrid ? expectedGrid->GetNumberOfCells() : 0)
+         << " cells as with their tetrahedra, got " << (grid ? grid->GetNumberOfPoints() : 0)
+         << " and " << (grid ? grid->GetNumberOfCells() : 0) << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestIsoVolume(int, char* [])
+{
+  vtkNew<vtkRTAnalyticSource> wavelet;
+  wavelet->SetWholeExtent(-20, 20, -20, 20, -20, 20);
+  wavelet->Update();
+  vtkNew<vtkImageData> image;
+  image->ShallowCopy(wavelet->GetOutput());
+
+  vtkNew<vtkDoubleArray> linear;
+  linear->SetName("Linear");
+  linear->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < image->GetNumberOfPoints(); ++cc)
+  {
+    double x[3];
+    image->GetPoint(cc, x);
+    linear->SetValue(cc, 7.0 * x[0] + 5.0 * x[1] + 3.0 * x[2]);
+  }
+  image->GetPointData()->AddArray(linear.GetPointer());
+
+  vtkNew<vtkDataSetTriangleFilter> tetrahedralize;
+  tetrahedralize->SetInputData(image.GetPointer());
+  tetrahedralize->Update();
+  vtkUnstructuredGrid* tets = tetrahedralize->GetOutput();
+
+  vtkNew<vtkMultiBlockDataSet> multiblock;
+  multiblock->SetNumberOfBlocks(2);
+  multiblock->SetBlock(0, image.GetPointer());
+  multiblock->SetBlock(1, tets);
+
+  vtkNew<vtkMultiBlockDataSet> multiblockTets;
+  multiblockTets->SetNumberOfBlocks(2);
+  multiblockTets->SetBlock(0, tets);
+  multiblockTets->SetBlock(1, tets);
+
+  vtkSmartPointer<vtkUnstructuredGrid> hexahedra = Hexahedra(image.GetPointer());
+  vtkNew<vtkDataSetTriangleFilter> tetrahedralizeHexahedra;
+  tetrahedralizeHexahedra->SetInputData(hexahedra);
+  tetrahedralizeHexahedra->Update();
+  vtkUnstructuredGrid* hexahedraTets = tetrahedralizeHexahedra->GetOutput();
+
+  if (!Compare("Image data", image.GetPointer(), tets) || !Compare("Tetrahedra", tets, tets) ||
+    !Compare("Hexahedra", hexahedra, hexahedraTets) ||
+    !CompareSplits(hexahedra, hexahedraTets) ||
+    !Compare("Multiblock", multiblock.GetPointer(), multiblockTets.GetPointer()))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
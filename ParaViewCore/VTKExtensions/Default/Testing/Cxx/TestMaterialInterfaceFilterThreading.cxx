@@ -0,0 +1,191 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMaterialInterfaceFilterThreading.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Verifies that labeling the fragments concurrently gives the same fragments,
+// ids and volumes as labeling them one block after the other.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkDataArray.h"
+#include "vtkDummyController.h"
+#include "vtkMaterialInterfaceFilter.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSpyPlotReader.h"
+#include "vtkTestUtilities.h"
+
+#include <cstring>
+
+namespace
+{
+bool SameArray(vtkDataArray* a, vtkDataArray* b)
+{
+  if (a == nullptr || b == nullptr)
+  {
+    return a == b;
+  }
+  if (a->GetDataType() != b->GetDataType() ||
+    a->GetNumberOfComponents() != b->GetNumberOfComponents() ||
+    a->GetNumberOfTuples() != b->GetNumberOfTuples())
+  {
+    return false;
+  }
+  const size_t size =
+    static_cast<size_t>(a->GetNumberOfTuples()) * a->GetNumberOfComponents() * a->GetDataTypeSize();
+  return size == 0 || memcmp(a->GetVoidPointer(0), b->GetVoidPointer(0), size) == 0;
+}
+
+bool SameAttributes(vtkDataSetAttributes* a, vtkDataSetAttributes* b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+  {
+    return false;
+  }
+  for (int cc = 0; cc < a->GetNumberOfArrays(); ++cc)
+  {
+    if (!SameArray(a->GetArray(cc), b->GetArray(cc)))
+    {
+      cerr << "Array '" << (a->GetArray(cc) ? a->GetArray(cc)->GetName() : "(null)")
+           << "' differs." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compares the polydata leaves of two outputs and returns the number of
+// leaves, or -1 if they differ.
+int CompareOutputs(vtkDataObject* serial, vtkDataObject* threaded)
+{
+  vtkMultiBlockDataSet* serialMB = vtkMultiBlockDataSet::SafeDownCast(serial);
+  vtkMultiBlockDataSet* threadedMB = vtkMultiBlockDataSet::SafeDownCast(threaded);
+  if (!serialMB || !threadedMB)
+  {
+    cerr << "Expected multiblock outputs." << endl;
+    return -1;
+  }
+
+  vtkSmartPointer<vtkCompositeDataIterator> serialIter;
+  serialIter.TakeReference(serialMB->NewIterator());
+  vtkSmartPointer<vtkCompositeDataIterator> threadedIter;
+  threadedIter.TakeReference(threadedMB->NewIterator());
+  int numLeaves = 0;
+  for (serialIter->InitTraversal(), threadedIter->InitTraversal();
+       !serialIter->IsDoneWithTraversal() && !threadedIter->IsDoneWithTraversal();
+       serialIter->GoToNextItem(), threadedIter->GoToNextItem())
+  {
+    if (serialIter->GetCurrentFlatIndex() != threadedIter->GetCurrentFlatIndex())
+    {
+      cerr << "Fragment ids differ." << endl;
+      return -1;
+    }
+    vtkPolyData* a = vtkPolyData::SafeDownCast(serialIter->GetCurrentDataObject());
+    vtkPolyData* b = vtkPolyData::SafeDownCast(threadedIter->GetCurrentDataObject());
+    if (!a || !b)
+    {
+      cerr << "Expected polydata leaves." << endl;
+      return -1;
+    }
+    if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfCells() != b->GetNumberOfCells())
+    {
+      cerr << "Size mismatch: " << a->GetNumberOfPoints() << "/" << a->GetNumberOfCells()
+           << " points/cells vs " << b->GetNumberOfPoints() << "/" << b->GetNumberOfCells()
+           << endl;
+      return -1;
+    }
+    if (a->GetNumberOfPoints() > 0 &&
+      !SameArray(a->GetPoints()->GetData(), b->GetPoints()->GetData()))
+    {
+      cerr << "Point coordinates differ." << endl;
+      return -1;
+    }
+    if (!SameArray(a->GetPolys()->GetData(), b->GetPolys()->GetData()))
+    {
+      cerr << "Polygons differ." << endl;
+      return -1;
+    }
+    if (!SameAttributes(a->GetPointData(), b->GetPointData()) ||
+      !SameAttributes(a->GetCellData(), b->GetCellData()))
+    {
+      return -1;
+    }
+    ++numLeaves;
+  }
+  if (!serialIter->IsDoneWithTraversal() || !threadedIter->IsDoneWithTraversal())
+  {
+    cerr << "Number of fragments differ." << endl;
+    return -1;
+  }
+  return numLeaves;
+}
+}
+
+int TestMaterialInterfaceFilterThreading(int argc, char* argv[])
+{
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  char* fname = vtkTestUtilities::ExpandDataFileName(argc, argv, "SPCTH/spcth.0");
+  vtkNew<vtkSpyPlotReader> reader;
+  reader->SetFileName(fname);
+  reader->SetGlobalController(controller.GetPointer());
+  reader->MergeXYZComponentsOn();
+  reader->DownConvertVolumeFractionOn();
+  reader->DistributeFilesOn();
+  reader->SetCellArrayStatus("Material volume fraction - 2", 1);
+  reader->Update();
+  delete[] fname;
+
+  // output 0 holds the fragments, output 1 their ids, volumes and centers.
+  vtkSmartPointer<vtkDataObject> fragments[2];
+  vtkSmartPointer<vtkDataObject> statistics[2];
+  for (int threaded = 0; threaded < 2; ++threaded)
+  {
+    vtkNew<vtkMaterialInterfaceFilter> filter;
+    filter->SetInputData(reader->GetOutputDataObject(0));
+    filter->SelectMaterialArray("Material volume fraction - 2");
+    filter->SetMaterialFractionThreshold(0.5);
+    filter->SetUseThreading(threaded != 0);
+    filter->Update();
+    fragments[threaded] = filter->GetOutputDataObject(0);
+    statistics[threaded] = filter->GetOutputDataObject(1);
+  }
+
+  int status = EXIT_SUCCESS;
+  const int numFragments = CompareOutputs(fragments[0], fragments[1]);
+  if (numFragments < 0)
+  {
+    cerr << "Threaded fragments differ from serial fragments." << endl;
+    status = EXIT_FAILURE;
+  }
+  else if (numFragments < 2)
+  {
+    cerr << "Expected several fragments, got " << numFragments << "." << endl;
+    status = EXIT_FAILURE;
+  }
+  if (CompareOutputs(statistics[0], statistics[1]) < 0)
+  {
+    cerr << "Threaded fragment ids or volumes differ from serial ones." << endl;
+    status = EXIT_FAILURE;
+  }
+
+  vtkMultiProcessController::SetGlobalController(nullptr);
+  return status;
+}
@@ -0,0 +1,238 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVGlyphFilter.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Glyphs a wavelet with spheres scaled by RTData and oriented along the point
+// coordinates, checks the glyphs against transforming the sphere one point at
+// a time with a vtkTransform, checks the number of glyphs of each glyph mode
+// and that running the filter again gives the same output.
+
+#include "vtkCellArray.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPVGlyphFilter.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSphereSource.h"
+#include "vtkTransform.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const double ScaleFactor = 0.001;
+
+void Glyph(vtkPVGlyphFilter* glyph, vtkImageData* input, vtkPolyData* source, int mode)
+{
+  glyph->SetInputData(0, input);
+  glyph->SetInputData(1, source);
+  glyph->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "RTData");
+  glyph->SetInputArrayToProcess(1, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "Coords");
+  glyph->SetScaleFactor(ScaleFactor);
+  glyph->SetGlyphMode(mode);
+  glyph->SetStride(7);
+  glyph->SetMaximumNumberOfSamplePoints(500);
+  glyph->Update();
+}
+
+bool Near(const double* a, const double* b, double tolerance)
+{
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    if (std::abs(a[cc] - b[cc]) > tolerance * std::max(1.0, std::abs(a[cc])))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CheckGlyphs(vtkImageData* input, vtkPolyData* source, vtkPolyData* output)
+{
+  const vtkIdType numSourcePts = source->GetNumberOfPoints();
+  vtkDataArray* rtdata = input->GetPointData()->GetArray("RTData");
+  vtkDataArray* coords = input->GetPointData()->GetArray("Coords");
+  vtkDataArray* normals = output->GetPointData()->GetNormals();
+  vtkDataArray* outRTData = output->GetPointData()->GetArray("RTData");
+  if (output->GetNumberOfPoints() != input->GetNumberOfPoints() * numSourcePts ||
+    output->GetNumberOfPolys() != input->GetNumberOfPoints() * source->GetNumberOfPolys() ||
+    !normals || !outRTData)
+  {
+    cerr << "Unexpected output size or missing point data." << endl;
+    return false;
+  }
+
+  vtkNew<vtkIdList> sourceCell;
+  source->GetPolys()->InitTraversal();
+  output->GetPolys()->InitTraversal();
+  for (vtkIdType ptId = 0; ptId < input->GetNumberOfPoints(); ++ptId)
+  {
+    double x[3];
+    input->GetPoint(ptId, x);
+    double v[3];
+    coords->GetTuple(ptId, v);
+    const double vMag = vtkMath::Norm(v);
+
+    vtkNew<vtkTransform> trans;
+    trans->Translate(x);
+    if (vMag > 0.0 && (v[1] != 0.0 || v[2] != 0.0))
+    {
+      trans->RotateWXYZ(180.0, (v[0] + vMag) / 2.0, v[1] / 2.0, v[2] / 2.0);
+    }
+    else if (v[0] < 0.0)
+    {
+      trans->RotateWXYZ(180.0, 0, 1, 0);
+    }
+    const double scale = rtdata->GetComponent(ptId, 0) * ScaleFactor;
+    trans->Scale(scale, scale, scale);
+
+    for (vtkIdType cc = 0; cc < numSourcePts; ++cc)
+    {
+      const vtkIdType outPtId = ptId * numSourcePts + cc;
+      double expected[3], result[3];
+      trans->TransformPoint(source->GetPoint(cc), expected);
+      output->GetPoint(outPtId, result);
+      if (!Near(expected, result, 1e-5))
+      {
+        cerr << "Unexpected point " << outPtId << ": (" << result[0] << ", " << result[1] << ", "
+             << result[2] << "), expected (" << expected[0] << ", " << expected[1] << ", "
+             << expected[2] << ")" << endl;
+        return false;
+      }
+      trans->TransformNormal(source->GetPointData()->GetNormals()->GetTuple(cc), expected);
+      normals->GetTuple(outPtId, result);
+      if (!Near(expected, result, 1e-5))
+      {
+        cerr << "Unexpected normal at point " << outPtId << endl;
+        return false;
+      }
+      if (outRTData->GetComponent(outPtId, 0) != rtdata->GetComponent(ptId, 0))
+      {
+        cerr << "Unexpected RTData at point " << outPtId << endl;
+        return false;
+      }
+    }
+
+    for (vtkIdType cc = 0; cc < source->GetNumberOfPolys(); ++cc)
+    {
+      vtkIdType npts, *pts;
+      source->GetPolys()->GetNextCell(npts, pts);
+      sourceCell->SetNumberOfIds(npts);
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        sourceCell->SetId(i, pts[i] + ptId * numSourcePts);
+      }
+      output->GetPolys()->GetNextCell(npts, pts);
+      if (npts != sourceCell->GetNumberOfIds())
+      {
+        cerr << "Unexpected cell size for glyph " << ptId << endl;
+        return false;
+      }
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        if (pts[i] != sourceCell->GetId(i))
+        {
+          cerr << "Unexpected cell for glyph " << ptId << endl;
+          return false;
+        }
+      }
+    }
+    source->GetPolys()->InitTraversal();
+  }
+  return true;
+}
+
+bool SameOutput(vtkPolyData* a, vtkPolyData* b)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints())
+  {
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < a->GetNumberOfPoints(); ++cc)
+  {
+    double pa[3], pb[3];
+    a->GetPoint(cc, pa);
+    b->GetPoint(cc, pb);
+    if (pa[0] != pb[0] || pa[1] != pb[1] || pa[2] != pb[2])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestPVGlyphFilter(int, char* [])
+{
+  vtkNew<vtkRTAnalyticSource> wavelet;
+  wavelet->SetWholeExtent(-20, 20, -20, 20, -20, 20);
+  wavelet->Update();
+  vtkNew<vtkImageData> image;
+  image->ShallowCopy(wavelet->GetOutput());
+
+  // orientation along the point coordinates, which covers the glyphs oriented
+  // along the negative and positive x axis.
+  vtkNew<vtkDoubleArray> coords;
+  coords->SetName("Coords");
+  coords->SetNumberOfComponents(3);
+  coords->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < image->GetNumberOfPoints(); ++cc)
+  {
+    coords->SetTuple(cc, image->GetPoint(cc));
+  }
+  image->GetPointData()->AddArray(coords.GetPointer());
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->Update();
+  vtkPolyData* source = sphere->GetOutput();
+
+  vtkNew<vtkPVGlyphFilter> allPoints;
+  Glyph(allPoints.GetPointer(), image.GetPointer(), source, vtkPVGlyphFilter::ALL_POINTS);
+  if (!CheckGlyphs(image.GetPointer(), source,
+        vtkPolyData::SafeDownCast(allPoints->GetOutputDataObject(0))))
+  {
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkPVGlyphFilter> everyNthPoint;
+  Glyph(everyNthPoint.GetPointer(), image.GetPointer(), source, vtkPVGlyphFilter::EVERY_NTH_POINT);
+  const vtkIdType numStrided = (image->GetNumberOfPoints() + 6) / 7;
+  if (vtkPolyData::SafeDownCast(everyNthPoint->GetOutputDataObject(0))->GetNumberOfPoints() !=
+    numStrided * source->GetNumberOfPoints())
+  {
+    cerr << "Expected " << numStrided << " glyphs with a stride of 7." << endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkPVGlyphFilter> uniform;
+  Glyph(uniform.GetPointer(), image.GetPointer(), source,
+    vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION);
+  vtkNew<vtkPVGlyphFilter> uniformAgain;
+  Glyph(uniformAgain.GetPointer(), image.GetPointer(), source,
+    vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION);
+  vtkPolyData* uniformOutput = vtkPolyData::SafeDownCast(uniform->GetOutputDataObject(0));
+  const vtkIdType numSampled = uniformOutput->GetNumberOfPoints() / source->GetNumberOfPoints();
+  if (numSampled == 0 || numSampled > 500 ||
+    !SameOutput(uniformOutput, vtkPolyData::SafeDownCast(uniformAgain->GetOutputDataObject(0))))
+  {
+    cerr << "Unexpected spatially uniform glyphs: " << numSampled << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,297 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVPostFilterComponentArrays.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Requests a component and the magnitude of a vector array through
+// vtkPVPostFilter and checks that the read-only views it adds give the same
+// values, tuples, lookups and iterators as arrays holding a copy of the
+// component and of the magnitude. Also contours an image by a component,
+// which needs the values of the view in contiguous memory.
+
+#include "vtkAlgorithm.h"
+#include "vtkArrayIteratorTemplate.h"
+#include "vtkCallbackCommand.h"
+#include "vtkCommand.h"
+#include "vtkDataObject.h"
+#include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkNew.h"
+#include "vtkPVContourFilter.h"
+#include "vtkPVPostFilter.h"
+#include "vtkPVPostFilterExecutive.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkVariant.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+// Vectors with integral magnitudes so that lookups by value are exact.
+const float Vectors[5][3] = { { 3, 4, 0 }, { 1, 2, 2 }, { 2, 3, 6 }, { 4, 4, 7 }, { 0, 0, -5 } };
+const vtkIdType NumberOfPoints = 40;
+
+vtkSmartPointer<vtkPolyData> MakeInput()
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(NumberOfPoints);
+  for (vtkIdType cc = 0; cc < NumberOfPoints; ++cc)
+  {
+    points->InsertNextPoint(cc, 0, 0);
+    const float scale = static_cast<float>(cc % 4 + 1);
+    const float* vector = Vectors[cc % 5];
+    vectors->SetTuple3(cc, scale * vector[0], scale * vector[1], scale * vector[2]);
+  }
+
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  data->SetPoints(points.GetPointer());
+  data->GetPointData()->AddArray(vectors.GetPointer());
+  return data;
+}
+
+// Copies a component, or the magnitude for component -1, of source as the
+// filter did before it added views.
+vtkSmartPointer<vtkDataArray> CopyComponent(vtkDataArray* source, int component)
+{
+  vtkSmartPointer<vtkDataArray> copy;
+  if (component == -1)
+  {
+    copy = vtkSmartPointer<vtkDoubleArray>::New();
+    copy->SetNumberOfTuples(source->GetNumberOfTuples());
+    for (vtkIdType cc = 0; cc < source->GetNumberOfTuples(); ++cc)
+    {
+      double mag = 0.0;
+      double* tuple = source->GetTuple(cc);
+      for (int comp = 0; comp < source->GetNumberOfComponents(); ++comp)
+      {
+        mag += tuple[comp] * tuple[comp];
+      }
+      copy->SetTuple1(cc, std::sqrt(mag));
+    }
+  }
+  else
+  {
+    copy.TakeReference(source->NewInstance());
+    copy->SetNumberOfTuples(source->GetNumberOfTuples());
+    copy->CopyComponent(0, source, component);
+  }
+  return copy;
+}
+
+template <class T>
+bool CompareIterator(const char* name, vtkDataArray* view, vtkDataArray* copy)
+{
+  vtkArrayIterator* iter = view->NewIterator();
+  vtkArrayIteratorTemplate<T>* typedIter = vtkArrayIteratorTemplate<T>::SafeDownCast(iter);
+  bool success =
+    typedIter != nullptr && typedIter->GetNumberOfValues() == copy->GetNumberOfTuples();
+  for (vtkIdType cc = 0; success && cc < copy->GetNumberOfTuples(); ++cc)
+  {
+    success = static_cast<double>(typedIter->GetValue(cc)) == copy->GetTuple1(cc);
+  }
+  if (iter)
+  {
+    iter->Delete();
+  }
+  if (!success)
+  {
+    cerr << name << ": the iterator does not match the copy." << endl;
+  }
+  return success;
+}
+
+bool Compare(const char* name, vtkDataArray* view, vtkDataArray* copy)
+{
+  if (!view || view->GetNumberOfComponents() != 1 ||
+    view->GetNumberOfTuples() != copy->GetNumberOfTuples() ||
+    view->GetDataType() != copy->GetDataType())
+  {
+    cerr << name << ": missing or mismatched array." << endl;
+    return false;
+  }
+
+  vtkNew<vtkIdList> viewIds;
+  vtkNew<vtkIdList> copyIds;
+  for (vtkIdType cc = 0; cc < copy->GetNumberOfTuples(); ++cc)
+  {
+    const double expected = copy->GetTuple1(cc);
+    double tuple[1];
+    view->GetTuple(cc, tuple);
+    if (view->GetTuple(cc)[0] != expected || tuple[0] != expected ||
+      view->GetVariantValue(cc).ToDouble() != expected)
+    {
+      cerr << name << ": expected " << expected << " at tuple " << cc << endl;
+      return false;
+    }
+
+    const vtkVariant value = copy->GetVariantValue(cc);
+    if (view->LookupValue(value) != copy->LookupValue(value))
+    {
+      cerr << name << ": wrong lookup of " << expected << endl;
+      return false;
+    }
+    view->LookupValue(value, viewIds.GetPointer());
+    copy->LookupValue(value, copyIds.GetPointer());
+    bool sameIds = viewIds->GetNumberOfIds() == copyIds->GetNumberOfIds();
+    for (vtkIdType kk = 0; sameIds && kk < copyIds->GetNumberOfIds(); ++kk)
+    {
+      sameIds = viewIds->GetId(kk) == copyIds->GetId(kk);
+    }
+    if (!sameIds)
+    {
+      cerr << name << ": wrong ids for " << expected << endl;
+      return false;
+    }
+  }
+  if (view->LookupValue(vtkVariant(-1000.0)) != -1)
+  {
+    cerr << name << ": found a value which is not in the array." << endl;
+    return false;
+  }
+
+  return copy->GetDataType() == VTK_DOUBLE ? CompareIterator<double>(name, view, copy)
+                                           : CompareIterator<float>(name, view, copy);
+}
+
+void RequestArray(vtkPVPostFilter* filter, int idx, const char* name)
+{
+  vtkNew<vtkInformation> info;
+  info->Set(vtkAlgorithm::INPUT_PORT(), 0);
+  info->Set(vtkAlgorithm::INPUT_CONNECTION(), 0);
+  info->Set(vtkDataObject::FIELD_ASSOCIATION(), vtkDataObject::FIELD_ASSOCIATION_POINTS);
+  info->Set(vtkDataObject::FIELD_NAME(), name);
+  vtkPVPostFilterExecutive::SafeDownCast(filter->GetExecutive())
+    ->SetPostArrayToProcessInformation(idx, info.GetPointer());
+}
+
+void CountWarnings(vtkObject*, unsigned long, void* clientData, void*)
+{
+  ++*static_cast<int*>(clientData);
+}
+
+vtkSmartPointer<vtkPolyData> Contour(vtkDataObject* input)
+{
+  vtkNew<vtkPVContourFilter> contour;
+  contour->SetInputData(input);
+  contour->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "Vectors_Y");
+  contour->SetValue(0, 30.5);
+  contour->Update();
+  return vtkPolyData::SafeDownCast(contour->GetOutputDataObject(0));
+}
+
+// Contours an image by the Y component of its vectors through the view, as
+// when contouring by a component in the client, and through a copy of the
+// component. The contour filter reads the scalars as contiguous memory, which
+// the view must provide once and without warnings.
+bool CompareContour()
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(10, 10, 10);
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < image->GetNumberOfPoints(); ++cc)
+  {
+    double x[3];
+    image->GetPoint(cc, x);
+    vectors->SetTuple3(cc, x[0], x[0] * x[0] + x[1] * x[1] + x[2] * x[2], x[2]);
+  }
+  image->GetPointData()->AddArray(vectors.GetPointer());
+
+  vtkNew<vtkPVPostFilter> filter;
+  filter->SetInputData(image.GetPointer());
+  RequestArray(filter.GetPointer(), 0, "Vectors_Y");
+  filter->Update();
+  vtkDataObject* output = filter->GetOutputDataObject(0);
+  vtkDataArray* view = vtkDataSet::SafeDownCast(output)->GetPointData()->GetArray("Vectors_Y");
+  if (!view)
+  {
+    cerr << "Contour: missing Vectors_Y." << endl;
+    return false;
+  }
+
+  int numWarnings = 0;
+  vtkNew<vtkCallbackCommand> warningObserver;
+  warningObserver->SetCallback(CountWarnings);
+  warningObserver->SetClientData(&numWarnings);
+  view->AddObserver(vtkCommand::WarningEvent, warningObserver.GetPointer());
+
+  const vtkMTimeType mtime = view->GetMTime();
+  vtkSmartPointer<vtkPolyData> contour = Contour(output);
+
+  vtkSmartPointer<vtkDataArray> copy = CopyComponent(vectors.GetPointer(), 1);
+  copy->SetName("Vectors_Y");
+  vtkNew<vtkImageData> copyImage;
+  copyImage->CopyStructure(image.GetPointer());
+  copyImage->GetPointData()->AddArray(copy);
+  vtkSmartPointer<vtkPolyData> expected = Contour(copyImage.GetPointer());
+
+  if (!contour || !expected || expected->GetNumberOfCells() == 0 ||
+    contour->GetNumberOfPoints() != expected->GetNumberOfPoints() ||
+    contour->GetNumberOfCells() != expected->GetNumberOfCells())
+  {
+    cerr << "Contour: the contour of the view does not match the contour of the copy." << endl;
+    return false;
+  }
+
+  void* values = view->GetVoidPointer(0);
+  if (values != view->GetVoidPointer(0) ||
+    memcmp(values, copy->GetVoidPointer(0), copy->GetNumberOfTuples() * sizeof(float)) != 0)
+  {
+    cerr << "Contour: the view does not keep a copy of its values." << endl;
+    return false;
+  }
+  if (view->GetMTime() != mtime || numWarnings != 0)
+  {
+    cerr << "Contour: accessing the values modified the view or warned." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestPVPostFilterComponentArrays(int, char* [])
+{
+  vtkSmartPointer<vtkPolyData> input = MakeInput();
+  vtkDataArray* vectors = input->GetPointData()->GetArray("Vectors");
+
+  vtkNew<vtkPVPostFilter> filter;
+  filter->SetInputData(input);
+  RequestArray(filter.GetPointer(), 0, "Vectors_Y");
+  RequestArray(filter.GetPointer(), 1, "Vectors_Magnitude");
+  filter->Update();
+
+  vtkPointData* pointData =
+    vtkDataSet::SafeDownCast(filter->GetOutputDataObject(0))->GetPointData();
+  bool success = true;
+  success = Compare("Vectors_Y", pointData->GetArray("Vectors_Y"),
+              CopyComponent(vectors, 1).GetPointer()) &&
+    success;
+  success = Compare("Vectors_Magnitude", pointData->GetArray("Vectors_Magnitude"),
+              CopyComponent(vectors, -1).GetPointer()) &&
+    success;
+  success = CompareContour() && success;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -23,15 +23,19 @@
 #include "vtkCell.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
+#include "vtkConcurrentUnionFind.h"
 #include "vtkDataArray.h"
 #include "vtkDataObject.h"
 #include "vtkDataSet.h"
 #include "vtkDoubleArray.h"
+#include "vtkEquivalenceSet.h"
 #include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkIntArray.h"
 #include "vtkMultiProcessController.h"
 #include "vtkNonOverlappingAMR.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkTimerLog.h"
 #include "vtkUniformGrid.h"
@@ -43,143 +47,233 @@
 #include "vtkMPIController.h"
 #endif
 
+#include <algorithm>
 #include <list>
-#include <map>
+#include <unordered_map>
+#include <utility>
 
 vtkStandardNewMacro(vtkAMRConnectivity);
 
+// Equivalence of region ids. Region ids are sparse, so they are mapped to
+// dense indices kept in a vtkEquivalenceSet (a union-find) and the smallest
+// region id of every set is kept with the root of the set.
 class vtkAMRConnectivityEquivalence
 {
 public:
-  vtkAMRConnectivityEquivalence()
-  {
-    set_to_min_id = vtkSmartPointer<vtkIntArray>::New();
-    set_to_min_id->SetNumberOfComponents(1);
-    set_to_min_id->SetNumberOfTuples(0);
-  }
+  vtkAMRConnectivityEquivalence() { this->Sets = vtkSmartPointer<vtkEquivalenceSet>::New(); }
 
   ~vtkAMRConnectivityEquivalence() {}
 
-  int AddEquivalence(int id1, int id2)
+  // Adds the equivalences between the region ids of every consecutive pair
+  // of regionIdPairs at once.
+  void AddEquivalences(const std::vector<int>& regionIdPairs)
   {
-    int min_id;
-    if (id1 < id2)
+    if (regionIdPairs.size() < 2)
     {
-      min_id = id1;
+      return;
     }
-    else
+    std::vector<int> indices(regionIdPairs.size());
+    for (size_t ii = 0; ii < regionIdPairs.size(); ++ii)
     {
-      min_id = id2;
+      indices[ii] = this->GetIndex(regionIdPairs[ii]);
     }
+    this->Sets->AddEquivalences(&indices[0], static_cast<vtkIdType>(indices.size() / 2));
 
-    std::map<int, int>::iterator iter;
-
-    iter = id_to_set.find(id1);
-    int set1 = (iter == id_to_set.end() ? -1 : iter->second);
-    iter = id_to_set.find(id2);
-    int set2 = (iter == id_to_set.end() ? -1 : iter->second);
-
-    if (set1 >= 0 && set_to_min_id->GetValue(set1) < 0)
+    // The roots of merged sets have changed, carry the smallest region id
+    // of every set over to its root.
+    const int numIndices = static_cast<int>(this->MinIds.size());
+    for (int index = 0; index < numIndices; ++index)
     {
-      set1 = -1;
+      int root = this->Sets->GetEquivalentSetId(index);
+      this->MinIds[root] = std::min(this->MinIds[root], this->MinIds[index]);
     }
-    if (set2 >= 0 && set_to_min_id->GetValue(set2) < 0)
+  }
+
+  int GetMinimumSetId(int id)
+  {
+    std::unordered_map<int, int>::iterator iter = this->IdToIndex.find(id);
+    if (iter == this->IdToIndex.end())
     {
-      set2 = -1;
+      return -1;
     }
+    return this->MinIds[this->Sets->GetEquivalentSetId(iter->second)];
+  }
 
-    if (set1 >= 0 && set2 >= 0 && set1 == set2)
+private:
+  int GetIndex(int id)
+  {
+    std::pair<std::unordered_map<int, int>::iterator, bool> inserted =
+      this->IdToIndex.insert(std::make_pair(id, static_cast<int>(this->MinIds.size())));
+    if (inserted.second)
     {
-      return 0;
+      // A new id is a set of its own.
+      this->MinIds.push_back(id);
     }
-    else if (set1 >= 0 && set2 >= 0)
+    return inserted.first->second;
+  }
+
+  std::unordered_map<int, int> IdToIndex;
+  // Smallest region id of a set, valid at the root of the set.
+  std::vector<int> MinIds;
+  vtkSmartPointer<vtkEquivalenceSet> Sets;
+};
+
+namespace
+{
+// A local block and the arrays used to find its fragments.
+struct vtkAMRConnectivityBlock
+{
+  vtkUniformGrid* Grid;
+  vtkIdTypeArray* RegionIds;
+  vtkDataArray* Volume;
+  vtkUnsignedCharArray* Ghosts;
+  int CellDims[3];
+  vtkIdType NumberOfRegions;
+
+  vtkIdType GetCellId(int i, int j, int k) const
+  {
+    return i + this->CellDims[0] * (j + static_cast<vtkIdType>(this->CellDims[1]) * k);
+  }
+};
+
+//----------------------------------------------------------------------------
+// Labels the fragments in every block with ids 1, 2, ... in the order in
+// which a scan over i, j and k (innermost) first reaches them. Cells
+// sharing a point are connected. Cells outside of the fragments get 0.
+//
+// Each block gets a vtkConcurrentUnionFind over its cells. Cells are
+// linked with their already scanned neighbors concurrently, one (block, i)
+// slab per work item, then every block is labeled in scan order.
+void vtkAMRConnectivityLabelRegions(
+  std::vector<vtkAMRConnectivityBlock>& blocks, double volumeFractionSurfaceValue)
+{
+  const vtkIdType numBlocks = static_cast<vtkIdType>(blocks.size());
+  std::vector<vtkConcurrentUnionFind<vtkIdType> > sets(numBlocks);
+
+  // Mark the cells in a fragment with -1.
+  vtkSMPTools::For(0, numBlocks, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType b = begin; b < end; ++b)
     {
-      // merge sets
-      int min_set, max_set;
-      if (set1 < set2)
-      {
-        min_set = set1;
-        max_set = set2;
-      }
-      else
-      {
-        min_set = set2;
-        max_set = set1;
-      }
-      for (iter = id_to_set.begin(); iter != id_to_set.end(); iter++)
-      {
-        if (iter->second == max_set)
-        {
-          id_to_set[iter->first] = min_set;
-        }
+      vtkAMRConnectivityBlock& block = blocks[b];
+      vtkIdType numCells = block.RegionIds->GetNumberOfTuples();
+      vtkIdType* regionIds = block.RegionIds->GetPointer(0);
+      block.NumberOfRegions = 0;
+      if (block.CellDims[0] <= 0 || block.CellDims[1] <= 0 || block.CellDims[2] <= 0)
+      { // Nothing to scan.
+        std::fill(regionIds, regionIds + numCells, 0);
+        continue;
       }
-      int max_set_min = set_to_min_id->GetValue(max_set);
-      int min_set_min = set_to_min_id->GetValue(min_set);
-      // pick the smallest of the two mins to represent the set.
-      if (max_set_min < min_set_min)
+      for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
       {
-        set_to_min_id->SetValue(min_set, max_set_min);
+        regionIds[cellId] =
+          (block.Volume->GetComponent(cellId, 0) > volumeFractionSurfaceValue &&
+            (block.Ghosts->GetValue(cellId) & vtkDataSetAttributes::DUPLICATECELL) == 0)
+          ? -1
+          : 0;
       }
-      set_to_min_id->SetValue(max_set, -1);
+      sets[b].Initialize(numCells);
     }
-    else if (set1 >= 0)
+  });
+
+  std::vector<std::pair<vtkIdType, int> > slabs;
+  for (vtkIdType b = 0; b < numBlocks; ++b)
+  {
+    if (sets[b].GetSize() > 0)
     {
-      id_to_set[id2] = set1;
-      if (id2 < set_to_min_id->GetValue(set1))
+      for (int i = 0; i < blocks[b].CellDims[0]; ++i)
       {
-        set_to_min_id->SetValue(set1, id2);
+        slabs.push_back(std::make_pair(b, i));
       }
     }
-    else if (set2 >= 0)
+  }
+
+  vtkSMPTools::For(0, static_cast<vtkIdType>(slabs.size()), [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType slab = begin; slab < end; ++slab)
     {
-      id_to_set[id1] = set2;
-      if (id1 < set_to_min_id->GetValue(set2))
+      const vtkAMRConnectivityBlock& block = blocks[slabs[slab].first];
+      vtkConcurrentUnionFind<vtkIdType>& blockSets = sets[slabs[slab].first];
+      const vtkIdType* regionIds = block.RegionIds->GetPointer(0);
+      const int i = slabs[slab].second;
+      for (int j = 0; j < block.CellDims[1]; ++j)
       {
-        set_to_min_id->SetValue(set2, id1);
+        for (int k = 0; k < block.CellDims[2]; ++k)
+        {
+          vtkIdType cellId = block.GetCellId(i, j, k);
+          if (regionIds[cellId] == 0)
+          {
+            continue;
+          }
+          // Link with the 13 neighbors sharing a point that come before
+          // this cell in the scan.
+          for (int di = -1; di <= 0; ++di)
+          {
+            for (int dj = -1; dj <= 1; ++dj)
+            {
+              for (int dk = -1; dk <= 1; ++dk)
+              {
+                if (di == 0 && (dj > 0 || (dj == 0 && dk >= 0)))
+                {
+                  continue;
+                }
+                int ni = i + di;
+                int nj = j + dj;
+                int nk = k + dk;
+                if (ni < 0 || nj < 0 || nj >= block.CellDims[1] || nk < 0 ||
+                  nk >= block.CellDims[2])
+                {
+                  continue;
+                }
+                vtkIdType neighbor = block.GetCellId(ni, nj, nk);
+                if (regionIds[neighbor] != 0)
+                {
+                  blockSets.Union(cellId, neighbor);
+                }
+              }
+            }
+          }
+        }
       }
     }
-    else
+  });
+
+  // Number the sets in scan order. The root of a set is its smallest cell
+  // id, it holds the label of the set once it has been reached.
+  vtkSMPTools::For(0, numBlocks, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType b = begin; b < end; ++b)
     {
-      // find an empty set.
-      int first_empty = -1;
-      for (int i = 0; i < set_to_min_id->GetNumberOfTuples(); i++)
+      vtkAMRConnectivityBlock& block = blocks[b];
+      if (sets[b].GetSize() == 0)
       {
-        if (set_to_min_id->GetValue(i) < 0)
-        {
-          first_empty = i;
-          break;
-        }
+        continue;
       }
-      if (first_empty < 0)
+      vtkIdType* regionIds = block.RegionIds->GetPointer(0);
+      vtkIdType numRegions = 0;
+      for (int i = 0; i < block.CellDims[0]; ++i)
       {
-        first_empty = set_to_min_id->InsertNextValue(-1);
+        for (int j = 0; j < block.CellDims[1]; ++j)
+        {
+          for (int k = 0; k < block.CellDims[2]; ++k)
+          {
+            vtkIdType cellId = block.GetCellId(i, j, k);
+            if (regionIds[cellId] == 0)
+            {
+              continue;
+            }
+            vtkIdType root = sets[b].Find(cellId);
+            if (regionIds[root] < 0)
+            {
+              regionIds[root] = ++numRegions;
+            }
+            regionIds[cellId] = regionIds[root];
+          }
+        }
       }
-
-      id_to_set[id1] = first_empty;
-      id_to_set[id2] = first_empty;
-      set_to_min_id->SetValue(first_empty, min_id);
-      // return zero here because its not values we've previously cared about.
+      block.NumberOfRegions = numRegions;
+      sets[b].Release();
     }
-    return 1;
-  }
-
-  int GetMinimumSetId(int id)
-  {
-    std::map<int, int>::iterator iter = id_to_set.find(id);
-    if (iter == id_to_set.end())
-    {
-      // vtkErrorWithObjectMacro (id_to_set, << "ID out of range " << id << " (expected 0 <= x < "
-      // << id_to_set->GetNumberOfTuples () << ")");
-      return -1;
-    }
-    int set = id_to_set[id];
-    return (set >= 0 ? set_to_min_id->GetValue(set) : -1);
-  }
-
-private:
-  std::map<int, int> id_to_set;
-  vtkSmartPointer<vtkIntArray> set_to_min_id;
-};
+  });
+}
+}
 
 #ifdef PARAVIEW_USE_MPI
 
@@ -343,16 +437,15 @@ int vtkAMRConnectivity::DoRequestData(vtkNonOverlappingAMR* volume, const char*
   this->RegionName = std::string("RegionId-");
   this->RegionName += volumeName;
 
-  // initialize with a global unique region id
-  this->NextRegionId = myProc + 1;
-
   vtkTimerLog::MarkStartEvent("Initial fragment seeding");
 
   // Find the block local fragments
-  vtkCompositeDataIterator* iter = volume->NewIterator();
+  std::vector<vtkAMRConnectivityBlock> blocks;
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(volume->NewIterator());
   for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
   {
-    // Go through each block and create an array RegionId set all zero.
+    // Go through each block and create an array RegionId.
     vtkUniformGrid* grid = vtkUniformGrid::SafeDownCast(iter->GetCurrentDataObject());
     if (!grid)
     {
@@ -363,10 +456,6 @@ int vtkAMRConnectivity::DoRequestData(vtkNonOverlappingAMR* volume, const char*
     regionId->SetName(this->RegionName.c_str());
     regionId->SetNumberOfComponents(1);
     regionId->SetNumberOfTuples(grid->GetNumberOfCells());
-    for (int i = 0; i < grid->GetNumberOfCells(); i++)
-    {
-      regionId->SetTuple1(i, 0);
-    }
     grid->GetCellData()->AddArray(regionId);
 
     vtkDataArray* volArray = grid->GetCellData()->GetArray(volumeName);
@@ -383,31 +472,50 @@ int vtkAMRConnectivity::DoRequestData(vtkNonOverlappingAMR* volume, const char*
       return 0;
     }
 
-    // within each block find all fragments
     int extents[6];
     grid->GetExtent(extents);
 
-    for (int i = extents[0]; i < extents[1]; i++)
+    vtkAMRConnectivityBlock block;
+    block.Grid = grid;
+    block.RegionIds = regionId;
+    block.Volume = volArray;
+    block.Ghosts = ghostArray;
+    block.CellDims[0] = extents[1] - extents[0];
+    block.CellDims[1] = extents[3] - extents[2];
+    block.CellDims[2] = extents[5] - extents[4];
+    block.NumberOfRegions = 0;
+    blocks.push_back(block);
+  }
+
+  // within each block find all fragments
+  vtkAMRConnectivityLabelRegions(blocks, this->VolumeFractionSurfaceValue);
+
+  // Make the region ids globally unique. The fragments are numbered as if
+  // the blocks were processed one after the other, starting at myProc + 1
+  // and incrementing by numProcs for each new fragment.
+  const vtkIdType numBlocks = static_cast<vtkIdType>(blocks.size());
+  std::vector<vtkIdType> regionOffsets(numBlocks, 0);
+  vtkIdType numRegions = 0;
+  for (vtkIdType b = 0; b < numBlocks; ++b)
+  {
+    regionOffsets[b] = numRegions;
+    numRegions += blocks[b].NumberOfRegions;
+  }
+  vtkSMPTools::For(0, numBlocks, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType b = begin; b < end; ++b)
     {
-      for (int j = extents[2]; j < extents[3]; j++)
+      vtkIdType* regionIds = blocks[b].RegionIds->GetPointer(0);
+      vtkIdType numCells = blocks[b].RegionIds->GetNumberOfTuples();
+      for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
       {
-        for (int k = extents[4]; k < extents[5]; k++)
+        if (regionIds[cellId] > 0)
         {
-          int ijk[3] = { i, j, k };
-          vtkIdType cellId = grid->ComputeCellId(ijk);
-          if (regionId->GetTuple1(cellId) == 0 &&
-            volArray->GetTuple1(cellId) > this->VolumeFractionSurfaceValue &&
-            (ghostArray->GetValue(cellId) & vtkDataSetAttributes::DUPLICATECELL) == 0)
-          {
-            // wave propagation sets the region id as it propagates
-            this->WavePropagation(cellId, grid, regionId, volArray, ghostArray);
-            // increment this way so the region id remains globally unique
-            this->NextRegionId += numProcs;
-          }
+          regionIds[cellId] = myProc + 1 + (regionOffsets[b] + regionIds[cellId] - 1) * numProcs;
         }
       }
     }
-  }
+  });
+  this->NextRegionId = myProc + 1 + numRegions * numProcs;
 
   vtkTimerLog::MarkEndEvent("Initial fragment seeding");
 
@@ -491,18 +599,20 @@ int vtkAMRConnectivity::DoRequestData(vtkNonOverlappingAMR* volume, const char*
     // Process all boundaries at the neighbors to find the equivalence pairs at the boundaries
     this->Equivalence = new vtkAMRConnectivityEquivalence;
 
-    // Initialize equivalence with all regions independent
+    // Collect the equivalent pairs of all boundaries and add them at once.
+    std::vector<int> regionIdPairs;
     for (size_t i = 0; i < this->BoundaryArrays.size(); i++)
     {
       for (size_t j = 0; j < this->BoundaryArrays[i].size(); j++)
       {
         if (i == static_cast<unsigned int>(myProc))
         {
-          this->ProcessBoundaryAtNeighbor(volume, this->BoundaryArrays[myProc][j]);
+          this->ProcessBoundaryAtNeighbor(volume, this->BoundaryArrays[myProc][j], regionIdPairs);
         }
       }
       this->BoundaryArrays[i].clear();
     }
+    this->Equivalence->AddEquivalences(regionIdPairs);
     vtkTimerLog::MarkEndEvent("Computing boundary regions");
 
     vtkTimerLog::MarkStartEvent("Transferring equivalence");
@@ -615,47 +725,51 @@ int vtkAMRConnectivity::DoRequestData(vtkNonOverlappingAMR* volume, const char*
   if (PropagateGhosts)
   {
     vtkTimerLog::MarkStartEvent("Propagating ghosts");
-    // Propagate the region IDs out to the ghosts
-    vtkSmartPointer<vtkIdList> ptIds = vtkIdList::New();
-    vtkSmartPointer<vtkIdList> cellIds = vtkIdList::New();
-    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
-    {
-      vtkUniformGrid* grid = vtkUniformGrid::SafeDownCast(iter->GetCurrentDataObject());
-      vtkIdTypeArray* regionIdArray =
-        vtkIdTypeArray::SafeDownCast(grid->GetCellData()->GetArray(this->RegionName.c_str()));
-      vtkDataArray* volArray = grid->GetCellData()->GetArray(volumeName);
-      vtkUnsignedCharArray* ghostArray = grid->GetCellGhostArray();
-      for (int cellId = 0; cellId < regionIdArray->GetNumberOfTuples(); cellId++)
+    // Propagate the region IDs out to the ghosts. Only ghost cells are
+    // written, so the blocks are processed concurrently.
+    vtkSMPThreadLocalObject<vtkIdList> localPtIds;
+    vtkSMPThreadLocalObject<vtkIdList> localCellIds;
+    vtkSMPTools::For(0, numBlocks, [&](vtkIdType begin, vtkIdType end) {
+      vtkIdList* ptIds = localPtIds.Local();
+      vtkIdList* cellIds = localCellIds.Local();
+      for (vtkIdType b = begin; b < end; ++b)
       {
-        if ((ghostArray->GetValue(cellId) & vtkDataSetAttributes::DUPLICATECELL) == 0 ||
-          volArray->GetTuple1(cellId) < this->VolumeFractionSurfaceValue)
+        vtkUniformGrid* grid = blocks[b].Grid;
+        vtkIdTypeArray* regionIdArray = blocks[b].RegionIds;
+        vtkDataArray* volArray = blocks[b].Volume;
+        vtkUnsignedCharArray* ghostArray = blocks[b].Ghosts;
+        for (vtkIdType cellId = 0; cellId < regionIdArray->GetNumberOfTuples(); cellId++)
         {
-          continue;
-        }
-        grid->GetCellPoints(cellId, ptIds);
-        bool isSet = false;
-        for (int i = 0; i < ptIds->GetNumberOfIds(); i++)
-        {
-          grid->GetPointCells(ptIds->GetId(i), cellIds);
-          for (int j = 0; j < cellIds->GetNumberOfIds(); j++)
+          if ((ghostArray->GetValue(cellId) & vtkDataSetAttributes::DUPLICATECELL) == 0 ||
+            volArray->GetComponent(cellId, 0) < this->VolumeFractionSurfaceValue)
+          {
+            continue;
+          }
+          grid->GetCellPoints(cellId, ptIds);
+          bool isSet = false;
+          for (int i = 0; i < ptIds->GetNumberOfIds(); i++)
           {
-            vtkIdType neighbor = cellIds->GetId(j);
-            if (neighbor != cellId &&
-              volArray->GetTuple1(neighbor) > this->VolumeFractionSurfaceValue &&
-              (ghostArray->GetValue(neighbor) & vtkDataSetAttributes::DUPLICATECELL) == 0)
+            grid->GetPointCells(ptIds->GetId(i), cellIds);
+            for (int j = 0; j < cellIds->GetNumberOfIds(); j++)
+            {
+              vtkIdType neighbor = cellIds->GetId(j);
+              if (neighbor != cellId &&
+                volArray->GetComponent(neighbor, 0) > this->VolumeFractionSurfaceValue &&
+                (ghostArray->GetValue(neighbor) & vtkDataSetAttributes::DUPLICATECELL) == 0)
+              {
+                regionIdArray->SetValue(cellId, regionIdArray->GetValue(neighbor));
+                isSet = true;
+                break;
+              }
+            }
+            if (isSet)
             {
-              regionIdArray->SetTuple1(cellId, regionIdArray->GetTuple1(neighbor));
-              isSet = true;
               break;
             }
           }
-          if (isSet)
-          {
-            break;
-          }
         }
       }
-    }
+    });
 
     vtkTimerLog::MarkEndEvent("Propagating ghosts");
   }
@@ -663,47 +777,6 @@ int vtkAMRConnectivity::DoRequestData(vtkNonOverlappingAMR* volume, const char*
   return 1;
 }
 
-//----------------------------------------------------------------------------
-int vtkAMRConnectivity::WavePropagation(vtkIdType cellIdStart, vtkUniformGrid* grid,
-  vtkIdTypeArray* regionId, vtkDataArray* volArray, vtkUnsignedCharArray* ghostArray)
-{
-  vtkSmartPointer<vtkIdList> todoList = vtkIdList::New();
-  todoList->SetNumberOfIds(0);
-  todoList->InsertNextId(cellIdStart);
-
-  vtkSmartPointer<vtkIdList> ptIds = vtkIdList::New();
-  vtkSmartPointer<vtkIdList> cellIds = vtkIdList::New();
-
-  while (todoList->GetNumberOfIds() > 0)
-  {
-    vtkIdType cellId = todoList->GetId(0);
-    todoList->DeleteId(cellId);
-    regionId->SetTuple1(cellId, this->NextRegionId);
-
-    grid->GetCellPoints(cellId, ptIds);
-    for (int i = 0; i < ptIds->GetNumberOfIds(); i++)
-    {
-      cellIds->SetNumberOfIds(0);
-      grid->GetPointCells(ptIds->GetId(i), cellIds);
-      for (int j = 0; j < cellIds->GetNumberOfIds(); j++)
-      {
-        vtkIdType neighbor = cellIds->GetId(j);
-        if (neighbor == cellId || todoList->IsId(neighbor) >= 0)
-        {
-          continue;
-        }
-        if (regionId->GetTuple1(neighbor) == 0 &&
-          volArray->GetTuple1(neighbor) > this->VolumeFractionSurfaceValue &&
-          (ghostArray->GetValue(neighbor) & vtkDataSetAttributes::DUPLICATECELL) == 0)
-        {
-          todoList->InsertNextId(neighbor);
-        }
-      }
-    }
-  }
-  return 1;
-}
-
 //----------------------------------------------------------------------------
 vtkAMRDualGridHelperBlock* vtkAMRConnectivity::GetBlockNeighbor(
   vtkAMRDualGridHelperBlock* block, int dir)
@@ -1163,17 +1236,15 @@ int vtkAMRConnectivity::ExchangeEquivPairs(vtkMPIController* controller)
     sendList.push_back(request);
   }
 
+  std::vector<int> regionIdPairs;
   while (!receiveList.empty())
   {
     vtkAMRConnectivityCommRequest request = receiveList.WaitAny();
     vtkSmartPointer<vtkIntArray> array = request.Buffer;
-    for (int i = 0; i < array->GetNumberOfTuples(); i += 2)
-    {
-      int v1 = array->GetValue(i);
-      int v2 = array->GetValue(i + 1);
-      this->Equivalence->AddEquivalence(v1, v2);
-    }
+    regionIdPairs.insert(regionIdPairs.end(), array->GetPointer(0),
+      array->GetPointer(0) + array->GetNumberOfTuples());
   }
+  this->Equivalence->AddEquivalences(regionIdPairs);
 
   receiveList.clear();
   sendList.WaitAll();
@@ -1184,7 +1255,7 @@ int vtkAMRConnectivity::ExchangeEquivPairs(vtkMPIController* controller)
 
 //----------------------------------------------------------------------------
 void vtkAMRConnectivity::ProcessBoundaryAtNeighbor(
-  vtkNonOverlappingAMR* volume, vtkIdTypeArray* array)
+  vtkNonOverlappingAMR* volume, vtkIdTypeArray* array, std::vector<int>& regionIdPairs)
 {
 
   vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
@@ -1299,7 +1370,8 @@ void vtkAMRConnectivity::ProcessBoundaryAtNeighbor(
           int blockRegion = array->GetTuple1(index);
           if (neighborRegion != 0 && blockRegion != 0)
           {
-            this->Equivalence->AddEquivalence(neighborRegion, blockRegion);
+            regionIdPairs.push_back(neighborRegion);
+            regionIdPairs.push_back(blockRegion);
           }
         }
         index++;
@@ -1320,7 +1392,8 @@ void vtkAMRConnectivity::ProcessBoundaryAtNeighbor(
           int blockRegion = array->GetTuple1(index);
           if (neighborRegion != 0 && blockRegion != 0)
           {
-            this->Equivalence->AddEquivalence(neighborRegion, blockRegion);
+            regionIdPairs.push_back(neighborRegion);
+            regionIdPairs.push_back(blockRegion);
           }
           index++;
         }
@@ -108,15 +108,14 @@ protected:
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
 
   int DoRequestData(vtkNonOverlappingAMR*, const char*);
-  int WavePropagation(vtkIdType cellIdStart, vtkUniformGrid* grid, vtkIdTypeArray* regionId,
-    vtkDataArray* volArray, vtkUnsignedCharArray* ghostArray);
 
   vtkAMRDualGridHelperBlock* GetBlockNeighbor(vtkAMRDualGridHelperBlock* block, int dir);
   void ProcessBoundaryAtBlock(vtkNonOverlappingAMR* volume, vtkAMRDualGridHelperBlock* block,
     vtkAMRDualGridHelperBlock* neighbor, int dir);
   int ExchangeBoundaries(vtkMPIController* controller);
   int ExchangeEquivPairs(vtkMPIController* controller);
-  void ProcessBoundaryAtNeighbor(vtkNonOverlappingAMR* volume, vtkIdTypeArray* array);
+  void ProcessBoundaryAtNeighbor(
+    vtkNonOverlappingAMR* volume, vtkIdTypeArray* array, std::vector<int>& regionIdPairs);
 
 private:
   vtkAMRConnectivity(const vtkAMRConnectivity&) = delete;
@@ -36,16 +36,23 @@
 #include "vtkDataSet.h"
 #include "vtkFloatArray.h"
 #include "vtkImageData.h"
+#include "vtkIntArray.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMultiPieceDataSet.h"
 #include "vtkNonOverlappingAMR.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
+#include <algorithm>
 #include <ctime>
 #include <math.h>
+#include <unordered_map>
 
 vtkStandardNewMacro(vtkAMRDualContour);
 
@@ -62,6 +69,11 @@ static int vtkAMRDualIsoEdgeToVTKPointsTable[12][2] = { { 0, 1 }, { 1, 2 }, { 3,
 // 3: Change degenerate quads to tris or remove.
 // 4: Copy Attributes from input to output.
 
+// In threaded execution, point ids handed out by a block are offset by the
+// block's position in processing order shifted by this many bits (the upper
+// half of a 64 bit vtkIdType).
+static const int vtkAMRDualContourBlockIdShift = static_cast<int>(sizeof(vtkIdType) * 4);
+
 //============================================================================
 // Used separately for each block.  This is the typical 3 edge per voxel
 // lookup.  We do need to worry about degeneracy because corners can merge
@@ -609,6 +621,83 @@ void vtkAMRDualContourEdgeLocator::ShareBlockLocatorWithNeighbor(
 }
 
 //============================================================================
+//============================================================================
+// Where a block's points, polygons and point attributes go. In serial
+// execution all blocks share the output mesh. In threaded execution each
+// block has its own and its point ids are offset by IdBase, which encodes
+// the block's position in processing order. Ids stored in shared locators
+// can then be resolved to output ids once all blocks are done.
+class vtkAMRDualContourBlockOutput
+{
+public:
+  vtkAMRDualContourBlockOutput()
+    : Locator(0)
+    , IdBase(0)
+  {
+  }
+
+  vtkIdType InsertNextPoint(const double pt[3])
+  {
+    return this->IdBase + this->Points->InsertNextPoint(pt);
+  }
+
+  vtkIdType GetLocalId(vtkIdType id) const { return id - this->IdBase; }
+
+  vtkAMRDualContourEdgeLocator* Locator;
+  vtkSmartPointer<vtkPolyData> Mesh;
+  vtkSmartPointer<vtkPoints> Points;
+  vtkSmartPointer<vtkCellArray> Faces;
+  vtkSmartPointer<vtkIntArray> BlockIds;
+  vtkIdType IdBase;
+};
+
+//----------------------------------------------------------------------------
+// Collects the blocks, in the same level or higher, that may receive point ids
+// from this block's locator once it is processed.
+static void vtkAMRDualContourGetLocatorNeighbors(vtkAMRDualGridHelper* helper,
+  vtkAMRDualGridHelperBlock* block, std::vector<vtkAMRDualGridHelperBlock*>& neighbors)
+{
+  // Blocks are processed low level to high so, we only need to share
+  // the locator with blocks in the same level or higher.
+  int numLevels = helper->GetNumberOfLevels();
+  int xMid, yMid, zMid;
+  int xMin, xMax, yMin, yMax, zMin, zMax;
+
+  for (int level = block->Level; level < numLevels; ++level)
+  {
+    // Neighborhood.
+    int levelDiff = level - block->Level;
+    xMid = block->GridIndex[0];
+    xMin = (xMid << levelDiff) - 1;
+    xMax = (xMid + 1) << levelDiff;
+    yMid = block->GridIndex[1];
+    yMin = (yMid << levelDiff) - 1;
+    yMax = (yMid + 1) << levelDiff;
+    zMid = block->GridIndex[2];
+    zMin = (zMid << levelDiff) - 1;
+    zMax = (zMid + 1) << levelDiff;
+
+    // Lets just start with neighbors in the same level.
+    for (int iz = zMin; iz <= zMax; ++iz)
+    {
+      for (int iy = yMin; iy <= yMax; ++iy)
+      {
+        for (int ix = xMin; ix <= xMax; ++ix)
+        {
+          if ((ix >> levelDiff) != xMid || (iy >> levelDiff) != yMid || (iz >> levelDiff) != zMid)
+          {
+            vtkAMRDualGridHelperBlock* neighbor = helper->GetBlock(level, ix, iy, iz);
+            if (neighbor && neighbor->Image)
+            {
+              neighbors.push_back(neighbor);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 // Description:
 // Construct object with initial range (0,1) and single contour value
@@ -623,6 +712,7 @@ vtkAMRDualContour::vtkAMRDualContour()
   this->EnableMultiProcessCommunication = 1;
   this->EnableMergePoints = 1;
   this->TriangulateCap = 1;
+  this->UseThreading = 1;
 
   this->Controller = NULL;
   this->SetController(vtkMultiProcessController::GetGlobalController());
@@ -631,7 +721,6 @@ vtkAMRDualContour::vtkAMRDualContour()
   this->SetNumberOfOutputPorts(1);
 
   this->TemperatureArray = 0;
-  this->BlockIdCellArray = 0;
   this->Helper = 0;
 
   this->BlockLocator = 0;
@@ -661,6 +750,7 @@ void vtkAMRDualContour::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "EnableMergePoints: " << this->EnableMergePoints << endl;
   os << indent << "TriangulateCap: " << this->TriangulateCap << endl;
   os << indent << "SkipGhostCopy: " << this->SkipGhostCopy << endl;
+  os << indent << "UseThreading: " << this->UseThreading << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -792,44 +882,54 @@ vtkMultiBlockDataSet* vtkAMRDualContour::DoRequestData(
 
   mpds->SetNumberOfPieces(0);
 
-  this->Mesh = vtkPolyData::New();
-  this->Points = vtkPoints::New();
-  this->Faces = vtkCellArray::New();
-  this->Mesh->SetPoints(this->Points);
-  this->Mesh->SetPolys(this->Faces);
-  mpds->SetPiece(0, this->Mesh);
+  vtkAMRDualContourBlockOutput output;
+  output.Mesh = vtkSmartPointer<vtkPolyData>::New();
+  output.Points = vtkSmartPointer<vtkPoints>::New();
+  output.Faces = vtkSmartPointer<vtkCellArray>::New();
+  output.Mesh->SetPoints(output.Points);
+  output.Mesh->SetPolys(output.Faces);
+  mpds->SetPiece(0, output.Mesh);
 
-  this->InitializeCopyAttributes(hbdsInput, this->Mesh);
+  this->InitializeCopyAttributes(hbdsInput, output.Mesh);
 
   // For debugging.
-  this->BlockIdCellArray = vtkIntArray::New();
-  this->BlockIdCellArray->SetName("BlockIds");
-  this->Mesh->GetCellData()->AddArray(this->BlockIdCellArray);
-
-  // Loop through blocks
-  int numLevels = hbdsInput->GetNumberOfLevels();
+  output.BlockIds = vtkSmartPointer<vtkIntArray>::New();
+  output.BlockIds->SetName("BlockIds");
+  output.Mesh->GetCellData()->AddArray(output.BlockIds);
 
-  // Add each block.
-  for (int level = 0; level < numLevels; ++level)
+  // Block ids are offset in the locators when threading, hence the need for
+  // 64 bit ids.
+  if (this->UseThreading && sizeof(vtkIdType) >= 8)
   {
-    int numBlocks = this->Helper->GetNumberOfBlocksInLevel(level);
-    for (int blockId = 0; blockId < numBlocks; ++blockId)
+    this->ProcessBlocksThreaded(hbdsInput, arrayNameToProcess, output.Mesh, output.BlockIds);
+  }
+  else
+  {
+    if (!this->EnableMergePoints)
+    { // Shared locator.
+      if (this->BlockLocator == 0)
+      {
+        this->BlockLocator = new vtkAMRDualContourEdgeLocator;
+      }
+      output.Locator = this->BlockLocator;
+    }
+
+    // Loop through blocks
+    int numLevels = hbdsInput->GetNumberOfLevels();
+
+    // Add each block.
+    for (int level = 0; level < numLevels; ++level)
     {
-      vtkAMRDualGridHelperBlock* block = this->Helper->GetBlock(level, blockId);
-      this->ProcessBlock(block, blockId, arrayNameToProcess);
+      int numBlocks = this->Helper->GetNumberOfBlocksInLevel(level);
+      for (int blockId = 0; blockId < numBlocks; ++blockId)
+      {
+        vtkAMRDualGridHelperBlock* block = this->Helper->GetBlock(level, blockId);
+        this->ProcessBlock(block, blockId, arrayNameToProcess, &output);
+      }
     }
   }
 
-  this->FinalizeCopyAttributes(this->Mesh);
-  this->BlockIdCellArray->Delete();
-  this->BlockIdCellArray = 0;
-
-  this->Mesh->Delete();
-  this->Mesh = 0;
-  this->Points->Delete();
-  this->Points = 0;
-  this->Faces->Delete();
-  this->Faces = 0;
+  this->FinalizeCopyAttributes(output.Mesh);
 
   mpds->Delete();
 
@@ -839,53 +939,201 @@ vtkMultiBlockDataSet* vtkAMRDualContour::DoRequestData(
 //----------------------------------------------------------------------------
 void vtkAMRDualContour::ShareBlockLocatorWithNeighbors(vtkAMRDualGridHelperBlock* block)
 {
-  vtkAMRDualGridHelperBlock* neighbor;
-  // Blocks are processed low level to high so, we only need to share
-  // the locator with blocks in the same level or higher.
-  int numLevels = this->Helper->GetNumberOfLevels();
-  int xMid, yMid, zMid;
-  int xMin, xMax, yMin, yMax, zMin, zMax;
+  std::vector<vtkAMRDualGridHelperBlock*> neighbors;
+  vtkAMRDualContourGetLocatorNeighbors(this->Helper, block, neighbors);
+  for (vtkAMRDualGridHelperBlock* neighbor : neighbors)
+  {
+    // The unused center flag is used as a flag to indicate
+    // that the neighbor has not been processed yet.
+    if (neighbor->RegionBits[1][1][1])
+    {
+      vtkAMRDualContourEdgeLocator* blockLocator = vtkAMRDualContourGetBlockLocator(block);
+      blockLocator->ShareBlockLocatorWithNeighbor(block, neighbor);
+    }
+  }
+}
 
-  for (int level = block->Level; level < numLevels; ++level)
+//----------------------------------------------------------------------------
+void vtkAMRDualContour::ProcessBlocksThreaded(vtkNonOverlappingAMR* hbdsInput,
+  const char* arrayNameToProcess, vtkPolyData* mesh, vtkIntArray* blockIdArray)
+{
+  // Local blocks, in the order the serial execution processes them.
+  std::vector<vtkAMRDualGridHelperBlock*> blocks;
+  std::vector<int> blockIds;
+  int numLevels = hbdsInput->GetNumberOfLevels();
+  for (int level = 0; level < numLevels; ++level)
   {
-    // Neighborhood.
-    int levelDiff = level - block->Level;
-    xMid = block->GridIndex[0];
-    xMin = (xMid << levelDiff) - 1;
-    xMax = (xMid + 1) << levelDiff;
-    yMid = block->GridIndex[1];
-    yMin = (yMid << levelDiff) - 1;
-    yMax = (yMid + 1) << levelDiff;
-    zMid = block->GridIndex[2];
-    zMin = (zMid << levelDiff) - 1;
-    zMax = (zMid + 1) << levelDiff;
+    int numBlocksInLevel = this->Helper->GetNumberOfBlocksInLevel(level);
+    for (int blockId = 0; blockId < numBlocksInLevel; ++blockId)
+    {
+      vtkAMRDualGridHelperBlock* block = this->Helper->GetBlock(level, blockId);
+      if (block->Image)
+      {
+        blocks.push_back(block);
+        blockIds.push_back(blockId);
+      }
+    }
+  }
+  const int numBlocks = static_cast<int>(blocks.size());
 
-    // Lets just start with neighbors in the same level.
-    for (int iz = zMin; iz <= zMax; ++iz)
+  // When merging points, a block copies point ids into the locators of its
+  // unprocessed neighbors. Two blocks conflict if one is a neighbor of the
+  // other or if they have a common neighbor. Blocks are grouped in waves so
+  // that conflicting blocks run in serial order and never at the same time.
+  std::vector<int> waves(numBlocks, 0);
+  int numWaves = numBlocks > 0 ? 1 : 0;
+  if (this->EnableMergePoints)
+  {
+    std::unordered_map<vtkAMRDualGridHelperBlock*, int> ordinals;
+    for (int cc = 0; cc < numBlocks; ++cc)
     {
-      for (int iy = yMin; iy <= yMax; ++iy)
+      ordinals[blocks[cc]] = cc;
+    }
+
+    std::vector<std::vector<int> > targets(numBlocks);
+    std::vector<std::vector<int> > writers(numBlocks);
+    std::vector<vtkAMRDualGridHelperBlock*> neighbors;
+    for (int cc = 0; cc < numBlocks; ++cc)
+    {
+      neighbors.clear();
+      vtkAMRDualContourGetLocatorNeighbors(this->Helper, blocks[cc], neighbors);
+      for (vtkAMRDualGridHelperBlock* neighbor : neighbors)
       {
-        for (int ix = xMin; ix <= xMax; ++ix)
+        auto iter = ordinals.find(neighbor);
+        if (iter != ordinals.end() && iter->second != cc)
         {
-          if ((ix >> levelDiff) != xMid || (iy >> levelDiff) != yMid || (iz >> levelDiff) != zMid)
+          targets[cc].push_back(iter->second);
+          writers[iter->second].push_back(cc);
+        }
+      }
+    }
+
+    for (int cc = 0; cc < numBlocks; ++cc)
+    {
+      int wave = 0;
+      auto after = [&](int other) {
+        if (other < cc)
+        {
+          wave = std::max(wave, waves[other] + 1);
+        }
+      };
+      for (int target : targets[cc])
+      {
+        after(target);
+        for (int writer : writers[target])
+        {
+          after(writer);
+        }
+      }
+      for (int writer : writers[cc])
+      {
+        after(writer);
+      }
+      waves[cc] = wave;
+      numWaves = std::max(numWaves, wave + 1);
+    }
+  }
+
+  std::vector<std::vector<int> > waveBlocks(numWaves);
+  std::vector<vtkAMRDualContourBlockOutput> outputs(numBlocks);
+  for (int cc = 0; cc < numBlocks; ++cc)
+  {
+    waveBlocks[waves[cc]].push_back(cc);
+
+    vtkAMRDualContourBlockOutput& output = outputs[cc];
+    output.Mesh = vtkSmartPointer<vtkPolyData>::New();
+    output.Points = vtkSmartPointer<vtkPoints>::New();
+    output.Points->SetDataType(mesh->GetPoints()->GetDataType());
+    output.Faces = vtkSmartPointer<vtkCellArray>::New();
+    output.BlockIds = vtkSmartPointer<vtkIntArray>::New();
+    output.Mesh->SetPoints(output.Points);
+    output.Mesh->SetPolys(output.Faces);
+    this->InitializeCopyAttributes(hbdsInput, output.Mesh);
+    output.IdBase = static_cast<vtkIdType>(cc) << vtkAMRDualContourBlockIdShift;
+  }
+
+  // Without point merging, blocks only need a scratch locator per thread.
+  vtkSMPThreadLocal<vtkAMRDualContourEdgeLocator*> locators(nullptr);
+  for (int wave = 0; wave < numWaves; ++wave)
+  {
+    const std::vector<int>& current = waveBlocks[wave];
+    auto worker = [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType idx = begin; idx < end; ++idx)
+      {
+        const int cc = current[idx];
+        vtkAMRDualContourBlockOutput& output = outputs[cc];
+        if (!this->EnableMergePoints)
+        {
+          vtkAMRDualContourEdgeLocator*& locator = locators.Local();
+          if (locator == nullptr)
           {
-            neighbor = this->Helper->GetBlock(level, ix, iy, iz);
-            // The unused center flag is used as a flag to indicate
-            if (neighbor && neighbor->Image && neighbor->RegionBits[1][1][1])
-            {
-              vtkAMRDualContourEdgeLocator* blockLocator = vtkAMRDualContourGetBlockLocator(block);
-              blockLocator->ShareBlockLocatorWithNeighbor(block, neighbor);
-            }
+            locator = new vtkAMRDualContourEdgeLocator;
           }
+          output.Locator = locator;
         }
+        this->ProcessBlock(blocks[cc], blockIds[cc], arrayNameToProcess, &output);
+      }
+    };
+    vtkSMPTools::For(0, static_cast<vtkIdType>(current.size()), worker);
+  }
+  for (auto iter = locators.begin(); iter != locators.end(); ++iter)
+  {
+    delete *iter;
+  }
+
+  // Append the block outputs in order, resolving the offset point ids.
+  std::vector<vtkIdType> offsets(numBlocks + 1, 0);
+  for (int cc = 0; cc < numBlocks; ++cc)
+  {
+    offsets[cc + 1] = offsets[cc] + outputs[cc].Points->GetNumberOfPoints();
+  }
+
+  vtkPoints* points = mesh->GetPoints();
+  vtkCellArray* faces = mesh->GetPolys();
+  vtkPointData* outPD = mesh->GetPointData();
+  points->SetNumberOfPoints(offsets[numBlocks]);
+  const vtkIdType localIdMask = (static_cast<vtkIdType>(1) << vtkAMRDualContourBlockIdShift) - 1;
+  std::vector<vtkIdType> cell;
+  for (int cc = 0; cc < numBlocks; ++cc)
+  {
+    vtkAMRDualContourBlockOutput& output = outputs[cc];
+    const vtkIdType numPoints = output.Points->GetNumberOfPoints();
+    if (numPoints > 0)
+    {
+      points->GetData()->InsertTuples(offsets[cc], numPoints, 0, output.Points->GetData());
+      vtkPointData* blockPD = output.Mesh->GetPointData();
+      for (int array = 0; array < outPD->GetNumberOfArrays(); ++array)
+      {
+        outPD->GetAbstractArray(array)->InsertTuples(
+          offsets[cc], numPoints, 0, blockPD->GetAbstractArray(array));
       }
     }
+
+    vtkIdType npts;
+    vtkIdType* pts;
+    vtkCellArray* blockFaces = output.Faces;
+    for (blockFaces->InitTraversal(); blockFaces->GetNextCell(npts, pts);)
+    {
+      cell.resize(npts);
+      for (vtkIdType ptIdx = 0; ptIdx < npts; ++ptIdx)
+      {
+        cell[ptIdx] =
+          offsets[pts[ptIdx] >> vtkAMRDualContourBlockIdShift] + (pts[ptIdx] & localIdMask);
+      }
+      faces->InsertNextCell(npts, &cell[0]);
+    }
+
+    const vtkIdType numFaces = output.BlockIds->GetNumberOfTuples();
+    for (vtkIdType faceIdx = 0; faceIdx < numFaces; ++faceIdx)
+    {
+      blockIdArray->InsertNextValue(output.BlockIds->GetValue(faceIdx));
+    }
   }
 }
 
 //----------------------------------------------------------------------------
-void vtkAMRDualContour::ProcessBlock(
-  vtkAMRDualGridHelperBlock* block, int blockId, const char* arrayNameToProcess)
+void vtkAMRDualContour::ProcessBlock(vtkAMRDualGridHelperBlock* block, int blockId,
+  const char* arrayNameToProcess, vtkAMRDualContourBlockOutput* output)
 {
   vtkImageData* image = block->Image;
   if (image == 0)
@@ -916,17 +1164,13 @@ void vtkAMRDualContour::ProcessBlock(
   // Input the dimensions of the dual cells with ghosts.
   if (this->EnableMergePoints)
   {
-    this->BlockLocator = vtkAMRDualContourGetBlockLocator(block);
+    output->Locator = vtkAMRDualContourGetBlockLocator(block);
   }
   else
-  { // Shared locator.
-    if (this->BlockLocator == 0)
-    {
-      this->BlockLocator = new vtkAMRDualContourEdgeLocator;
-    }
-    this->BlockLocator->Initialize(
+  { // Shared locator, provided by the caller.
+    output->Locator->Initialize(
       extent[1] - extent[0], extent[3] - extent[2], extent[5] - extent[4]);
-    this->BlockLocator->CopyRegionLevelDifferences(block);
+    output->Locator->CopyRegionLevelDifferences(block);
   }
   image->GetOrigin(origin);
   spacing = image->GetSpacing();
@@ -1007,7 +1251,8 @@ void vtkAMRDualContour::ProcessBlock(
           cornerOffsets[5] = xOffset + 1 + zInc;
           cornerOffsets[6] = xOffset + 1 + yInc + zInc;
           cornerOffsets[7] = xOffset + yInc + zInc;
-          this->ProcessDualCell(block, blockId, x, y, z, cornerOffsets, volumeFractionArray);
+          this->ProcessDualCell(
+            block, blockId, x, y, z, cornerOffsets, volumeFractionArray, output);
         }
         xOffset += 1; // xInc
       }
@@ -1021,8 +1266,8 @@ void vtkAMRDualContour::ProcessBlock(
     // Copy point ids into neighbor locators.
     this->ShareBlockLocatorWithNeighbors(block);
     // We are done.  We no longer need the locator for this block.
-    delete this->BlockLocator;
-    this->BlockLocator = 0;
+    delete output->Locator;
+    output->Locator = 0;
     block->UserData = 0;
     // Lets use this unused flag (owner of center region/block) to indicate
     // that the block is already processes.
@@ -1092,7 +1337,8 @@ static int vtkAMRDualLegacyIdToBitIdMap[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
 // a fast path for internal cells (with no degeneracies).
 // Corner offsets are absolute (relative to origin / 0).
 void vtkAMRDualContour::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int blockId, int x, int y,
-  int z, vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray)
+  int z, vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray,
+  vtkAMRDualContourBlockOutput* output)
 {
   // compute the case index
   vtkImageData* image = block->Image;
@@ -1329,7 +1575,7 @@ void vtkAMRDualContour::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int bl
     // Only permanently keep locator for edges shared between two blocks.
     for (int ii = 0; ii < 3; ++ii, ++edge) // insert triangle
     {
-      vtkIdType* ptIdPtr = this->BlockLocator->GetEdgePointer(x, y, z, *edge);
+      vtkIdType* ptIdPtr = output->Locator->GetEdgePointer(x, y, z, *edge);
 
       if (*ptIdPtr == -1)
       {
@@ -1357,31 +1603,33 @@ void vtkAMRDualContour::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int bl
           cornerPoints[pt1Idx | 1] + k * (cornerPoints[pt2Idx | 1] - cornerPoints[pt1Idx | 1]);
         pt[2] =
           cornerPoints[pt1Idx | 2] + k * (cornerPoints[pt2Idx | 2] - cornerPoints[pt1Idx | 2]);
-        *ptIdPtr = this->Points->InsertNextPoint(pt);
+        *ptIdPtr = output->InsertNextPoint(pt);
         // Interpolate attributes
         // Find the offsets of the two attributes to interpolate
         vtkIdType offset0 = cornerOffsets[vtkAMRDualIsoEdgeToVTKPointsTable[*edge][0]];
         vtkIdType offset1 = cornerOffsets[vtkAMRDualIsoEdgeToVTKPointsTable[*edge][1]];
-        this->InterpolateAttributes(block->Image, offset0, offset1, k, this->Mesh, *ptIdPtr);
+        this->InterpolateAttributes(
+          block->Image, offset0, offset1, k, output->Mesh, output->GetLocalId(*ptIdPtr));
       }
       edgePointIds[*edge] = pointIds[ii] = *ptIdPtr;
     }
     if (pointIds[0] != pointIds[1] && pointIds[0] != pointIds[2] && pointIds[1] != pointIds[2])
     {
-      this->Faces->InsertNextCell(3, pointIds);
-      this->BlockIdCellArray->InsertNextValue(blockId);
+      output->Faces->InsertNextCell(3, pointIds);
+      output->BlockIds->InsertNextValue(blockId);
     }
   }
 
   if (this->EnableCapping)
   {
     this->CapCell(x, y, z, cubeBoundaryBits, cubeCase, edgePointIds, cornerPoints, cornerOffsets,
-      blockId, block->Image);
+      blockId, block->Image, output);
   }
 }
 
 //----------------------------------------------------------------------------
-void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int blockId)
+void vtkAMRDualContour::AddCapPolygon(
+  int ptCount, vtkIdType* pointIds, int blockId, vtkAMRDualContourBlockOutput* output)
 {
   if (this->TriangulateCap)
   {
@@ -1397,8 +1645,8 @@ void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int bloc
         tri[2] = pointIds[low];
         if (tri[0] != tri[1] && tri[0] != tri[2] && tri[1] != tri[2])
         {
-          this->Faces->InsertNextCell(3, tri);
-          this->BlockIdCellArray->InsertNextValue(blockId);
+          output->Faces->InsertNextCell(3, tri);
+          output->BlockIds->InsertNextValue(blockId);
         }
       }
       else
@@ -1408,16 +1656,16 @@ void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int bloc
         tri[2] = pointIds[low];
         if (tri[0] != tri[1] && tri[0] != tri[2] && tri[1] != tri[2])
         {
-          this->Faces->InsertNextCell(3, tri);
-          this->BlockIdCellArray->InsertNextValue(blockId);
+          output->Faces->InsertNextCell(3, tri);
+          output->BlockIds->InsertNextValue(blockId);
         }
         tri[0] = pointIds[high];
         tri[1] = pointIds[high + 1];
         tri[2] = pointIds[low];
         if (tri[0] != tri[1] && tri[0] != tri[2] && tri[1] != tri[2])
         {
-          this->Faces->InsertNextCell(3, tri);
-          this->BlockIdCellArray->InsertNextValue(blockId);
+          output->Faces->InsertNextCell(3, tri);
+          output->BlockIds->InsertNextValue(blockId);
         }
       }
       ++low;
@@ -1427,8 +1675,8 @@ void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int bloc
   else
   {
     // Do not worry about degenerate polygons in this path.
-    this->Faces->InsertNextCell(ptCount, pointIds);
-    this->BlockIdCellArray->InsertNextValue(blockId);
+    output->Faces->InsertNextCell(ptCount, pointIds);
+    output->BlockIds->InsertNextValue(blockId);
   }
 }
 
@@ -1453,7 +1701,9 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
   // For block id array (for debugging).  I should just make this an ivar.
   int blockId,
   // For passing attributes to output mesh
-  vtkDataSet* inData)
+  vtkDataSet* inData,
+  // Where points and polygons are added
+  vtkAMRDualContourBlockOutput* output)
 {
   int cornerIdx;
   vtkIdType* ptIdPtr;
@@ -1472,12 +1722,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoNXCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = output->Locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            *ptIdPtr = output->InsertNextPoint(cornerPoints + (cornerIdx << 2));
+            this->CopyAttributes(inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]],
+              output->Mesh, output->GetLocalId(*ptIdPtr));
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1487,7 +1737,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(ptCount, pointIds, blockId, output);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1508,12 +1758,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoPXCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = output->Locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            *ptIdPtr = output->InsertNextPoint(cornerPoints + (cornerIdx << 2));
+            this->CopyAttributes(inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]],
+              output->Mesh, output->GetLocalId(*ptIdPtr));
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1523,7 +1773,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(ptCount, pointIds, blockId, output);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1545,12 +1795,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoNYCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = output->Locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            *ptIdPtr = output->InsertNextPoint(cornerPoints + (cornerIdx << 2));
+            this->CopyAttributes(inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]],
+              output->Mesh, output->GetLocalId(*ptIdPtr));
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1560,7 +1810,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(ptCount, pointIds, blockId, output);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1582,12 +1832,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoPYCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = output->Locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            *ptIdPtr = output->InsertNextPoint(cornerPoints + (cornerIdx << 2));
+            this->CopyAttributes(inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]],
+              output->Mesh, output->GetLocalId(*ptIdPtr));
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1597,7 +1847,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(ptCount, pointIds, blockId, output);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1618,12 +1868,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoNZCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = output->Locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            *ptIdPtr = output->InsertNextPoint(cornerPoints + (cornerIdx << 2));
+            this->CopyAttributes(inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]],
+              output->Mesh, output->GetLocalId(*ptIdPtr));
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1633,7 +1883,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(ptCount, pointIds, blockId, output);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1655,12 +1905,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoPZCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = output->Locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            *ptIdPtr = output->InsertNextPoint(cornerPoints + (cornerIdx << 2));
+            this->CopyAttributes(inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]],
+              output->Mesh, output->GetLocalId(*ptIdPtr));
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1670,7 +1920,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(ptCount, pointIds, blockId, output);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -21,6 +21,9 @@
  * a particle index as part of the cell data of the output.  It computes
  * the volume of each particle from the volume fraction.
  *
+ * Blocks can be contoured concurrently (see UseThreading). The output is
+ * identical to the one produced by processing the blocks one after the other.
+ *
  * This will turn on validation and debug i/o of the filter.
  * \code{.cpp}
  * #define vtkAMRDualContourDEBUG
@@ -53,6 +56,7 @@ class vtkCallbackCommand;
 class vtkAMRDualGridHelper;
 class vtkAMRDualGridHelperBlock;
 class vtkAMRDualGridHelperFace;
+class vtkAMRDualContourBlockOutput;
 class vtkAMRDualContourEdgeLocator;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkAMRDualContour : public vtkMultiBlockDataSetAlgorithm
@@ -114,6 +118,19 @@ public:
   vtkBooleanMacro(SkipGhostCopy, int);
   //@}
 
+  //@{
+  /**
+   * When on (default), the blocks local to this process are contoured
+   * concurrently using vtkSMPTools, each into its own output that are then
+   * appended in block order. When EnableMergePoints is on, blocks that share
+   * point ids with each other are never processed at the same time, so the
+   * output does not depend on this flag.
+   */
+  vtkSetMacro(UseThreading, int);
+  vtkGetMacro(UseThreading, int);
+  vtkBooleanMacro(UseThreading, int);
+  //@}
+
   vtkGetObjectMacro(Controller, vtkMultiProcessController);
   virtual void SetController(vtkMultiProcessController*);
 
@@ -130,6 +147,7 @@ protected:
   int EnableMergePoints;
   int TriangulateCap;
   int SkipGhostCopy;
+  int UseThreading;
 
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
 
@@ -154,12 +172,22 @@ protected:
 
   void ShareBlockLocatorWithNeighbors(vtkAMRDualGridHelperBlock* block);
 
-  void ProcessBlock(vtkAMRDualGridHelperBlock* block, int blockId, const char* arrayName);
+  void ProcessBlock(vtkAMRDualGridHelperBlock* block, int blockId, const char* arrayName,
+    vtkAMRDualContourBlockOutput* output);
+
+  /**
+   * Contours all the local blocks concurrently, then appends their outputs to
+   * the mesh in block order.
+   */
+  void ProcessBlocksThreaded(
+    vtkNonOverlappingAMR* input, const char* arrayName, vtkPolyData* mesh, vtkIntArray* blockIds);
 
   void ProcessDualCell(vtkAMRDualGridHelperBlock* block, int blockId, int x, int y, int z,
-    vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray);
+    vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray,
+    vtkAMRDualContourBlockOutput* output);
 
-  void AddCapPolygon(int ptCount, vtkIdType* pointIds, int blockId);
+  void AddCapPolygon(
+    int ptCount, vtkIdType* pointIds, int blockId, vtkAMRDualContourBlockOutput* output);
 
   // This method is getting too many arguments!
   // Capping was an after thought...
@@ -177,17 +205,15 @@ protected:
     // For block id array (for debugging).  I should just make this an ivar.
     int blockId,
     // For passing attributes to output mesh
-    vtkDataSet* inData);
+    vtkDataSet* inData,
+    // Where points and polygons are added
+    vtkAMRDualContourBlockOutput* output);
 
   // Stuff exclusively for debugging.
-  vtkIntArray* BlockIdCellArray;
   vtkFloatArray* TemperatureArray;
 
   // Ivars used to reduce method parrameters.
   vtkAMRDualGridHelper* Helper;
-  vtkPolyData* Mesh;
-  vtkPoints* Points;
-  vtkCellArray* Faces;
 
   vtkMultiProcessController* Controller;
 
@@ -196,6 +222,7 @@ protected:
   int* MessageBuffer;
   int* MessageBufferLength;
 
+  // Locator reused for all blocks when points are not merged (serial execution).
   vtkAMRDualContourEdgeLocator* BlockLocator;
 
   // Stuff for passing cell attributes to point attributes.
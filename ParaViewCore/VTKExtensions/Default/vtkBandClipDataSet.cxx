@@ -0,0 +1,690 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkBandClipDataSet.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkBandClipDataSet.h"
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkDataSet.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkOrderedTriangulator.h"
+#include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkStructuredGrid.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <vector>
+
+vtkStandardNewMacro(vtkBandClipDataSet);
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Band clip cases of the simplices. The case of a simplex is the sum over its
+// vertices of state * 3^i, where the state of vertex i is 0 below the band, 1
+// inside and 2 above (b, i and a in the comments, vertex 0 first). Every case
+// lists the simplices of the clipped simplex, with the orientation of the
+// simplex. Codes below the number of vertices n are the vertices, code
+// n + 2 * e is the point of edge e at the lower value and n + 2 * e + 1 the
+// point at the upper value.
+//
+// The pieces of a case are the part of the simplex within the band, which is
+// convex, split into simplices from its vertex with the smallest code.
+const unsigned char vtkBandClipVertexCases[] = {
+  // b
+  0, // i
+  // a
+};
+const unsigned short vtkBandClipVertexCaseOffsets[] = {
+  0, 0, 1, 1
+};
+
+const unsigned char vtkBandClipLineCases[] = {
+  // bb
+  0, 2, // ib
+  3, 2, // ab
+  2, 1, // bi
+  0, 1, // ii
+  3, 1, // ai
+  2, 3, // ba
+  0, 3, // ia
+  // aa
+};
+const unsigned short vtkBandClipLineCaseOffsets[] = {
+  0, 0, 2, 4, 6, 8, 10, 12, 14, 14
+};
+
+const unsigned char vtkBandClipTriangleCases[] = {
+  // bbb
+  0, 3, 7, // ibb
+  3, 7, 8, 3, 8, 4, // abb
+  1, 5, 3, // bib
+  0, 1, 5, 0, 5, 7, // iib
+  1, 7, 8, 1, 5, 7, 1, 8, 4, // aib
+  3, 6, 5, 3, 4, 6, // bab
+  0, 6, 5, 0, 5, 7, 0, 4, 6, // iab
+  5, 7, 8, 5, 8, 6, // aab
+  2, 7, 5, // bbi
+  0, 5, 2, 0, 3, 5, // ibi
+  2, 4, 3, 2, 3, 5, 2, 8, 4, // abi
+  1, 2, 7, 1, 7, 3, // bii
+  0, 1, 2, // iii
+  1, 2, 8, 1, 8, 4, // aii
+  2, 3, 4, 2, 7, 3, 2, 4, 6, // bai
+  0, 6, 2, 0, 4, 6, // iai
+  2, 8, 6, // aai
+  5, 8, 7, 5, 6, 8, // bba
+  0, 5, 6, 0, 3, 5, 0, 6, 8, // iba
+  3, 5, 6, 3, 6, 4, // aba
+  1, 8, 7, 1, 7, 3, 1, 6, 8, // bia
+  0, 1, 6, 0, 6, 8, // iia
+  1, 6, 4, // aia
+  3, 8, 7, 3, 4, 8, // baa
+  0, 4, 8, // iaa
+  // aaa
+};
+const unsigned short vtkBandClipTriangleCaseOffsets[] = {
+  0, 0, 3, 9, 12, 18, 27, 33, 42, 48, 51, 57, 66, 72, 75, 81, 90, 96, 99, 105, 114, 120, 129, 135,
+  138, 144, 147, 147
+};
+
+const unsigned char vtkBandClipTetraCases[] = {
+  // bbbb
+  0, 4, 8, 10, // ibbb
+  4, 8, 9, 11, 4, 8, 11, 10, 4, 9, 5, 11, // abbb
+  1, 6, 4, 12, // bibb
+  0, 1, 6, 12, 0, 6, 8, 10, 0, 6, 10, 12, // iibb
+  1, 8, 9, 11, 1, 8, 11, 10, 1, 6, 8, 10, 1, 6, 10, 12, 1, 9, 5, 11, // aibb
+  4, 7, 6, 13, 4, 13, 6, 12, 4, 5, 7, 13, // babb
+  0, 7, 6, 13, 0, 13, 6, 12, 0, 6, 8, 10, 0, 6, 10, 12, 0, 5, 7, 13, // iabb
+  6, 8, 9, 11, 6, 8, 11, 10, 6, 10, 11, 13, 6, 10, 13, 12, 6, 9, 7, 11, 6, 11, 7, 13, // aabb
+  2, 8, 6, 14, // bbib
+  0, 6, 2, 14, 0, 4, 6, 14, 0, 4, 14, 10, // ibib
+  2, 5, 4, 11, 2, 11, 4, 10, 2, 4, 6, 14, 2, 4, 14, 10, 2, 9, 5, 11, // abib
+  1, 2, 8, 14, 1, 8, 4, 14, 1, 14, 4, 12, // biib
+  0, 1, 2, 14, 0, 1, 14, 12, 0, 10, 12, 14, // iiib
+  1, 2, 9, 11, 1, 2, 11, 10, 1, 2, 10, 14, 1, 10, 12, 14, 1, 9, 5, 11, // aiib
+  2, 4, 5, 13, 2, 4, 13, 12, 2, 8, 4, 14, 2, 14, 4, 12, 2, 5, 7, 13, // baib
+  0, 7, 2, 13, 0, 13, 2, 12, 0, 12, 2, 14, 0, 10, 12, 14, 0, 5, 7, 13, // iaib
+  2, 10, 11, 13, 2, 10, 13, 12, 2, 10, 12, 14, 2, 9, 7, 11, 2, 11, 7, 13, // aaib
+  6, 9, 8, 15, 6, 15, 8, 14, 6, 7, 9, 15, // bbab
+  0, 6, 7, 15, 0, 6, 15, 14, 0, 4, 6, 14, 0, 4, 14, 10, 0, 7, 9, 15, // ibab
+  4, 6, 7, 15, 4, 6, 15, 14, 4, 11, 10, 15, 4, 15, 10, 14, 4, 7, 5, 15, 4, 15, 5, 11, // abab
+  1, 9, 8, 15, 1, 15, 8, 14, 1, 8, 4, 14, 1, 14, 4, 12, 1, 7, 9, 15, // biab
+  0, 1, 7, 15, 0, 1, 15, 14, 0, 1, 14, 12, 0, 10, 12, 14, 0, 7, 9, 15, // iiab
+  1, 11, 10, 15, 1, 15, 10, 14, 1, 10, 12, 14, 1, 7, 5, 15, 1, 15, 5, 11, // aiab
+  4, 12, 13, 15, 4, 12, 15, 14, 4, 9, 8, 15, 4, 15, 8, 14, 4, 5, 9, 15, 4, 5, 15, 13, // baab
+  0, 12, 13, 15, 0, 12, 15, 14, 0, 10, 12, 14, 0, 5, 9, 15, 0, 5, 15, 13, // iaab
+  10, 12, 13, 15, 10, 12, 15, 14, 10, 13, 11, 15, // aaab
+  3, 12, 10, 14, // bbbi
+  0, 3, 12, 14, 0, 4, 8, 14, 0, 4, 14, 12, // ibbi
+  3, 4, 5, 9, 3, 4, 9, 8, 3, 4, 8, 14, 3, 4, 14, 12, 3, 9, 5, 11, // abbi
+  1, 10, 3, 14, 1, 6, 4, 14, 1, 14, 4, 10, // bibi
+  0, 3, 1, 14, 0, 14, 1, 6, 0, 6, 8, 14, // iibi
+  1, 3, 14, 8, 1, 3, 8, 9, 1, 3, 9, 11, 1, 6, 8, 14, 1, 9, 5, 11, // aibi
+  3, 5, 4, 7, 3, 7, 4, 6, 3, 6, 4, 14, 3, 14, 4, 10, 3, 5, 7, 13, // babi
+  0, 14, 3, 6, 0, 6, 3, 7, 0, 7, 3, 13, 0, 6, 8, 14, 0, 5, 7, 13, // iabi
+  3, 6, 7, 9, 3, 6, 9, 8, 3, 6, 8, 14, 3, 9, 7, 11, 3, 11, 7, 13, // aabi
+  2, 3, 10, 12, 2, 8, 6, 10, 2, 10, 6, 12, // bbii
+  0, 2, 3, 12, 0, 2, 12, 6, 0, 4, 6, 12, // ibii
+  2, 12, 3, 4, 2, 4, 3, 5, 2, 5, 3, 11, 2, 4, 6, 12, 2, 9, 5, 11, // abii
+  1, 3, 2, 10, 1, 10, 2, 8, 1, 8, 4, 10, // biii
+  0, 1, 2, 3, // iiii
+  1, 3, 2, 11, 1, 11, 2, 9, 1, 9, 5, 11, // aiii
+  2, 3, 10, 4, 2, 3, 4, 5, 2, 3, 5, 13, 2, 8, 4, 10, 2, 5, 7, 13, // baii
+  0, 2, 3, 13, 0, 2, 13, 7, 0, 5, 7, 13, // iaii
+  2, 3, 11, 13, 2, 9, 7, 11, 2, 11, 7, 13, // aaii
+  3, 7, 6, 9, 3, 9, 6, 8, 3, 8, 6, 10, 3, 10, 6, 12, 3, 7, 9, 15, // bbai
+  0, 3, 12, 6, 0, 3, 6, 7, 0, 3, 7, 15, 0, 4, 6, 12, 0, 7, 9, 15, // ibai
+  3, 4, 5, 7, 3, 4, 7, 6, 3, 4, 6, 12, 3, 7, 5, 15, 3, 15, 5, 11, // abai
+  1, 10, 3, 8, 1, 8, 3, 9, 1, 9, 3, 15, 1, 8, 4, 10, 1, 7, 9, 15, // biai
+  0, 3, 1, 15, 0, 15, 1, 7, 0, 7, 9, 15, // iiai
+  1, 11, 3, 15, 1, 7, 5, 15, 1, 15, 5, 11, // aiai
+  3, 5, 4, 9, 3, 9, 4, 8, 3, 8, 4, 10, 3, 5, 9, 15, 3, 5, 15, 13, // baai
+  0, 3, 13, 15, 0, 5, 9, 15, 0, 5, 15, 13, // iaai
+  3, 13, 11, 15, // aaai
+  10, 13, 12, 15, 10, 15, 12, 14, 10, 11, 13, 15, // bbba
+  0, 13, 12, 15, 0, 15, 12, 14, 0, 4, 8, 14, 0, 4, 14, 12, 0, 11, 13, 15, // ibba
+  4, 13, 12, 15, 4, 15, 12, 14, 4, 8, 9, 15, 4, 8, 15, 14, 4, 9, 5, 15, 4, 15, 5, 13, // abba
+  1, 10, 11, 15, 1, 10, 15, 14, 1, 6, 4, 14, 1, 14, 4, 10, 1, 11, 13, 15, // biba
+  0, 1, 6, 14, 0, 1, 14, 15, 0, 1, 15, 13, 0, 6, 8, 14, 0, 11, 13, 15, // iiba
+  1, 8, 9, 15, 1, 8, 15, 14, 1, 6, 8, 14, 1, 9, 5, 15, 1, 15, 5, 13, // aiba
+  4, 7, 6, 15, 4, 15, 6, 14, 4, 10, 11, 15, 4, 10, 15, 14, 4, 5, 7, 15, 4, 5, 15, 11, // baba
+  0, 7, 6, 15, 0, 15, 6, 14, 0, 6, 8, 14, 0, 5, 7, 15, 0, 5, 15, 11, // iaba
+  6, 8, 9, 15, 6, 8, 15, 14, 6, 9, 7, 15, // aaba
+  2, 11, 10, 13, 2, 13, 10, 12, 2, 8, 6, 10, 2, 10, 6, 12, 2, 11, 13, 15, // bbia
+  0, 6, 2, 12, 0, 12, 2, 13, 0, 13, 2, 15, 0, 4, 6, 12, 0, 11, 13, 15, // ibia
+  2, 5, 4, 13, 2, 13, 4, 12, 2, 4, 6, 12, 2, 9, 5, 15, 2, 15, 5, 13, // abia
+  1, 2, 8, 10, 1, 2, 10, 11, 1, 2, 11, 15, 1, 8, 4, 10, 1, 11, 13, 15, // biia
+  0, 1, 2, 15, 0, 1, 15, 13, 0, 11, 13, 15, // iiia
+  1, 2, 9, 15, 1, 9, 5, 15, 1, 15, 5, 13, // aiia
+  2, 4, 5, 11, 2, 4, 11, 10, 2, 8, 4, 10, 2, 5, 7, 15, 2, 5, 15, 11, // baia
+  0, 7, 2, 15, 0, 5, 7, 15, 0, 5, 15, 11, // iaia
+  2, 9, 7, 15, // aaia
+  6, 9, 8, 11, 6, 11, 8, 10, 6, 11, 10, 13, 6, 13, 10, 12, 6, 7, 9, 11, 6, 7, 11, 13, // bbaa
+  0, 6, 7, 13, 0, 6, 13, 12, 0, 4, 6, 12, 0, 7, 9, 11, 0, 7, 11, 13, // ibaa
+  4, 6, 7, 13, 4, 6, 13, 12, 4, 7, 5, 13, // abaa
+  1, 9, 8, 11, 1, 11, 8, 10, 1, 8, 4, 10, 1, 7, 9, 11, 1, 7, 11, 13, // biaa
+  0, 1, 7, 13, 0, 7, 9, 11, 0, 7, 11, 13, // iiaa
+  1, 7, 5, 13, // aiaa
+  4, 9, 8, 11, 4, 11, 8, 10, 4, 5, 9, 11, // baaa
+  0, 5, 9, 11, // iaaa
+  // aaaa
+};
+const unsigned short vtkBandClipTetraCaseOffsets[] = {
+  0, 0, 4, 16, 20, 32, 52, 64, 84, 108, 112, 124, 144, 156, 168, 188, 208, 228, 248, 260, 280, 304,
+  324, 344, 364, 388, 408, 420, 424, 436, 456, 468, 480, 500, 520, 540, 560, 572, 584, 604, 616,
+  620, 632, 652, 664, 676, 696, 716, 736, 756, 768, 780, 800, 812, 816, 828, 848, 872, 892, 912,
+  932, 956, 976, 988, 1008, 1028, 1048, 1068, 1080, 1092, 1112, 1124, 1128, 1152, 1172, 1184, 1204,
+  1216, 1220, 1232, 1236, 1236
+};
+
+const int vtkBandClipLineEdges[1][2] = { { 0, 1 } };
+const int vtkBandClipTriangleEdges[3][2] = { { 0, 1 }, { 1, 2 }, { 2, 0 } };
+const int vtkBandClipTetraEdges[6][2] = { { 0, 1 }, { 1, 2 }, { 2, 0 }, { 0, 3 }, { 1, 3 },
+  { 2, 3 } };
+
+struct vtkBandClipSimplexCases
+{
+  const unsigned char* Cases;
+  const unsigned short* Offsets;
+  const int (*Edges)[2];
+  int CellType;
+};
+
+// Indexed by the dimension of the simplex.
+const vtkBandClipSimplexCases vtkBandClipSimplices[4] = {
+  { vtkBandClipVertexCases, vtkBandClipVertexCaseOffsets, nullptr, VTK_VERTEX },
+  { vtkBandClipLineCases, vtkBandClipLineCaseOffsets, vtkBandClipLineEdges, VTK_LINE },
+  { vtkBandClipTriangleCases, vtkBandClipTriangleCaseOffsets, vtkBandClipTriangleEdges,
+    VTK_TRIANGLE },
+  { vtkBandClipTetraCases, vtkBandClipTetraCaseOffsets, vtkBandClipTetraEdges, VTK_TETRA }
+};
+
+//----------------------------------------------------------------------------
+// A point where the scalars reach the lower (Bound 0) or the upper (Bound 1)
+// value on the edge between two input points, with Point0 < Point1.
+struct vtkBandClipEdge
+{
+  vtkIdType Point0;
+  vtkIdType Point1;
+  int Bound;
+
+  bool operator<(const vtkBandClipEdge& other) const
+  {
+    if (this->Point0 != other.Point0)
+    {
+      return this->Point0 < other.Point0;
+    }
+    if (this->Point1 != other.Point1)
+    {
+      return this->Point1 < other.Point1;
+    }
+    return this->Bound < other.Bound;
+  }
+
+  bool operator==(const vtkBandClipEdge& other) const
+  {
+    return this->Point0 == other.Point0 && this->Point1 == other.Point1 &&
+      this->Bound == other.Bound;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Cells are clipped in chunks of this many input cells. The output of each
+// chunk is kept apart and the chunks are appended in order, so that the
+// output does not depend on the threads that processed them.
+const vtkIdType vtkBandClipChunkSize = 1024;
+
+struct vtkBandClipChunk
+{
+  // The cells generated for the chunk, in the vtkCellArray layout. Non
+  // negative point entries are input point ids, an entry -1 - i is the
+  // point of Edges[i].
+  std::vector<vtkIdType> Connectivity;
+  std::vector<unsigned char> Types;
+  std::vector<vtkIdType> CellIds;
+  std::vector<vtkBandClipEdge> Edges;
+  vtkIdType NumberOfSkippedCells;
+
+  vtkBandClipChunk()
+    : NumberOfSkippedCells(0)
+  {
+  }
+};
+
+//----------------------------------------------------------------------------
+struct vtkBandClipLocalData
+{
+  vtkSmartPointer<vtkGenericCell> Cell;
+  vtkSmartPointer<vtkIdList> SimplexIds;
+  vtkSmartPointer<vtkPoints> SimplexPoints;
+  vtkSmartPointer<vtkOrderedTriangulator> Triangulator;
+};
+
+//----------------------------------------------------------------------------
+class vtkBandClipWorker
+{
+public:
+  vtkDataSet* Input;
+  vtkDataArray* Scalars;
+  double Lower;
+  double Upper;
+  // Cell dimensions of structured inputs, 0 for the other datasets.
+  int CellDims[3];
+  std::vector<vtkBandClipChunk> Chunks;
+  vtkSMPThreadLocal<vtkBandClipLocalData> LocalData;
+
+  void Initialize()
+  {
+    vtkBandClipLocalData& local = this->LocalData.Local();
+    local.Cell = vtkSmartPointer<vtkGenericCell>::New();
+    local.SimplexIds = vtkSmartPointer<vtkIdList>::New();
+    local.SimplexPoints = vtkSmartPointer<vtkPoints>::New();
+    local.Triangulator = vtkSmartPointer<vtkOrderedTriangulator>::New();
+  }
+
+  void operator()(vtkIdType beginChunk, vtkIdType endChunk)
+  {
+    const vtkIdType numCells = this->Input->GetNumberOfCells();
+    for (vtkIdType chunkId = beginChunk; chunkId < endChunk; ++chunkId)
+    {
+      const vtkIdType begin = chunkId * vtkBandClipChunkSize;
+      this->ClipCells(
+        begin, std::min(begin + vtkBandClipChunkSize, numCells), this->Chunks[chunkId]);
+    }
+  }
+
+  void Reduce() {}
+
+private:
+  void ClipCells(vtkIdType begin, vtkIdType end, vtkBandClipChunk& chunk)
+  {
+    vtkBandClipLocalData& local = this->LocalData.Local();
+    vtkGenericCell* cell = local.Cell;
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Input->GetCell(cellId, cell);
+      const int cellType = cell->GetCellType();
+      if (cellType == VTK_EMPTY_CELL)
+      {
+        continue;
+      }
+      if (cellType == VTK_POLYHEDRON)
+      {
+        ++chunk.NumberOfSkippedCells;
+        continue;
+      }
+
+      const vtkIdType npts = cell->GetNumberOfPoints();
+      double range[2] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        const double s = this->Scalars->GetComponent(cell->GetPointId(i), 0);
+        range[0] = s < range[0] ? s : range[0];
+        range[1] = s > range[1] ? s : range[1];
+      }
+      if (range[1] < this->Lower || range[0] > this->Upper)
+      {
+        continue;
+      }
+
+      if (range[0] >= this->Lower && range[1] <= this->Upper)
+      {
+        // The cell is inside the band, pass it as is.
+        chunk.Connectivity.push_back(npts);
+        for (vtkIdType i = 0; i < npts; ++i)
+        {
+          chunk.Connectivity.push_back(cell->GetPointId(i));
+        }
+        chunk.Types.push_back(static_cast<unsigned char>(cellType));
+        chunk.CellIds.push_back(cellId);
+        continue;
+      }
+
+      // Split the cell into simplices and clip them with the case tables.
+      this->Triangulate(cellId, local);
+      const int dimension = cell->GetCellDimension();
+      const int numVertices = dimension + 1;
+      const vtkBandClipSimplexCases& cases = vtkBandClipSimplices[dimension];
+      const vtkIdType numIds = local.SimplexIds->GetNumberOfIds();
+      for (vtkIdType first = 0; first + numVertices <= numIds; first += numVertices)
+      {
+        const vtkIdType* simplex = local.SimplexIds->GetPointer(first);
+        int caseId = 0;
+        for (int i = numVertices - 1; i >= 0; --i)
+        {
+          const double s = this->Scalars->GetComponent(simplex[i], 0);
+          caseId = 3 * caseId + (s < this->Lower ? 0 : (s > this->Upper ? 2 : 1));
+        }
+        for (int code = cases.Offsets[caseId]; code < cases.Offsets[caseId + 1];
+             code += numVertices)
+        {
+          chunk.Connectivity.push_back(numVertices);
+          for (int i = 0; i < numVertices; ++i)
+          {
+            const int pointCode = cases.Cases[code + i];
+            if (pointCode < numVertices)
+            {
+              chunk.Connectivity.push_back(simplex[pointCode]);
+              continue;
+            }
+            const int* edge = cases.Edges[(pointCode - numVertices) / 2];
+            vtkBandClipEdge point;
+            point.Point0 = std::min(simplex[edge[0]], simplex[edge[1]]);
+            point.Point1 = std::max(simplex[edge[0]], simplex[edge[1]]);
+            point.Bound = (pointCode - numVertices) % 2;
+            chunk.Connectivity.push_back(-1 - static_cast<vtkIdType>(chunk.Edges.size()));
+            chunk.Edges.push_back(point);
+          }
+          chunk.Types.push_back(static_cast<unsigned char>(cases.CellType));
+          chunk.CellIds.push_back(cellId);
+        }
+      }
+    }
+  }
+
+  // Splits the cell in local.Cell into the simplices in local.SimplexIds.
+  // The faces shared by two 3D cells have to be split the same way by both.
+  // Structured cells are split the way vtkDataSetTriangleFilter does, which
+  // alternates the split between neighbors. The other 3D cells are split
+  // with vtkOrderedTriangulator, which orders the points by their ids so
+  // that a face is split the same way from either side.
+  void Triangulate(vtkIdType cellId, vtkBandClipLocalData& local) const
+  {
+    vtkGenericCell* cell = local.Cell;
+    if (this->CellDims[0] != 0)
+    {
+      const vtkIdType i = cellId % this->CellDims[0];
+      const vtkIdType j = (cellId / this->CellDims[0]) % this->CellDims[1];
+      const vtkIdType k = cellId / (static_cast<vtkIdType>(this->CellDims[0]) * this->CellDims[1]);
+      cell->Triangulate(static_cast<int>((i + j + k) % 2), local.SimplexIds, local.SimplexPoints);
+      return;
+    }
+    if (cell->GetCellDimension() != 3 || cell->GetCellType() == VTK_TETRA)
+    {
+      cell->Triangulate(0, local.SimplexIds, local.SimplexPoints);
+      return;
+    }
+
+    vtkOrderedTriangulator* triangulator = local.Triangulator;
+    const int numPts = cell->GetNumberOfPoints();
+    double* pcoords = cell->GetParametricCoords();
+    triangulator->InitTriangulation(0.0, 1.0, 0.0, 1.0, 0.0, 1.0, numPts);
+    for (int i = 0; i < numPts; ++i)
+    {
+      double x[3];
+      cell->GetPoints()->GetPoint(i, x);
+      triangulator->InsertPoint(cell->GetPointId(i), x, pcoords + 3 * i, 0);
+    }
+    if (cell->IsPrimaryCell())
+    {
+      triangulator->TemplateTriangulate(cell->GetCellType(), numPts, cell->GetNumberOfEdges());
+    }
+    else
+    {
+      triangulator->Triangulate();
+    }
+    local.SimplexIds->Reset();
+    local.SimplexPoints->Reset();
+    triangulator->AddTetras(0, local.SimplexIds, local.SimplexPoints);
+  }
+};
+}
+
+//----------------------------------------------------------------------------
+vtkBandClipDataSet::vtkBandClipDataSet()
+{
+  this->LowerValue = 0.0;
+  this->UpperValue = 1.0;
+
+  // by default process active point scalars
+  this->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS,
+    vtkDataSetAttributes::SCALARS);
+}
+
+//----------------------------------------------------------------------------
+vtkBandClipDataSet::~vtkBandClipDataSet()
+{
+}
+
+//----------------------------------------------------------------------------
+int vtkBandClipDataSet::FillInputPortInformation(int, vtkInformation* info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataSet");
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkBandClipDataSet::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkDataSet* input = vtkDataSet::GetData(inputVector[0], 0);
+  vtkUnstructuredGrid* output = vtkUnstructuredGrid::GetData(outputVector, 0);
+
+  int association = vtkDataObject::FIELD_ASSOCIATION_POINTS;
+  vtkDataArray* scalars = this->GetInputArrayToProcess(0, inputVector, association);
+  if (!scalars || association != vtkDataObject::FIELD_ASSOCIATION_POINTS)
+  {
+    vtkErrorMacro("Point scalars are required.");
+    return 0;
+  }
+
+  const vtkIdType numCells = input->GetNumberOfCells();
+  const vtkIdType numInputPoints = input->GetNumberOfPoints();
+  if (numCells == 0 || numInputPoints == 0)
+  {
+    return 1;
+  }
+
+  // Make the clip scalars the active ones so that they get interpolated with
+  // the other point arrays.
+  vtkPointData* inputPD = input->GetPointData();
+  vtkNew<vtkPointData> inPD;
+  inPD->ShallowCopy(inputPD);
+  if (!scalars->GetName() || inPD->SetActiveScalars(scalars->GetName()) < 0)
+  {
+    inPD->SetScalars(scalars);
+  }
+
+  vtkBandClipWorker worker;
+  worker.Input = input;
+  worker.Scalars = scalars;
+  worker.Lower = this->LowerValue;
+  worker.Upper = this->UpperValue;
+  int dims[3] = { 0, 0, 0 };
+  if (vtkImageData* image = vtkImageData::SafeDownCast(input))
+  {
+    image->GetDimensions(dims);
+  }
+  else if (vtkRectilinearGrid* rectilinear = vtkRectilinearGrid::SafeDownCast(input))
+  {
+    rectilinear->GetDimensions(dims);
+  }
+  else if (vtkStructuredGrid* structured = vtkStructuredGrid::SafeDownCast(input))
+  {
+    structured->GetDimensions(dims);
+  }
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    worker.CellDims[cc] = dims[0] > 0 ? std::max(dims[cc] - 1, 1) : 0;
+  }
+
+  // GetCell() with a generic cell is only thread safe once the dataset has
+  // built its cell links, which the first call does.
+  vtkNew<vtkGenericCell> cell;
+  input->GetCell(0, cell.GetPointer());
+
+  const vtkIdType numChunks = (numCells + vtkBandClipChunkSize - 1) / vtkBandClipChunkSize;
+  worker.Chunks.resize(numChunks);
+  vtkSMPTools::For(0, numChunks, 1, worker);
+
+  // Output points are the input points used by the cells, in input order,
+  // then one point per edge and bound crossed.
+  std::vector<vtkIdType> pointMap(numInputPoints, -1);
+  std::vector<vtkBandClipEdge> edges;
+  vtkIdType numOutputCells = 0;
+  vtkIdType numSkipped = 0;
+  for (vtkIdType chunkId = 0; chunkId < numChunks; ++chunkId)
+  {
+    const vtkBandClipChunk& local = worker.Chunks[chunkId];
+    numSkipped += local.NumberOfSkippedCells;
+    numOutputCells += static_cast<vtkIdType>(local.Types.size());
+    const vtkIdType size = static_cast<vtkIdType>(local.Connectivity.size());
+    for (vtkIdType location = 0; location < size; location += local.Connectivity[location] + 1)
+    {
+      for (vtkIdType i = 1; i <= local.Connectivity[location]; ++i)
+      {
+        const vtkIdType ptId = local.Connectivity[location + i];
+        if (ptId >= 0)
+        {
+          pointMap[ptId] = 0;
+        }
+      }
+    }
+    edges.insert(edges.end(), local.Edges.begin(), local.Edges.end());
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  vtkIdType numOutputPoints = 0;
+  for (vtkIdType ptId = 0; ptId < numInputPoints; ++ptId)
+  {
+    if (pointMap[ptId] >= 0)
+    {
+      pointMap[ptId] = numOutputPoints++;
+    }
+  }
+  const vtkIdType firstEdgePoint = numOutputPoints;
+  numOutputPoints += static_cast<vtkIdType>(edges.size());
+
+  vtkNew<vtkPoints> newPoints;
+  vtkPointSet* inputPS = vtkPointSet::SafeDownCast(input);
+  newPoints->SetDataType(
+    inputPS && inputPS->GetPoints() ? inputPS->GetPoints()->GetDataType() : VTK_FLOAT);
+  newPoints->SetNumberOfPoints(numOutputPoints);
+  vtkPointData* outPD = output->GetPointData();
+  outPD->InterpolateAllocate(inPD.GetPointer(), numOutputPoints);
+  for (vtkIdType ptId = 0; ptId < numInputPoints; ++ptId)
+  {
+    if (pointMap[ptId] >= 0)
+    {
+      newPoints->SetPoint(pointMap[ptId], input->GetPoint(ptId));
+      outPD->CopyData(inPD.GetPointer(), ptId, pointMap[ptId]);
+    }
+  }
+  const vtkIdType numEdges = static_cast<vtkIdType>(edges.size());
+  for (vtkIdType e = 0; e < numEdges; ++e)
+  {
+    const vtkBandClipEdge& edge = edges[e];
+    const double value = edge.Bound == 0 ? this->LowerValue : this->UpperValue;
+    const double s0 = scalars->GetComponent(edge.Point0, 0);
+    const double s1 = scalars->GetComponent(edge.Point1, 0);
+    const double t = (value - s0) / (s1 - s0);
+    double x0[3];
+    double x1[3];
+    input->GetPoint(edge.Point0, x0);
+    input->GetPoint(edge.Point1, x1);
+    double x[3];
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      x[cc] = x0[cc] + t * (x1[cc] - x0[cc]);
+    }
+    newPoints->SetPoint(firstEdgePoint + e, x);
+    outPD->InterpolateEdge(inPD.GetPointer(), firstEdgePoint + e, edge.Point0, edge.Point1, t);
+  }
+
+  vtkNew<vtkCellArray> newCells;
+  vtkNew<vtkUnsignedCharArray> newTypes;
+  newTypes->Allocate(numOutputCells);
+  vtkNew<vtkIdTypeArray> newLocations;
+  newLocations->Allocate(numOutputCells);
+  vtkCellData* outCD = output->GetCellData();
+  outCD->CopyAllocate(input->GetCellData(), numOutputCells);
+  for (vtkIdType chunkId = 0; chunkId < numChunks; ++chunkId)
+  {
+    const vtkBandClipChunk& local = worker.Chunks[chunkId];
+    const vtkIdType* connectivity = local.Connectivity.empty() ? nullptr : &local.Connectivity[0];
+    const vtkIdType numLocalCells = static_cast<vtkIdType>(local.Types.size());
+    for (vtkIdType cellId = 0; cellId < numLocalCells; ++cellId)
+    {
+      const vtkIdType npts = *connectivity++;
+      newLocations->InsertNextValue(newCells->GetNumberOfConnectivityEntries());
+      const vtkIdType newCellId = newCells->InsertNextCell(static_cast<int>(npts));
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        const vtkIdType ptId = connectivity[i];
+        if (ptId >= 0)
+        {
+          newCells->InsertCellPoint(pointMap[ptId]);
+        }
+        else
+        {
+          const vtkBandClipEdge& edge = local.Edges[-1 - ptId];
+          newCells->InsertCellPoint(
+            firstEdgePoint + (std::lower_bound(edges.begin(), edges.end(), edge) - edges.begin()));
+        }
+      }
+      connectivity += npts;
+      newTypes->InsertNextValue(local.Types[cellId]);
+      outCD->CopyData(input->GetCellData(), local.CellIds[cellId], newCellId);
+    }
+  }
+  if (numSkipped > 0)
+  {
+    vtkWarningMacro("Skipped " << numSkipped << " polyhedral cells.");
+  }
+
+  // Restore the active scalars of the input.
+  vtkDataArray* activeScalars = inputPD->GetScalars();
+  if (activeScalars != scalars)
+  {
+    if (activeScalars && activeScalars->GetName())
+    {
+      outPD->SetActiveScalars(activeScalars->GetName());
+    }
+    else
+    {
+      outPD->SetActiveAttribute(-1, vtkDataSetAttributes::SCALARS);
+    }
+  }
+
+  output->SetPoints(newPoints.GetPointer());
+  output->SetCells(newTypes.GetPointer(), newLocations.GetPointer(), newCells.GetPointer());
+  output->Squeeze();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkBandClipDataSet::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "LowerValue: " << this->LowerValue << endl;
+  os << indent << "UpperValue: " << this->UpperValue << endl;
+}
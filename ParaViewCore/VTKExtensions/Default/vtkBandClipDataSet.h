@@ -0,0 +1,83 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkBandClipDataSet.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkBandClipDataSet
+ * @brief   clip a dataset to a range of point scalars in one pass
+ *
+ * vtkBandClipDataSet keeps the portion of the input where the selected point
+ * scalars lie between LowerValue and UpperValue. This gives the same result
+ * as clipping with the lower value and then clipping the output with the
+ * upper value inside out, without building the intermediate unstructured
+ * grid.
+ *
+ * Cells are classified against the band from their point scalars. Cells
+ * entirely inside the band are passed with their original type, cells
+ * entirely outside are dropped, and cells straddling a bound are split into
+ * simplices which are cut with band case tables, giving tetrahedra,
+ * triangles, lines or vertices. 3D cells are split the way
+ * vtkDataSetTriangleFilter splits them, so that neighbor cells split their
+ * shared faces the same way. The cells are processed concurrently with
+ * vtkSMPTools, and the output does not depend on the number of threads.
+ *
+ * The output points are the input points used by the output cells, in the
+ * order of the input, followed by one point per edge and bound crossed, so
+ * that coincident input points are kept apart.
+ *
+ * Polyhedral cells are not supported and are skipped.
+ *
+ * @sa
+ * vtkIsoVolume vtkPVClipDataSet
+*/
+
+#ifndef vtkBandClipDataSet_h
+#define vtkBandClipDataSet_h
+
+#include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
+#include "vtkUnstructuredGridAlgorithm.h"
+
+class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkBandClipDataSet : public vtkUnstructuredGridAlgorithm
+{
+public:
+  static vtkBandClipDataSet* New();
+  vtkTypeMacro(vtkBandClipDataSet, vtkUnstructuredGridAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //@{
+  /**
+   * Set/get the bounds of the band of scalars to keep (inclusive of the end
+   * values). Defaults are 0 and 1.
+   */
+  vtkSetMacro(LowerValue, double);
+  vtkGetMacro(LowerValue, double);
+  vtkSetMacro(UpperValue, double);
+  vtkGetMacro(UpperValue, double);
+  //@}
+
+protected:
+  vtkBandClipDataSet();
+  ~vtkBandClipDataSet() override;
+
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
+  int FillInputPortInformation(int port, vtkInformation* info) override;
+
+  double LowerValue;
+  double UpperValue;
+
+private:
+  vtkBandClipDataSet(const vtkBandClipDataSet&) = delete;
+  void operator=(const vtkBandClipDataSet&) = delete;
+};
+
+#endif
@@ -15,36 +15,230 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkCleanUnstructuredGrid.h"
 
 #include "vtkCell.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCollection.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkIntArray.h"
-#include "vtkMergePoints.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Points binned in a uniform grid. The bins are built in parallel by sorting
+// the point ids by bin, so that the ids of each bin are in increasing order.
+// Points with non-finite coordinates are kept in an extra bin of their own.
+class vtkCleanPointBins
+{
+public:
+  vtkCleanPointBins(const std::vector<float>& coords, double tolerance)
+    : Coords(coords)
+    , Tolerance(tolerance)
+  {
+  }
+
+  void Build(const double bounds[6])
+  {
+    const vtkIdType numPts = static_cast<vtkIdType>(this->Coords.size() / 3);
+
+    // about 4 points per bin, and bins no smaller than the tolerance so that
+    // a query visits at most 3 bins along each axis.
+    double volume = 1.0;
+    int dim = 0;
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      this->Origin[cc] = bounds[2 * cc];
+      const double length = bounds[2 * cc + 1] - bounds[2 * cc];
+      if (length > 0.0)
+      {
+        volume *= length;
+        ++dim;
+      }
+    }
+    const double binSize =
+      dim > 0 ? std::pow(volume / std::max<vtkIdType>(numPts / 4, 1), 1.0 / dim) : 1.0;
+    double divisions[3];
+    double numberOfBins = 1.0;
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      const double length = bounds[2 * cc + 1] - bounds[2 * cc];
+      divisions[cc] = length > 0.0 ? std::floor(length / binSize) : 1.0;
+      if (this->Tolerance > 0.0)
+      {
+        divisions[cc] = std::min(divisions[cc], std::floor(length / this->Tolerance));
+      }
+      divisions[cc] = std::max(1.0, divisions[cc]);
+      numberOfBins *= divisions[cc];
+    }
+    // very flat bounds could ask for too many bins.
+    const double maxNumberOfBins = static_cast<double>(std::max<vtkIdType>(numPts, 1));
+    const double shrink =
+      numberOfBins > maxNumberOfBins ? std::cbrt(maxNumberOfBins / numberOfBins) : 1.0;
+    this->NumberOfBins = 1;
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      const double length = bounds[2 * cc + 1] - bounds[2 * cc];
+      this->Divisions[cc] =
+        static_cast<vtkIdType>(std::max(1.0, std::floor(divisions[cc] * shrink)));
+      this->Factor[cc] = length > 0.0 ? this->Divisions[cc] / length : 0.0;
+      this->NumberOfBins *= this->Divisions[cc];
+    }
+
+    this->Bins.resize(numPts);
+    vtkSMPTools::For(0, numPts, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType ptId = begin; ptId < end; ++ptId)
+      {
+        this->Bins[ptId] = std::make_pair(this->GetBin(&this->Coords[3 * ptId]), ptId);
+      }
+    });
+    vtkSMPTools::Sort(this->Bins.begin(), this->Bins.end());
+
+    // Offsets[bin] is the position of the first point of each bin, the
+    // non-finite bin included.
+    this->Offsets.assign(this->NumberOfBins + 2, numPts);
+    vtkSMPTools::For(0, numPts, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType pos = begin; pos < end; ++pos)
+      {
+        const vtkIdType first = pos == 0 ? 0 : this->Bins[pos - 1].first + 1;
+        for (vtkIdType bin = first; bin <= this->Bins[pos].first; ++bin)
+        {
+          this->Offsets[bin] = pos;
+        }
+      }
+    });
+  }
+
+  // Returns the lowest id, lower than ptId, of the points within tolerance of
+  // ptId for which accept() is true, or -1.
+  template <typename Accept>
+  vtkIdType FindLowest(vtkIdType ptId, Accept accept) const
+  {
+    const float* x = &this->Coords[3 * ptId];
+    vtkIdType lo[3], hi[3];
+    if (!this->IsFinite(x))
+    {
+      return this->FindLowestInBin(this->NumberOfBins, x, ptId, accept);
+    }
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      lo[cc] = this->GetIndex(cc, x[cc] - this->Tolerance);
+      hi[cc] = this->GetIndex(cc, x[cc] + this->Tolerance);
+    }
+    vtkIdType lowest = -1;
+    for (vtkIdType k = lo[2]; k <= hi[2]; ++k)
+    {
+      for (vtkIdType j = lo[1]; j <= hi[1]; ++j)
+      {
+        for (vtkIdType i = lo[0]; i <= hi[0]; ++i)
+        {
+          const vtkIdType bin = i + this->Divisions[0] * (j + this->Divisions[1] * k);
+          const vtkIdType id =
+            this->FindLowestInBin(bin, x, lowest >= 0 ? lowest : ptId, accept);
+          lowest = id >= 0 ? id : lowest;
+        }
+      }
+    }
+    return lowest;
+  }
+
+private:
+  static bool IsFinite(const float* x)
+  {
+    return vtkMath::IsFinite(x[0]) && vtkMath::IsFinite(x[1]) && vtkMath::IsFinite(x[2]);
+  }
+
+  vtkIdType GetIndex(int axis, double value) const
+  {
+    const double index = std::floor((value - this->Origin[axis]) * this->Factor[axis]);
+    return static_cast<vtkIdType>(
+      std::max(0.0, std::min(index, static_cast<double>(this->Divisions[axis] - 1))));
+  }
+
+  vtkIdType GetBin(const float* x) const
+  {
+    if (!this->IsFinite(x))
+    {
+      return this->NumberOfBins;
+    }
+    return this->GetIndex(0, x[0]) +
+      this->Divisions[0] * (this->GetIndex(1, x[1]) + this->Divisions[1] * this->GetIndex(2, x[2]));
+  }
+
+  // The ids of a bin being sorted, stops at the first match below limit.
+  template <typename Accept>
+  vtkIdType FindLowestInBin(vtkIdType bin, const float* x, vtkIdType limit, Accept accept) const
+  {
+    for (vtkIdType pos = this->Offsets[bin]; pos < this->Offsets[bin + 1]; ++pos)
+    {
+      const vtkIdType id = this->Bins[pos].second;
+      if (id >= limit)
+      {
+        break;
+      }
+      if (this->Matches(x, &this->Coords[3 * id]) && accept(id))
+      {
+        return id;
+      }
+    }
+    return -1;
+  }
+
+  bool Matches(const float* x, const float* y) const
+  {
+    if (this->Tolerance <= 0.0)
+    {
+      return x[0] == y[0] && x[1] == y[1] && x[2] == y[2];
+    }
+    const double d[3] = { static_cast<double>(x[0]) - y[0], static_cast<double>(x[1]) - y[1],
+      static_cast<double>(x[2]) - y[2] };
+    return vtkMath::Dot(d, d) <= this->Tolerance * this->Tolerance;
+  }
+
+  const std::vector<float>& Coords;
+  double Tolerance;
+  double Origin[3];
+  double Factor[3];
+  vtkIdType Divisions[3];
+  vtkIdType NumberOfBins;
+  std::vector<std::pair<vtkIdType, vtkIdType> > Bins;
+  std::vector<vtkIdType> Offsets;
+};
+}
+
 vtkStandardNewMacro(vtkCleanUnstructuredGrid);
 
 //----------------------------------------------------------------------------
 vtkCleanUnstructuredGrid::vtkCleanUnstructuredGrid()
+  : Tolerance(0.0)
 {
-  this->Locator = vtkMergePoints::New();
 }
 
 //----------------------------------------------------------------------------
 vtkCleanUnstructuredGrid::~vtkCleanUnstructuredGrid()
 {
-  this->Locator->Delete();
-  this->Locator = NULL;
 }
 
 //----------------------------------------------------------------------------
 void vtkCleanUnstructuredGrid::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "Tolerance: " << this->Tolerance << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -58,7 +252,7 @@ int vtkCleanUnstructuredGrid::RequestData(vtkInformation* vtkNotUsed(request),
   vtkUnstructuredGrid* output =
     vtkUnstructuredGrid::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  if (input->GetNumberOfCells() == 0)
+  if (input->GetNumberOfCells() == 0 || input->GetNumberOfPoints() == 0)
   {
     // set up a ugrid with same data arrays as input, but
     // no points, cells or data.
@@ -71,71 +265,172 @@ int vtkCleanUnstructuredGrid::RequestData(vtkInformation* vtkNotUsed(request),
     return 1;
   }
 
-  output->GetPointData()->CopyAllocate(input->GetPointData());
   output->GetCellData()->PassData(input->GetCellData());
 
-  // First, create a new points array that eliminate duplicate points.
-  // Also create a mapping from the old point id to the new.
-  vtkPoints* newPts = vtkPoints::New();
+  // First, eliminate duplicate points: the points are binned in parallel, then
+  // each point looks for the lowest id point it coincides with, or is within
+  // the tolerance of. The output points are stored as floats, which is also
+  // the precision at which points are compared.
   vtkIdType num = input->GetNumberOfPoints();
-  vtkIdType id;
-  vtkIdType newId;
-  vtkIdType* ptMap = new vtkIdType[num];
+  std::vector<float> coords(3 * num);
   double pt[3];
+  input->GetPoint(0, pt);
+  vtkSMPTools::For(0, num, [&](vtkIdType begin, vtkIdType end) {
+    double x[3];
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      input->GetPoint(id, x);
+      std::copy(x, x + 3, &coords[3 * id]);
+    }
+  });
 
-  this->Locator->InitPointInsertion(newPts, input->GetBounds(), num);
+  vtkCleanPointBins bins(coords, this->Tolerance);
+  bins.Build(input->GetBounds());
+  this->UpdateProgress(0.2);
 
-  vtkIdType progressStep = num / 100;
-  if (progressStep == 0)
+  std::vector<vtkIdType> ptMap(num);
+  vtkSMPTools::For(0, num, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      ptMap[id] = bins.FindLowest(id, [](vtkIdType) { return true; });
+    }
+  });
+  this->UpdateProgress(0.5);
+
+  // Then number the unique points in order. A point merges into the lowest id
+  // point that is kept, when the lowest id point it is close to has itself
+  // been merged, which only happens with a tolerance, it has to look again.
+  std::vector<vtkIdType> uniqueIds;
+  for (vtkIdType id = 0; id < num; ++id)
   {
-    progressStep = 1;
+    vtkIdType mergeId = ptMap[id];
+    if (mergeId >= 0 && uniqueIds[ptMap[mergeId]] != mergeId)
+    {
+      mergeId = bins.FindLowest(
+        id, [&](vtkIdType candidate) { return uniqueIds[ptMap[candidate]] == candidate; });
+    }
+    if (mergeId >= 0)
+    {
+      ptMap[id] = ptMap[mergeId];
+    }
+    else
+    {
+      ptMap[id] = static_cast<vtkIdType>(uniqueIds.size());
+      uniqueIds.push_back(id);
+    }
   }
-  for (id = 0; id < num; ++id)
+
+  // Copy the unique points and their point data. Point data arrays are copied
+  // in parallel when each output array has a matching input array.
+  const vtkIdType numUnique = static_cast<vtkIdType>(uniqueIds.size());
+  vtkPointData* inPD = input->GetPointData();
+  vtkPointData* outPD = output->GetPointData();
+  outPD->CopyAllocate(inPD, numUnique);
+  std::vector<std::pair<vtkDataArray*, vtkDataArray*> > arrays;
+  for (int cc = 0; cc < outPD->GetNumberOfArrays(); ++cc)
   {
-    if (id % progressStep == 0)
+    vtkAbstractArray* outArray = outPD->GetAbstractArray(cc);
+    const int attribute = outPD->IsArrayAnAttribute(cc);
+    vtkDataArray* inArray = vtkDataArray::SafeDownCast(outArray->GetName()
+        ? inPD->GetAbstractArray(outArray->GetName())
+        : (attribute >= 0 ? inPD->GetAbstractAttribute(attribute) : nullptr));
+    if (!inArray || !vtkDataArray::SafeDownCast(outArray) ||
+      inArray->GetNumberOfComponents() != outArray->GetNumberOfComponents())
     {
-      this->UpdateProgress(0.8 * ((float)id / num));
+      arrays.clear();
+      break;
     }
-    input->GetPoint(id, pt);
-    if (this->Locator->InsertUniquePoint(pt, newId))
+    arrays.push_back(std::make_pair(inArray, vtkDataArray::SafeDownCast(outArray)));
+  }
+  const bool parallelPointData = arrays.size() == static_cast<size_t>(outPD->GetNumberOfArrays());
+  for (size_t cc = 0; parallelPointData && cc < arrays.size(); ++cc)
+  {
+    arrays[cc].second->SetNumberOfTuples(numUnique);
+  }
+
+  vtkPoints* newPts = vtkPoints::New();
+  newPts->SetNumberOfPoints(numUnique);
+  float* newCoords = vtkFloatArray::SafeDownCast(newPts->GetData())->GetPointer(0);
+  vtkSMPTools::For(0, numUnique, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType newId = begin; newId < end; ++newId)
     {
-      output->GetPointData()->CopyData(input->GetPointData(), id, newId);
+      const vtkIdType id = uniqueIds[newId];
+      std::copy(&coords[3 * id], &coords[3 * id] + 3, newCoords + 3 * newId);
+      for (size_t cc = 0; parallelPointData && cc < arrays.size(); ++cc)
+      {
+        arrays[cc].second->SetTuple(newId, id, arrays[cc].first);
+      }
     }
-    ptMap[id] = newId;
+  });
+  for (vtkIdType newId = 0; !parallelPointData && newId < numUnique; ++newId)
+  {
+    outPD->CopyData(inPD, uniqueIds[newId], newId);
   }
   output->SetPoints(newPts);
   newPts->Delete();
+  this->UpdateProgress(0.7);
 
-  // Now copy the cells.
-  vtkIdList* cellPoints = vtkIdList::New();
+  // Now copy the cells. The connectivity of unstructured grids is remapped in
+  // parallel, polyhedra and other datasets go through InsertNextCell().
+  vtkUnstructuredGrid* inputUG = vtkUnstructuredGrid::SafeDownCast(input);
   num = input->GetNumberOfCells();
+  if (inputUG && !inputUG->GetFaces() && inputUG->GetCellLocationsArray())
+  {
+    vtkCellArray* inCells = inputUG->GetCells();
+    const vtkIdType* inIds = inCells->GetPointer();
+    const vtkIdType* locations = inputUG->GetCellLocationsArray()->GetPointer(0);
+    vtkNew<vtkIdTypeArray> newIds;
+    newIds->SetNumberOfValues(inCells->GetNumberOfConnectivityEntries());
+    vtkIdType* outIds = newIds->GetPointer(0);
+    vtkSMPTools::For(0, num, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType id = begin; id < end; ++id)
+      {
+        const vtkIdType loc = locations[id];
+        const vtkIdType npts = inIds[loc];
+        outIds[loc] = npts;
+        for (vtkIdType i = 1; i <= npts; ++i)
+        {
+          outIds[loc + i] = ptMap[inIds[loc + i]];
+        }
+      }
+    });
+    vtkNew<vtkCellArray> newCells;
+    newCells->SetCells(num, newIds.GetPointer());
+    output->SetCells(inputUG->GetCellTypesArray(), inputUG->GetCellLocationsArray(),
+      newCells.GetPointer());
+    return 1;
+  }
+
+  vtkIdType progressStep = num / 100;
+  if (progressStep == 0)
+  {
+    progressStep = 1;
+  }
+  vtkIdList* cellPoints = vtkIdList::New();
   output->Allocate(num);
-  for (id = 0; id < num; ++id)
+  for (vtkIdType id = 0; id < num; ++id)
   {
     if (id % progressStep == 0)
     {
-      this->UpdateProgress(0.8 + 0.2 * ((float)id / num));
+      this->UpdateProgress(0.7 + 0.3 * ((float)id / num));
     }
     // special handling for polyhedron cells
-    if (vtkUnstructuredGrid::SafeDownCast(input) && input->GetCellType(id) == VTK_POLYHEDRON)
+    if (inputUG && input->GetCellType(id) == VTK_POLYHEDRON)
     {
-      vtkUnstructuredGrid::SafeDownCast(input)->GetFaceStream(id, cellPoints);
-      vtkUnstructuredGrid::ConvertFaceStreamPointIds(cellPoints, ptMap);
+      inputUG->GetFaceStream(id, cellPoints);
+      vtkUnstructuredGrid::ConvertFaceStreamPointIds(cellPoints, &ptMap[0]);
     }
     else
     {
       input->GetCellPoints(id, cellPoints);
-      for (int i = 0; i < cellPoints->GetNumberOfIds(); i++)
+      for (vtkIdType i = 0; i < cellPoints->GetNumberOfIds(); i++)
       {
-        int cellPtId = cellPoints->GetId(i);
-        newId = ptMap[cellPtId];
-        cellPoints->SetId(i, newId);
+        cellPoints->SetId(i, ptMap[cellPoints->GetId(i)]);
       }
     }
     output->InsertNextCell(input->GetCellType(id), cellPoints);
   }
 
-  delete[] ptMap;
   cellPoints->Delete();
   output->Squeeze();
 
@@ -20,8 +20,10 @@
  *
  * vtkCleanUnstructuredGrid is a filter that takes unstructured grid data as
  * input and generates unstructured grid data as output. vtkCleanUnstructuredGrid can
- * merge duplicate points (with coincident coordinates) using the vtkMergePoints object
- * to merge points.
+ * merge duplicate points (with coincident coordinates), or points closer than
+ * \c Tolerance. A point is merged into the lowest id point it is close to that
+ * is kept, so the output does not depend on the number of threads used to bin
+ * the points, look for duplicates and remap the cell connectivity.
  *
  * @sa
  * vtkCleanPolyData
@@ -33,8 +35,6 @@
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 #include "vtkUnstructuredGridAlgorithm.h"
 
-class vtkPointLocator;
-
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkCleanUnstructuredGrid
   : public vtkUnstructuredGridAlgorithm
 {
@@ -45,11 +45,20 @@ public:
 
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Set/Get the distance under which points are merged, in the units of the
+   * input points. The default, 0, only merges coincident points.
+   */
+  vtkSetClampMacro(Tolerance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(Tolerance, double);
+  //@}
+
 protected:
   vtkCleanUnstructuredGrid();
   ~vtkCleanUnstructuredGrid() override;
 
-  vtkPointLocator* Locator;
+  double Tolerance;
 
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
   int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
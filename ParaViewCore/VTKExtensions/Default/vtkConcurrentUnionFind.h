@@ -0,0 +1,148 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkConcurrentUnionFind.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkConcurrentUnionFind
+ * @brief   lock-free disjoint sets over dense integer ids.
+ *
+ * vtkConcurrentUnionFind stores one parent link per member. Union() links
+ * the root with the larger id below the root with the smaller id using an
+ * atomic compare-and-swap, and Find() halves the path it walks. Both may be
+ * called concurrently from several threads (e.g. from vtkSMPTools::For).
+ *
+ * Links always point to smaller ids, so the root of a set is its smallest
+ * member. This is the ordering vtkEquivalenceSet relies on when it resolves
+ * its sets.
+ *
+ * This is an internal helper for vtkEquivalenceSet, vtkAMRConnectivity and
+ * vtkMaterialInterfaceFilter.
+*/
+
+#ifndef vtkConcurrentUnionFind_h
+#define vtkConcurrentUnionFind_h
+
+#include <atomic>  // for std::atomic
+#include <memory>  // for std::unique_ptr
+#include <utility> // for std::swap
+
+template <typename IdType>
+class vtkConcurrentUnionFind
+{
+public:
+  vtkConcurrentUnionFind()
+    : Size(0)
+  {
+  }
+
+  /**
+   * Make every member of [0, size) a set of its own. Not thread safe.
+   */
+  void Initialize(IdType size)
+  {
+    this->Allocate(size);
+    for (IdType ii = 0; ii < size; ++ii)
+    {
+      this->Parents[ii].store(ii, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Start from existing parent links. Every link must point to a smaller
+   * or equal id. Not thread safe.
+   */
+  void Initialize(const IdType* parents, IdType size)
+  {
+    this->Allocate(size);
+    for (IdType ii = 0; ii < size; ++ii)
+    {
+      this->Parents[ii].store(parents[ii], std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Release the links.
+   */
+  void Release()
+  {
+    this->Parents.reset();
+    this->Size = 0;
+  }
+
+  IdType GetSize() const { return this->Size; }
+
+  /**
+   * Return the root (smallest member) of the set containing id.
+   */
+  IdType Find(IdType id)
+  {
+    IdType parent = this->Parents[id].load(std::memory_order_relaxed);
+    while (parent != id)
+    {
+      IdType grandParent = this->Parents[parent].load(std::memory_order_relaxed);
+      if (grandParent != parent)
+      {
+        // Path halving. If the exchange fails another thread has already
+        // moved this link closer to the root, which is just as good.
+        this->Parents[id].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+      }
+      id = grandParent;
+      parent = this->Parents[id].load(std::memory_order_relaxed);
+    }
+    return id;
+  }
+
+  /**
+   * Merge the sets containing id1 and id2. Returns true when the two
+   * members were in different sets.
+   */
+  bool Union(IdType id1, IdType id2)
+  {
+    while (true)
+    {
+      id1 = this->Find(id1);
+      id2 = this->Find(id2);
+      if (id1 == id2)
+      {
+        return false;
+      }
+      if (id1 > id2)
+      {
+        std::swap(id1, id2);
+      }
+      // Only link id2 if it is still a root. Otherwise another thread
+      // linked it in the mean time and we start over from the new roots.
+      IdType expected = id2;
+      if (this->Parents[id2].compare_exchange_strong(expected, id1))
+      {
+        return true;
+      }
+    }
+  }
+
+private:
+  void Allocate(IdType size)
+  {
+    this->Parents.reset(size > 0 ? new std::atomic<IdType>[size] : nullptr);
+    this->Size = size;
+  }
+
+  std::unique_ptr<std::atomic<IdType>[]> Parents;
+  IdType Size;
+
+  vtkConcurrentUnionFind(const vtkConcurrentUnionFind&) = delete;
+  void operator=(const vtkConcurrentUnionFind&) = delete;
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkConcurrentUnionFind.h
@@ -13,8 +13,13 @@
 
 =========================================================================*/
 #include "vtkEquivalenceSet.h"
+#include "vtkConcurrentUnionFind.h"
 #include "vtkIntArray.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
 
 vtkStandardNewMacro(vtkEquivalenceSet);
 
@@ -24,6 +29,9 @@ vtkStandardNewMacro(vtkEquivalenceSet);
 //
 // I believe that this class is a strictly ordered tree of equivalences.
 // Every member points to its own id or an id smaller than itself.
+// It is a union-find structure: the root of every tree is the smallest
+// member of the set, sets are linked by their roots and lookups halve
+// the paths they walk.
 
 //----------------------------------------------------------------------------
 vtkEquivalenceSet::vtkEquivalenceSet()
@@ -76,16 +84,24 @@ void vtkEquivalenceSet::PrintSelf(ostream& os, vtkIndent indent)
 // Return the id of the equivalent set.
 int vtkEquivalenceSet::GetEquivalentSetId(int memberId)
 {
-  int ref;
+  if (memberId >= this->EquivalenceArray->GetNumberOfTuples())
+  { // We might consider this an error ...
+    return memberId;
+  }
 
-  ref = this->GetReference(memberId);
-  while (!this->Resolved && ref != memberId)
+  int* refs = this->EquivalenceArray->GetPointer(0);
+  if (this->Resolved)
   {
-    memberId = ref;
-    ref = this->GetReference(memberId);
+    return refs[memberId];
   }
 
-  return ref;
+  // Point every member on the way to its grandparent to keep chains short.
+  while (refs[memberId] != memberId)
+  {
+    refs[memberId] = refs[refs[memberId]];
+    memberId = refs[memberId];
+  }
+  return memberId;
 }
 
 //----------------------------------------------------------------------------
@@ -111,35 +127,84 @@ void vtkEquivalenceSet::AddEquivalence(int id1, int id2)
     return;
   }
 
-  int num = this->EquivalenceArray->GetNumberOfTuples();
-
   // Expand the range to include both ids.
-  while (num <= id1 || num <= id2)
-  {
-    // All values inserted are equivalent to only themselves.
-    this->EquivalenceArray->InsertNextTuple1(num);
-    ++num;
-  }
+  this->ExpandRange(std::max(id1, id2));
 
   // Our rule for references in the equivalent set is that
   // all elements must point to a member equal to or smaller
   // than itself.
+  this->EquateInternal(id1, id2);
+}
 
-  // The only problem we could encounter is changing a reference.
-  // we do not want to orphan anything previously referenced.
+//----------------------------------------------------------------------------
+void vtkEquivalenceSet::AddEquivalences(const int* pairs, vtkIdType numberOfPairs)
+{
+  if (this->Resolved)
+  {
+    vtkGenericWarningMacro("Set already resolved, you cannot add more equivalences.");
+    return;
+  }
+  if (numberOfPairs <= 0)
+  {
+    return;
+  }
 
-  // Replace the larger references.
-  if (id1 < id2)
+  // Expand the range to include all the ids.
+  vtkSMPThreadLocal<int> localMaxIds(-1);
+  vtkSMPTools::For(0, 2 * numberOfPairs, [&](vtkIdType begin, vtkIdType end) {
+    int& maxId = localMaxIds.Local();
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      maxId = std::max(maxId, pairs[ii]);
+    }
+  });
+  int maxId = -1;
+  for (vtkSMPThreadLocal<int>::iterator iter = localMaxIds.begin(); iter != localMaxIds.end();
+       ++iter)
+  {
+    maxId = std::max(maxId, *iter);
+  }
+  this->ExpandRange(maxId);
+
+  // Link the pairs concurrently, then point every member directly to
+  // the root of its set.
+  int numIds = this->EquivalenceArray->GetNumberOfTuples();
+  int* refs = this->EquivalenceArray->GetPointer(0);
+  vtkConcurrentUnionFind<int> sets;
+  sets.Initialize(refs, numIds);
+  vtkSMPTools::For(0, numberOfPairs, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      if (pairs[2 * ii] >= 0 && pairs[2 * ii + 1] >= 0)
+      {
+        sets.Union(pairs[2 * ii], pairs[2 * ii + 1]);
+      }
+    }
+  });
+  vtkSMPTools::For(0, numIds, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      refs[ii] = sets.Find(static_cast<int>(ii));
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+void vtkEquivalenceSet::ExpandRange(int id)
+{
+  int num = this->EquivalenceArray->GetNumberOfTuples();
+  if (num > id)
   {
-    // We could follow the references to the smallest.  It might
-    // make this processing more efficient.  This is a compromise.
-    // The referenced id will always be smaller than the id so
-    // order does not change.
-    this->EquateInternal(this->GetReference(id1), id2);
+    return;
   }
-  else
+
+  // All values inserted are equivalent to only themselves.
+  // InsertValue grows the array geometrically.
+  this->EquivalenceArray->InsertValue(id, id);
+  int* refs = this->EquivalenceArray->GetPointer(0);
+  for (; num < id; ++num)
   {
-    this->EquateInternal(this->GetReference(id2), id1);
+    refs[num] = num;
   }
 }
 
@@ -168,32 +233,20 @@ vtkIdType vtkEquivalenceSet::Capacity()
 }
 
 //----------------------------------------------------------------------------
-// id1 must be less than or equal to id2.
 void vtkEquivalenceSet::EquateInternal(int id1, int id2)
 {
-  // This is the reference that might be orphaned in this process.
-  int oldRef = this->GetEquivalentSetId(id2);
+  int root1 = this->GetEquivalentSetId(id1);
+  int root2 = this->GetEquivalentSetId(id2);
 
-  // The two ids are already equal (not the only way they might be equal).
-  if (oldRef == id1)
+  // Link the larger root below the smaller one so that no member ever
+  // references an id larger than itself.
+  if (root1 < root2)
   {
-    return;
+    this->EquivalenceArray->SetValue(root2, root1);
   }
-
-  // The only problem we could encounter is changing a reference.
-  // we do not want to orphan anything previously referenced.
-  if (oldRef == id2)
+  else if (root2 < root1)
   {
-    this->EquivalenceArray->SetValue(id2, id1);
-  }
-  else if (oldRef > id1)
-  {
-    this->EquivalenceArray->SetValue(id2, id1);
-    this->EquateInternal(id1, oldRef);
-  }
-  else
-  { // oldRef < id1
-    this->EquateInternal(oldRef, id1);
+    this->EquivalenceArray->SetValue(root1, root2);
   }
 }
 
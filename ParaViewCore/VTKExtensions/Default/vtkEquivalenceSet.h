@@ -37,6 +37,12 @@ public:
   void Initialize();
   void AddEquivalence(int id1, int id2);
 
+  // Makes the ids of each of the numberOfPairs pairs (id1, id2) stored
+  // consecutively in pairs equivalent. The pairs are linked concurrently
+  // with vtkSMPTools, which is much faster than calling AddEquivalence
+  // for each pair when there are many of them.
+  void AddEquivalences(const int* pairs, vtkIdType numberOfPairs);
+
   // The length of the equivalent array...
   // The Domain of the equivalance map is [0, numberOfMembers).
   int GetNumberOfMembers();
@@ -80,9 +86,13 @@ protected:
   // traversed by different processes or passes.
   vtkIntArray* EquivalenceArray;
 
-  // Return the id of the equivalent set.
+  // Links the sets of the two ids. The root with the larger id is linked
+  // below the other one.
   void EquateInternal(int id1, int id2);
 
+  // Makes sure the array contains the given id.
+  void ExpandRange(int id);
+
 private:
   vtkEquivalenceSet(const vtkEquivalenceSet&) = delete;
   void operator=(const vtkEquivalenceSet&) = delete;
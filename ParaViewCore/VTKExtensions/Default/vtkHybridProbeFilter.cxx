@@ -14,23 +14,250 @@
 =========================================================================*/
 #include "vtkHybridProbeFilter.h"
 
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCharArray.h"
+#include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
 #include "vtkCompositeDataToUnstructuredGridFilter.h"
 #include "vtkExtractSelection.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
-#include "vtkPProbeFilter.h"
-#include "vtkPointSource.h"
+#include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSelection.h"
 #include "vtkSelectionNode.h"
-#include "vtkSelectionSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkStaticCellLocator.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace
+{
+// Geometry the cell locator of a dataset depends on: its points and, for
+// unstructured grids and polydata, its cells. Changes to the attributes alone,
+// e.g. from one timestep to the next, do not invalidate it.
+vtkMTimeType vtkHybridProbeGeometryMTime(vtkDataSet* ds)
+{
+  vtkMTimeType mtime = 0;
+  if (vtkPointSet* ps = vtkPointSet::SafeDownCast(ds))
+  {
+    mtime = ps->GetPoints() ? ps->GetPoints()->GetMTime() : 0;
+  }
+  if (vtkUnstructuredGrid* ug = vtkUnstructuredGrid::SafeDownCast(ds))
+  {
+    mtime = std::max(mtime, ug->GetCells() ? ug->GetCells()->GetMTime() : 0);
+  }
+  else if (vtkPolyData* pd = vtkPolyData::SafeDownCast(ds))
+  {
+    mtime = std::max(mtime, pd->GetVerts()->GetMTime());
+    mtime = std::max(mtime, pd->GetLines()->GetMTime());
+    mtime = std::max(mtime, pd->GetPolys()->GetMTime());
+    mtime = std::max(mtime, pd->GetStrips()->GetMTime());
+  }
+  return mtime;
+}
+
+// Where a location was found: the leaf of the input, the cell, its points and
+// the interpolation weights.
+struct vtkHybridProbeHit
+{
+  int Leaf = -1;
+  vtkIdType CellId = -1;
+  std::vector<vtkIdType> PointIds;
+  std::vector<double> Weights;
+};
+}
+
+//----------------------------------------------------------------------------
+// Keeps a cell locator for each leaf of the input between executions. A
+// locator is rebuilt only when its dataset is a different one, or when the
+// geometry of the dataset changed.
+class vtkHybridProbeFilter::vtkInternals
+{
+public:
+  struct Leaf
+  {
+    vtkDataSet* DataSet;
+    unsigned int FlatIndex;
+    double Tolerance2;
+    int MaxCellSize;
+  };
+
+  struct Index
+  {
+    vtkMTimeType GeometryMTime;
+    vtkSmartPointer<vtkStaticCellLocator> Locator;
+  };
+
+  std::vector<Leaf> Leaves;
+  std::vector<Index> Indices;
+  unsigned long NumberOfBuilds = 0;
+
+  // Largest number of points of a cell over all the leaves, i.e. the number
+  // of interpolation weights to allocate.
+  int MaxCellSize = 1;
+
+  //---------------------------------------------------------------------------
+  // Collects the non-empty leaves of the input and makes their locators ready
+  // to be used from several threads.
+  void Update(vtkDataObject* input)
+  {
+    this->Leaves.clear();
+    this->MaxCellSize = 1;
+    if (vtkCompositeDataSet* cd = vtkCompositeDataSet::SafeDownCast(input))
+    {
+      vtkSmartPointer<vtkCompositeDataIterator> iter;
+      iter.TakeReference(cd->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+        this->AddLeaf(vtkDataSet::SafeDownCast(iter->GetCurrentDataObject()),
+          iter->GetCurrentFlatIndex());
+      }
+    }
+    else
+    {
+      this->AddLeaf(vtkDataSet::SafeDownCast(input), 0);
+    }
+
+    // Locators of datasets which are gone or changed are released first, they
+    // keep the previous input alive and do not need to coexist with the new
+    // ones.
+    this->Indices.resize(this->Leaves.size());
+    for (size_t cc = 0; cc < this->Leaves.size(); ++cc)
+    {
+      vtkDataSet* ds = this->Leaves[cc].DataSet;
+      Index& index = this->Indices[cc];
+      if (index.Locator &&
+        (index.Locator->GetDataSet() != ds || !vtkPointSet::SafeDownCast(ds) ||
+          index.GeometryMTime != vtkHybridProbeGeometryMTime(ds)))
+      {
+        index.Locator = nullptr;
+      }
+    }
+
+    for (size_t cc = 0; cc < this->Leaves.size(); ++cc)
+    {
+      vtkDataSet* ds = this->Leaves[cc].DataSet;
+      Index& index = this->Indices[cc];
+      // image data and rectilinear grids find their cells directly.
+      if (!index.Locator && vtkPointSet::SafeDownCast(ds))
+      {
+        const vtkMTimeType mtime = vtkHybridProbeGeometryMTime(ds);
+        index.Locator = vtkSmartPointer<vtkStaticCellLocator>::New();
+        index.Locator->SetDataSet(ds);
+        index.Locator->BuildLocator();
+        index.GeometryMTime = mtime;
+        ++this->NumberOfBuilds;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Looks for the cell containing x in the given leaf. weights must hold
+  // MaxCellSize values.
+  bool Find(size_t leafIndex, const double x[3], vtkGenericCell* cell, vtkIdList* ptIds,
+    std::vector<double>& weights, vtkHybridProbeHit& hit) const
+  {
+    const Leaf& leaf = this->Leaves[leafIndex];
+    assert(static_cast<int>(weights.size()) >= leaf.MaxCellSize);
+    double* xx = const_cast<double*>(x);
+    double pcoords[3];
+    vtkIdType cellId;
+    if (this->Indices[leafIndex].Locator)
+    {
+      cellId = this->Indices[leafIndex].Locator->FindCell(
+        xx, leaf.Tolerance2, cell, pcoords, &weights[0]);
+    }
+    else
+    {
+      int subId;
+      cellId =
+        leaf.DataSet->FindCell(xx, nullptr, cell, -1, leaf.Tolerance2, subId, pcoords, &weights[0]);
+    }
+    if (cellId < 0)
+    {
+      return false;
+    }
+    leaf.DataSet->GetCellPoints(cellId, ptIds);
+    hit.Leaf = static_cast<int>(leafIndex);
+    hit.CellId = cellId;
+    hit.PointIds.assign(ptIds->GetPointer(0), ptIds->GetPointer(0) + ptIds->GetNumberOfIds());
+    hit.Weights.assign(weights.begin(), weights.begin() + ptIds->GetNumberOfIds());
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  // Finds the cells containing all the locations in parallel.
+  void Find(vtkPoints* locations, std::vector<vtkHybridProbeHit>& hits) const
+  {
+    const vtkIdType numLocations = locations->GetNumberOfPoints();
+    hits.assign(numLocations, vtkHybridProbeHit());
+    vtkSMPThreadLocalObject<vtkGenericCell> cells;
+    vtkSMPThreadLocalObject<vtkIdList> ptIds;
+    vtkSMPThreadLocal<std::vector<double> > weights(std::vector<double>(this->MaxCellSize));
+    vtkSMPTools::For(0, numLocations, [&](vtkIdType begin, vtkIdType end) {
+      double x[3];
+      for (vtkIdType cc = begin; cc < end; ++cc)
+      {
+        locations->GetPoint(cc, x);
+        // the first leaf containing the location wins.
+        for (size_t leaf = 0; leaf < this->Leaves.size(); ++leaf)
+        {
+          if (this->Find(leaf, x, cells.Local(), ptIds.Local(), weights.Local(), hits[cc]))
+          {
+            break;
+          }
+        }
+      }
+    });
+  }
+
+private:
+  void AddLeaf(vtkDataSet* ds, unsigned int flatIndex)
+  {
+    if (!ds || ds->GetNumberOfCells() == 0)
+    {
+      return;
+    }
+    // tolerance relative to the size of the dataset.
+    double tol2 = ds->GetLength();
+    tol2 = tol2 ? tol2 * tol2 / 1000.0 : 0.001;
+
+    // GetCell() and GetCellPoints() are thread safe once called from a single
+    // thread.
+    vtkNew<vtkGenericCell> cell;
+    ds->GetCell(0, cell.GetPointer());
+
+    // GetMaxCellSize() goes through all the cells of unstructured data, it is
+    // only computed once per execution.
+    Leaf leaf = { ds, flatIndex, tol2, std::max(ds->GetMaxCellSize(), 1) };
+    this->Leaves.push_back(leaf);
+    this->MaxCellSize = std::max(this->MaxCellSize, leaf.MaxCellSize);
+  }
+};
+
 vtkStandardNewMacro(vtkHybridProbeFilter);
+vtkCxxSetObjectMacro(vtkHybridProbeFilter, Locations, vtkPoints);
 //----------------------------------------------------------------------------
 vtkHybridProbeFilter::vtkHybridProbeFilter()
   : Mode(vtkHybridProbeFilter::INTERPOLATE_AT_LOCATION)
+  , Locations(nullptr)
+  , Internals(new vtkHybridProbeFilter::vtkInternals())
 {
   this->Location[0] = this->Location[1] = this->Location[2] = 0.0;
 }
@@ -38,6 +265,25 @@ vtkHybridProbeFilter::vtkHybridProbeFilter()
 //----------------------------------------------------------------------------
 vtkHybridProbeFilter::~vtkHybridProbeFilter()
 {
+  this->SetLocations(nullptr);
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkHybridProbeFilter::GetMTime()
+{
+  vtkMTimeType mtime = this->Superclass::GetMTime();
+  if (this->Locations)
+  {
+    mtime = std::max(mtime, this->Locations->GetMTime());
+  }
+  return mtime;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkHybridProbeFilter::GetNumberOfLocatorBuilds() const
+{
+  return this->Internals->NumberOfBuilds;
 }
 
 //----------------------------------------------------------------------------
@@ -62,6 +308,8 @@ int vtkHybridProbeFilter::RequestData(
   vtkDataObject* input = vtkDataObject::GetData(inputVector[0], 0);
   vtkUnstructuredGrid* output = vtkUnstructuredGrid::GetData(outputVector, 0);
 
+  this->Internals->Update(input);
+
   switch (this->Mode)
   {
     case INTERPOLATE_AT_LOCATION:
@@ -77,37 +325,182 @@ int vtkHybridProbeFilter::RequestData(
 //----------------------------------------------------------------------------
 bool vtkHybridProbeFilter::InterpolateAtLocation(vtkDataObject* input, vtkUnstructuredGrid* output)
 {
-  vtkNew<vtkPointSource> pointSource;
-  pointSource->SetNumberOfPoints(1);
-  pointSource->SetCenter(this->Location);
-  pointSource->SetRadius(0.0);
-  pointSource->SetOutputPointsPrecision(vtkAlgorithm::DOUBLE_PRECISION);
-
-  vtkNew<vtkPProbeFilter> probe;
-  probe->SetInputConnection(0, pointSource->GetOutputPort());
-  probe->SetInputDataObject(1, input);
-  probe->Update();
-
-  output->ShallowCopy(probe->GetOutputDataObject(0));
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  if (this->Locations)
+  {
+    points->DeepCopy(this->Locations);
+  }
+  else
+  {
+    points->InsertNextPoint(this->Location);
+  }
+  const vtkIdType numPts = points->GetNumberOfPoints();
+
+  std::vector<vtkHybridProbeHit> hits;
+  this->Internals->Find(points.GetPointer(), hits);
+
+  // Output arrays are the point arrays common to all leaves, followed by the
+  // cell arrays common to all leaves that have a name not used by the former,
+  // as vtkProbeFilter does.
+  const std::vector<vtkInternals::Leaf>& leaves = this->Internals->Leaves;
+  vtkDataSetAttributes::FieldList pointList;
+  vtkDataSetAttributes::FieldList cellList;
+  for (size_t cc = 0; cc < leaves.size(); ++cc)
+  {
+    pointList.IntersectFieldList(leaves[cc].DataSet->GetPointData());
+    cellList.IntersectFieldList(leaves[cc].DataSet->GetCellData());
+  }
+
+  output->Initialize();
+  output->SetPoints(points.GetPointer());
+  vtkPointData* outPD = output->GetPointData();
+  vtkNew<vtkPointData> cellArrays;
+  if (!leaves.empty())
+  {
+    outPD->InterpolateAllocate(pointList, numPts, numPts);
+    cellArrays->CopyAllocate(cellList, numPts, numPts);
+  }
+
+  vtkNew<vtkCharArray> mask;
+  mask->SetName("vtkValidPointMask");
+  mask->SetNumberOfTuples(numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    const vtkHybridProbeHit& hit = hits[cc];
+    if (hit.Leaf < 0)
+    {
+      outPD->NullPoint(cc);
+      cellArrays->NullPoint(cc);
+      mask->SetValue(cc, 0);
+      continue;
+    }
+    vtkDataSet* ds = leaves[hit.Leaf].DataSet;
+    vtkNew<vtkIdList> ptIds;
+    ptIds->SetNumberOfIds(static_cast<vtkIdType>(hit.PointIds.size()));
+    std::copy(hit.PointIds.begin(), hit.PointIds.end(), ptIds->GetPointer(0));
+    outPD->InterpolatePoint(pointList, ds->GetPointData(), hit.Leaf, cc, ptIds.GetPointer(),
+      const_cast<double*>(hit.Weights.data()));
+    cellArrays->CopyData(cellList, ds->GetCellData(), hit.Leaf, hit.CellId, cc);
+    mask->SetValue(cc, 1);
+  }
+  for (int cc = 0; cc < cellArrays->GetNumberOfArrays(); ++cc)
+  {
+    vtkAbstractArray* array = cellArrays->GetAbstractArray(cc);
+    if (!array->GetName() || !outPD->HasArray(array->GetName()))
+    {
+      outPD->AddArray(array);
+    }
+  }
+  outPD->AddArray(mask.GetPointer());
+  if (vtkDataSet* ds = vtkDataSet::SafeDownCast(input))
+  {
+    output->GetFieldData()->PassData(ds->GetFieldData());
+  }
+
+  this->ReduceValidPoints(output);
   return true;
 }
 
+//----------------------------------------------------------------------------
+void vtkHybridProbeFilter::ReduceValidPoints(vtkUnstructuredGrid* output)
+{
+  // Same as vtkPProbeFilter: the first process gets, for each point, the
+  // values of any process that found it.
+  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  if (!controller || controller->GetNumberOfProcesses() <= 1)
+  {
+    return;
+  }
+
+  std::vector<vtkSmartPointer<vtkDataObject> > remotes;
+  controller->Gather(output, remotes, 0);
+  if (controller->GetLocalProcessId() != 0)
+  {
+    output->ReleaseData();
+    return;
+  }
+
+  vtkPointData* outPD = output->GetPointData();
+  bool hasArrays = !this->Internals->Leaves.empty();
+  for (size_t cc = 1; cc < remotes.size(); ++cc)
+  {
+    vtkDataSet* remote = vtkDataSet::SafeDownCast(remotes[cc]);
+    vtkCharArray* remoteMask = remote
+      ? vtkArrayDownCast<vtkCharArray>(remote->GetPointData()->GetArray("vtkValidPointMask"))
+      : nullptr;
+    if (!remoteMask || remote->GetNumberOfPoints() != output->GetNumberOfPoints())
+    {
+      continue;
+    }
+    if (!hasArrays && remote->GetPointData()->GetNumberOfArrays() > 1)
+    {
+      // this process has no data, start from the arrays of the first one that
+      // has some.
+      outPD->DeepCopy(remote->GetPointData());
+      hasArrays = true;
+      continue;
+    }
+    for (vtkIdType ptId = 0; ptId < remote->GetNumberOfPoints(); ++ptId)
+    {
+      if (remoteMask->GetValue(ptId) != 1)
+      {
+        continue;
+      }
+      for (int k = 0; k < outPD->GetNumberOfArrays(); ++k)
+      {
+        vtkAbstractArray* array = outPD->GetAbstractArray(k);
+        vtkAbstractArray* remoteArray =
+          array->GetName() ? remote->GetPointData()->GetAbstractArray(array->GetName()) : nullptr;
+        if (remoteArray)
+        {
+          array->SetTuple(ptId, ptId, remoteArray);
+        }
+      }
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 bool vtkHybridProbeFilter::ExtractCellContainingLocation(
   vtkDataObject* input, vtkUnstructuredGrid* output)
 {
-  vtkNew<vtkSelectionSource> selSource;
-  selSource->AddLocation(this->Location[0], this->Location[1], this->Location[2]);
-  selSource->SetContentType(vtkSelectionNode::LOCATIONS);
-  selSource->SetFieldType(vtkSelectionNode::CELL);
+  // Find the cell in each leaf with the cached locators, then extract it by
+  // index.
+  const std::vector<vtkInternals::Leaf>& leaves = this->Internals->Leaves;
+  const bool composite = vtkCompositeDataSet::SafeDownCast(input) != nullptr;
+  vtkNew<vtkSelection> selection;
+  vtkNew<vtkGenericCell> cell;
+  vtkNew<vtkIdList> ptIds;
+  std::vector<double> weights(this->Internals->MaxCellSize);
+  for (size_t cc = 0; cc < leaves.size(); ++cc)
+  {
+    vtkHybridProbeHit hit;
+    if (!this->Internals->Find(
+          cc, this->Location, cell.GetPointer(), ptIds.GetPointer(), weights, hit))
+    {
+      continue;
+    }
+    vtkNew<vtkSelectionNode> node;
+    node->SetContentType(vtkSelectionNode::INDICES);
+    node->SetFieldType(vtkSelectionNode::CELL);
+    if (composite)
+    {
+      node->GetProperties()->Set(vtkSelectionNode::COMPOSITE_INDEX(), leaves[cc].FlatIndex);
+    }
+    vtkNew<vtkIdTypeArray> ids;
+    ids->InsertNextValue(hit.CellId);
+    node->SetSelectionList(ids.GetPointer());
+    selection->AddNode(node.GetPointer());
+  }
 
   vtkNew<vtkExtractSelection> extractor;
   extractor->SetInputDataObject(0, input);
-  extractor->SetInputConnection(1, selSource->GetOutputPort());
+  extractor->SetInputDataObject(1, selection.GetPointer());
   extractor->PreserveTopologyOff();
   extractor->Update();
 
-  if (vtkCompositeDataSet::SafeDownCast(input))
+  if (composite)
   {
     vtkNew<vtkCompositeDataToUnstructuredGridFilter> merger;
     merger->SetInputDataObject(extractor->GetOutputDataObject(0));
@@ -128,4 +521,5 @@ void vtkHybridProbeFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Mode: " << this->Mode << endl;
   os << indent << "Location: " << this->Location[0] << ", " << this->Location[1] << ", "
      << this->Location[2] << endl;
+  os << indent << "Locations: " << this->Locations << endl;
 }
@@ -25,7 +25,12 @@
  * exactly what he/she is looking for -- interpolate at point location (probe)
  * or extract cell containing the point (extract selection).
  *
- * Internally this filter uses vtkPProbeFilter and vtkExtractSelection.
+ * The cells containing the location are found with a vtkStaticCellLocator for
+ * each dataset of the input, which is kept between executions and only rebuilt
+ * when the points or cells of the dataset change, so that moving the location
+ * or updating the attributes does not pay for it again. \c Locations can be
+ * set to interpolate at many points at once, found in parallel with
+ * vtkSMPTools. Cells are extracted with vtkExtractSelection.
 */
 
 #ifndef vtkHybridProbeFilter_h
@@ -34,6 +39,7 @@
 #include "vtkDataObjectAlgorithm.h"
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 
+class vtkPoints;
 class vtkUnstructuredGrid;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkHybridProbeFilter : public vtkDataObjectAlgorithm
@@ -62,6 +68,27 @@ public:
   vtkGetVector3Macro(Location, double);
   //@}
 
+  //@{
+  /**
+   * Get/Set the points to interpolate at in INTERPOLATE_AT_LOCATION mode.
+   * When set, they are used instead of \c Location and the output has one point
+   * for each of them. Default is nullptr.
+   */
+  void SetLocations(vtkPoints*);
+  vtkGetObjectMacro(Locations, vtkPoints);
+  //@}
+
+  /**
+   * Overridden to include the MTime of \c Locations.
+   */
+  vtkMTimeType GetMTime() VTK_OVERRIDE;
+
+  /**
+   * Returns how many times a cell locator was built since this filter was
+   * created, to check that they are reused.
+   */
+  unsigned long GetNumberOfLocatorBuilds() const;
+
 protected:
   vtkHybridProbeFilter();
   ~vtkHybridProbeFilter() override;
@@ -73,12 +100,22 @@ protected:
   bool InterpolateAtLocation(vtkDataObject* input, vtkUnstructuredGrid* output);
   bool ExtractCellContainingLocation(vtkDataObject* input, vtkUnstructuredGrid* output);
 
+  /**
+   * In parallel, gathers on the first process the values interpolated by the
+   * processes that found each point, as vtkPProbeFilter does.
+   */
+  void ReduceValidPoints(vtkUnstructuredGrid* output);
+
   double Location[3];
   int Mode;
+  vtkPoints* Locations;
 
 private:
   vtkHybridProbeFilter(const vtkHybridProbeFilter&) = delete;
   void operator=(const vtkHybridProbeFilter&) = delete;
+
+  class vtkInternals;
+  vtkInternals* Internals;
 };
 
 #endif
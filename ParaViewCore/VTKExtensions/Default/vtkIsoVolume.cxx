@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkIsoVolume.h"
 
+#include "vtkBandClipDataSet.h"
 #include "vtkCell.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
@@ -24,6 +25,7 @@
 #include "vtkInformationStringVectorKey.h"
 #include "vtkInformationVector.h"
 #include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
 #include "vtkNonOverlappingAMR.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVClipDataSet.h"
@@ -103,16 +105,41 @@ int vtkIsoVolume::RequestData(vtkInformation* vtkNotUsed(request),
   }
   arrayName = vtkStdString(inArrayInfo->Get(vtkDataObject::FIELD_NAME()));
 
-  // FIXME: Currently, both clips are always run. As a performance improvement
-  // we can avoid running one of the clips if not needed.
-  vtkDataObject* inputClone = inObj->NewInstance();
-  inputClone->ShallowCopy(inObj);
-  outObj1.TakeReference(
-    this->Clip(inputClone, this->LowerThreshold, arrayName.c_str(), fieldAssociation, false));
-  inputClone->Delete();
-
-  outObj1.TakeReference(
-    this->Clip(outObj1, this->UpperThreshold, arrayName.c_str(), fieldAssociation, true));
+  vtkDataSet* inDS = vtkDataSet::SafeDownCast(inObj);
+  vtkMultiBlockDataSet* inMB = vtkMultiBlockDataSet::SafeDownCast(inObj);
+  if (fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS && inDS)
+  {
+    outObj1.TakeReference(this->ClipRange(inDS, arrayName.c_str()));
+  }
+  else if (fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS && inMB)
+  {
+    vtkMultiBlockDataSet* outMB = vtkMultiBlockDataSet::New();
+    outMB->CopyStructure(inMB);
+    vtkSmartPointer<vtkCompositeDataIterator> iter;
+    iter.TakeReference(inMB->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkDataSet* block = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+      if (block)
+      {
+        vtkDataObject* clipped = this->ClipRange(block, arrayName.c_str());
+        outMB->SetDataSet(iter, clipped);
+        clipped->Delete();
+      }
+    }
+    outObj1.TakeReference(outMB);
+  }
+  else
+  {
+    vtkDataObject* inputClone = inObj->NewInstance();
+    inputClone->ShallowCopy(inObj);
+    outObj1.TakeReference(
+      this->Clip(inputClone, this->LowerThreshold, arrayName.c_str(), fieldAssociation, false));
+    inputClone->Delete();
+
+    outObj1.TakeReference(
+      this->Clip(outObj1, this->UpperThreshold, arrayName.c_str(), fieldAssociation, true));
+  }
 
   assert(outObj1->IsA(outObj->GetClassName()));
   outObj->ShallowCopy(outObj1);
@@ -144,6 +171,36 @@ vtkDataObject* vtkIsoVolume::Clip(
   return output;
 }
 
+//----------------------------------------------------------------------------
+vtkDataObject* vtkIsoVolume::ClipRange(vtkDataSet* input, const char* array_name)
+{
+  vtkSmartPointer<vtkDataSet> inputClone;
+  inputClone.TakeReference(input->NewInstance());
+  inputClone->ShallowCopy(input);
+
+  vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(input);
+  if (grid && grid->GetFaces())
+  {
+    // vtkBandClipDataSet does not cut polyhedra.
+    vtkSmartPointer<vtkDataObject> lower;
+    lower.TakeReference(this->Clip(inputClone, this->LowerThreshold, array_name,
+      vtkDataObject::FIELD_ASSOCIATION_POINTS, false));
+    return this->Clip(
+      lower, this->UpperThreshold, array_name, vtkDataObject::FIELD_ASSOCIATION_POINTS, true);
+  }
+
+  vtkNew<vtkBandClipDataSet> clipper;
+  clipper->SetInputData(inputClone);
+  clipper->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, array_name);
+  clipper->SetLowerValue(this->LowerThreshold);
+  clipper->SetUpperValue(this->UpperThreshold);
+  clipper->Update();
+
+  vtkDataObject* output = clipper->GetOutputDataObject(0);
+  output->Register(this);
+  return output;
+}
+
 //----------------------------------------------------------------------------
 void vtkIsoVolume::PrintSelf(ostream& os, vtkIndent indent)
 {
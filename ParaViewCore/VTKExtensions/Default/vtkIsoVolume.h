@@ -18,9 +18,12 @@
  * threshold set and vtkPVClipDataSet filter.
  *
  *
+ * Point scalars of datasets and multiblock datasets are clipped to the range
+ * in a single pass with vtkBandClipDataSet. Other inputs are clipped with the
+ * lower threshold, then with the upper threshold.
  *
  * @sa
- * vtkThreshold vtkPVClipDataSet
+ * vtkThreshold vtkPVClipDataSet vtkBandClipDataSet
 */
 
 #ifndef vtkIsoVolume_h
@@ -30,6 +33,7 @@
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 
 // Forware declarations.
+class vtkDataSet;
 class vtkPVClipDataSet;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkIsoVolume : public vtkDataObjectAlgorithm
@@ -71,6 +75,12 @@ protected:
   vtkDataObject* Clip(
     vtkDataObject* input, double value, const char* array_name, int fieldAssociation, bool invert);
 
+  /**
+   * Clips a dataset to the range of the point scalars in a single pass.
+   * Grids with polyhedral cells fall back to Clip().
+   */
+  vtkDataObject* ClipRange(vtkDataSet* input, const char* array_name);
+
   double LowerThreshold;
   double UpperThreshold;
 
@@ -55,6 +55,10 @@
 #include "vtkPointAccumulator.h"
 #include "vtkPointData.h"
 #include "vtkUnsignedIntArray.h"
+// SMP
+#include "vtkConcurrentUnionFind.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 // IO & IPC
 #include "vtkDataSetWriter.h"
 #include "vtkMaterialInterfaceCommBuffer.h"
@@ -72,6 +76,7 @@
 // STL
 #include <fstream>
 using std::ofstream;
+#include <map>
 #include <sstream>
 using std::ostringstream;
 #include <vector>
@@ -1641,6 +1646,7 @@ vtkMaterialInterfaceFilter::vtkMaterialInterfaceFilter()
   this->NToSum = 0;
   this->ComputeMoments = false;
   this->ComputeOBB = false;
+  this->UseThreading = true;
 
   this->MaterialFractionThreshold = 0.5;
   this->scaledMaterialFractionThreshold = 127.5;
@@ -1895,6 +1901,41 @@ int vtkMaterialInterfaceFilter::InitializeBlocks(vtkNonOverlappingAMR* input,
     this->InputBlocks[blockId] = 0;
   }
 
+  // Block initialization copies (and possibly clips) the volume fraction
+  // of each image independently of the other blocks, so it can be done
+  // concurrently. Blocks are created in the same order as the serial loop
+  // below which then only collects the level extents.
+  if (this->UseThreading)
+  {
+    vector<vtkImageData*> images(this->NumberOfInputBlocks, static_cast<vtkImageData*>(0));
+    vector<int> levels(this->NumberOfInputBlocks, 0);
+    int localBlockId = 0;
+    for (level = 0; level < numLevels; ++level)
+    {
+      int numBlocks = input->GetNumberOfDataSets(level);
+      for (int levelBlockId = 0; levelBlockId < numBlocks; ++levelBlockId)
+      {
+        vtkImageData* image = input->GetDataSet(level, levelBlockId);
+        if (image)
+        {
+          images[localBlockId] = image;
+          levels[localBlockId] = level;
+          this->InputBlocks[localBlockId] = new vtkMaterialInterfaceFilterBlock;
+          ++localBlockId;
+        }
+      }
+    }
+    vtkSMPTools::For(0, localBlockId, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType ii = begin; ii < end; ++ii)
+      {
+        this->InputBlocks[ii]->Initialize(static_cast<int>(ii), images[ii], levels[ii],
+          this->GlobalOrigin, this->RootSpacing, materialFractionArrayName, massArrayName,
+          volumeWtdAvgArrayNames, massWtdAvgArrayNames, summedArrayNames, integratedArrayNames,
+          this->InvertVolumeFraction, sphere);
+      }
+    });
+  }
+
   // Initialize each block with the input image
   // and global index coordinate system.
   int blockIndex = -1;
@@ -1917,13 +1958,21 @@ int vtkMaterialInterfaceFilter::InitializeBlocks(vtkNonOverlappingAMR* input,
 
       if (image)
       {
-        block = this->InputBlocks[++blockIndex] = new vtkMaterialInterfaceFilterBlock;
-        // Do we really need the block to know its id?
-        // We use it to find neighbors.  We should save pointers
-        // directly in neighbor array. We also use it for debugging.
-        block->Initialize(blockIndex, image, level, this->GlobalOrigin, this->RootSpacing,
-          materialFractionArrayName, massArrayName, volumeWtdAvgArrayNames, massWtdAvgArrayNames,
-          summedArrayNames, integratedArrayNames, this->InvertVolumeFraction, sphere);
+        if (this->UseThreading)
+        { // Already initialized above.
+          block = this->InputBlocks[++blockIndex];
+        }
+        else
+        {
+          block = this->InputBlocks[++blockIndex] = new vtkMaterialInterfaceFilterBlock;
+          // Do we really need the block to know its id?
+          // We use it to find neighbors.  We should save pointers
+          // directly in neighbor array. We also use it for debugging.
+          block->Initialize(blockIndex, image, level, this->GlobalOrigin, this->RootSpacing,
+            materialFractionArrayName, massArrayName, volumeWtdAvgArrayNames,
+            massWtdAvgArrayNames, summedArrayNames, integratedArrayNames,
+            this->InvertVolumeFraction, sphere);
+        }
         // For debugging:
         block->LevelBlockId = levelBlockId;
 
@@ -3592,12 +3641,8 @@ int vtkMaterialInterfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
     // Lets profile to see what takes the most time for large number of processes.
     this->ProcessBlocksTimer->StartTimer();
 #endif
-    int blockId;
-    for (blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
-    {
-      // build fragments
-      this->ProcessBlock(blockId);
-    }
+    // build fragments
+    this->ProcessBlocks();
 #ifdef vtkMaterialInterfaceFilterPROFILE
     // Lets profile to see what takes the most time for large number of processes.
     this->ProcessBlocksTimer->StopTimer();
@@ -3741,135 +3786,307 @@ int vtkMaterialInterfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
 }
 
 //----------------------------------------------------------------------------
-int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
-{
-#ifdef vtkMaterialInterfaceFilterDEBUG
-  ostringstream progressMesg;
-  progressMesg << "vtkMaterialInterfaceFilter::ProcessBlock(" << blockId << ") , Material "
-               << this->MaterialId;
-  this->SetProgressText(progressMesg.str().c_str());
-#endif
-  this->Progress += this->ProgressBlockInc;
+// Fragments are found in three steps. The cells inside the material of
+// each block (local and ghost) are labeled with the face connected piece
+// they belong to. Pieces touching across blocks are then joined with a
+// union-find, and each set with a piece in a local block becomes a
+// fragment. Finally the surface of each fragment is generated and its
+// attributes integrated by a breadth first search started from all its
+// pieces. Blocks are independent in the first two steps, which are
+// threaded. Ids are given in the order of the first local piece of each
+// fragment so that the result does not depend on the threading.
+void vtkMaterialInterfaceFilter::ProcessBlocks()
+{
+  // Local blocks first, fragment ids follow their order.
+  vector<vtkMaterialInterfaceFilterBlock*> blocks;
+  for (int blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
+  {
+    if (this->InputBlocks[blockId])
+    {
+      blocks.push_back(this->InputBlocks[blockId]);
+    }
+  }
+  const int nLocalBlocks = static_cast<int>(blocks.size());
+  blocks.insert(blocks.end(), this->GhostBlocks.begin(), this->GhostBlocks.end());
+  const int nBlocks = static_cast<int>(blocks.size());
+  std::map<vtkMaterialInterfaceFilterBlock*, int> blockIndices;
+  for (int ii = 0; ii < nBlocks; ++ii)
+  {
+    blockIndices[blocks[ii]] = ii;
+  }
+  const vtkIdType grain = this->UseThreading ? 0 : nBlocks;
+
+  // Label the pieces of each block.
+  vector<int> pieceOffsets(nBlocks + 1, 0);
+  vector<vector<vtkMaterialInterfaceFilterIterator> > seeds(nBlocks);
+  vector<vector<std::pair<int, vtkMaterialInterfaceFilterIterator> > > boundaryCells(nBlocks);
+  vtkSMPTools::For(0, nBlocks, grain, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      pieceOffsets[ii + 1] = this->LabelBlockPieces(blocks[ii], seeds[ii], boundaryCells[ii]);
+    }
+  });
+  for (int ii = 0; ii < nBlocks; ++ii)
+  {
+    pieceOffsets[ii + 1] += pieceOffsets[ii];
+  }
+  this->Progress += this->ProgressBlockInc * this->NumberOfInputBlocks;
   this->UpdateProgress(this->Progress);
 
-  vtkMaterialInterfaceFilterBlock* block = this->InputBlocks[blockId];
-  if (block == 0)
+  // Join the pieces touching across blocks.
+  const int nPieces = pieceOffsets[nBlocks];
+  vtkConcurrentUnionFind<int> pieceSets;
+  pieceSets.Initialize(nPieces);
+  vtkSMPTools::For(0, nBlocks, grain, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      vector<std::pair<int, vtkMaterialInterfaceFilterIterator> >& cells = boundaryCells[ii];
+      for (size_t jj = 0; jj < cells.size(); ++jj)
+      {
+        std::map<vtkMaterialInterfaceFilterBlock*, int>::const_iterator neighbor =
+          blockIndices.find(cells[jj].second.Block);
+        if (neighbor != blockIndices.end())
+        {
+          pieceSets.Union(pieceOffsets[ii] + cells[jj].first,
+            pieceOffsets[neighbor->second] + *(cells[jj].second.FragmentIdPointer));
+        }
+      }
+      cells.clear();
+    }
+  });
+
+  // A fragment has to start from a local cell above the threshold. Sets
+  // made only of ghost pieces, or only of cells at the threshold, are not
+  // fragments.
+  const int firstFragmentId = this->FragmentId;
+  vector<int> setFragmentIds(nPieces, -1);
+  int nFragments = 0;
+  for (int ii = 0; ii < nLocalBlocks; ++ii)
   {
-    return 0;
+    for (size_t piece = 0; piece < seeds[ii].size(); ++piece)
+    {
+      if (*(seeds[ii][piece].VolumeFractionPointer) > this->scaledMaterialFractionThreshold)
+      {
+        const int pieceId = pieceOffsets[ii] + static_cast<int>(piece);
+        int& fragmentId = setFragmentIds[pieceSets.Find(pieceId)];
+        if (fragmentId == -1)
+        {
+          fragmentId = firstFragmentId + nFragments++;
+        }
+      }
+    }
   }
+  vector<char> pieceInFragment(nPieces, 0);
+  vector<vector<vtkMaterialInterfaceFilterIterator> > fragmentSeeds(nFragments);
+  for (int ii = 0; ii < nBlocks; ++ii)
+  {
+    for (size_t piece = 0; piece < seeds[ii].size(); ++piece)
+    {
+      const int pieceId = pieceOffsets[ii] + static_cast<int>(piece);
+      const int fragmentId = setFragmentIds[pieceSets.Find(pieceId)];
+      if (fragmentId != -1)
+      {
+        pieceInFragment[pieceId] = 1;
+        fragmentSeeds[fragmentId - firstFragmentId].push_back(seeds[ii][piece]);
+      }
+    }
+  }
+  pieceSets.Release();
 
-  vtkMaterialInterfaceFilterIterator* xIterator = new vtkMaterialInterfaceFilterIterator;
-  vtkMaterialInterfaceFilterIterator* yIterator = new vtkMaterialInterfaceFilterIterator;
-  vtkMaterialInterfaceFilterIterator* zIterator = new vtkMaterialInterfaceFilterIterator;
-  zIterator->Block = block;
-  // set iterator to reference first non ghost cell
-  zIterator->VolumeFractionPointer = block->GetBaseVolumeFractionPointer();
-  zIterator->FragmentIdPointer = block->GetBaseFragmentIdPointer();
-  zIterator->FlatIndex = block->GetBaseFlatIndex();
+  // Mark the cells of the fragments as not visited (-2), and reset the
+  // others.
+  vtkSMPTools::For(0, nBlocks, grain, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      vtkMaterialInterfaceFilterBlock* block = blocks[ii];
+      const int* ext = block->GetBaseCellExtent();
+      const int* incs = block->GetCellIncrements();
+      int* zPointer = block->GetBaseFragmentIdPointer();
+      for (int iz = ext[4]; iz <= ext[5]; ++iz, zPointer += incs[2])
+      {
+        int* yPointer = zPointer;
+        for (int iy = ext[2]; iy <= ext[3]; ++iy, yPointer += incs[1])
+        {
+          int* xPointer = yPointer;
+          for (int ix = ext[0]; ix <= ext[1]; ++ix, xPointer += incs[0])
+          {
+            if (*xPointer >= 0)
+            {
+              *xPointer = pieceInFragment[pieceOffsets[ii] + *xPointer] ? -2 : -1;
+            }
+          }
+        }
+      }
+    }
+  });
 
+  // Every cell of a fragment is reached from the seeds of its pieces since
+  // the pieces are connected.
   vtkMaterialInterfaceFilterRingBuffer* queue = new vtkMaterialInterfaceFilterRingBuffer;
+  for (int ii = 0; ii < nFragments; ++ii)
+  {
+    this->FragmentId = firstFragmentId + ii;
+    this->CurrentFragmentMesh = this->NewFragmentMesh();
+    this->EquivalenceSet->AddEquivalence(this->FragmentId, this->FragmentId);
+    // We have to mark every voxel we push on the queue.
+    vector<vtkMaterialInterfaceFilterIterator>& fragmentPieces = fragmentSeeds[ii];
+    for (size_t jj = 0; jj < fragmentPieces.size(); ++jj)
+    {
+      *(fragmentPieces[jj].FragmentIdPointer) = this->FragmentId;
+      queue->Push(&fragmentPieces[jj]);
+    }
+    this->ConnectFragment(queue);
+    // save the current fragment mesh
+    // the id is implicit given by its position in the vector, but only
+    // until fragments are resolved. After resolution we add addributes such
+    // as id, volume, summations averages, etc..
+    this->CurrentFragmentMesh->Squeeze();
+    this->FragmentMeshes.push_back(this->CurrentFragmentMesh);
+    // Save the volume from the last fragment.
+    this->FragmentVolumes->InsertTuple1(this->FragmentId, this->FragmentVolume);
+    if (this->ClipWithPlane)
+    {
+      this->ClipDepthMaximums->InsertTuple1(this->FragmentId, this->ClipDepthMax);
+      this->ClipDepthMinimums->InsertTuple1(this->FragmentId, this->ClipDepthMin);
+    }
+    // clear the volume accumulator
+    this->FragmentVolume = 0.0;
+    this->ClipDepthMax = 0.0;
+    this->ClipDepthMin = VTK_FLOAT_MAX;
+    if (this->ComputeMoments)
+    {
+      // Save the moments from the last fragment
+      this->FragmentMoments->InsertTuple(this->FragmentId, &this->FragmentMoment[0]);
+      // clear the moment accumulator
+      FillVector(this->FragmentMoment, 0.0);
+    }
+    // for the volume weighted averaged scalars/vectors...
+    for (int i = 0; i < this->NVolumeWtdAvgs; ++i)
+    {
+      // update the integrated value, independent of ncomps
+      this->FragmentVolumeWtdAvgs[i]->InsertTuple(
+        this->FragmentId, &this->FragmentVolumeWtdAvg[i][0]);
+      // clear the accumulator
+      FillVector(this->FragmentVolumeWtdAvg[i], 0.0);
+    }
+    // for the mass weighted averaged scalars/vectors...
+    for (int i = 0; i < this->NMassWtdAvgs; ++i)
+    {
+      // update the integrated value, independent of ncomps
+      this->FragmentMassWtdAvgs[i]->InsertTuple(
+        this->FragmentId, &this->FragmentMassWtdAvg[i][0]);
+      // clear the accumulator
+      FillVector(this->FragmentMassWtdAvg[i], 0.0);
+    }
+    // for the summed scalars/vectors...
+    for (int i = 0; i < this->NToSum; ++i)
+    {
+      // update the integrated value, independent of ncomps
+      this->FragmentSums[i]->InsertTuple(this->FragmentId, &this->FragmentSum[i][0]);
+      // clear the accumulator
+      FillVector(this->FragmentSum[i], 0.0);
+    }
+  }
+  // Move to next fragment.
+  this->FragmentId = firstFragmentId + nFragments;
+  delete queue;
+}
+
+//----------------------------------------------------------------------------
+// Breadth first search restricted to one block. The cells are labeled with
+// the index of their piece in the block. This only writes to the block's
+// own fragment ids, so blocks can be labeled concurrently.
+int vtkMaterialInterfaceFilter::LabelBlockPieces(vtkMaterialInterfaceFilterBlock* block,
+  vector<vtkMaterialInterfaceFilterIterator>& seeds,
+  vector<std::pair<int, vtkMaterialInterfaceFilterIterator> >& boundaryCells)
+{
+  vtkMaterialInterfaceFilterIterator xIterator;
+  vtkMaterialInterfaceFilterIterator yIterator;
+  vtkMaterialInterfaceFilterIterator zIterator;
+  zIterator.Block = block;
+  // set iterator to reference first non ghost cell
+  zIterator.VolumeFractionPointer = block->GetBaseVolumeFractionPointer();
+  zIterator.FragmentIdPointer = block->GetBaseFragmentIdPointer();
+  zIterator.FlatIndex = block->GetBaseFlatIndex();
+
+  vtkMaterialInterfaceFilterRingBuffer queue;
+  vtkMaterialInterfaceFilterIterator neighbors[4];
+  int numberOfPieces = 0;
 
   // Loop through all the voxels.
-  int ix, iy, iz;
-  const int* ext;
   int cellIncs[3];
   block->GetCellIncrements(cellIncs);
-
-  ext = block->GetBaseCellExtent();
-  for (iz = ext[4]; iz <= ext[5]; ++iz)
+  const int* ext = block->GetBaseCellExtent();
+  for (int iz = ext[4]; iz <= ext[5]; ++iz)
   {
-    zIterator->Index[2] = iz;
-    *yIterator = *zIterator;
-    for (iy = ext[2]; iy <= ext[3]; ++iy)
+    zIterator.Index[2] = iz;
+    yIterator = zIterator;
+    for (int iy = ext[2]; iy <= ext[3]; ++iy)
     {
-      yIterator->Index[1] = iy;
-      *xIterator = *yIterator;
-      for (ix = ext[0]; ix <= ext[1]; ++ix)
+      yIterator.Index[1] = iy;
+      xIterator = yIterator;
+      for (int ix = ext[0]; ix <= ext[1]; ++ix)
       {
-        xIterator->Index[0] = ix;
-        //
-        if (*(xIterator->FragmentIdPointer) == -1 &&
-          *(xIterator->VolumeFractionPointer) > this->scaledMaterialFractionThreshold)
-        { // We have a new fragment.
-          this->CurrentFragmentMesh = this->NewFragmentMesh();
-          this->EquivalenceSet->AddEquivalence(this->FragmentId, this->FragmentId);
-          // We have to mark every voxel we push on the queue.
-          *(xIterator->FragmentIdPointer) = this->FragmentId;
-          // There should be no need to clear the queue.
-          queue->Push(xIterator);
-          this->ConnectFragment(queue);
-          // save the current fragment mesh
-          // the id is implicit given by its position in the vector, but only
-          // until fragments are resolved. After resolution we add addributes such
-          // as id, volume, summations averages, etc..
-          this->CurrentFragmentMesh->Squeeze();
-          this->FragmentMeshes.push_back(this->CurrentFragmentMesh);
-          // Save the volume from the last fragment.
-          this->FragmentVolumes->InsertTuple1(this->FragmentId, this->FragmentVolume);
-          if (this->ClipWithPlane)
-          {
-            this->ClipDepthMaximums->InsertTuple1(this->FragmentId, this->ClipDepthMax);
-            this->ClipDepthMinimums->InsertTuple1(this->FragmentId, this->ClipDepthMin);
-          }
-          // clear the volume accumulator
-          this->FragmentVolume = 0.0;
-          this->ClipDepthMax = 0.0;
-          this->ClipDepthMin = VTK_FLOAT_MAX;
-          if (this->ComputeMoments)
-          {
-            // Save the moments from the last fragment
-            this->FragmentMoments->InsertTuple(this->FragmentId, &this->FragmentMoment[0]);
-            // clear the moment accumulator
-            FillVector(this->FragmentMoment, 0.0);
-          }
-          // for the volume weighted averaged scalars/vectors...
-          for (int i = 0; i < this->NVolumeWtdAvgs; ++i)
-          {
-            // update the integrated value, independent of ncomps
-            this->FragmentVolumeWtdAvgs[i]->InsertTuple(
-              this->FragmentId, &this->FragmentVolumeWtdAvg[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentVolumeWtdAvg[i], 0.0);
-          }
-          // for the mass weighted averaged scalars/vectors...
-          for (int i = 0; i < this->NMassWtdAvgs; ++i)
-          {
-            // update the integrated value, independent of ncomps
-            this->FragmentMassWtdAvgs[i]->InsertTuple(
-              this->FragmentId, &this->FragmentMassWtdAvg[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentMassWtdAvg[i], 0.0);
-          }
-          // for the summed scalars/vectors...
-          for (int i = 0; i < this->NToSum; ++i)
+        xIterator.Index[0] = ix;
+        if (*(xIterator.FragmentIdPointer) == -1 &&
+          *(xIterator.VolumeFractionPointer) >= this->scaledMaterialFractionThreshold)
+        { // We have a new piece.
+          const int piece = numberOfPieces++;
+          seeds.push_back(xIterator);
+          *(xIterator.FragmentIdPointer) = piece;
+          queue.Push(&xIterator);
+          while (queue.GetSize())
           {
-            // update the integrated value, independent of ncomps
-            this->FragmentSums[i]->InsertTuple(this->FragmentId, &this->FragmentSum[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentSum[i], 0.0);
+            vtkMaterialInterfaceFilterIterator iterator;
+            queue.Pop(&iterator);
+            // Prefer a seed above the threshold, it tells whether the piece
+            // can start a fragment.
+            if (*(iterator.VolumeFractionPointer) > this->scaledMaterialFractionThreshold &&
+              *(seeds[piece].VolumeFractionPointer) <= this->scaledMaterialFractionThreshold)
+            {
+              seeds[piece] = iterator;
+            }
+            for (int axis = 0; axis < 3; ++axis)
+            {
+              for (int maxFlag = 0; maxFlag < 2; ++maxFlag)
+              {
+                int num = this->GetFaceNeighborIterators(&iterator, axis, maxFlag, neighbors);
+                for (int ii = 0; ii < num; ++ii)
+                {
+                  vtkMaterialInterfaceFilterIterator* next = neighbors + ii;
+                  if (next->VolumeFractionPointer == 0 ||
+                    next->VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
+                  { // Neighbor is outside of the material.
+                    continue;
+                  }
+                  if (next->Block != block)
+                  { // Joined once all the blocks are labeled.
+                    boundaryCells.push_back(std::make_pair(piece, *next));
+                  }
+                  else if (*(next->FragmentIdPointer) == -1)
+                  { // We have not visited this neighbor yet. Mark the voxel and recurse.
+                    *(next->FragmentIdPointer) = piece;
+                    queue.Push(next);
+                  }
+                }
+              }
+            }
           }
-          // Move to next fragment.
-          ++this->FragmentId;
         }
-        xIterator->FlatIndex += cellIncs[0]; // 1/ncomp
-        xIterator->VolumeFractionPointer += cellIncs[0];
-        xIterator->FragmentIdPointer += cellIncs[0];
+        xIterator.FlatIndex += cellIncs[0]; // 1/ncomp
+        xIterator.VolumeFractionPointer += cellIncs[0];
+        xIterator.FragmentIdPointer += cellIncs[0];
       }
-      yIterator->FlatIndex += cellIncs[1]; // nx
-      yIterator->VolumeFractionPointer += cellIncs[1];
-      yIterator->FragmentIdPointer += cellIncs[1];
+      yIterator.FlatIndex += cellIncs[1]; // nx
+      yIterator.VolumeFractionPointer += cellIncs[1];
+      yIterator.FragmentIdPointer += cellIncs[1];
     }
-    zIterator->FlatIndex += cellIncs[2]; // nx*ny
-    zIterator->VolumeFractionPointer += cellIncs[2];
-    zIterator->FragmentIdPointer += cellIncs[2];
+    zIterator.FlatIndex += cellIncs[2]; // nx*ny
+    zIterator.VolumeFractionPointer += cellIncs[2];
+    zIterator.FragmentIdPointer += cellIncs[2];
   }
 
-  delete queue;
-  delete xIterator;
-  delete yIterator;
-  delete zIterator;
-
-  return 1;
+  return numberOfPieces;
 }
 
 // We conserver neighbor relations and put the reference (in)
@@ -5477,9 +5694,11 @@ inline int vtkMaterialInterfaceFilter::AccumulateMoments(double* moments, // =(M
 // This extracts faces at the same time.
 // This integrates quantities at the same time.
 // This is called only when the voxel is part of a fragment.
-// I tried to create a generic API to replace the hard coded conditional ifs.
+// The voxels of the fragment that have not been visited yet are marked -2
+// by ProcessBlocks.
 void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingBuffer* queue)
 {
+  vtkMaterialInterfaceFilterIterator neighbors[4];
   while (queue->GetSize())
   {
     // Get the next voxel/iterator to search.
@@ -5539,200 +5758,33 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
       }
     }
 
-    // Create another iterator on the stack for recursion.
-    vtkMaterialInterfaceFilterIterator next;
-
     // Look at the face connected neighbors and recurse.
     // We are not on the border and volume fraction of neighbor is high and
     // we have not visited the voxel yet.
     for (int ii = 0; ii < 3; ++ii)
     {
-      // I would make these variables to make the computation more clear,
-      // but they would accumulate on the stack.
-      // axis0 = ii;
-      // axis1 = (ii+1)%3;
-      // axis2 = (ii+2)%3;
-      // idxMin = 2*ii;
-      // idxMax = 2*ii+1this->IndexMax+1;
-      // "Left"/min
-      this->GetNeighborIterator(&next, &iterator, ii, 0, (ii + 1) % 3, 0, (ii + 2) % 3, 0);
-
-      if (next.VolumeFractionPointer == 0 ||
-        next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-      {
-        // Neighbor is outside of fragment.  Make a face.
-        this->CreateFace(&iterator, &next, ii, 0);
-      }
-      else if (next.FragmentIdPointer[0] == -1)
-      { // We have not visited this neighbor yet. Mark the voxel and recurse.
-        *(next.FragmentIdPointer) = this->FragmentId;
-        queue->Push(&next);
-      }
-      else
-      { // The last case is that we have already visited this voxel and it
-        // is in the same fragment.
-        this->AddEquivalence(&iterator, &next);
-      }
-
-      // Handle the case when the new iterator is a higher level.
-      // We need to loop over all the faces of the higher level that touch this face.
-      // We will restrict our case to 4 neighbors (max difference in levels is 1).
-      // If level skip, things should still work OK. Biggest issue is holes in surface.
-      // This also sort of assumes that at most one other block touches this face.
-      // Holes might appear if this is not true.
-      if (next.Block && next.Block->GetLevel() > iterator.Block->GetLevel())
-      {
-        vtkMaterialInterfaceFilterIterator next2;
-        bool threeDimFlag = next.Block->GetBaseCellExtent()[4] < next.Block->GetBaseCellExtent()[5];
-        // Take the first neighbor found and move +Y
-        if (ii != 1 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 0);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
-        }
-        // Take the fist iterator found and move +Z
-        if (ii != 0 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 2) % 3, 1, ii, 0, (ii + 1) % 3, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 0);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
-        }
-        // To get the +Y+Z start with the +Z iterator and move +Y put results in "next"
-        if (next2.Block && threeDimFlag)
-        {
-          this->GetNeighborIterator(&next, &next2, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next.VolumeFractionPointer == 0 ||
-            next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next, ii, 0);
-          }
-          else if (next.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
-        }
-      }
-
-      // "Right"/max
-      this->GetNeighborIterator(&next, &iterator, ii, 1, (ii + 1) % 3, 0, (ii + 2) % 3, 0);
-      if (next.VolumeFractionPointer == 0 ||
-        next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-      { // Neighbor is outside of fragment.  Make a face.
-        this->CreateFace(&iterator, &next, ii, 1);
-      }
-      else if (next.FragmentIdPointer[0] == -1)
-      { // We have not visited this neighbor yet. Mark the voxel and recurse.
-        *(next.FragmentIdPointer) = this->FragmentId;
-        queue->Push(&next);
-      }
-      else
-      { // The last case is that we have already visited this voxel and it
-        // is in the same fragment.
-        this->AddEquivalence(&iterator, &next);
-      }
-      // Same case as above with the same logic to visit the
-      // four smaller cells that touch this face of the current block.
-      if (next.Block && next.Block->GetLevel() > iterator.Block->GetLevel())
+      // "Left"/min, then "Right"/max
+      for (int maxFlag = 0; maxFlag < 2; ++maxFlag)
       {
-        vtkMaterialInterfaceFilterIterator next2;
-        bool threeDimFlag = next.Block->GetBaseCellExtent()[4] < next.Block->GetBaseCellExtent()[5];
-        // Take the first neighbor found and move +Y
-        if (ii != 1 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 1);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
-        }
-        // Take the fist iterator found and move +Z
-        if (ii != 0 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 2) % 3, 1, ii, 0, (ii + 1) % 3, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 1);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
-        }
-        // To get the +Y+Z start with the +Z iterator and move +Y put results in "next"
-        if (next2.Block && threeDimFlag)
+        int num = this->GetFaceNeighborIterators(&iterator, ii, maxFlag, neighbors);
+        for (int jj = 0; jj < num; ++jj)
         {
-          this->GetNeighborIterator(&next, &next2, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next.VolumeFractionPointer == 0 ||
-            next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
+          vtkMaterialInterfaceFilterIterator* next = neighbors + jj;
+          if (next->VolumeFractionPointer == 0 ||
+            next->VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
           {
             // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next, ii, 1);
+            this->CreateFace(&iterator, next, ii, maxFlag);
           }
-          else if (next.FragmentIdPointer[0] == -1)
+          else if (next->FragmentIdPointer[0] == -2)
           { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next);
+            *(next->FragmentIdPointer) = this->FragmentId;
+            queue->Push(next);
           }
           else
           { // The last case is that we have already visited this voxel and it
             // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
+            this->AddEquivalence(&iterator, next);
           }
         }
       }
@@ -5740,11 +5792,55 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
   }
 }
 
+//----------------------------------------------------------------------------
+// Returns the face neighbor of iterator along axis in the maxFlag direction
+// in neighbors[0].
+// When the neighbor is a higher level, we need to loop over all the faces
+// of the higher level that touch this face. We will restrict our case to 4
+// neighbors (max difference in levels is 1). If level skip, things should
+// still work OK. Biggest issue is holes in surface. This also sort of
+// assumes that at most one other block touches this face. Holes might
+// appear if this is not true.
+int vtkMaterialInterfaceFilter::GetFaceNeighborIterators(
+  vtkMaterialInterfaceFilterIterator* iterator, int axis, int maxFlag,
+  vtkMaterialInterfaceFilterIterator neighbors[4])
+{
+  vtkMaterialInterfaceFilterIterator* next = neighbors;
+  this->GetNeighborIterator(next, iterator, axis, maxFlag, (axis + 1) % 3, 0, (axis + 2) % 3, 0);
+  int num = 1;
+  if (next->Block && next->Block->GetLevel() > iterator->Block->GetLevel())
+  {
+    vtkMaterialInterfaceFilterIterator next2;
+    bool threeDimFlag = next->Block->GetBaseCellExtent()[4] < next->Block->GetBaseCellExtent()[5];
+    // Take the first neighbor found and move +Y
+    if (axis != 1 || threeDimFlag)
+    { // stupid after the fact way of dealing with 2d AMR input.
+      this->GetNeighborIterator(&next2, next, (axis + 1) % 3, 1, (axis + 2) % 3, 0, axis, 0);
+      neighbors[num++] = next2;
+    }
+    // Take the fist iterator found and move +Z
+    if (axis != 0 || threeDimFlag)
+    { // stupid after the fact way of dealing with 2d AMR input.
+      this->GetNeighborIterator(&next2, next, (axis + 2) % 3, 1, axis, 0, (axis + 1) % 3, 0);
+      neighbors[num++] = next2;
+    }
+    // To get the +Y+Z start with the +Z iterator and move +Y
+    if (next2.Block && threeDimFlag)
+    {
+      this->GetNeighborIterator(
+        neighbors + num, &next2, (axis + 1) % 3, 1, (axis + 2) % 3, 0, axis, 0);
+      ++num;
+    }
+  }
+  return num;
+}
+
 //----------------------------------------------------------------------------
 void vtkMaterialInterfaceFilter::PrintSelf(ostream& os, vtkIndent indent)
 {
   // TODO print state
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseThreading: " << this->UseThreading << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -6380,38 +6476,109 @@ void vtkMaterialInterfaceFilter::ResolveLocalFragmentGeometry()
   assert("Couldn't get the resolved fragnments." && resolvedFragments);
   resolvedFragments->SetNumberOfPieces(this->NumberOfResolvedFragments);
 
-  int nFragmentPieces = static_cast<int>(this->FragmentMeshes.size());
-  for (int localId = 0; localId < nFragmentPieces; ++localId)
-  {
-    // find out this guy's global id within this material
-    int globalId = this->EquivalenceSet->GetEquivalentSetId(localId + localToGlobal);
+  const int nFragmentPieces = static_cast<int>(this->FragmentMeshes.size());
+  if (this->UseThreading)
+  {
+    // Group the local pieces by global id, in the order they are found, and
+    // append each group in a single pass. Groups are independent so they
+    // are merged concurrently. The result is the same as appending the
+    // pieces one at a time below.
+    vector<int> groupOfFragment(this->NumberOfResolvedFragments, -1);
+    vector<int> groupFragmentIds;
+    vector<vector<vtkPolyData*> > groups;
+    for (int localId = 0; localId < nFragmentPieces; ++localId)
+    {
+      int globalId = this->EquivalenceSet->GetEquivalentSetId(localId + localToGlobal);
+      int& group = groupOfFragment[globalId];
+      if (group == -1)
+      {
+        group = static_cast<int>(groups.size());
+        groups.resize(groups.size() + 1);
+        groupFragmentIds.push_back(globalId);
+        vtkPolyData* destMesh = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
+        if (destMesh == 0)
+        {
+          // make a note that we have a piece of this fragment
+          // and assume for now that we are the owner.
+          resolvedFragmentIds.push_back(globalId);
+        }
+        else
+        {
+          groups[group].push_back(destMesh);
+        }
+      }
+      groups[group].push_back(this->FragmentMeshes[localId]);
+    }
+
+    const int nGroups = static_cast<int>(groups.size());
+    vector<vtkPolyData*> mergedMeshes(nGroups, static_cast<vtkPolyData*>(0));
+    vtkSMPTools::For(0, nGroups, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType group = begin; group < end; ++group)
+      {
+        vector<vtkPolyData*>& meshes = groups[group];
+        if (meshes.size() == 1)
+        {
+          continue;
+        }
+        vtkAppendPolyData* apf = vtkAppendPolyData::New();
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+          apf->AddInputData(meshes[i]);
+        }
+        apf->Update();
+        mergedMeshes[group] = apf->GetOutput();
+        mergedMeshes[group]->Register(0);
+        apf->Delete();
+      }
+    });
 
-    // If we have a mesh that is yet unused then
-    // we copy, but if not, it's a local piece that has been
-    // resolved and we need to append.
-    vtkPolyData* destMesh = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
-    vtkPolyData*& srcMesh = this->FragmentMeshes[localId];
-    if (destMesh == 0)
+    for (int group = 0; group < nGroups; ++group)
     {
-      resolvedFragments->SetPiece(globalId, srcMesh);
-      // make a note that we have a piece of this fragment
-      // and assume for now that we are the owner.
-      resolvedFragmentIds.push_back(globalId);
+      if (mergedMeshes[group])
+      {
+        resolvedFragments->SetPiece(groupFragmentIds[group], mergedMeshes[group]);
+        mergedMeshes[group]->UnRegister(0);
+      }
+      else
+      {
+        resolvedFragments->SetPiece(groupFragmentIds[group], groups[group][0]);
+      }
     }
-    else
+  }
+  else
+  {
+    for (int localId = 0; localId < nFragmentPieces; ++localId)
     {
-      // merge two local pieces
-      vtkAppendPolyData* apf = vtkAppendPolyData::New();
-      apf->AddInputData(destMesh);
-      apf->AddInputData(srcMesh);
-      apf->Update();
-      vtkPolyData* mergedMesh = apf->GetOutput();
+      // find out this guy's global id within this material
+      int globalId = this->EquivalenceSet->GetEquivalentSetId(localId + localToGlobal);
 
-      // mergedMesh->Register(0); // Do I have to? no because multi piece does it
-      resolvedFragments->SetPiece(globalId, mergedMesh);
-      apf->Delete();
-      ReleaseVtkPointer(srcMesh);
-      // destMesh->Delete(); // no because multi piece does it
+      // If we have a mesh that is yet unused then
+      // we copy, but if not, it's a local piece that has been
+      // resolved and we need to append.
+      vtkPolyData* destMesh = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
+      vtkPolyData*& srcMesh = this->FragmentMeshes[localId];
+      if (destMesh == 0)
+      {
+        resolvedFragments->SetPiece(globalId, srcMesh);
+        // make a note that we have a piece of this fragment
+        // and assume for now that we are the owner.
+        resolvedFragmentIds.push_back(globalId);
+      }
+      else
+      {
+        // merge two local pieces
+        vtkAppendPolyData* apf = vtkAppendPolyData::New();
+        apf->AddInputData(destMesh);
+        apf->AddInputData(srcMesh);
+        apf->Update();
+        vtkPolyData* mergedMesh = apf->GetOutput();
+
+        // mergedMesh->Register(0); // Do I have to? no because multi piece does it
+        resolvedFragments->SetPiece(globalId, mergedMesh);
+        apf->Delete();
+        ReleaseVtkPointer(srcMesh);
+        // destMesh->Delete(); // no because multi piece does it
+      }
     }
   }
   // These have been loaded into the resolved fragments
@@ -6487,31 +6654,66 @@ void vtkMaterialInterfaceFilter::CleanLocalFragmentGeometry()
   vtkIdType nFinal = 0;
 #endif
   // clean each frgament mesh we own.
-  int nLocal = static_cast<int>(resolvedFragmentIds.size());
-  for (int localId = 0; localId < nLocal; ++localId)
+  const int nLocal = static_cast<int>(resolvedFragmentIds.size());
+  if (this->UseThreading)
+  {
+    // Fragments are cleaned concurrently, each thread with its own filter.
+    // Pieces are swapped afterwards since the multipiece is not thread safe.
+    vtkSMPThreadLocalObject<vtkCleanPolyData> cleaners;
+    vector<vtkPolyData*> cleanedMeshes(nLocal, static_cast<vtkPolyData*>(0));
+    vtkSMPTools::For(0, nLocal, [&](vtkIdType begin, vtkIdType end) {
+      vtkCleanPolyData* cleaner = cleaners.Local();
+      for (vtkIdType localId = begin; localId < end; ++localId)
+      {
+        int fragmentId = resolvedFragmentIds[localId];
+        cleaner->SetInputData(resolvedFragments->GetPiece(fragmentId));
+        cleaner->Update();
+        vtkPolyData* cleanedFragmentMesh = cleaner->GetOutput();
+        cleanedFragmentMesh->Squeeze();
+        cleanedMeshes[localId] = vtkPolyData::New();
+        cleanedMeshes[localId]->ShallowCopy(cleanedFragmentMesh);
+      }
+      // Don't keep a reference to the last fragment.
+      cleaner->SetInputData(0);
+    });
+    for (int localId = 0; localId < nLocal; ++localId)
+    {
+#ifdef vtkMaterialInterfaceFilterDEBUG
+      nInitial += resolvedFragments->GetPiece(resolvedFragmentIds[localId])->GetNumberOfPoints();
+      nFinal += cleanedMeshes[localId]->GetNumberOfPoints();
+#endif
+      resolvedFragments->SetPiece(resolvedFragmentIds[localId], cleanedMeshes[localId]);
+      cleanedMeshes[localId]->Delete();
+    }
+  }
+  else
   {
-    // get the material id
-    int fragmentId = resolvedFragmentIds[localId];
-    // get the fragment
-    vtkPolyData* fragmentMesh = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(fragmentId));
+    for (int localId = 0; localId < nLocal; ++localId)
+    {
+      // get the material id
+      int fragmentId = resolvedFragmentIds[localId];
+      // get the fragment
+      vtkPolyData* fragmentMesh =
+        dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(fragmentId));
 #ifdef vtkMaterialInterfaceFilterDEBUG
-    nInitial += fragmentMesh->GetNumberOfPoints();
+      nInitial += fragmentMesh->GetNumberOfPoints();
 #endif
-    // clean duplicate points
-    cpd->SetInputData(fragmentMesh);
-    cpd->Update();
-    vtkPolyData* cleanedFragmentMesh = cpd->GetOutput();
+      // clean duplicate points
+      cpd->SetInputData(fragmentMesh);
+      cpd->Update();
+      vtkPolyData* cleanedFragmentMesh = cpd->GetOutput();
 
 #ifdef vtkMaterialInterfaceFilterDEBUG
-    nFinal += cleanedFragmentMesh->GetNumberOfPoints();
+      nFinal += cleanedFragmentMesh->GetNumberOfPoints();
 #endif
-    // Free unused resources
-    cleanedFragmentMesh->Squeeze();
-    // Copy and swap dirty old mesh for new cleaned mesh.
-    vtkPolyData* cleanedFragmentMeshOut = vtkPolyData::New();
-    cleanedFragmentMeshOut->ShallowCopy(cleanedFragmentMesh);
-    resolvedFragments->SetPiece(fragmentId, cleanedFragmentMeshOut);
-    cleanedFragmentMeshOut->Delete();
+      // Free unused resources
+      cleanedFragmentMesh->Squeeze();
+      // Copy and swap dirty old mesh for new cleaned mesh.
+      vtkPolyData* cleanedFragmentMeshOut = vtkPolyData::New();
+      cleanedFragmentMeshOut->ShallowCopy(cleanedFragmentMesh);
+      resolvedFragments->SetPiece(fragmentId, cleanedFragmentMeshOut);
+      cleanedFragmentMeshOut->Delete();
+    }
   }
   cpd->Delete();
 #ifdef vtkMaterialInterfaceFilterDEBUG
@@ -9272,54 +9474,54 @@ int vtkMaterialInterfaceFilter::ComputeLocalFragmentOBB()
   int nLocal = static_cast<int>(resolvedFragmentIds.size());
 
   // OBB set up
-  vtkOBBTree* obbCalc;
-  double* pObb;
-  obbCalc = vtkOBBTree::New();
   assert("FragmentOBBs has incorrect size." && this->FragmentOBBs->GetNumberOfTuples() == nLocal);
-  pObb = this->FragmentOBBs->GetPointer(0);
-
-  // Traverse the fragments we own
-  for (int i = 0; i < nLocal; ++i)
-  {
-    // skip split fragments, these have already been
-    // taken care of.
-    if (fragmentSplitMarker[i] == 1)
-    {
-      pObb += 15;
-      continue;
-    }
-
-    // get fragment mesh
-    int globalId = resolvedFragmentIds[i];
-    vtkPolyData* thisFragment = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
+  double* obbs = this->FragmentOBBs->GetPointer(0);
+
+  // Each fragment writes its own tuple, so fragments are independent.
+  // Every thread gets its own OBB calculator.
+  vtkSMPThreadLocalObject<vtkOBBTree> obbCalcs;
+  vtkSMPTools::For(0, nLocal, this->UseThreading ? 0 : nLocal,
+    [&](vtkIdType begin, vtkIdType end) {
+      vtkOBBTree* obbCalc = obbCalcs.Local();
+      // Traverse the fragments we own
+      for (vtkIdType i = begin; i < end; ++i)
+      {
+        // skip split fragments, these have already been
+        // taken care of.
+        if (fragmentSplitMarker[i] == 1)
+        {
+          continue;
+        }
+        double* pObb = obbs + 15 * i;
 
-    // compute OBB
-    double size[3];
-    // (c_x,c_y,c_z),(max_x,max_y,max_z),(mid_x,mid_y,mid_z),(min_x,min_y,min_z),|max|,|mid|,|min|
-    obbCalc->ComputeOBB(thisFragment, pObb, pObb + 3, pObb + 6, pObb + 9, size);
-    // obbCalc->ComputeOBB(thisFragment->GetPoints(),pObb,pObb+3,pObb+6,pObb+9,size);
+        // get fragment mesh
+        int globalId = resolvedFragmentIds[i];
+        vtkPolyData* thisFragment =
+          dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
 
-    // compute magnitudes
-    for (int q = 0; q < 3; ++q)
-    {
-      pObb[12 + q] = 0;
-    }
-    for (int q = 0; q < 3; ++q)
-    {
-      pObb[12] += pObb[3 + q] * pObb[3 + q];
-      pObb[13] += pObb[6 + q] * pObb[6 + q];
-      pObb[14] += pObb[9 + q] * pObb[9 + q];
-    }
-    for (int q = 0; q < 3; ++q)
-    {
-      pObb[12 + q] = sqrt(pObb[12 + q]);
-    }
+        // compute OBB
+        double size[3];
+        // (c_x,c_y,c_z),(max_x,max_y,max_z),(mid_x,mid_y,mid_z),(min_x,min_y,min_z),|max|,|mid|,|min|
+        obbCalc->ComputeOBB(thisFragment, pObb, pObb + 3, pObb + 6, pObb + 9, size);
+        // obbCalc->ComputeOBB(thisFragment->GetPoints(),pObb,pObb+3,pObb+6,pObb+9,size);
 
-    pObb += 15;
-  } // fragment traversal
-
-  // OBB clean up
-  obbCalc->Delete();
+        // compute magnitudes
+        for (int q = 0; q < 3; ++q)
+        {
+          pObb[12 + q] = 0;
+        }
+        for (int q = 0; q < 3; ++q)
+        {
+          pObb[12] += pObb[3 + q] * pObb[3 + q];
+          pObb[13] += pObb[6 + q] * pObb[6 + q];
+          pObb[14] += pObb[9 + q] * pObb[9 + q];
+        }
+        for (int q = 0; q < 3; ++q)
+        {
+          pObb[12 + q] = sqrt(pObb[12 + q]);
+        }
+      } // fragment traversal
+    });
 
   return 1;
 }
@@ -9342,32 +9544,35 @@ int vtkMaterialInterfaceFilter::ComputeLocalFragmentAABBCenters()
   // AABB set up
   assert("FragmentAABBCenters is expected to be pre-allocated." &&
     this->FragmentAABBCenters->GetNumberOfTuples() == nLocal);
-  double aabb[6];
-  double* pCoaabb = this->FragmentAABBCenters->GetPointer(0);
+  double* coaabbs = this->FragmentAABBCenters->GetPointer(0);
 
-  // Traverse the fragments we own
-  for (int i = 0; i < nLocal; ++i)
-  {
-    // skip fragments with geometry split over multiple
-    // processes. These have been already taken care of.
-    if (fragmentSplitMarker[i] == 1)
-    {
-      pCoaabb += 3;
-      continue;
-    }
+  vtkSMPTools::For(0, nLocal, this->UseThreading ? 0 : nLocal,
+    [&](vtkIdType begin, vtkIdType end) {
+      // Traverse the fragments we own
+      for (vtkIdType i = begin; i < end; ++i)
+      {
+        // skip fragments with geometry split over multiple
+        // processes. These have been already taken care of.
+        if (fragmentSplitMarker[i] == 1)
+        {
+          continue;
+        }
+        double* pCoaabb = coaabbs + 3 * i;
 
-    int globalId = resolvedFragmentIds[i];
+        int globalId = resolvedFragmentIds[i];
 
-    vtkPolyData* thisFragment = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
+        vtkPolyData* thisFragment =
+          dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
 
-    // AABB calculation
-    thisFragment->GetBounds(aabb);
-    for (int q = 0, k = 0; q < 3; ++q, k += 2)
-    {
-      pCoaabb[q] = (aabb[k] + aabb[k + 1]) / 2.0;
-    }
-    pCoaabb += 3;
-  } // fragment traversal
+        // AABB calculation
+        double aabb[6];
+        thisFragment->GetBounds(aabb);
+        for (int q = 0, k = 0; q < 3; ++q, k += 2)
+        {
+          pCoaabb[q] = (aabb[k] + aabb[k + 1]) / 2.0;
+        }
+      } // fragment traversal
+    });
 
   return 1;
 }
@@ -38,6 +38,7 @@
 #include "vtkMultiBlockDataSetAlgorithm.h"
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 #include <string>                            // needed for string
+#include <utility>                           // needed for pair
 #include <vector>                            // needed for vector
 
 #include "vtkSmartPointer.h" // needed for smart pointer
@@ -261,6 +262,22 @@ public:
   vtkGetMacro(ComputeOBB, bool);
   //@}
 
+  /// Threading
+  //@{
+  /**
+   * Turn on/off shared memory parallelism inside each process. When on,
+   * blocks are set up concurrently and the fragments owned by the process
+   * are merged, cleaned and measured (OBB, AABB) concurrently using
+   * vtkSMPTools. The cells of each block are labeled concurrently and
+   * the labels touching across blocks are joined with a concurrent
+   * union-find. Fragment ids, surfaces and integrated attributes are
+   * identical to the serial execution. On by default.
+   */
+  vtkSetMacro(UseThreading, bool);
+  vtkGetMacro(UseThreading, bool);
+  vtkBooleanMacro(UseThreading, bool);
+  //@}
+
   /// Loading
   //@{
   /**
@@ -348,8 +365,21 @@ protected:
     std::vector<std::string>& integratedArrayNames);
   // Create a new fragment/piece.
   vtkPolyData* NewFragmentMesh();
-  // Process each cell, looking for fragments.
-  int ProcessBlock(int blockId);
+  // Find the fragments of all the blocks. The pieces of each block are
+  // labeled independently, then the pieces that touch across blocks are
+  // joined into fragments.
+  void ProcessBlocks();
+  // Label the face connected pieces of cells inside the material in a
+  // single block. Returns the number of pieces. A cell of each piece is
+  // added to seeds and the cells inside the material in other blocks that
+  // touch a piece are added to boundaryCells with the label of the piece.
+  int LabelBlockPieces(vtkMaterialInterfaceFilterBlock* block,
+    std::vector<vtkMaterialInterfaceFilterIterator>& seeds,
+    std::vector<std::pair<int, vtkMaterialInterfaceFilterIterator> >& boundaryCells);
+  // Get the cells on the other side of a face of a cell. There are up
+  // to four of them when the neighbor is on a higher level.
+  int GetFaceNeighborIterators(vtkMaterialInterfaceFilterIterator* iterator, int axis,
+    int maxFlag, vtkMaterialInterfaceFilterIterator neighbors[4]);
   // Cell has been identified as inside the fragment. Integrate, and
   // generate fragment surface etc...
   void ConnectFragment(vtkMaterialInterfaceFilterRingBuffer* iterator);
@@ -603,6 +633,8 @@ protected:
   vtkDoubleArray* FragmentOBBs;
   // turn on/off OBB calculation
   bool ComputeOBB;
+  // turn on/off threaded block and fragment processing
+  bool UseThreading;
 
   // Upper bound used to exclude heavily loaded procs
   // from work sharing. Reducing may aliviate oom issues.
@@ -17,6 +17,8 @@
 #include "vtkCellData.h"
 #include "vtkDataObject.h"
 #include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
 #include "vtkFunctionParser.h"
 #include "vtkGraph.h"
 #include "vtkInformation.h"
@@ -24,13 +26,23 @@
 #include "vtkObjectFactory.h"
 #include "vtkPVPostFilter.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkTable.h"
 
 #include <algorithm>
 #include <assert.h>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -67,12 +79,870 @@ public:
     this->Calc->AddScalarVariable(name.c_str(), this->ArrayName, this->Component);
   }
 };
+
+//----------------------------------------------------------------------------
+// Compiled functions are evaluated on blocks of tuples. Each value of the
+// function is held in a register, a block of doubles, and every operation
+// loops over the tuples of the block.
+const vtkIdType vtkCalculatorBlockSize = 256;
+
+enum vtkCalculatorOpCode
+{
+  VTK_CALC_NEGATE,
+  VTK_CALC_ABS,
+  VTK_CALC_EXP,
+  VTK_CALC_CEIL,
+  VTK_CALC_FLOOR,
+  VTK_CALC_LN,
+  VTK_CALC_LOG10,
+  VTK_CALC_SQRT,
+  VTK_CALC_SIN,
+  VTK_CALC_COS,
+  VTK_CALC_TAN,
+  VTK_CALC_ASIN,
+  VTK_CALC_ACOS,
+  VTK_CALC_ATAN,
+  VTK_CALC_SINH,
+  VTK_CALC_COSH,
+  VTK_CALC_TANH,
+  VTK_CALC_SIGN,
+  VTK_CALC_ADD,
+  VTK_CALC_SUBTRACT,
+  VTK_CALC_MULTIPLY,
+  VTK_CALC_DIVIDE,
+  VTK_CALC_POWER,
+  VTK_CALC_MIN,
+  VTK_CALC_MAX
+};
+
+struct vtkCalculatorInstruction
+{
+  int OpCode;
+  int Result;
+  int Left;
+  int Right; // -1 for unary operations.
+};
+
+// A component of an input array loaded in a register for every block. A null
+// array stands for the point coordinates.
+struct vtkCalculatorInput
+{
+  vtkDataArray* Array;
+  int Component;
+  int Register;
+};
+
+struct vtkCalculatorProgram
+{
+  vtkCalculatorProgram()
+    : NumberOfRegisters(0)
+  {
+  }
+
+  std::vector<vtkCalculatorInstruction> Instructions;
+  std::vector<std::pair<int, double> > Constants;
+  std::vector<vtkCalculatorInput> Inputs;
+  std::vector<int> Results; // one register for scalar results, three for vectors.
+  int NumberOfRegisters;
+};
+
+// A variable of the function, bound to one component (scalars) or three
+// components (vectors) of an input array, or of the point coordinates when
+// the array is null.
+struct vtkCalculatorVariable
+{
+  std::string Name;
+  vtkDataArray* Array;
+  bool Vector;
+  int Components[3];
+};
+
+//----------------------------------------------------------------------------
+// Compiles the functions understood by vtkFunctionParser into a
+// vtkCalculatorProgram, with a recursive descent parser. Vector operations are
+// expanded into operations on their components. Compile() fails for anything
+// not supported, including constructs whose meaning may differ from
+// vtkFunctionParser (chained powers, negated powers, dot products mixed with
+// other products), in which case the function parser is used instead.
+class vtkCalculatorCompiler
+{
+public:
+  vtkCalculatorCompiler(const std::string& function,
+    const std::vector<vtkCalculatorVariable>& variables, vtkCalculatorProgram& program)
+    : Function(function)
+    , Variables(variables)
+    , Program(program)
+    , Position(0)
+  {
+  }
+
+  bool Compile()
+  {
+    Value value;
+    this->Position = 0;
+    if (!this->ParseSum(value) || this->Peek() != '\0')
+    {
+      return false;
+    }
+    this->Program.Results.assign(value.Registers, value.Registers + (value.Vector ? 3 : 1));
+    return true;
+  }
+
+private:
+  struct Value
+  {
+    bool Vector;
+    int Registers[3];
+  };
+
+  void SkipSpaces()
+  {
+    while (this->Position < this->Function.size() &&
+      isspace(static_cast<unsigned char>(this->Function[this->Position])))
+    {
+      ++this->Position;
+    }
+  }
+
+  char Peek()
+  {
+    this->SkipSpaces();
+    return this->Position < this->Function.size() ? this->Function[this->Position] : '\0';
+  }
+
+  bool Accept(char c)
+  {
+    if (this->Peek() == c)
+    {
+      ++this->Position;
+      return true;
+    }
+    return false;
+  }
+
+  int Emit(int opCode, int left, int right = -1)
+  {
+    vtkCalculatorInstruction instruction = { opCode, this->Program.NumberOfRegisters++, left,
+      right };
+    this->Program.Instructions.push_back(instruction);
+    return instruction.Result;
+  }
+
+  int Constant(double value)
+  {
+    const int reg = this->Program.NumberOfRegisters++;
+    this->Program.Constants.push_back(std::make_pair(reg, value));
+    return reg;
+  }
+
+  int Input(vtkDataArray* array, int component)
+  {
+    for (size_t cc = 0; cc < this->Program.Inputs.size(); ++cc)
+    {
+      const vtkCalculatorInput& input = this->Program.Inputs[cc];
+      if (input.Array == array && input.Component == component)
+      {
+        return input.Register;
+      }
+    }
+    vtkCalculatorInput input = { array, component, this->Program.NumberOfRegisters++ };
+    this->Program.Inputs.push_back(input);
+    return input.Register;
+  }
+
+  static Value Scalar(int reg)
+  {
+    Value value = { false, { reg, -1, -1 } };
+    return value;
+  }
+
+  static Value Vector(int x, int y, int z)
+  {
+    Value value = { true, { x, y, z } };
+    return value;
+  }
+
+  Value Negate(const Value& a)
+  {
+    Value result = a;
+    for (int cc = 0; cc < (a.Vector ? 3 : 1); ++cc)
+    {
+      result.Registers[cc] = this->Emit(VTK_CALC_NEGATE, a.Registers[cc]);
+    }
+    return result;
+  }
+
+  Value Dot(const Value& a, const Value& b)
+  {
+    int sum = this->Emit(VTK_CALC_MULTIPLY, a.Registers[0], b.Registers[0]);
+    for (int cc = 1; cc < 3; ++cc)
+    {
+      sum = this->Emit(
+        VTK_CALC_ADD, sum, this->Emit(VTK_CALC_MULTIPLY, a.Registers[cc], b.Registers[cc]));
+    }
+    return Scalar(sum);
+  }
+
+  Value Cross(const Value& a, const Value& b)
+  {
+    int result[3];
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      const int i = (cc + 1) % 3;
+      const int j = (cc + 2) % 3;
+      result[cc] =
+        this->Emit(VTK_CALC_SUBTRACT, this->Emit(VTK_CALC_MULTIPLY, a.Registers[i], b.Registers[j]),
+          this->Emit(VTK_CALC_MULTIPLY, a.Registers[j], b.Registers[i]));
+    }
+    return Vector(result[0], result[1], result[2]);
+  }
+
+  // sum := product (('+' | '-') product)*
+  bool ParseSum(Value& value)
+  {
+    if (!this->ParseProduct(value))
+    {
+      return false;
+    }
+    for (char op = this->Peek(); op == '+' || op == '-'; op = this->Peek())
+    {
+      ++this->Position;
+      Value right;
+      if (!this->ParseProduct(right) || right.Vector != value.Vector)
+      {
+        return false;
+      }
+      for (int cc = 0; cc < (value.Vector ? 3 : 1); ++cc)
+      {
+        value.Registers[cc] = this->Emit(op == '+' ? VTK_CALC_ADD : VTK_CALC_SUBTRACT,
+          value.Registers[cc], right.Registers[cc]);
+      }
+    }
+    return true;
+  }
+
+  // product := unary (('*' | '/' | '.') unary)*
+  bool ParseProduct(Value& value)
+  {
+    if (!this->ParseUnary(value))
+    {
+      return false;
+    }
+    int numOperators = 0;
+    bool hasDot = false;
+    for (char op = this->Peek(); op == '*' || op == '/' || op == '.'; op = this->Peek())
+    {
+      ++this->Position;
+      hasDot = hasDot || op == '.';
+      if (++numOperators > 1 && hasDot)
+      {
+        return false;
+      }
+      Value right;
+      if (!this->ParseUnary(right))
+      {
+        return false;
+      }
+      if (op == '.')
+      {
+        if (!value.Vector || !right.Vector)
+        {
+          return false;
+        }
+        value = this->Dot(value, right);
+      }
+      else if (op == '/')
+      {
+        if (value.Vector || right.Vector)
+        {
+          return false;
+        }
+        value = Scalar(this->Emit(VTK_CALC_DIVIDE, value.Registers[0], right.Registers[0]));
+      }
+      else if (value.Vector && right.Vector)
+      {
+        return false;
+      }
+      else if (value.Vector || right.Vector)
+      {
+        const Value& vector = value.Vector ? value : right;
+        const int scalar = value.Vector ? right.Registers[0] : value.Registers[0];
+        value = Vector(this->Emit(VTK_CALC_MULTIPLY, scalar, vector.Registers[0]),
+          this->Emit(VTK_CALC_MULTIPLY, scalar, vector.Registers[1]),
+          this->Emit(VTK_CALC_MULTIPLY, scalar, vector.Registers[2]));
+      }
+      else
+      {
+        value = Scalar(this->Emit(VTK_CALC_MULTIPLY, value.Registers[0], right.Registers[0]));
+      }
+    }
+    return true;
+  }
+
+  // unary := '-' power | power
+  bool ParseUnary(Value& value)
+  {
+    bool isPower = false;
+    if (this->Accept('-'))
+    {
+      if (!this->ParsePower(value, isPower) || isPower)
+      {
+        return false;
+      }
+      value = this->Negate(value);
+      return true;
+    }
+    return this->ParsePower(value, isPower);
+  }
+
+  // power := primary ('^' ['-'] primary)?
+  bool ParsePower(Value& value, bool& isPower)
+  {
+    isPower = false;
+    if (!this->ParsePrimary(value))
+    {
+      return false;
+    }
+    if (!this->Accept('^'))
+    {
+      return true;
+    }
+    isPower = true;
+    const bool negate = this->Accept('-');
+    Value exponent;
+    if (!this->ParsePrimary(exponent) || value.Vector || exponent.Vector || this->Peek() == '^')
+    {
+      return false;
+    }
+    if (negate)
+    {
+      exponent = this->Negate(exponent);
+    }
+    value = Scalar(this->Emit(VTK_CALC_POWER, value.Registers[0], exponent.Registers[0]));
+    return true;
+  }
+
+  bool ParsePrimary(Value& value)
+  {
+    const char c = this->Peek();
+    if (c == '\0')
+    {
+      return false;
+    }
+    if (c == '(')
+    {
+      ++this->Position;
+      return this->ParseSum(value) && this->Accept(')');
+    }
+    if (isdigit(static_cast<unsigned char>(c)) ||
+      (c == '.' && this->Position + 1 < this->Function.size() &&
+        isdigit(static_cast<unsigned char>(this->Function[this->Position + 1]))))
+    {
+      return this->ParseNumber(value);
+    }
+    if (this->ParseFunctionCall(value))
+    {
+      return true;
+    }
+    if (this->ParseVariable(value))
+    {
+      return true;
+    }
+
+    static const char* hats[3] = { "iHat", "jHat", "kHat" };
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      if (this->Function.compare(this->Position, 4, hats[cc]) == 0)
+      {
+        this->Position += 4;
+        int registers[3];
+        for (int kk = 0; kk < 3; ++kk)
+        {
+          registers[kk] = this->Constant(kk == cc ? 1.0 : 0.0);
+        }
+        value = Vector(registers[0], registers[1], registers[2]);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ParseNumber(Value& value)
+  {
+    size_t end = this->Position;
+    while (end < this->Function.size() && isdigit(static_cast<unsigned char>(this->Function[end])))
+    {
+      ++end;
+    }
+    if (end < this->Function.size() && this->Function[end] == '.')
+    {
+      ++end;
+      while (
+        end < this->Function.size() && isdigit(static_cast<unsigned char>(this->Function[end])))
+      {
+        ++end;
+      }
+    }
+    // exponents and numbers directly followed by a name are left to the
+    // function parser.
+    if (end < this->Function.size() && isalpha(static_cast<unsigned char>(this->Function[end])))
+    {
+      return false;
+    }
+    const std::string number = this->Function.substr(this->Position, end - this->Position);
+    this->Position = end;
+    value = Scalar(this->Constant(atof(number.c_str())));
+    return true;
+  }
+
+  bool ParseFunctionCall(Value& value)
+  {
+    struct FunctionInfo
+    {
+      const char* Name;
+      int OpCode; // -1 for functions of vectors.
+      int NumberOfArguments;
+    };
+    static const FunctionInfo functions[] = { { "abs", VTK_CALC_ABS, 1 },
+      { "exp", VTK_CALC_EXP, 1 }, { "ceil", VTK_CALC_CEIL, 1 }, { "floor", VTK_CALC_FLOOR, 1 },
+      { "ln", VTK_CALC_LN, 1 }, { "log10", VTK_CALC_LOG10, 1 }, { "log", VTK_CALC_LOG10, 1 },
+      { "sqrt", VTK_CALC_SQRT, 1 }, { "sin", VTK_CALC_SIN, 1 }, { "cos", VTK_CALC_COS, 1 },
+      { "tan", VTK_CALC_TAN, 1 }, { "asin", VTK_CALC_ASIN, 1 }, { "acos", VTK_CALC_ACOS, 1 },
+      { "atan", VTK_CALC_ATAN, 1 }, { "sinh", VTK_CALC_SINH, 1 }, { "cosh", VTK_CALC_COSH, 1 },
+      { "tanh", VTK_CALC_TANH, 1 }, { "sign", VTK_CALC_SIGN, 1 }, { "min", VTK_CALC_MIN, 2 },
+      { "max", VTK_CALC_MAX, 2 }, { "mag", -1, 1 }, { "norm", -1, 1 }, { "cross", -1, 2 } };
+
+    for (size_t cc = 0; cc < sizeof(functions) / sizeof(functions[0]); ++cc)
+    {
+      const FunctionInfo& info = functions[cc];
+      const size_t length = strlen(info.Name);
+      if (this->Function.compare(this->Position, length, info.Name) != 0)
+      {
+        continue;
+      }
+      const size_t start = this->Position;
+      this->Position += length;
+      if (!this->Accept('('))
+      {
+        // not a call, e.g. a variable starting with the function name.
+        this->Position = start;
+        continue;
+      }
+
+      Value args[2];
+      for (int arg = 0; arg < info.NumberOfArguments; ++arg)
+      {
+        if ((arg > 0 && !this->Accept(',')) || !this->ParseSum(args[arg]))
+        {
+          return false;
+        }
+      }
+      if (!this->Accept(')'))
+      {
+        return false;
+      }
+
+      const bool vectorArgs = info.OpCode == -1;
+      for (int arg = 0; arg < info.NumberOfArguments; ++arg)
+      {
+        if (args[arg].Vector != vectorArgs)
+        {
+          return false;
+        }
+      }
+      if (!vectorArgs)
+      {
+        value = Scalar(this->Emit(info.OpCode, args[0].Registers[0],
+          info.NumberOfArguments > 1 ? args[1].Registers[0] : -1));
+      }
+      else if (strcmp(info.Name, "cross") == 0)
+      {
+        value = this->Cross(args[0], args[1]);
+      }
+      else
+      {
+        const int magnitude =
+          this->Emit(VTK_CALC_SQRT, this->Dot(args[0], args[0]).Registers[0]);
+        if (strcmp(info.Name, "mag") == 0)
+        {
+          value = Scalar(magnitude);
+        }
+        else
+        {
+          value = Vector(this->Emit(VTK_CALC_DIVIDE, args[0].Registers[0], magnitude),
+            this->Emit(VTK_CALC_DIVIDE, args[0].Registers[1], magnitude),
+            this->Emit(VTK_CALC_DIVIDE, args[0].Registers[2], magnitude));
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool ParseVariable(Value& value)
+  {
+    // like the function parser, take the longest variable name matching.
+    const vtkCalculatorVariable* match = nullptr;
+    for (size_t cc = 0; cc < this->Variables.size(); ++cc)
+    {
+      const vtkCalculatorVariable& variable = this->Variables[cc];
+      if (!variable.Name.empty() &&
+        this->Function.compare(this->Position, variable.Name.size(), variable.Name) == 0 &&
+        (!match || variable.Name.size() > match->Name.size()))
+      {
+        match = &variable;
+      }
+    }
+    if (!match)
+    {
+      return false;
+    }
+    this->Position += match->Name.size();
+    if (match->Vector)
+    {
+      value = Vector(this->Input(match->Array, match->Components[0]),
+        this->Input(match->Array, match->Components[1]),
+        this->Input(match->Array, match->Components[2]));
+    }
+    else
+    {
+      value = Scalar(this->Input(match->Array, match->Components[0]));
+    }
+    return true;
+  }
+
+  const std::string& Function;
+  const std::vector<vtkCalculatorVariable>& Variables;
+  vtkCalculatorProgram& Program;
+  size_t Position;
+};
+
+//----------------------------------------------------------------------------
+// Runs one instruction on the first n tuples of the registers. Returns false
+// if the operation is invalid for any of them, i.e. wherever the function
+// parser reports an error or replaces the value, so that those are left to
+// it.
+bool vtkCalculatorExecute(const vtkCalculatorInstruction& instruction, double* registers, int n)
+{
+  double* r = registers + instruction.Result * vtkCalculatorBlockSize;
+  const double* a = registers + instruction.Left * vtkCalculatorBlockSize;
+  const double* b =
+    instruction.Right >= 0 ? registers + instruction.Right * vtkCalculatorBlockSize : nullptr;
+  int invalid = 0;
+  switch (instruction.OpCode)
+  {
+    case VTK_CALC_NEGATE:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = -a[i];
+      }
+      break;
+    case VTK_CALC_ABS:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::fabs(a[i]);
+      }
+      break;
+    case VTK_CALC_EXP:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::exp(a[i]);
+      }
+      break;
+    case VTK_CALC_CEIL:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::ceil(a[i]);
+      }
+      break;
+    case VTK_CALC_FLOOR:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::floor(a[i]);
+      }
+      break;
+    case VTK_CALC_LN:
+      for (int i = 0; i < n; ++i)
+      {
+        invalid |= a[i] <= 0.0;
+        r[i] = std::log(a[i]);
+      }
+      break;
+    case VTK_CALC_LOG10:
+      for (int i = 0; i < n; ++i)
+      {
+        invalid |= a[i] <= 0.0;
+        r[i] = std::log10(a[i]);
+      }
+      break;
+    case VTK_CALC_SQRT:
+      for (int i = 0; i < n; ++i)
+      {
+        invalid |= a[i] < 0.0;
+        r[i] = std::sqrt(a[i]);
+      }
+      break;
+    case VTK_CALC_SIN:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::sin(a[i]);
+      }
+      break;
+    case VTK_CALC_COS:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::cos(a[i]);
+      }
+      break;
+    case VTK_CALC_TAN:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::tan(a[i]);
+      }
+      break;
+    case VTK_CALC_ASIN:
+      for (int i = 0; i < n; ++i)
+      {
+        invalid |= a[i] < -1.0 || a[i] > 1.0;
+        r[i] = std::asin(a[i]);
+      }
+      break;
+    case VTK_CALC_ACOS:
+      for (int i = 0; i < n; ++i)
+      {
+        invalid |= a[i] < -1.0 || a[i] > 1.0;
+        r[i] = std::acos(a[i]);
+      }
+      break;
+    case VTK_CALC_ATAN:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::atan(a[i]);
+      }
+      break;
+    case VTK_CALC_SINH:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::sinh(a[i]);
+      }
+      break;
+    case VTK_CALC_COSH:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::cosh(a[i]);
+      }
+      break;
+    case VTK_CALC_TANH:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = std::tanh(a[i]);
+      }
+      break;
+    case VTK_CALC_SIGN:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = a[i] > 0.0 ? 1.0 : (a[i] < 0.0 ? -1.0 : 0.0);
+      }
+      break;
+    case VTK_CALC_ADD:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = a[i] + b[i];
+      }
+      break;
+    case VTK_CALC_SUBTRACT:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = a[i] - b[i];
+      }
+      break;
+    case VTK_CALC_MULTIPLY:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = a[i] * b[i];
+      }
+      break;
+    case VTK_CALC_DIVIDE:
+      for (int i = 0; i < n; ++i)
+      {
+        invalid |= b[i] == 0.0;
+        r[i] = a[i] / b[i];
+      }
+      break;
+    case VTK_CALC_POWER:
+      for (int i = 0; i < n; ++i)
+      {
+        invalid |= (a[i] < 0.0 && b[i] != std::floor(b[i])) || (a[i] == 0.0 && b[i] < 0.0);
+        r[i] = std::pow(a[i], b[i]);
+      }
+      break;
+    case VTK_CALC_MIN:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = a[i] < b[i] ? a[i] : b[i];
+      }
+      break;
+    case VTK_CALC_MAX:
+      for (int i = 0; i < n; ++i)
+      {
+        r[i] = a[i] > b[i] ? a[i] : b[i];
+      }
+      break;
+  }
+  return invalid == 0;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+bool vtkCalculatorGather(const T* data, int numComps, int component, vtkIdType n, double* out)
+{
+  data += component;
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    out[i] = static_cast<double>(data[i * numComps]);
+  }
+  return true;
+}
+
+template <class T>
+void vtkCalculatorScatter(const double* in, vtkIdType n, int numComps, int component, T* data)
+{
+  data += component;
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    data[i * numComps] = static_cast<T>(in[i]);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Evaluates a vtkCalculatorProgram on all the tuples, a block at a time, the
+// blocks being processed in parallel.
+class vtkCalculatorKernel
+{
+public:
+  vtkCalculatorKernel(
+    const vtkCalculatorProgram& program, vtkDataSet* pointsOwner, vtkDataArray* result)
+    : Program(program)
+    , PointsOwner(pointsOwner)
+    , Result(result)
+  {
+  }
+
+  void Initialize()
+  {
+    std::vector<double>& registers = this->Registers.Local();
+    registers.resize(static_cast<size_t>(this->Program.NumberOfRegisters * vtkCalculatorBlockSize));
+    for (size_t cc = 0; cc < this->Program.Constants.size(); ++cc)
+    {
+      double* reg = &registers[this->Program.Constants[cc].first * vtkCalculatorBlockSize];
+      std::fill(reg, reg + vtkCalculatorBlockSize, this->Program.Constants[cc].second);
+    }
+    this->Invalid.Local() = false;
+  }
+
+  void operator()(vtkIdType beginBlock, vtkIdType endBlock)
+  {
+    double* registers = &this->Registers.Local()[0];
+    bool& invalid = this->Invalid.Local();
+    const vtkIdType numTuples = this->Result->GetNumberOfTuples();
+    for (vtkIdType block = beginBlock; block < endBlock && !invalid; ++block)
+    {
+      const vtkIdType start = block * vtkCalculatorBlockSize;
+      const int n = static_cast<int>(std::min(vtkCalculatorBlockSize, numTuples - start));
+      for (size_t cc = 0; cc < this->Program.Inputs.size(); ++cc)
+      {
+        this->Load(this->Program.Inputs[cc], start, n,
+          registers + this->Program.Inputs[cc].Register * vtkCalculatorBlockSize);
+      }
+      for (size_t cc = 0; cc < this->Program.Instructions.size(); ++cc)
+      {
+        invalid = !vtkCalculatorExecute(this->Program.Instructions[cc], registers, n) || invalid;
+      }
+      this->Store(registers, start, n, invalid);
+    }
+  }
+
+  void Reduce() {}
+
+  bool GetInvalid()
+  {
+    for (vtkSMPThreadLocal<bool>::iterator iter = this->Invalid.begin();
+         iter != this->Invalid.end(); ++iter)
+    {
+      if (*iter)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  void Load(const vtkCalculatorInput& input, vtkIdType start, int n, double* reg)
+  {
+    vtkDataArray* array = input.Array;
+    if (!array)
+    {
+      double x[3];
+      for (int i = 0; i < n; ++i)
+      {
+        this->PointsOwner->GetPoint(start + i, x);
+        reg[i] = x[input.Component];
+      }
+      return;
+    }
+    const int numComps = array->GetNumberOfComponents();
+    bool loaded = false;
+    if (array->HasStandardMemoryLayout())
+    {
+      switch (array->GetDataType())
+      {
+        vtkTemplateMacro(loaded = vtkCalculatorGather(
+                           static_cast<const VTK_TT*>(array->GetVoidPointer(start * numComps)),
+                           numComps, input.Component, n, reg));
+      }
+    }
+    for (int i = 0; !loaded && i < n; ++i)
+    {
+      reg[i] = array->GetComponent(start + i, input.Component);
+    }
+  }
+
+  void Store(const double* registers, vtkIdType start, int n, bool& invalid)
+  {
+    const int numComps = static_cast<int>(this->Program.Results.size());
+    for (int cc = 0; cc < numComps; ++cc)
+    {
+      const double* reg = registers + this->Program.Results[cc] * vtkCalculatorBlockSize;
+      // results the function parser could handle differently, e.g. not a
+      // number coming from the inputs, are left to it as well.
+      int notFinite = 0;
+      for (int i = 0; i < n; ++i)
+      {
+        notFinite |= !std::isfinite(reg[i]);
+      }
+      invalid = invalid || notFinite != 0;
+      switch (this->Result->GetDataType())
+      {
+        vtkTemplateMacro(vtkCalculatorScatter(reg, n, numComps, cc,
+          static_cast<VTK_TT*>(this->Result->GetVoidPointer(start * numComps))));
+      }
+    }
+  }
+
+  const vtkCalculatorProgram& Program;
+  vtkDataSet* PointsOwner;
+  vtkDataArray* Result;
+  vtkSMPThreadLocal<std::vector<double> > Registers;
+  vtkSMPThreadLocal<bool> Invalid;
+};
 }
 
 vtkStandardNewMacro(vtkPVArrayCalculator);
 // ----------------------------------------------------------------------------
 vtkPVArrayCalculator::vtkPVArrayCalculator()
 {
+  this->CompileExpression = true;
 }
 
 // ----------------------------------------------------------------------------
@@ -197,13 +1067,144 @@ int vtkPVArrayCalculator::RequestData(
     // put is the input of a (some) subsequent calculator(s) or the user changes
     // the input of a downstream calculator.
     this->UpdateArrayAndVariableNames(input, dataAttrs);
+
+    vtkDataObject* output = vtkDataObject::GetData(outputVector, 0);
+    if (this->CompileExpression &&
+      this->EvaluateCompiled(input, output, attributeType, numTuples))
+    {
+      return 1;
+    }
   }
 
   return this->Superclass::RequestData(request, inputVector, outputVector);
 }
 
+// ----------------------------------------------------------------------------
+bool vtkPVArrayCalculator::EvaluateCompiled(
+  vtkDataObject* input, vtkDataObject* output, int attributeType, vtkIdType numTuples)
+{
+  // results going to the coordinates, normals or texture coordinates, and
+  // array types other than floating point ones, are left to the superclass.
+  if (!this->Function || !this->ResultArrayName || this->CoordinateResults ||
+    this->ResultNormals || this->ResultTCoords ||
+    (this->ResultArrayType != VTK_DOUBLE && this->ResultArrayType != VTK_FLOAT))
+  {
+    return false;
+  }
+
+  vtkDataSetAttributes* inAttrs = input->GetAttributes(attributeType);
+  if (!inAttrs)
+  {
+    return false;
+  }
+
+  // coordinates are only available for points.
+  vtkDataArray* points = nullptr;
+  vtkDataSet* pointsOwner = nullptr;
+  if (attributeType == vtkDataObject::POINT || attributeType == vtkDataObject::VERTEX)
+  {
+    if (vtkPointSet* ps = vtkPointSet::SafeDownCast(input))
+    {
+      points = ps->GetPoints() ? ps->GetPoints()->GetData() : nullptr;
+    }
+    else if (vtkGraph* graph = vtkGraph::SafeDownCast(input))
+    {
+      points = graph->GetPoints() ? graph->GetPoints()->GetData() : nullptr;
+    }
+    else
+    {
+      pointsOwner = vtkDataSet::SafeDownCast(input);
+    }
+  }
+
+  // bind the variables to the input arrays, variables that cannot be bound
+  // are ignored and make the compilation fail if they are used.
+  std::vector<vtkCalculatorVariable> variables;
+  for (int cc = 0; cc < this->GetNumberOfScalarArrays(); ++cc)
+  {
+    vtkDataArray* array = inAttrs->GetArray(this->GetScalarArrayName(cc));
+    const int component = this->GetSelectedScalarComponent(cc);
+    if (array && this->GetScalarVariableName(cc) && component >= 0 &&
+      component < array->GetNumberOfComponents())
+    {
+      vtkCalculatorVariable variable = { this->GetScalarVariableName(cc), array, false,
+        { component, 0, 0 } };
+      variables.push_back(variable);
+    }
+  }
+  for (int cc = 0; cc < this->GetNumberOfVectorArrays(); ++cc)
+  {
+    vtkDataArray* array = inAttrs->GetArray(this->GetVectorArrayName(cc));
+    const int* components = this->GetSelectedVectorComponents(cc);
+    if (array && this->GetVectorVariableName(cc) && components &&
+      *std::max_element(components, components + 3) < array->GetNumberOfComponents() &&
+      *std::min_element(components, components + 3) >= 0)
+    {
+      vtkCalculatorVariable variable = { this->GetVectorVariableName(cc), array, true,
+        { components[0], components[1], components[2] } };
+      variables.push_back(variable);
+    }
+  }
+  if (points || pointsOwner)
+  {
+    for (int cc = 0; cc < this->GetNumberOfCoordinateScalarArrays(); ++cc)
+    {
+      const int component = this->GetSelectedCoordinateScalarComponent(cc);
+      if (this->GetCoordinateScalarVariableName(cc) && component >= 0 && component < 3)
+      {
+        vtkCalculatorVariable variable = { this->GetCoordinateScalarVariableName(cc), points,
+          false, { component, 0, 0 } };
+        variables.push_back(variable);
+      }
+    }
+    for (int cc = 0; cc < this->GetNumberOfCoordinateVectorArrays(); ++cc)
+    {
+      const int* components = this->GetSelectedCoordinateVectorComponents(cc);
+      if (this->GetCoordinateVectorVariableName(cc) && components &&
+        *std::max_element(components, components + 3) < 3 &&
+        *std::min_element(components, components + 3) >= 0)
+      {
+        vtkCalculatorVariable variable = { this->GetCoordinateVectorVariableName(cc), points, true,
+          { components[0], components[1], components[2] } };
+        variables.push_back(variable);
+      }
+    }
+  }
+
+  vtkCalculatorProgram program;
+  vtkCalculatorCompiler compiler(this->Function, variables, program);
+  if (!compiler.Compile())
+  {
+    vtkDebugMacro("Function not supported by the compiled kernel: " << this->Function);
+    return false;
+  }
+
+  vtkSmartPointer<vtkDataArray> result;
+  result.TakeReference(vtkDataArray::CreateDataArray(this->ResultArrayType));
+  result->SetNumberOfComponents(static_cast<int>(program.Results.size()));
+  result->SetNumberOfTuples(numTuples);
+
+  vtkCalculatorKernel kernel(program, pointsOwner, result);
+  const vtkIdType numBlocks = (numTuples + vtkCalculatorBlockSize - 1) / vtkCalculatorBlockSize;
+  vtkSMPTools::For(0, numBlocks, kernel);
+  if (kernel.GetInvalid())
+  {
+    vtkDebugMacro("Invalid values, falling back to the function parser.");
+    return false;
+  }
+
+  output->ShallowCopy(input);
+  vtkDataSetAttributes* outAttrs = output->GetAttributes(attributeType);
+  result->SetName(this->ResultArrayName);
+  const int idx = outAttrs->AddArray(result);
+  outAttrs->SetActiveAttribute(idx, program.Results.size() == 1 ? vtkDataSetAttributes::SCALARS
+                                                                : vtkDataSetAttributes::VECTORS);
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 void vtkPVArrayCalculator::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "CompileExpression: " << this->CompileExpression << endl;
 }
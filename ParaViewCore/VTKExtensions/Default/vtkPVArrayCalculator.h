@@ -24,6 +24,12 @@
  *  their mapping with the input fields. We extend vtkArrayCalculator to
  *  automatically add scalar/vector fields mapping using the array available in
  *  the input.
+ *
+ *  By default, the function is compiled once into a kernel evaluating blocks
+ *  of tuples in parallel with vtkSMPTools, instead of evaluating the
+ *  vtkFunctionParser byte code for each tuple. Functions or options the
+ *  kernel does not support, and data for which an operation is invalid (e.g.
+ *  the square root of a negative value), are handled by vtkArrayCalculator.
  * @sa
  *  vtkArrayCalculator vtkFunctionParser
 */
@@ -45,12 +51,33 @@ public:
 
   static vtkPVArrayCalculator* New();
 
+  //@{
+  /**
+   * When on, the function is compiled into a kernel evaluating blocks of
+   * tuples in parallel, with a fall back to vtkArrayCalculator when the
+   * kernel cannot be used. Default is on.
+   */
+  vtkSetMacro(CompileExpression, bool);
+  vtkGetMacro(CompileExpression, bool);
+  vtkBooleanMacro(CompileExpression, bool);
+  //@}
+
 protected:
   vtkPVArrayCalculator();
   ~vtkPVArrayCalculator() override;
 
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
 
+  /**
+   * Evaluates the function with the compiled kernel. Returns false, leaving
+   * the output untouched, if the function or the options are not supported
+   * by the kernel or if an operation was invalid for some tuple.
+   */
+  bool EvaluateCompiled(
+    vtkDataObject* input, vtkDataObject* output, int attributeType, vtkIdType numTuples);
+
+  bool CompileExpression;
+
   //@{
   /**
    * This function updates the (scalar and vector arrays / variables) names
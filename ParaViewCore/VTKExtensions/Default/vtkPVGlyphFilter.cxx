@@ -16,13 +16,16 @@
 
 // VTK includes
 #include "vtkBoundingBox.h"
+#include "vtkCellArray.h"
 #include "vtkCellCenters.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkMinimalStandardRandomSequence.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMultiProcessController.h"
@@ -31,6 +34,7 @@
 #include "vtkOctreePointLocator.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
@@ -42,8 +46,345 @@
 #include <cmath>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
+namespace
+{
+// Number of input points per chunk when glyphing in parallel. The chunks do not
+// depend on the number of threads, which keeps the output deterministic.
+const vtkIdType vtkGlyphChunkSize = 16384;
+
+//----------------------------------------------------------------------------
+// Decides which input points get a glyph. Unlike
+// vtkPVGlyphFilter::IsPointVisible, this can be used from several threads.
+struct vtkGlyphPointSelector
+{
+  int GlyphMode;
+  int Stride;
+  const std::vector<vtkIdType>* SampledPointIds;
+  const unsigned char* GhostLevels;
+  vtkUniformGrid* UniformGrid;
+
+  bool IsGlyphed(vtkIdType ptId) const
+  {
+    // If we are processing a piece, we do not want to duplicate glyphs on the
+    // borders. Blanking specified on uniform grids is respected too.
+    if (this->GhostLevels && (this->GhostLevels[ptId] & vtkDataSetAttributes::DUPLICATEPOINT))
+    {
+      return false;
+    }
+    if (this->UniformGrid && !this->UniformGrid->IsPointVisible(ptId))
+    {
+      return false;
+    }
+    switch (this->GlyphMode)
+    {
+      case vtkPVGlyphFilter::ALL_POINTS:
+        return true;
+
+      case vtkPVGlyphFilter::EVERY_NTH_POINT:
+        return this->Stride <= 1 || (ptId % this->Stride) == 0;
+
+      case vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION:
+        return std::binary_search(
+          this->SampledPointIds->begin(), this->SampledPointIds->end(), ptId);
+    }
+    return false;
+  }
+};
+
+//----------------------------------------------------------------------------
+// First pass: counts the glyphs of each chunk of input points.
+class vtkGlyphCounter
+{
+public:
+  vtkGlyphCounter(
+    const vtkGlyphPointSelector& selector, vtkIdType numPts, std::vector<vtkIdType>& counts)
+    : Selector(selector)
+    , NumberOfPoints(numPts)
+    , Counts(counts)
+  {
+  }
+
+  void operator()(vtkIdType beginChunk, vtkIdType endChunk)
+  {
+    for (vtkIdType chunk = beginChunk; chunk < endChunk; ++chunk)
+    {
+      const vtkIdType end = std::min((chunk + 1) * vtkGlyphChunkSize, this->NumberOfPoints);
+      vtkIdType count = 0;
+      for (vtkIdType ptId = chunk * vtkGlyphChunkSize; ptId < end; ++ptId)
+      {
+        count += this->Selector.IsGlyphed(ptId) ? 1 : 0;
+      }
+      this->Counts[chunk] = count;
+    }
+  }
+
+private:
+  const vtkGlyphPointSelector& Selector;
+  vtkIdType NumberOfPoints;
+  std::vector<vtkIdType>& Counts;
+};
+
+//----------------------------------------------------------------------------
+// Rotation matrix of vtkTransform::RotateWXYZ(180, x, y, z).
+void vtkGlyphHalfTurn(double x, double y, double z, double r[3][3])
+{
+  const double angle = vtkMath::RadiansFromDegrees(180.0);
+  const double w = std::cos(0.5 * angle);
+  const double f = std::sin(0.5 * angle) / std::sqrt(x * x + y * y + z * z);
+  x *= f;
+  y *= f;
+  z *= f;
+
+  const double ww = w * w, wx = w * x, wy = w * y, wz = w * z;
+  const double xx = x * x, yy = y * y, zz = z * z;
+  const double xy = x * y, xz = x * z, yz = y * z;
+
+  r[0][0] = ww + xx - yy - zz;
+  r[1][0] = 2.0 * (xy + wz);
+  r[2][0] = 2.0 * (xz - wy);
+
+  r[0][1] = 2.0 * (xy - wz);
+  r[1][1] = ww - xx + yy - zz;
+  r[2][1] = 2.0 * (yz + wx);
+
+  r[0][2] = 2.0 * (xz + wy);
+  r[1][2] = 2.0 * (yz - wx);
+  r[2][2] = ww - xx - yy + zz;
+}
+
+//----------------------------------------------------------------------------
+// Second pass: writes the points, normals, cells and point data of the glyphs
+// of each chunk at the offsets computed from the counts of the first pass.
+class vtkGlyphGenerator
+{
+public:
+  // The glyph source, with the source transform applied to its points, and
+  // its cells as stored in the verts, lines, polys and strips arrays.
+  struct Source
+  {
+    vtkIdType NumberOfPoints;
+    std::vector<double> Points;
+    std::vector<double> Normals;
+    const vtkIdType* Cells[4];
+    vtkIdType CellsSize[4];
+  };
+
+  // Where the glyphs are written to. Either FloatPoints or DoublePoints is set.
+  struct Output
+  {
+    float* FloatPoints;
+    double* DoublePoints;
+    float* Normals;
+    vtkIdType* Cells[4];
+    std::vector<std::pair<vtkDataArray*, vtkDataArray*> > PointData;
+    std::vector<vtkIdType> GlyphPointIds;
+  };
+
+  vtkGlyphGenerator(const vtkGlyphPointSelector& selector, vtkDataSet* input,
+    vtkDataArray* scaleArray, vtkDataArray* orientArray, int vectorScaleMode, double scaleFactor,
+    const std::vector<vtkIdType>& offsets, const Source& source, Output& output)
+    : Selector(selector)
+    , Input(input)
+    , ScaleArray(scaleArray)
+    , OrientArray(orientArray)
+    , VectorScaleMode(vectorScaleMode)
+    , ScaleFactor(scaleFactor)
+    , Offsets(offsets)
+    , GlyphSource(source)
+    , GlyphOutput(output)
+  {
+  }
+
+  void operator()(vtkIdType beginChunk, vtkIdType endChunk)
+  {
+    const vtkIdType numPts = this->Input->GetNumberOfPoints();
+    for (vtkIdType chunk = beginChunk; chunk < endChunk; ++chunk)
+    {
+      vtkIdType glyph = this->Offsets[chunk];
+      const vtkIdType end = std::min((chunk + 1) * vtkGlyphChunkSize, numPts);
+      for (vtkIdType ptId = chunk * vtkGlyphChunkSize; ptId < end; ++ptId)
+      {
+        if (this->Selector.IsGlyphed(ptId))
+        {
+          this->Generate(ptId, glyph++);
+        }
+      }
+    }
+  }
+
+private:
+  void GetScale(vtkIdType ptId, double scale[3]) const
+  {
+    scale[0] = scale[1] = scale[2] = 1.0;
+    vtkDataArray* array = this->ScaleArray;
+    const int numComps = array ? array->GetNumberOfComponents() : 0;
+    if (numComps == 1)
+    {
+      scale[0] = scale[1] = scale[2] = array->GetComponent(ptId, 0);
+    }
+    else if (numComps == 2 || numComps == 3)
+    {
+      double vec[3] = { 0.0, 0.0, 0.0 };
+      for (int cc = 0; cc < numComps; ++cc)
+      {
+        vec[cc] = array->GetComponent(ptId, cc);
+      }
+      if (this->VectorScaleMode == vtkPVGlyphFilter::SCALE_BY_MAGNITUDE)
+      {
+        scale[0] = scale[1] = scale[2] = numComps == 2 ? vtkMath::Norm2D(vec) : vtkMath::Norm(vec);
+      }
+      else
+      {
+        // leave the z scale alone for 2D
+        std::copy(vec, vec + numComps, scale);
+      }
+    }
+
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      scale[cc] *= this->ScaleFactor;
+      if (scale[cc] == 0.0)
+      {
+        scale[cc] = 1.0e-10;
+      }
+    }
+  }
+
+  void GetRotation(vtkIdType ptId, double r[3][3]) const
+  {
+    vtkMath::Identity3x3(r);
+    if (!this->OrientArray)
+    {
+      return;
+    }
+    double v[3] = { 0.0, 0.0, 0.0 };
+    for (int cc = 0; cc < this->OrientArray->GetNumberOfComponents(); ++cc)
+    {
+      v[cc] = this->OrientArray->GetComponent(ptId, cc);
+    }
+    const double vMag = vtkMath::Norm(v);
+    if (vMag > 0.0)
+    {
+      // if there is no y or z component
+      if (v[1] == 0.0 && v[2] == 0.0)
+      {
+        if (v[0] < 0) // just flip x if we need to
+        {
+          vtkGlyphHalfTurn(0, 1, 0, r);
+        }
+      }
+      else
+      {
+        vtkGlyphHalfTurn((v[0] + vMag) / 2.0, v[1] / 2.0, v[2] / 2.0, r);
+      }
+    }
+  }
+
+  // Same as translating to the input point, rotating, then scaling with a
+  // vtkTransform.
+  void Generate(vtkIdType ptId, vtkIdType glyph)
+  {
+    const Source& source = this->GlyphSource;
+    Output& output = this->GlyphOutput;
+
+    double scale[3];
+    this->GetScale(ptId, scale);
+    double r[3][3];
+    this->GetRotation(ptId, r);
+    double x[3];
+    this->Input->GetPoint(ptId, x);
+
+    double m[3][3];
+    for (int i = 0; i < 3; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        m[i][j] = r[i][j] * scale[j];
+      }
+    }
+
+    const vtkIdType firstPtId = glyph * source.NumberOfPoints;
+    for (vtkIdType cc = 0; cc < source.NumberOfPoints; ++cc)
+    {
+      const double* p = &source.Points[3 * cc];
+      for (int i = 0; i < 3; ++i)
+      {
+        const double value = m[i][0] * p[0] + m[i][1] * p[1] + m[i][2] * p[2] + x[i];
+        if (output.FloatPoints)
+        {
+          output.FloatPoints[3 * (firstPtId + cc) + i] = static_cast<float>(value);
+        }
+        else
+        {
+          output.DoublePoints[3 * (firstPtId + cc) + i] = value;
+        }
+      }
+    }
+
+    if (output.Normals)
+    {
+      // normals are transformed by the inverse transpose, which is the
+      // rotation followed by the inverse scaling.
+      for (int i = 0; i < 3; ++i)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          m[i][j] = r[i][j] / scale[j];
+        }
+      }
+      for (vtkIdType cc = 0; cc < source.NumberOfPoints; ++cc)
+      {
+        double n[3];
+        vtkMath::Multiply3x3(m, &source.Normals[3 * cc], n);
+        vtkMath::Normalize(n);
+        std::copy(n, n + 3, output.Normals + 3 * (firstPtId + cc));
+      }
+    }
+
+    for (int type = 0; type < 4; ++type)
+    {
+      const vtkIdType size = source.CellsSize[type];
+      const vtkIdType* src = source.Cells[type];
+      vtkIdType* dst = output.Cells[type] + glyph * size;
+      for (vtkIdType cc = 0; cc < size;)
+      {
+        const vtkIdType npts = src[cc];
+        dst[cc] = npts;
+        for (vtkIdType i = 1; i <= npts; ++i)
+        {
+          dst[cc + i] = src[cc + i] + firstPtId;
+        }
+        cc += npts + 1;
+      }
+    }
+
+    for (size_t cc = 0; cc < output.PointData.size(); ++cc)
+    {
+      vtkDataArray* inArray = output.PointData[cc].first;
+      vtkDataArray* outArray = output.PointData[cc].second;
+      for (vtkIdType i = 0; i < source.NumberOfPoints; ++i)
+      {
+        outArray->SetTuple(firstPtId + i, ptId, inArray);
+      }
+    }
+    output.GlyphPointIds[glyph] = ptId;
+  }
+
+  const vtkGlyphPointSelector& Selector;
+  vtkDataSet* Input;
+  vtkDataArray* ScaleArray;
+  vtkDataArray* OrientArray;
+  int VectorScaleMode;
+  double ScaleFactor;
+  const std::vector<vtkIdType>& Offsets;
+  const Source& GlyphSource;
+  Output& GlyphOutput;
+};
+}
+
 class vtkPVGlyphFilter::vtkInternals
 {
   vtkBoundingBox Bounds;
@@ -84,6 +425,15 @@ class vtkPVGlyphFilter::vtkInternals
   }
 
 public:
+  //---------------------------------------------------------------------------
+  // Returns the sorted ids of the points of the given dataset closest to the
+  // random sample points, for SPATIALLY_UNIFORM_DISTRIBUTION.
+  const std::vector<vtkIdType>& GetSampledPointIds(vtkDataSet* ds)
+  {
+    this->SetupLocator(ds);
+    return this->PointIds;
+  }
+
   void Reset()
   {
     this->Bounds.Reset();
@@ -572,9 +922,6 @@ bool vtkPVGlyphFilter::Execute(vtkDataSet* input, vtkInformationVector* sourceVe
 
   vtkDebugMacro(<< "Generating glyphs");
 
-  auto pts = vtkSmartPointer<vtkIdList>::New();
-  pts->Allocate(VTK_CELL_SIZE);
-
   unsigned char* inGhostLevels = nullptr;
   vtkDataArray* temp = nullptr;
   auto pd = input->GetPointData();
@@ -598,7 +945,6 @@ bool vtkPVGlyphFilter::Execute(vtkDataSet* input, vtkInformationVector* sourceVe
     return 1;
   }
 
-  // Allocate storage for output PolyData
   vtkPointData* outputPD = output->GetPointData();
   outputPD->CopyVectorsOff();
   outputPD->CopyNormalsOff();
@@ -623,235 +969,174 @@ bool vtkPVGlyphFilter::Execute(vtkDataSet* input, vtkInformationVector* sourceVe
 
   auto sourcePts = source->GetPoints();
   vtkIdType numSourcePts = sourcePts->GetNumberOfPoints();
-  vtkIdType numSourceCells = source->GetNumberOfCells();
-
   vtkDataArray* sourceNormals = source->GetPointData()->GetNormals();
 
-  // Prepare to copy output.
-  pd = input->GetPointData();
-  outputPD->CopyAllocate(pd, numPts * numSourcePts);
+  // The source transform is the same for all the glyphs, apply it once.
+  vtkGlyphGenerator::Source glyphSource;
+  glyphSource.NumberOfPoints = numSourcePts;
+  glyphSource.Points.resize(3 * numSourcePts);
+  vtkNew<vtkPoints> transformedSourcePts;
+  if (this->SourceTransform)
+  {
+    transformedSourcePts->SetDataTypeToDouble();
+    transformedSourcePts->Allocate(numSourcePts);
+    this->SourceTransform->TransformPoints(sourcePts, transformedSourcePts.GetPointer());
+    sourcePts = transformedSourcePts.GetPointer();
+  }
+  for (vtkIdType cc = 0; cc < numSourcePts; ++cc)
+  {
+    sourcePts->GetPoint(cc, &glyphSource.Points[3 * cc]);
+  }
+  if (sourceNormals)
+  {
+    glyphSource.Normals.resize(3 * numSourcePts);
+    for (vtkIdType cc = 0; cc < numSourcePts; ++cc)
+    {
+      sourceNormals->GetTuple(cc, &glyphSource.Normals[3 * cc]);
+    }
+  }
+  vtkCellArray* sourceCells[4] = { source->GetVerts(), source->GetLines(), source->GetPolys(),
+    source->GetStrips() };
+  for (int type = 0; type < 4; ++type)
+  {
+    glyphSource.Cells[type] = sourceCells[type]->GetPointer();
+    glyphSource.CellsSize[type] = sourceCells[type]->GetNumberOfConnectivityEntries();
+  }
 
-  vtkNew<vtkIdList> srcPointIdList;
-  srcPointIdList->SetNumberOfIds(numSourcePts);
-  vtkNew<vtkIdList> dstPointIdList;
-  dstPointIdList->SetNumberOfIds(numSourcePts);
-  vtkNew<vtkIdList> srcCellIdList;
-  srcCellIdList->SetNumberOfIds(numSourceCells);
-  vtkNew<vtkIdList> dstCellIdList;
-  dstCellIdList->SetNumberOfIds(numSourceCells);
+  // Everything the point selector and the generator read from several threads
+  // has to be set up before: the sampled point ids, the ghost array cached by
+  // uniform grids and the structures GetPoint() builds on the first call.
+  vtkGlyphPointSelector selector;
+  selector.GlyphMode = this->GlyphMode;
+  selector.Stride = this->Stride;
+  selector.SampledPointIds = this->GlyphMode == SPATIALLY_UNIFORM_DISTRIBUTION
+    ? &this->Internals->GetSampledPointIds(input)
+    : nullptr;
+  selector.GhostLevels = inGhostLevels;
+  selector.UniformGrid = vtkUniformGrid::SafeDownCast(input);
+  if (selector.UniformGrid)
+  {
+    selector.UniformGrid->GetPointGhostArray();
+  }
+  double x[3];
+  input->GetPoint(0, x);
+
+  // First pass: count the glyphs of each chunk, their offsets in the output
+  // follow from a prefix sum.
+  const vtkIdType numChunks = (numPts + vtkGlyphChunkSize - 1) / vtkGlyphChunkSize;
+  std::vector<vtkIdType> offsets(numChunks + 1, 0);
+  vtkGlyphCounter counter(selector, numPts, offsets);
+  vtkSMPTools::For(0, numChunks, counter);
+  vtkIdType numGlyphs = 0;
+  for (vtkIdType chunk = 0; chunk <= numChunks; ++chunk)
+  {
+    const vtkIdType count = offsets[chunk];
+    offsets[chunk] = numGlyphs;
+    numGlyphs += count;
+  }
+  this->UpdateProgress(0.5);
+  if (this->GetAbortExecute())
+  {
+    return true;
+  }
 
-  auto newPts = vtkSmartPointer<vtkPoints>::New();
+  // Allocate the output once.
+  const vtkIdType numOutputPts = numGlyphs * numSourcePts;
+  vtkGlyphGenerator::Output glyphOutput;
+  glyphOutput.GlyphPointIds.resize(numGlyphs);
 
+  auto newPts = vtkSmartPointer<vtkPoints>::New();
   // Set the desired precision for the points in the output.
-  if (this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+  if (this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
   {
-    newPts->SetDataType(VTK_FLOAT);
+    newPts->SetDataType(VTK_DOUBLE);
   }
-  else if (this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+  else
   {
     newPts->SetDataType(VTK_FLOAT);
   }
-  else if (this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  newPts->SetNumberOfPoints(numOutputPts);
+  glyphOutput.FloatPoints = nullptr;
+  glyphOutput.DoublePoints = nullptr;
+  if (vtkFloatArray* floatPts = vtkFloatArray::SafeDownCast(newPts->GetData()))
   {
-    newPts->SetDataType(VTK_DOUBLE);
+    glyphOutput.FloatPoints = floatPts->GetPointer(0);
+  }
+  else
+  {
+    glyphOutput.DoublePoints = vtkDoubleArray::SafeDownCast(newPts->GetData())->GetPointer(0);
   }
-
-  newPts->Allocate(numPts * numSourcePts);
 
   vtkSmartPointer<vtkFloatArray> newNormals;
+  glyphOutput.Normals = nullptr;
   if (sourceNormals)
   {
     newNormals.TakeReference(vtkFloatArray::New());
     newNormals->SetNumberOfComponents(3);
-    newNormals->Allocate(3 * numPts * numSourcePts);
+    newNormals->SetNumberOfTuples(numOutputPts);
     newNormals->SetName("Normals");
+    glyphOutput.Normals = newNormals->GetPointer(0);
   }
 
-  // Setting up for calls to PolyData::InsertNextCell()
-  output->Allocate(source, 3 * numPts * numSourceCells, numPts * numSourceCells);
-
-  vtkSmartPointer<vtkPoints> transformedSourcePts = vtkSmartPointer<vtkPoints>::New();
-  transformedSourcePts->SetDataTypeToDouble();
-  transformedSourcePts->Allocate(numSourcePts);
-
-  // Traverse all Input points, transforming Source points and copying
-  // point attributes.
-  auto trans = vtkSmartPointer<vtkTransform>::New();
-  vtkNew<vtkIdList> pointIdList;
-  vtkIdType ptIncr = 0;
-  vtkIdType cellIncr = 0;
-  for (vtkIdType inPtId = 0; inPtId < numPts; inPtId++)
+  vtkSmartPointer<vtkCellArray> newCells[4];
+  for (int type = 0; type < 4; ++type)
   {
-    double scalex(1.0), scaley(1.0), scalez(1.0);
-    if (!(inPtId % 10000))
+    glyphOutput.Cells[type] = nullptr;
+    if (sourceCells[type]->GetNumberOfCells() > 0)
     {
-      this->UpdateProgress(static_cast<double>(inPtId) / numPts);
-      if (this->GetAbortExecute())
-      {
-        break;
-      }
+      newCells[type] = vtkSmartPointer<vtkCellArray>::New();
+      glyphOutput.Cells[type] = newCells[type]->WritePointer(
+        numGlyphs * sourceCells[type]->GetNumberOfCells(), numGlyphs * glyphSource.CellsSize[type]);
     }
+  }
 
-    // Get the scalar and vector data
-    if (scaleArray)
-    {
-      if (scaleArray->GetNumberOfComponents() == 1)
-      {
-        scalex = scaley = scalez = scaleArray->GetComponent(inPtId, 0);
-      }
-      else
-      {
-        // Consider the vector scaling mode
-        if (scaleArray->GetNumberOfComponents() == 2)
-        {
-          double* vec2 = scaleArray->GetTuple(inPtId);
-          if (this->VectorScaleMode == SCALE_BY_MAGNITUDE)
-          {
-            scalex = scaley = scalez = vtkMath::Norm2D(vec2);
-          }
-          else if (this->VectorScaleMode == SCALE_BY_COMPONENTS)
-          {
-            scalex = vec2[0];
-            scaley = vec2[1];
-            // leave scalez alone for 2D
-          }
-        }
-        else if (scaleArray->GetNumberOfComponents() == 3)
-        {
-          double* vec3 = scaleArray->GetTuple(inPtId);
-          if (this->VectorScaleMode == SCALE_BY_MAGNITUDE)
-          {
-            scalex = scaley = scalez = vtkMath::Norm(vec3);
-          }
-          else
-          {
-            scalex = vec3[0];
-            scaley = vec3[1];
-            scalez = vec3[2];
-          }
-        }
-      }
-    }
-
-    // Apply scale factor
-    scalex *= this->ScaleFactor;
-    scaley *= this->ScaleFactor;
-    scalez *= this->ScaleFactor;
-
-    // Check ghost points.
-    // If we are processing a piece, we do not want to duplicate
-    // glyphs on the borders.
-    if (inGhostLevels && inGhostLevels[inPtId] & vtkDataSetAttributes::DUPLICATEPOINT)
-    {
-      continue;
-    }
-
-    // this is used to respect blanking specified on uniform grids.
-    vtkUniformGrid* inputUG = vtkUniformGrid::SafeDownCast(input);
-    if (inputUG && !inputUG->IsPointVisible(inPtId))
-    {
-      // input is a vtkUniformGrid and the current point is blanked. Don't glyph
-      // it.
-      continue;
-    }
-
-    if (!this->IsPointVisible(input, inPtId))
-    {
-      continue;
-    }
-
-    // Now begin copying/transforming glyph
-    trans->Identity();
-
-    // Copy all topology (transformation independent)
-    for (vtkIdType cellId = 0; cellId < numSourceCells; cellId++)
-    {
-      source->GetCellPoints(cellId, pointIdList);
-      int npts = pointIdList->GetNumberOfIds();
-      pts->Reset();
-      for (vtkIdType i = 0; i < npts; i++)
-      {
-        pts->InsertId(i, pointIdList->GetId(i) + ptIncr);
-      }
-      output->InsertNextCell(source->GetCellType(cellId), pts);
-    }
-
-    // translate Source to Input point
-    double x[3];
-    input->GetPoint(inPtId, x);
-    trans->Translate(x[0], x[1], x[2]);
-
-    if (orientArray)
-    {
-      double v[3] = { 0.0 };
-      orientArray->GetTuple(inPtId, v);
-      double vMag = vtkMath::Norm(v);
-      if (vMag > 0.0)
-      {
-        // if there is no y or z component
-        if (v[1] == 0.0 && v[2] == 0.0)
-        {
-          if (v[0] < 0) // just flip x if we need to
-          {
-            trans->RotateWXYZ(180.0, 0, 1, 0);
-          }
-        }
-        else
-        {
-          double vNew[3];
-          vNew[0] = (v[0] + vMag) / 2.0;
-          vNew[1] = v[1] / 2.0;
-          vNew[2] = v[2] / 2.0;
-          trans->RotateWXYZ(180.0, vNew[0], vNew[1], vNew[2]);
-        }
-      }
-    }
-
-    // scale data if appropriate
-    if (scalex == 0.0)
-    {
-      scalex = 1.0e-10;
-    }
-    if (scaley == 0.0)
-    {
-      scaley = 1.0e-10;
-    }
-    if (scalez == 0.0)
-    {
-      scalez = 1.0e-10;
-    }
-    trans->Scale(scalex, scaley, scalez);
-
-    // multiply points and normals by resulting matrix
-    if (this->SourceTransform)
-    {
-      transformedSourcePts->Reset();
-      this->SourceTransform->TransformPoints(sourcePts, transformedSourcePts);
-      trans->TransformPoints(transformedSourcePts, newPts);
-    }
-    else
+  // Point data arrays are copied in parallel when each output array can be
+  // paired with its input array, otherwise they are copied afterwards.
+  outputPD->CopyAllocate(pd, numOutputPts);
+  bool pairedPointData = true;
+  std::vector<std::pair<vtkDataArray*, vtkDataArray*> > pointDataArrays;
+  for (int cc = 0; cc < outputPD->GetNumberOfArrays() && pairedPointData; ++cc)
+  {
+    vtkAbstractArray* outArray = outputPD->GetAbstractArray(cc);
+    const int attribute = outputPD->IsArrayAnAttribute(cc);
+    vtkAbstractArray* inArray = outArray->GetName()
+      ? pd->GetAbstractArray(outArray->GetName())
+      : (attribute >= 0 ? pd->GetAbstractAttribute(attribute) : nullptr);
+    vtkDataArray* inDataArray = vtkDataArray::SafeDownCast(inArray);
+    vtkDataArray* outDataArray = vtkDataArray::SafeDownCast(outArray);
+    pairedPointData = inDataArray && outDataArray &&
+      inDataArray->GetNumberOfComponents() == outDataArray->GetNumberOfComponents();
+    pointDataArrays.push_back(std::make_pair(inDataArray, outDataArray));
+  }
+  if (pairedPointData)
+  {
+    for (size_t cc = 0; cc < pointDataArrays.size(); ++cc)
     {
-      trans->TransformPoints(sourcePts, newPts);
+      pointDataArrays[cc].second->SetNumberOfTuples(numOutputPts);
     }
+    glyphOutput.PointData.swap(pointDataArrays);
+  }
 
-    if (newNormals.GetPointer())
-    {
-      trans->TransformNormals(sourceNormals, newNormals);
-    }
+  // Second pass: generate the glyphs of each chunk in parallel.
+  vtkGlyphGenerator generator(selector, input, scaleArray, orientArray, this->VectorScaleMode,
+    this->ScaleFactor, offsets, glyphSource, glyphOutput);
+  vtkSMPTools::For(0, numChunks, generator);
 
-    // Copy point data from source (if possible)
-    if (pd)
+  if (!pairedPointData)
+  {
+    vtkNew<vtkIdList> srcPointIdList;
+    srcPointIdList->SetNumberOfIds(numSourcePts);
+    vtkNew<vtkIdList> dstPointIdList;
+    dstPointIdList->SetNumberOfIds(numSourcePts);
+    for (vtkIdType glyph = 0; glyph < numGlyphs; ++glyph)
     {
       for (vtkIdType i = 0; i < numSourcePts; ++i)
       {
-        srcPointIdList->SetId(i, inPtId);
-        dstPointIdList->SetId(i, ptIncr + i);
+        srcPointIdList->SetId(i, glyphOutput.GlyphPointIds[glyph]);
+        dstPointIdList->SetId(i, glyph * numSourcePts + i);
       }
-      outputPD->CopyData(pd, srcPointIdList, dstPointIdList);
+      outputPD->CopyData(pd, srcPointIdList.GetPointer(), dstPointIdList.GetPointer());
     }
-
-    ptIncr += numSourcePts;
-    cellIncr += numSourceCells;
   }
 
   if (newNormals.GetPointer())
@@ -859,10 +1144,23 @@ bool vtkPVGlyphFilter::Execute(vtkDataSet* input, vtkInformationVector* sourceVe
     outputPD->SetNormals(newNormals);
   }
 
-  // Update ourselves and release memory
-  //
   output->SetPoints(newPts);
-  output->Squeeze();
+  if (newCells[0])
+  {
+    output->SetVerts(newCells[0]);
+  }
+  if (newCells[1])
+  {
+    output->SetLines(newCells[1]);
+  }
+  if (newCells[2])
+  {
+    output->SetPolys(newCells[2]);
+  }
+  if (newCells[3])
+  {
+    output->SetStrips(newCells[3]);
+  }
 
   return true;
 }
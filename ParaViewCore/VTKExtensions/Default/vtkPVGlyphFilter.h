@@ -35,6 +35,11 @@
  * doesn't not equal the number of points actually glyphed, since that depends on
  * several factors. In parallel, this filter ensures that spatial bounds are collected
  * across all ranks for generating identical sample points.
+ *
+ * Glyphs are generated with vtkSMPTools in two passes over fixed chunks of the
+ * input points: the first counts the glyphs of each chunk, the output is then
+ * allocated once and the second pass fills it in parallel. The output does not
+ * depend on the number of threads.
 */
 
 #ifndef vtkPVGlyphFilter_h
@@ -185,8 +190,12 @@ protected:
 
   /**
    * Returns 1 if point is to be glyphed, otherwise returns 0.
+   * Note that RequestData() does not call it, it tests the points from
+   * several threads with an equivalent thread safe implementation. This is
+   * why it is no longer virtual: overriding it would not change which points
+   * are glyphed.
    */
-  virtual int IsPointVisible(vtkDataSet* ds, vtkIdType ptId);
+  int IsPointVisible(vtkDataSet* ds, vtkIdType ptId);
 
   /**
    * Returns true if input Scalars and Vectors are compatible, otherwise returns 0.
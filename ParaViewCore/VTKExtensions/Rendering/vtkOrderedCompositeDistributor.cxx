@@ -27,17 +27,32 @@
 
 #include "vtkBSPCuts.h"
 #include "vtkCallbackCommand.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
 #include "vtkDataObjectTypes.h"
 #include "vtkDataSetSurfaceFilter.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkIntArray.h"
 #include "vtkMath.h"
 #include "vtkMultiProcessController.h"
+#include "vtkMultiProcessStream.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPKdTree.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
+#include "vtkWeakPointer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #ifdef PARAVIEW_USE_MPI
 #include "vtkDistributedDataFilter.h"
@@ -55,6 +70,476 @@ static void D3UpdateProgress(vtkObject* _D3, unsigned long, void* _distributor,
   distributor->UpdateProgress(D3->GetProgress() * 0.9);
 }
 #endif
+//-----------------------------------------------------------------------------
+// Remembers where each point and cell of the local input ended up during the
+// last redistribution so that the attribute arrays of a later input with the
+// same geometry can be exchanged without running vtkDistributedDataFilter.
+class vtkOrderedCompositeDistributor::vtkInternals
+{
+public:
+  static const char* SourceProcessArrayName() { return "vtkOCDSourceProcess"; }
+  static const char* SourceIdArrayName() { return "vtkOCDSourceId"; }
+
+  enum
+  {
+    ROUTES_TAG = 2890,
+    ATTRIBUTES_TAG = 2891
+  };
+
+  // Routes for either points or cells.
+  struct vtkRoutes
+  {
+    // Send[p] are ids of local input elements, in the order process p wants them.
+    std::vector<std::vector<vtkIdType> > Send;
+    // Receive[p] are ids of local output elements filled with data from process p.
+    std::vector<std::vector<vtkIdType> > Receive;
+  };
+
+  // Arrays (name, type, components) and active attributes of a
+  // vtkDataSetAttributes. Arrays are exchanged in this order.
+  struct vtkLayout
+  {
+    std::vector<std::string> Names;
+    std::vector<int> Types;
+    std::vector<int> Components;
+    int Attributes[vtkDataSetAttributes::NUM_ATTRIBUTES];
+  };
+
+  bool Valid;
+  int BoundaryMode;
+  vtkWeakPointer<vtkPKdTree> KdTree;
+  vtkMTimeType CutsMTime;
+  vtkSmartPointer<vtkDataSet> InputStructure;
+  vtkSmartPointer<vtkDataSet> OutputStructure;
+  vtkRoutes PointRoutes;
+  vtkRoutes CellRoutes;
+
+  vtkInternals()
+    : Valid(false)
+    , BoundaryMode(-1)
+    , CutsMTime(0)
+  {
+  }
+
+  // Blocking sends and receives are paired up by visiting the pairs (i, j),
+  // i < j, in the same lexicographic order on every process.
+  template <typename Functor>
+  static void ForEachPeer(int rank, int numProcs, Functor f)
+  {
+    for (int i = 0; i < numProcs; ++i)
+    {
+      for (int j = i + 1; j < numProcs; ++j)
+      {
+        if (rank == i)
+        {
+          f(j, /*send_first=*/true);
+        }
+        else if (rank == j)
+        {
+          f(i, /*send_first=*/false);
+        }
+      }
+    }
+  }
+
+  static bool SameArray(vtkDataArray* a, vtkDataArray* b)
+  {
+    if (a == b)
+    {
+      return true;
+    }
+    if (a == nullptr || b == nullptr || a->GetDataType() != b->GetDataType() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents() ||
+      a->GetNumberOfTuples() != b->GetNumberOfTuples())
+    {
+      return false;
+    }
+    const size_t size = static_cast<size_t>(a->GetNumberOfTuples()) *
+      a->GetNumberOfComponents() * a->GetDataTypeSize();
+    return size == 0 || memcmp(a->GetVoidPointer(0), b->GetVoidPointer(0), size) == 0;
+  }
+
+  static bool SameCells(vtkCellArray* a, vtkCellArray* b)
+  {
+    if (a == b)
+    {
+      return true;
+    }
+    if (a == nullptr || b == nullptr)
+    {
+      return false;
+    }
+    return SameArray(a->GetData(), b->GetData());
+  }
+
+  // Returns true if both datasets have identical points and cells. Only
+  // unstructured grids and polydata are compared, other types are never
+  // considered identical.
+  static bool SameStructure(vtkDataSet* a, vtkDataSet* b)
+  {
+    if (a == nullptr || b == nullptr || a->GetDataObjectType() != b->GetDataObjectType() ||
+      a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfCells() != b->GetNumberOfCells())
+    {
+      return false;
+    }
+
+    vtkPointSet* psA = vtkPointSet::SafeDownCast(a);
+    vtkPointSet* psB = vtkPointSet::SafeDownCast(b);
+    if (psA == nullptr || psB == nullptr)
+    {
+      return false;
+    }
+    if (psA->GetPoints() != psB->GetPoints() &&
+      (psA->GetPoints() == nullptr || psB->GetPoints() == nullptr ||
+          !SameArray(psA->GetPoints()->GetData(), psB->GetPoints()->GetData())))
+    {
+      return false;
+    }
+
+    if (vtkUnstructuredGrid* ugA = vtkUnstructuredGrid::SafeDownCast(a))
+    {
+      vtkUnstructuredGrid* ugB = vtkUnstructuredGrid::SafeDownCast(b);
+      return SameArray(ugA->GetCellTypesArray(), ugB->GetCellTypesArray()) &&
+        SameCells(ugA->GetCells(), ugB->GetCells());
+    }
+    if (vtkPolyData* pdA = vtkPolyData::SafeDownCast(a))
+    {
+      vtkPolyData* pdB = vtkPolyData::SafeDownCast(b);
+      return SameCells(pdA->GetVerts(), pdB->GetVerts()) &&
+        SameCells(pdA->GetLines(), pdB->GetLines()) &&
+        SameCells(pdA->GetPolys(), pdB->GetPolys()) &&
+        SameCells(pdA->GetStrips(), pdB->GetStrips());
+    }
+    return false;
+  }
+
+  static vtkSmartPointer<vtkDataSet> CopyStructure(vtkDataSet* ds)
+  {
+    vtkSmartPointer<vtkDataSet> clone;
+    clone.TakeReference(ds->NewInstance());
+    clone->CopyStructure(ds);
+    return clone;
+  }
+
+  // Appends the array layout to the stream. Returns false if some array is
+  // not a vtkDataArray and hence cannot be exchanged.
+  static bool SerializeLayout(vtkDataSetAttributes* dsa, vtkMultiProcessStream& stream)
+  {
+    bool valid = true;
+    const int numArrays = dsa->GetNumberOfArrays();
+    stream << numArrays;
+    for (int cc = 0; cc < numArrays; ++cc)
+    {
+      vtkDataArray* array = dsa->GetArray(cc);
+      valid = valid && array != nullptr;
+      const char* name = array ? array->GetName() : nullptr;
+      stream << std::string(name ? name : "") << (array ? array->GetDataType() : -1)
+             << (array ? array->GetNumberOfComponents() : 0);
+    }
+    int attributes[vtkDataSetAttributes::NUM_ATTRIBUTES];
+    dsa->GetAttributeIndices(attributes);
+    for (int cc = 0; cc < vtkDataSetAttributes::NUM_ATTRIBUTES; ++cc)
+    {
+      stream << attributes[cc];
+    }
+    return valid;
+  }
+
+  static void DeserializeLayout(vtkMultiProcessStream& stream, vtkLayout& layout)
+  {
+    int numArrays = 0;
+    stream >> numArrays;
+    layout.Names.resize(numArrays);
+    layout.Types.resize(numArrays);
+    layout.Components.resize(numArrays);
+    for (int cc = 0; cc < numArrays; ++cc)
+    {
+      stream >> layout.Names[cc] >> layout.Types[cc] >> layout.Components[cc];
+    }
+    for (int cc = 0; cc < vtkDataSetAttributes::NUM_ATTRIBUTES; ++cc)
+    {
+      stream >> layout.Attributes[cc];
+    }
+  }
+
+  // Builds the routes from the source process/id arrays the output carries
+  // and removes those arrays from the output. Collective.
+  static bool BuildRoutes(vtkDataSetAttributes* outDSA, vtkIdType numOut, vtkIdType numIn,
+    vtkMultiProcessController* controller, vtkRoutes& routes)
+  {
+    const int numProcs = controller->GetNumberOfProcesses();
+    const int rank = controller->GetLocalProcessId();
+
+    vtkIntArray* procs = vtkIntArray::SafeDownCast(outDSA->GetArray(SourceProcessArrayName()));
+    vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(outDSA->GetArray(SourceIdArrayName()));
+    bool valid = numOut == 0 || (procs != nullptr && ids != nullptr &&
+                                  procs->GetNumberOfTuples() == numOut &&
+                                  ids->GetNumberOfTuples() == numOut);
+
+    std::vector<std::vector<vtkIdType> > requests(numProcs);
+    routes.Receive.assign(numProcs, std::vector<vtkIdType>());
+    for (vtkIdType cc = 0; valid && cc < numOut; ++cc)
+    {
+      const int proc = procs->GetValue(cc);
+      if (proc < 0 || proc >= numProcs)
+      {
+        valid = false;
+        break;
+      }
+      routes.Receive[proc].push_back(cc);
+      requests[proc].push_back(ids->GetValue(cc));
+    }
+    outDSA->RemoveArray(SourceProcessArrayName());
+    outDSA->RemoveArray(SourceIdArrayName());
+    if (!valid)
+    {
+      // still take part in the exchange, just with nothing to ask for.
+      requests.assign(numProcs, std::vector<vtkIdType>());
+      routes.Receive.assign(numProcs, std::vector<vtkIdType>());
+    }
+
+    routes.Send.assign(numProcs, std::vector<vtkIdType>());
+    routes.Send[rank] = requests[rank];
+    ForEachPeer(rank, numProcs, [&](int peer, bool send_first) {
+      for (int pass = 0; pass < 2; ++pass)
+      {
+        if ((pass == 0) == send_first)
+        {
+          vtkIdType count = static_cast<vtkIdType>(requests[peer].size());
+          controller->Send(&count, 1, peer, ROUTES_TAG);
+          if (count > 0)
+          {
+            controller->Send(&requests[peer][0], count, peer, ROUTES_TAG);
+          }
+        }
+        else
+        {
+          vtkIdType count = 0;
+          controller->Receive(&count, 1, peer, ROUTES_TAG);
+          routes.Send[peer].resize(count);
+          if (count > 0)
+          {
+            controller->Receive(&routes.Send[peer][0], count, peer, ROUTES_TAG);
+          }
+        }
+      }
+    });
+
+    for (int proc = 0; proc < numProcs; ++proc)
+    {
+      for (vtkIdType id : routes.Send[proc])
+      {
+        valid = valid && id >= 0 && id < numIn;
+      }
+    }
+    return valid;
+  }
+
+  // Exchanges the arrays described by the layout along the routes and adds
+  // them to outDSA. Collective.
+  static void TransferAttributes(vtkDataSetAttributes* inDSA, vtkDataSetAttributes* outDSA,
+    vtkIdType numOut, const vtkLayout& layout, const vtkRoutes& routes,
+    vtkMultiProcessController* controller)
+  {
+    const int numProcs = controller->GetNumberOfProcesses();
+    const int rank = controller->GetLocalProcessId();
+    for (size_t idx = 0; idx < layout.Names.size(); ++idx)
+    {
+      vtkSmartPointer<vtkDataArray> output;
+      output.TakeReference(vtkDataArray::CreateDataArray(layout.Types[idx]));
+      output->SetNumberOfComponents(layout.Components[idx]);
+      output->SetNumberOfTuples(numOut);
+      if (!layout.Names[idx].empty())
+      {
+        output->SetName(layout.Names[idx].c_str());
+      }
+
+      vtkDataArray* input = inDSA->GetArray(static_cast<int>(idx));
+      const std::vector<vtkIdType>& localSend = routes.Send[rank];
+      const std::vector<vtkIdType>& localReceive = routes.Receive[rank];
+      for (size_t cc = 0; cc < localSend.size(); ++cc)
+      {
+        output->SetTuple(localReceive[cc], localSend[cc], input);
+      }
+
+      ForEachPeer(rank, numProcs, [&](int peer, bool send_first) {
+        for (int pass = 0; pass < 2; ++pass)
+        {
+          if ((pass == 0) == send_first)
+          {
+            const std::vector<vtkIdType>& send = routes.Send[peer];
+            if (!send.empty())
+            {
+              vtkSmartPointer<vtkDataArray> buffer;
+              buffer.TakeReference(vtkDataArray::CreateDataArray(layout.Types[idx]));
+              buffer->SetNumberOfComponents(layout.Components[idx]);
+              buffer->SetNumberOfTuples(static_cast<vtkIdType>(send.size()));
+              for (size_t cc = 0; cc < send.size(); ++cc)
+              {
+                buffer->SetTuple(static_cast<vtkIdType>(cc), send[cc], input);
+              }
+              controller->Send(buffer.GetPointer(), peer, ATTRIBUTES_TAG);
+            }
+          }
+          else
+          {
+            const std::vector<vtkIdType>& receive = routes.Receive[peer];
+            if (!receive.empty())
+            {
+              vtkSmartPointer<vtkDataArray> buffer;
+              buffer.TakeReference(vtkDataArray::CreateDataArray(layout.Types[idx]));
+              controller->Receive(buffer.GetPointer(), peer, ATTRIBUTES_TAG);
+              for (size_t cc = 0; cc < receive.size(); ++cc)
+              {
+                output->SetTuple(receive[cc], static_cast<vtkIdType>(cc), buffer.GetPointer());
+              }
+            }
+          }
+        }
+      });
+      outDSA->AddArray(output);
+    }
+
+    for (int cc = 0; cc < vtkDataSetAttributes::NUM_ATTRIBUTES; ++cc)
+    {
+      if (layout.Attributes[cc] >= 0)
+      {
+        outDSA->SetActiveAttribute(layout.Attributes[cc], cc);
+      }
+    }
+  }
+
+  // Adds the source process/id arrays to a shallow copy of the input.
+  static vtkSmartPointer<vtkDataSet> TagInput(vtkDataSet* input, int rank)
+  {
+    vtkSmartPointer<vtkDataSet> tagged;
+    tagged.TakeReference(input->NewInstance());
+    tagged->ShallowCopy(input);
+    TagAttributes(tagged->GetPointData(), input->GetNumberOfPoints(), rank);
+    TagAttributes(tagged->GetCellData(), input->GetNumberOfCells(), rank);
+    return tagged;
+  }
+
+  static void TagAttributes(vtkDataSetAttributes* dsa, vtkIdType count, int rank)
+  {
+    vtkNew<vtkIntArray> procs;
+    procs->SetName(SourceProcessArrayName());
+    procs->SetNumberOfTuples(count);
+    procs->FillComponent(0, rank);
+    vtkNew<vtkIdTypeArray> ids;
+    ids->SetName(SourceIdArrayName());
+    ids->SetNumberOfTuples(count);
+    for (vtkIdType cc = 0; cc < count; ++cc)
+    {
+      ids->SetValue(cc, cc);
+    }
+    dsa->AddArray(procs.GetPointer());
+    dsa->AddArray(ids.GetPointer());
+  }
+
+  vtkMTimeType GetCutsMTime(vtkPKdTree* tree) const
+  {
+    vtkBSPCuts* cuts = tree ? tree->GetCuts() : nullptr;
+    return cuts ? std::max(tree->GetMTime(), cuts->GetMTime()) : 0;
+  }
+
+  // Remembers the routes taken by the input during a full redistribution.
+  // Collective.
+  void Record(vtkDataSet* input, vtkDataSet* output, vtkPKdTree* tree, int boundaryMode,
+    vtkMultiProcessController* controller)
+  {
+    bool valid = BuildRoutes(output->GetPointData(), output->GetNumberOfPoints(),
+      input->GetNumberOfPoints(), controller, this->PointRoutes);
+    valid = BuildRoutes(output->GetCellData(), output->GetNumberOfCells(),
+              input->GetNumberOfCells(), controller, this->CellRoutes) &&
+      valid;
+
+    this->Valid = valid;
+    this->BoundaryMode = boundaryMode;
+    this->KdTree = tree;
+    this->CutsMTime = this->GetCutsMTime(tree);
+    this->InputStructure = CopyStructure(input);
+    this->OutputStructure = CopyStructure(output);
+  }
+
+  void Reset()
+  {
+    this->Valid = false;
+    this->InputStructure = nullptr;
+    this->OutputStructure = nullptr;
+    this->PointRoutes = vtkRoutes();
+    this->CellRoutes = vtkRoutes();
+  }
+
+  // Returns true, on all processes, if the cached routes can be used for the
+  // input. On success the point and cell layouts are filled in. Collective.
+  bool CanReuse(vtkDataSet* input, vtkPKdTree* tree, int boundaryMode,
+    vtkMultiProcessController* controller, vtkLayout& pointLayout, vtkLayout& cellLayout)
+  {
+    const int numProcs = controller->GetNumberOfProcesses();
+    const int rank = controller->GetLocalProcessId();
+
+    const bool sameRoutes = this->Valid && this->BoundaryMode == boundaryMode &&
+      this->KdTree.GetPointer() == tree && this->CutsMTime == this->GetCutsMTime(tree) &&
+      static_cast<int>(this->PointRoutes.Send.size()) == numProcs;
+    int reusable = sameRoutes && SameStructure(input, this->InputStructure) ? 1 : 0;
+
+    vtkMultiProcessStream localLayout;
+    reusable = SerializeLayout(input->GetPointData(), localLayout) && reusable;
+    reusable = SerializeLayout(input->GetCellData(), localLayout) && reusable;
+
+    // all processes with data must agree on the arrays being exchanged; the
+    // lowest such process provides the layout for everyone else.
+    const int hasData = input->GetNumberOfPoints() > 0 ? 1 : 0;
+    int localSource = hasData ? rank : numProcs;
+    int source = numProcs;
+    controller->AllReduce(&localSource, &source, 1, vtkCommunicator::MIN_OP);
+    if (source == numProcs)
+    {
+      return false;
+    }
+
+    vtkMultiProcessStream layout;
+    if (rank == source)
+    {
+      layout = localLayout;
+    }
+    controller->Broadcast(layout, source);
+    if (hasData)
+    {
+      std::vector<unsigned char> localRaw, raw;
+      localLayout.GetRawData(localRaw);
+      layout.GetRawData(raw);
+      reusable = (localRaw == raw) && reusable;
+    }
+
+    int allReusable = 0;
+    controller->AllReduce(&reusable, &allReusable, 1, vtkCommunicator::MIN_OP);
+    if (!allReusable)
+    {
+      return false;
+    }
+
+    DeserializeLayout(layout, pointLayout);
+    DeserializeLayout(layout, cellLayout);
+    return true;
+  }
+
+  // Produces the output from the cached structure and the input's attributes.
+  // Collective.
+  void Reuse(vtkDataSet* input, vtkDataSet* output, const vtkLayout& pointLayout,
+    const vtkLayout& cellLayout, vtkMultiProcessController* controller)
+  {
+    output->CopyStructure(this->OutputStructure);
+    output->GetFieldData()->ShallowCopy(input->GetFieldData());
+    TransferAttributes(input->GetPointData(), output->GetPointData(),
+      output->GetNumberOfPoints(), pointLayout, this->PointRoutes, controller);
+    TransferAttributes(input->GetCellData(), output->GetCellData(), output->GetNumberOfCells(),
+      cellLayout, this->CellRoutes, controller);
+  }
+};
+
 //-----------------------------------------------------------------------------
 
 vtkStandardNewMacro(vtkOrderedCompositeDistributor);
@@ -68,6 +553,9 @@ vtkOrderedCompositeDistributor::vtkOrderedCompositeDistributor()
   this->Controller = NULL;
   this->PassThrough = false;
   this->OutputType = NULL;
+  this->ReuseTopology = false;
+  this->LastExecutionReusedTopology = false;
+  this->Internals = new vtkInternals();
   this->SetController(vtkMultiProcessController::GetGlobalController());
 }
 
@@ -77,6 +565,7 @@ vtkOrderedCompositeDistributor::~vtkOrderedCompositeDistributor()
   this->SetPKdTree(NULL);
   this->SetController(NULL);
   this->SetOutputType(NULL);
+  delete this->Internals;
 }
 
 //-----------------------------------------------------------------------------
@@ -88,6 +577,8 @@ void vtkOrderedCompositeDistributor::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Controller: " << this->Controller << endl;
   os << indent << "PassThrough: " << this->PassThrough << endl;
   os << indent << "OutputType: " << (this->OutputType ? this->OutputType : "(none)") << endl;
+  os << indent << "ReuseTopology: " << this->ReuseTopology << endl;
+  os << indent << "LastExecutionReusedTopology: " << this->LastExecutionReusedTopology << endl;
 }
 
 //-----------------------------------------------------------------------------
@@ -152,6 +643,8 @@ int vtkOrderedCompositeDistributor::RequestData(vtkInformation* vtkNotUsed(reque
   vtkDataSet* input = vtkDataSet::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
   vtkDataSet* output = vtkDataSet::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
+  this->LastExecutionReusedTopology = false;
+
   if (!output || !input)
   {
     // Ignore request.
@@ -193,6 +686,24 @@ int vtkOrderedCompositeDistributor::RequestData(vtkInformation* vtkNotUsed(reque
     return 1;
   }
 
+  // Split cells have no single source, so there are no routes to remember.
+  const bool cacheRoutes = this->ReuseTopology && this->BoundaryMode != SPLIT_BOUNDARY_CELLS;
+  if (!cacheRoutes)
+  {
+    this->Internals->Reset();
+  }
+  else
+  {
+    vtkInternals::vtkLayout pointLayout, cellLayout;
+    if (this->Internals->CanReuse(
+          input, this->PKdTree, this->BoundaryMode, this->Controller, pointLayout, cellLayout))
+    {
+      this->Internals->Reuse(input, output, pointLayout, cellLayout, this->Controller);
+      this->LastExecutionReusedTopology = true;
+      return 1;
+    }
+  }
+
   this->UpdateProgress(0.01);
 
   vtkNew<vtkDistributedDataFilter> d3;
@@ -214,7 +725,14 @@ int vtkOrderedCompositeDistributor::RequestData(vtkInformation* vtkNotUsed(reque
       d3->SetBoundaryModeToAssignToAllIntersectingRegions();
       break;
   }
-  d3->SetInputData(input);
+  vtkSmartPointer<vtkDataSet> d3Input = input;
+  if (cacheRoutes)
+  {
+    // tag each point and cell with where it came from so that routes can be
+    // recovered from the redistributed output.
+    d3Input = vtkInternals::TagInput(input, this->Controller->GetLocalProcessId());
+  }
+  d3->SetInputData(d3Input);
   d3->SetCuts(cuts);
 
   // We need to pass the region assignments from PKdTree to D3
@@ -248,6 +766,11 @@ int vtkOrderedCompositeDistributor::RequestData(vtkInformation* vtkNotUsed(reque
       return 0;
     }
   }
+
+  if (cacheRoutes)
+  {
+    this->Internals->Record(input, output, this->PKdTree, this->BoundaryMode, this->Controller);
+  }
 #endif
 
   return 1;
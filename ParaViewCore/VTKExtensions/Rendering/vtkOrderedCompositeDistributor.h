@@ -36,6 +36,12 @@
  * This class also has an optional pass through mode to make it easy to
  * turn ordered compositing on and off.
  *
+ * When ReuseTopology is on, the distributor remembers where each point and
+ * cell went during the last redistribution. If the next input has identical
+ * geometry and topology (typical of time series where only the fields change)
+ * and the partitioning has not changed, only the point and cell attribute
+ * arrays are exchanged along the remembered routes.
+ *
 */
 
 #ifndef vtkOrderedCompositeDistributor_h
@@ -113,6 +119,25 @@ public:
   vtkGetMacro(BoundaryMode, int);
   //@}
 
+  //@{
+  /**
+   * When on, the routes taken by points and cells during a redistribution are
+   * cached so that subsequent inputs with the same geometry and topology,
+   * distributed with the same kd-tree cuts, only exchange their attribute
+   * arrays. Routes are not cached in SPLIT_BOUNDARY_CELLS mode since split
+   * cells have no single source. Default is off.
+   */
+  vtkSetMacro(ReuseTopology, bool);
+  vtkGetMacro(ReuseTopology, bool);
+  vtkBooleanMacro(ReuseTopology, bool);
+  //@}
+
+  /**
+   * Returns true if the last execution reused cached routes and only exchanged
+   * attribute arrays.
+   */
+  vtkGetMacro(LastExecutionReusedTopology, bool);
+
 protected:
   vtkOrderedCompositeDistributor();
   ~vtkOrderedCompositeDistributor() override;
@@ -122,6 +147,8 @@ protected:
   bool PassThrough;
   vtkPKdTree* PKdTree;
   vtkMultiProcessController* Controller;
+  bool ReuseTopology;
+  bool LastExecutionReusedTopology;
 
   int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
   int RequestDataObject(
@@ -129,6 +156,9 @@ protected:
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
 
 private:
+  class vtkInternals;
+  vtkInternals* Internals;
+
   vtkOrderedCompositeDistributor(const vtkOrderedCompositeDistributor&) = delete;
   void operator=(const vtkOrderedCompositeDistributor&) = delete;
 };
@@ -0,0 +1,262 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestOrderedCompositeDistributorReuse.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Tests that vtkOrderedCompositeDistributor only exchanges the attribute
+// arrays when the geometry and topology of its input don't change, and that
+// the arrays end up on the right points and cells.
+// This test requires at least 2 MPI processes.
+
+#include "vtkCellData.h"
+#include "vtkCommunicator.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkKdTreeManager.h"
+#include "vtkMPIController.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkOrderedCompositeDistributor.h"
+#include "vtkPKdTree.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkProcess.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+
+#include <cmath>
+
+namespace
+{
+double Field(const double x[3], double scale)
+{
+  return scale * (x[0] + 2.0 * x[1] + 3.0 * x[2]);
+}
+
+void GetCellCenter(vtkPolyData* data, vtkIdType cellId, double center[3])
+{
+  vtkNew<vtkIdList> ptIds;
+  data->GetCellPoints(cellId, ptIds.GetPointer());
+  center[0] = center[1] = center[2] = 0.0;
+  for (vtkIdType cc = 0; cc < ptIds->GetNumberOfIds(); ++cc)
+  {
+    double x[3];
+    data->GetPoint(ptIds->GetId(cc), x);
+    vtkMath::Add(center, x, center);
+  }
+  if (ptIds->GetNumberOfIds() > 0)
+  {
+    vtkMath::MultiplyScalar(center, 1.0 / ptIds->GetNumberOfIds());
+  }
+}
+
+// Returns a piece of a sphere with point and cell arrays that are functions of
+// the position, multiplied by `scale`.
+vtkSmartPointer<vtkPolyData> MakePiece(int piece, int numPieces, int resolution, double scale)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->UpdatePiece(piece, numPieces, 0);
+
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  data->ShallowCopy(sphere->GetOutput());
+
+  vtkNew<vtkDoubleArray> pointValues;
+  pointValues->SetName("PointValues");
+  pointValues->SetNumberOfTuples(data->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < data->GetNumberOfPoints(); ++cc)
+  {
+    double x[3];
+    data->GetPoint(cc, x);
+    pointValues->SetValue(cc, Field(x, scale));
+  }
+  data->GetPointData()->AddArray(pointValues.GetPointer());
+
+  vtkNew<vtkDoubleArray> cellValues;
+  cellValues->SetName("CellValues");
+  cellValues->SetNumberOfTuples(data->GetNumberOfCells());
+  for (vtkIdType cc = 0; cc < data->GetNumberOfCells(); ++cc)
+  {
+    double center[3];
+    GetCellCenter(data, cc, center);
+    cellValues->SetValue(cc, Field(center, scale));
+  }
+  data->GetCellData()->AddArray(cellValues.GetPointer());
+  return data;
+}
+
+// Checks that the arrays of the redistributed data match the positions.
+bool CheckValues(vtkPolyData* data, double scale)
+{
+  vtkDataArray* pointValues = data->GetPointData()->GetArray("PointValues");
+  vtkDataArray* cellValues = data->GetCellData()->GetArray("CellValues");
+  if (data->GetNumberOfPoints() > 0 && pointValues == nullptr)
+  {
+    cerr << "Missing point array." << endl;
+    return false;
+  }
+  if (data->GetNumberOfCells() > 0 && cellValues == nullptr)
+  {
+    cerr << "Missing cell array." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < data->GetNumberOfPoints(); ++cc)
+  {
+    double x[3];
+    data->GetPoint(cc, x);
+    if (std::abs(pointValues->GetTuple1(cc) - Field(x, scale)) > 1e-5)
+    {
+      cerr << "Wrong value for point " << cc << endl;
+      return false;
+    }
+  }
+  for (vtkIdType cc = 0; cc < data->GetNumberOfCells(); ++cc)
+  {
+    double center[3];
+    GetCellCenter(data, cc, center);
+    if (std::abs(cellValues->GetTuple1(cc) - Field(center, scale)) > 1e-5)
+    {
+      cerr << "Wrong value for cell " << cc << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+class TestOrderedCompositeDistributorReuseProcess : public vtkProcess
+{
+public:
+  static TestOrderedCompositeDistributorReuseProcess* New();
+  vtkTypeMacro(TestOrderedCompositeDistributorReuseProcess, vtkProcess);
+
+  void Execute() override;
+
+  bool Step(vtkOrderedCompositeDistributor* distributor, vtkPolyData* input, double scale,
+    bool expectReuse, const char* label);
+};
+
+vtkStandardNewMacro(TestOrderedCompositeDistributorReuseProcess);
+
+//----------------------------------------------------------------------------
+bool TestOrderedCompositeDistributorReuseProcess::Step(vtkOrderedCompositeDistributor* distributor,
+  vtkPolyData* input, double scale, bool expectReuse, const char* label)
+{
+  distributor->SetInputData(input);
+  distributor->Update();
+
+  vtkPolyData* output = vtkPolyData::SafeDownCast(distributor->GetOutputDataObject(0));
+  int ok = output != nullptr && CheckValues(output, scale) ? 1 : 0;
+  if (distributor->GetLastExecutionReusedTopology() != expectReuse)
+  {
+    cerr << label << ": expected the topology " << (expectReuse ? "to" : "not to")
+         << " be reused." << endl;
+    ok = 0;
+  }
+
+  // the total number of cells must be the same as in the input.
+  vtkIdType counts[2] = { input->GetNumberOfCells(), output ? output->GetNumberOfCells() : 0 };
+  vtkIdType totals[2] = { 0, 0 };
+  this->Controller->AllReduce(counts, totals, 2, vtkCommunicator::SUM_OP);
+  if (totals[0] != totals[1])
+  {
+    cerr << label << ": " << totals[1] << " cells after redistribution instead of " << totals[0]
+         << endl;
+    ok = 0;
+  }
+
+  int allOk = 0;
+  this->Controller->AllReduce(&ok, &allOk, 1, vtkCommunicator::MIN_OP);
+  if (!allOk && this->Controller->GetLocalProcessId() == 0)
+  {
+    cerr << label << " failed." << endl;
+  }
+  return allOk == 1;
+}
+
+//----------------------------------------------------------------------------
+void TestOrderedCompositeDistributorReuseProcess::Execute()
+{
+  const int me = this->Controller->GetLocalProcessId();
+  const int numProcs = this->Controller->GetNumberOfProcesses();
+
+  vtkSmartPointer<vtkPolyData> first = MakePiece(me, numProcs, 32, 1.0);
+
+  vtkNew<vtkKdTreeManager> kdTreeManager;
+  kdTreeManager->AddDataObject(first);
+  kdTreeManager->GenerateKdTree();
+
+  vtkNew<vtkOrderedCompositeDistributor> distributor;
+  distributor->SetController(this->Controller);
+  distributor->SetPKdTree(kdTreeManager->GetKdTree());
+  distributor->SetBoundaryMode(vtkOrderedCompositeDistributor::ASSIGN_TO_ONE_REGION);
+  distributor->SetReuseTopology(true);
+
+  bool success = true;
+
+  // the first redistribution records the routes.
+  success = this->Step(distributor.GetPointer(), first, 1.0, false, "First step") && success;
+
+  // same geometry, new values: only the arrays are exchanged.
+  success = this->Step(distributor.GetPointer(), MakePiece(me, numProcs, 32, 2.0), 2.0, true,
+              "Same topology") &&
+    success;
+
+  // different topology: full redistribution.
+  success = this->Step(distributor.GetPointer(), MakePiece(me, numProcs, 24, 3.0), 3.0, false,
+              "New topology") &&
+    success;
+
+  // changing the cuts invalidates the routes.
+  kdTreeManager->RemoveAllDataObjects();
+  kdTreeManager->AddDataObject(MakePiece(me, numProcs, 48, 1.0));
+  kdTreeManager->GenerateKdTree();
+  success = this->Step(distributor.GetPointer(), MakePiece(me, numProcs, 24, 4.0), 4.0, false,
+              "New cuts") &&
+    success;
+
+  this->ReturnValue = success ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  vtkMPIController* contr = vtkMPIController::New();
+  contr->Initialize(&argc, &argv);
+  vtkMultiProcessController::SetGlobalController(contr);
+
+  int retVal = 0;
+  if (contr->GetNumberOfProcesses() < 2)
+  {
+    if (contr->GetLocalProcessId() == 0)
+    {
+      cout << "TestOrderedCompositeDistributorReuse requires more than 1 process" << endl;
+    }
+  }
+  else
+  {
+    TestOrderedCompositeDistributorReuseProcess* p =
+      TestOrderedCompositeDistributorReuseProcess::New();
+    contr->SetSingleProcessObject(p);
+    contr->SingleMethodExecute();
+    retVal = p->GetReturnValue();
+    p->Delete();
+  }
+
+  contr->Finalize();
+  contr->Delete();
+  return !retVal;
+}
@@ -850,6 +850,10 @@ void pqFileDialog::onFilterChange(const QString& filter)
 {
   auto& impl = *this->Implementation;
 
+  // the filter must see the whole directory, not only the pages fetched so
+  // far.
+  impl.Model->fetchAll();
+
   // set filter on proxy
   impl.FileFilter.setFilter(filter);
 
@@ -948,6 +952,10 @@ void pqFileDialog::onTextEdited(const QString& str)
   impl.Ui.Files->clearSelection();
   if (str.size() > 0)
   {
+    // complete against the whole directory, not only the pages fetched so
+    // far.
+    impl.Model->fetchAll();
+
     // convert the typed information to be impl.FileNames
     impl.FileNames = str.split(impl.FileNamesSeperator, QString::SkipEmptyParts);
   }
@@ -250,15 +250,6 @@ Q_GLOBAL_STATIC(pqFileDialogModelIconProvider, Icons);
 namespace
 {
 
-///////////////////////////////////////////////////////////////////////
-// CaseInsensitiveSort
-
-bool CaseInsensitiveSort(const pqFileDialogModelFileInfo& A, const pqFileDialogModelFileInfo& B)
-{
-  // Sort alphabetically (but case-insensitively)
-  return A.label().toLower() < B.label().toLower();
-}
-
 class CaseInsensitiveSortGroup
   : public std::binary_function<pqFileDialogModelFileInfo, pqFileDialogModelFileInfo, bool>
 {
@@ -313,7 +304,10 @@ class pqFileDialogModel::pqImplementation
 {
 public:
   pqImplementation(pqServer* server)
-    : Separator(0)
+    : ListingOffset(0)
+    , ListingTotal(0)
+    , ListingGeneration(0)
+    , Separator(0)
     , Server(server)
   {
 
@@ -361,14 +355,16 @@ public:
   }
 
   /// query the file system for information
-  vtkPVFileInformation* GetData(bool dirListing, const QString& path, bool specialDirs)
+  vtkPVFileInformation* GetData(
+    bool dirListing, const QString& path, bool specialDirs, int listingOffset = 0)
   {
-    return this->GetData(dirListing, this->CurrentPath, path, specialDirs);
+    return this->GetData(dirListing, this->CurrentPath, path, specialDirs, listingOffset);
   }
 
-  /// query the file system for information
-  vtkPVFileInformation* GetData(
-    bool dirListing, const QString& workingDir, const QString& path, bool specialDirs)
+  /// query the file system for information. Directory listings are requested
+  /// in pages of ListingPageSize entries starting at `listingOffset`.
+  vtkPVFileInformation* GetData(bool dirListing, const QString& workingDir, const QString& path,
+    bool specialDirs, int listingOffset = 0)
   {
     if (this->FileInformationHelperProxy)
     {
@@ -378,6 +374,9 @@ public:
       pqSMAdaptor::setElementProperty(helper->GetProperty("DirectoryListing"), dirListing);
       pqSMAdaptor::setElementProperty(helper->GetProperty("Path"), path.toUtf8());
       pqSMAdaptor::setElementProperty(helper->GetProperty("SpecialDirectories"), specialDirs);
+      pqSMAdaptor::setElementProperty(helper->GetProperty("ListingOffset"), listingOffset);
+      pqSMAdaptor::setElementProperty(
+        helper->GetProperty("ListingPageSize"), pqImplementation::ListingPageSize);
       helper->UpdateVTKObjects();
 
       // get data from server
@@ -391,6 +390,8 @@ public:
       helper->SetPath(path.toUtf8().data());
       helper->SetSpecialDirectories(specialDirs);
       helper->SetWorkingDirectory(workingDir.toUtf8().data());
+      helper->SetListingOffset(listingOffset);
+      helper->SetListingPageSize(pqImplementation::ListingPageSize);
       this->FileInformation->CopyFromObject(helper);
     }
     return this->FileInformation;
@@ -401,9 +402,52 @@ public:
   {
     this->CurrentPath = path;
     this->FileList.clear();
+    // Indices for the files in groups point into FileList, so make sure
+    // appending the remaining pages later doesn't reallocate it. The total
+    // number of contents is an upper bound for the listing.
+    this->FileList.reserve(dir->GetTotalNumberOfContents());
+    this->ListingOffset = 0;
+    this->ListingGeneration = dir->GetListingGeneration();
+    this->Append(dir);
+  }
+
+  /// number of entries of the current directory listing fetched so far and
+  /// in total.
+  int ListingOffset;
+  int ListingTotal;
 
-    QList<pqFileDialogModelFileInfo> dirs;
-    QList<pqFileDialogModelFileInfo> files;
+  /// generation of the current directory listing. The pages of a listing only
+  /// line up while it doesn't change.
+  vtkTypeInt64 ListingGeneration;
+
+  /// the next page of the current directory listing converted to entries of
+  /// the model, without adding them to the model.
+  QList<pqFileDialogModelFileInfo> FetchNextPage(vtkPVFileInformation*& dir)
+  {
+    dir = this->GetData(true, this->CurrentPath, false, this->ListingOffset);
+    return this->ToFileInfos(dir);
+  }
+
+  /// adds a page of the directory listing to our model.
+  void Append(vtkPVFileInformation* dir) { this->Append(dir, this->ToFileInfos(dir)); }
+  void Append(vtkPVFileInformation* dir, const QList<pqFileDialogModelFileInfo>& infos)
+  {
+    for (int i = 0; i != infos.size(); ++i)
+    {
+      this->FileList.push_back(infos[i]);
+    }
+    this->ListingOffset += dir->GetContents()->GetNumberOfItems();
+    this->ListingTotal = dir->GetContents()->GetNumberOfItems() > 0
+      ? dir->GetTotalNumberOfContents()
+      : this->ListingOffset;
+  }
+
+  /// converts the contents of the queried information to entries of the model.
+  /// The server lists directories first, then files, case-insensitively, so
+  /// the entries are kept in the order they are listed.
+  QList<pqFileDialogModelFileInfo> ToFileInfos(vtkPVFileInformation* dir)
+  {
+    QList<pqFileDialogModelFileInfo> infos;
 
     vtkSmartPointer<vtkCollectionIterator> iter;
     iter.TakeReference(dir->GetContents()->NewIterator());
@@ -417,7 +461,7 @@ public:
       }
       if (vtkPVFileInformation::IsDirectory(info->GetType()))
       {
-        dirs.push_back(pqFileDialogModelFileInfo(QString::fromUtf8(info->GetName()),
+        infos.push_back(pqFileDialogModelFileInfo(QString::fromUtf8(info->GetName()),
           QString::fromUtf8(info->GetFullPath()),
           static_cast<vtkPVFileInformation::FileTypes>(info->GetType()), info->GetHidden(),
           info->GetExtension(), info->GetSize(), info->GetModificationTime()));
@@ -425,7 +469,7 @@ public:
       else if (info->GetType() != vtkPVFileInformation::FILE_GROUP &&
         info->GetType() != vtkPVFileInformation::DIRECTORY_GROUP)
       {
-        files.push_back(pqFileDialogModelFileInfo(QString::fromUtf8(info->GetName()),
+        infos.push_back(pqFileDialogModelFileInfo(QString::fromUtf8(info->GetName()),
           QString::fromUtf8(info->GetFullPath()),
           static_cast<vtkPVFileInformation::FileTypes>(info->GetType()), info->GetHidden(),
           info->GetExtension(), info->GetSize(), info->GetModificationTime()));
@@ -448,8 +492,7 @@ public:
         }
 
         const bool as_files = (info->GetType() == vtkPVFileInformation::FILE_GROUP);
-        auto& container = as_files ? files : dirs;
-        container.push_back(pqFileDialogModelFileInfo(/*QString::fromUtf8*/ (info->GetName()),
+        infos.push_back(pqFileDialogModelFileInfo(/*QString::fromUtf8*/ (info->GetName()),
           groupFiles[0].filePath(),
           (as_files ? vtkPVFileInformation::SINGLE_FILE : vtkPVFileInformation::DIRECTORY),
           info->GetHidden(), info->GetExtension(), info->GetSize(), info->GetModificationTime(),
@@ -457,17 +500,7 @@ public:
       }
     }
 
-    qSort(dirs.begin(), dirs.end(), CaseInsensitiveSort);
-    qSort(files.begin(), files.end(), CaseInsensitiveSort);
-
-    for (int i = 0; i != dirs.size(); ++i)
-    {
-      this->FileList.push_back(dirs[i]);
-    }
-    for (int i = 0; i != files.size(); ++i)
-    {
-      this->FileList.push_back(files[i]);
-    }
+    return infos;
   }
 
   QStringList getFilePaths(const QModelIndex& index)
@@ -581,6 +614,10 @@ public:
   }
 
 private:
+  /// Number of entries of directory listings requested at once. The
+  /// remaining entries are fetched as the view needs them.
+  static const int ListingPageSize = 1000;
+
   // server vs. local implementation private
   pqServer* Server;
 
@@ -628,6 +665,51 @@ void pqFileDialogModel::setCurrentPath(const QString& path)
   this->endResetModel();
 }
 
+bool pqFileDialogModel::canFetchMore(const QModelIndex& idx) const
+{
+  return !idx.isValid() &&
+    this->Implementation->ListingOffset < this->Implementation->ListingTotal;
+}
+
+void pqFileDialogModel::fetchMore(const QModelIndex& idx)
+{
+  if (!this->canFetchMore(idx))
+  {
+    return;
+  }
+
+  vtkPVFileInformation* info = NULL;
+  const QList<pqFileDialogModelFileInfo> infos = this->Implementation->FetchNextPage(info);
+  const int first = this->Implementation->FileList.size();
+  if (info->GetListingGeneration() != this->Implementation->ListingGeneration ||
+    first + infos.size() > this->Implementation->FileList.capacity())
+  {
+    // the directory changed since the listing started, list it again. The
+    // generation has the resolution of the file system time stamps, so a
+    // page that doesn't fit what was reserved for the listing, which would
+    // invalidate the indices of grouped files, is also taken as a change.
+    this->setCurrentPath(this->getCurrentPath());
+    return;
+  }
+  if (!infos.isEmpty())
+  {
+    this->beginInsertRows(QModelIndex(), first, first + infos.size() - 1);
+  }
+  this->Implementation->Append(info, infos);
+  if (!infos.isEmpty())
+  {
+    this->endInsertRows();
+  }
+}
+
+void pqFileDialogModel::fetchAll()
+{
+  while (this->canFetchMore(QModelIndex()))
+  {
+    this->fetchMore(QModelIndex());
+  }
+}
+
 QString pqFileDialogModel::getCurrentPath()
 {
   return this->Implementation->CurrentPath;
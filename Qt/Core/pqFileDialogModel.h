@@ -179,6 +179,18 @@ public:
   * returns flags for item
   */
   Qt::ItemFlags flags(const QModelIndex& idx) const override;
+  /**
+  * Large directory listings are requested in pages. These fetch the remaining
+  * pages of the current directory as the view needs them.
+  */
+  bool canFetchMore(const QModelIndex& idx) const override;
+  void fetchMore(const QModelIndex& idx) override;
+
+  /**
+  * Fetches all the remaining pages of the current directory, for operations
+  * that need the complete listing such as filtering and completion.
+  */
+  void fetchAll();
 
 private:
   class pqImplementation;
@@ -360,6 +360,11 @@ QVariant pqSpreadSheetViewModel::data(const QModelIndex& idx, int role /*=Qt::Di
   }
 
   vtkVariant value = view->GetValue(row, column);
+  if (!value.IsValid())
+  {
+    // values of columns that were not delivered.
+    return QVariant("");
+  }
   bool is_selected = view->IsRowSelected(row);
   if (is_selected)
   {
@@ -656,5 +661,13 @@ void pqSpreadSheetViewModel::hiddenColumnsChanged()
   if (numCols > 0)
   {
     emit this->headerDataChanged(Qt::Horizontal, 0, this->columnCount() - 1);
+
+    // columns that are shown again may not have been delivered for the
+    // cached blocks.
+    const int numRows = this->rowCount();
+    if (numRows > 0)
+    {
+      emit this->dataChanged(this->index(0, 0), this->index(numRows - 1, numCols - 1));
+    }
   }
 }
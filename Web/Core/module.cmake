@@ -5,6 +5,8 @@ vtk_module(vtkParaViewWebCore
     vtkWebCore
     vtkWebGLExporter
     vtkPVServerManagerDefault
+  PRIVATE_DEPENDS
+    vtkImagingCore
   TEST_DEPENDS
     vtkImagingSources
   TEST_LABELS
@@ -19,6 +19,7 @@
 #include "vtkCommand.h"
 #include "vtkDataEncoder.h"
 #include "vtkImageData.h"
+#include "vtkImageShrink3D.h"
 #include "vtkJPEGWriter.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
@@ -39,6 +40,7 @@
 #include "vtkWebGLObject.h"
 #include "vtkWebInteractionEvent.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <cmath>
 #include <map>
@@ -46,17 +48,75 @@
 class vtkPVWebApplication::vtkInternals
 {
 public:
+  struct FrameStatisticsType
+  {
+    int NumberOfRenderedFrames;
+    int NumberOfSkippedFrames;
+    int NumberOfEncodedFrames;
+    double LastRenderTime;
+    double TotalRenderTime;
+    double TotalEncodeLatency;
+    // time at which the first and last frames since the last reset were
+    // rendered, used to measure the frame rate.
+    double FirstFrameTime;
+    double LastFrameTime;
+    FrameStatisticsType() { this->Reset(); }
+    void Reset()
+    {
+      this->NumberOfRenderedFrames = 0;
+      this->NumberOfSkippedFrames = 0;
+      this->NumberOfEncodedFrames = 0;
+      this->LastRenderTime = 0.0;
+      this->TotalRenderTime = 0.0;
+      this->TotalEncodeLatency = 0.0;
+      this->FirstFrameTime = 0.0;
+      this->LastFrameTime = 0.0;
+    }
+    void AddRenderTime(double elapsed)
+    {
+      this->NumberOfRenderedFrames++;
+      this->LastRenderTime = elapsed;
+      this->TotalRenderTime += elapsed;
+      this->LastFrameTime = vtkTimerLog::GetUniversalTime();
+      if (this->NumberOfRenderedFrames == 1)
+      {
+        this->FirstFrameTime = this->LastFrameTime;
+      }
+    }
+    double GetFrameRate() const
+    {
+      const double elapsed = this->LastFrameTime - this->FirstFrameTime;
+      return elapsed > 0.0 ? (this->NumberOfRenderedFrames - 1) / elapsed : 0.0;
+    }
+  };
+
   struct ImageCacheValueType
   {
   public:
     vtkSmartPointer<vtkUnsignedCharArray> Data;
     bool NeedsRender;
     bool HasImagesBeingProcessed;
+    // true when Data was produced by InteractiveRender(), in which case the
+    // next StillRender() cannot reuse it.
+    bool IsInteractiveImage;
+    // true when InteractiveRender() turned UseInteractiveRenderingForScreenshots
+    // on, StillRender() turns it back off.
+    bool ResetInteractiveRendering;
+    // encoding used for Data, -1 if none.
+    int Encoding;
+    // time at which the most recent image was pushed to the encoder, 0 once
+    // its output has been obtained.
+    double PushTime;
+    FrameStatisticsType Statistics;
     vtkObject* ViewPointer;
     unsigned long ObserverId;
     ImageCacheValueType()
       : NeedsRender(true)
       , HasImagesBeingProcessed(false)
+      , IsInteractiveImage(false)
+      , ResetInteractiveRendering(false)
+      , Encoding(-1)
+      , PushTime(0.0)
       , ViewPointer(NULL)
       , ObserverId(0)
     {
@@ -97,11 +157,55 @@ public:
   typedef std::map<void*, ImageCacheValueType> ImageCacheType;
   ImageCacheType ImageCache;
 
+  // Statistics of the view, without adding it to the cache when it isn't
+  // there yet.
+  const FrameStatisticsType& GetStatistics(vtkSMViewProxy* view) const
+  {
+    static const FrameStatisticsType empty;
+    ImageCacheType::const_iterator iter = this->ImageCache.find(view);
+    return iter != this->ImageCache.end() ? iter->second.Statistics : empty;
+  }
+
   typedef std::map<void*, unsigned int> ButtonStatesType;
   ButtonStatesType ButtonStates;
 
+  // The encoder keeps a separate slot for each view (keyed by its global id)
+  // and only ever hands out the most recent output for a view, dropping
+  // older frames that are still queued.
   vtkNew<vtkDataEncoder> Encoder;
 
+  // Updates the cached value with the most recent output from the encoder.
+  void UpdateLatestOutput(vtkSMViewProxy* view, ImageCacheValueType& value)
+  {
+    bool latest = this->Encoder->GetLatestOutput(view->GetGlobalID(), value.Data);
+    value.HasImagesBeingProcessed = !latest;
+    if (latest && value.PushTime > 0.0)
+    {
+      value.Statistics.NumberOfEncodedFrames++;
+      value.Statistics.TotalEncodeLatency += vtkTimerLog::GetUniversalTime() - value.PushTime;
+      value.PushTime = 0.0;
+    }
+  }
+
+  // Pushes the image to the encoder and updates the cached value with the
+  // most recent encoded output. Takes over the reference to `image`. When
+  // `wait` is true, this blocks until `image` has been encoded.
+  void Encode(vtkSMViewProxy* view, vtkImageData*& image, int quality, int encoding,
+    ImageCacheValueType& value, bool wait)
+  {
+    this->Encoder->PushAndTakeReference(view->GetGlobalID(), image, quality, encoding);
+    assert(image == NULL);
+    value.PushTime = vtkTimerLog::GetUniversalTime();
+    value.Encoding = encoding;
+
+    if (wait || value.Data == NULL)
+    {
+      // we need to wait till output is processed.
+      this->Encoder->Flush(view->GetGlobalID());
+    }
+    this->UpdateLatestOutput(view, value);
+  }
+
   // WebGL related struct
   struct WebGLObjCacheValue
   {
@@ -122,6 +226,7 @@ vtkStandardNewMacro(vtkPVWebApplication);
 vtkPVWebApplication::vtkPVWebApplication()
   : ImageEncoding(ENCODING_BASE64)
   , ImageCompression(COMPRESSION_JPEG)
+  , InteractiveImageReductionFactor(2)
   , Internals(new vtkPVWebApplication::vtkInternals())
 {
 }
@@ -136,15 +241,97 @@ vtkPVWebApplication::~vtkPVWebApplication()
 //----------------------------------------------------------------------------
 bool vtkPVWebApplication::GetHasImagesBeingProcessed(vtkSMViewProxy* view)
 {
-  const vtkInternals::ImageCacheValueType& value = this->Internals->ImageCache[view];
-  return value.HasImagesBeingProcessed;
+  vtkInternals::ImageCacheType::const_iterator iter = this->Internals->ImageCache.find(view);
+  return iter != this->Internals->ImageCache.end() && iter->second.HasImagesBeingProcessed;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVWebApplication::GetIsInteracting(vtkSMViewProxy* view)
+{
+  vtkInternals::ButtonStatesType::const_iterator iter = this->Internals->ButtonStates.find(view);
+  return iter != this->Internals->ButtonStates.end() && iter->second != 0;
 }
 
 //----------------------------------------------------------------------------
 vtkUnsignedCharArray* vtkPVWebApplication::InteractiveRender(vtkSMViewProxy* view, int quality)
 {
-  // for now, just do the same as StillRender().
-  return this->StillRender(view, quality);
+  return this->InteractiveRenderInternal(view, quality, this->ImageEncoding);
+}
+
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkPVWebApplication::InteractiveRenderInternal(
+  vtkSMViewProxy* view, int quality, int encoding)
+{
+  if (!view)
+  {
+    vtkErrorMacro("No view specified.");
+    return NULL;
+  }
+
+  vtkInternals::ImageCacheValueType& value = this->Internals->ImageCache[view];
+  value.SetListener(view);
+
+  if (value.Data != NULL && value.Encoding == encoding)
+  {
+    this->Internals->UpdateLatestOutput(view, value);
+    if (value.HasImagesBeingProcessed)
+    {
+      // The encoder hasn't caught up with the previous frame yet. Rendering
+      // another frame now would only add to the backlog of images that are
+      // stale by the time they get delivered, so skip this one. NeedsRender is
+      // left untouched so that the next call renders the current state.
+      value.Statistics.NumberOfSkippedFrames++;
+      return value.Data;
+    }
+    if (value.NeedsRender == false && view->GetNeedsUpdate() == false)
+    {
+      return value.Data;
+    }
+  }
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+
+  // Render using the view's interactive path (LOD, image reduction), if the
+  // view supports it. The property is left on for the whole interaction and
+  // only turned off by the next StillRender().
+  vtkSMProperty* interactiveProp = view->GetProperty("UseInteractiveRenderingForScreenshots");
+  if (interactiveProp && vtkSMPropertyHelper(interactiveProp).GetAsInt() == 0)
+  {
+    vtkSMPropertyHelper(interactiveProp).Set(1);
+    view->UpdateVTKObjects();
+    value.ResetInteractiveRendering = true;
+  }
+
+  vtkImageData* image = view->CaptureWindow(1);
+
+  if (!image)
+  {
+    vtkErrorMacro("Failed to capture image for view : " << view);
+    return value.Data;
+  }
+  image->GetDimensions(this->LastStillRenderImageSize);
+
+  // Sub-sample the image, this reduces both the encoding time and the size
+  // of the frame to deliver.
+  const int factor = this->InteractiveImageReductionFactor;
+  if (factor > 1 && this->LastStillRenderImageSize[0] >= factor &&
+    this->LastStillRenderImageSize[1] >= factor)
+  {
+    vtkNew<vtkImageShrink3D> shrinker;
+    shrinker->SetInputData(image);
+    shrinker->SetShrinkFactors(factor, factor, 1);
+    shrinker->AveragingOn();
+    shrinker->Update();
+    image->Delete();
+    image = vtkImageData::New();
+    image->ShallowCopy(shrinker->GetOutput());
+  }
+  value.Statistics.AddRenderTime(vtkTimerLog::GetUniversalTime() - startTime);
+
+  this->Internals->Encode(view, image, quality, encoding, value, value.Encoding != encoding);
+  value.NeedsRender = false;
+  value.IsInteractiveImage = true;
+  return value.Data;
 }
 
 //----------------------------------------------------------------------------
@@ -155,6 +342,13 @@ void vtkPVWebApplication::InvalidateCache(vtkSMViewProxy* view)
 
 //----------------------------------------------------------------------------
 vtkUnsignedCharArray* vtkPVWebApplication::StillRender(vtkSMViewProxy* view, int quality)
+{
+  return this->StillRenderInternal(view, quality, this->ImageEncoding);
+}
+
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkPVWebApplication::StillRenderInternal(
+  vtkSMViewProxy* view, int quality, int encoding)
 {
   if (!view)
   {
@@ -167,13 +361,13 @@ vtkUnsignedCharArray* vtkPVWebApplication::StillRender(vtkSMViewProxy* view, int
   vtkInternals::ImageCacheValueType& value = this->Internals->ImageCache[view];
   value.SetListener(view);
 
-  if (value.NeedsRender == false && value.Data != NULL && view->GetNeedsUpdate() == false)
+  if (value.NeedsRender == false && value.Data != NULL && view->GetNeedsUpdate() == false &&
+    value.IsInteractiveImage == false && value.Encoding == encoding)
   {
     // cout <<  "Reusing cache" << endl;
     if (doThread)
     {
-      bool latest = this->Internals->Encoder->GetLatestOutput(view->GetGlobalID(), value.Data);
-      value.HasImagesBeingProcessed = !latest;
+      this->Internals->UpdateLatestOutput(view, value);
     }
     else
     {
@@ -183,36 +377,26 @@ vtkUnsignedCharArray* vtkPVWebApplication::StillRender(vtkSMViewProxy* view, int
   }
 
   // cout <<  "Regenerating " << endl;
-  // vtkTimerLog::ResetLog();
-  // vtkTimerLog::CleanupLog();
-  // vtkTimerLog::MarkStartEvent("StillRenderToString");
-  // vtkTimerLog::MarkStartEvent("CaptureWindow");
+  if (value.ResetInteractiveRendering)
+  {
+    vtkSMPropertyHelper(view, "UseInteractiveRenderingForScreenshots").Set(0);
+    view->UpdateVTKObjects();
+    value.ResetInteractiveRendering = false;
+  }
+  double startTime = vtkTimerLog::GetUniversalTime();
 
   // TODO: We should add logic to check if a new rendering needs to be done and
   // then alone do a new rendering otherwise use the cached image.
   vtkImageData* image = view->CaptureWindow(1);
   image->GetDimensions(this->LastStillRenderImageSize);
-  // vtkTimerLog::MarkEndEvent("CaptureWindow");
+  value.Statistics.AddRenderTime(vtkTimerLog::GetUniversalTime() - startTime);
 
-  // vtkTimerLog::MarkEndEvent("StillRenderToString");
-  // vtkTimerLog::DumpLogWithIndents(&cout, 0.0);
-
-  if (doThread || this->ImageEncoding)
+  if (doThread || encoding)
   {
-    this->Internals->Encoder->PushAndTakeReference(
-      view->GetGlobalID(), image, quality, this->ImageEncoding);
-    assert(image == NULL);
-
-    if (value.Data == NULL)
-    {
-      // we need to wait till output is processed.
-      // cout << "Flushing" << endl;
-      this->Internals->Encoder->Flush(view->GetGlobalID());
-      // cout << "Done Flushing" << endl;
-    }
-
-    bool latest = this->Internals->Encoder->GetLatestOutput(view->GetGlobalID(), value.Data);
-    value.HasImagesBeingProcessed = !latest;
+    // if the cached image is an interactive one or uses a different encoding,
+    // make sure that it gets replaced by this image before we return.
+    bool wait = value.IsInteractiveImage || value.Encoding != encoding;
+    this->Internals->Encode(view, image, quality, encoding, value, wait);
   }
   else
   {
@@ -223,8 +407,10 @@ vtkUnsignedCharArray* vtkPVWebApplication::StillRender(vtkSMViewProxy* view, int
     writer->Write();
     // smart pointer does the right thing, even if Data was null
     value.Data = writer->GetResult();
+    value.Encoding = ENCODING_NONE;
   }
   value.NeedsRender = false;
+  value.IsInteractiveImage = false;
   return value.Data;
 }
 
@@ -255,6 +441,138 @@ vtkUnsignedCharArray* vtkPVWebApplication::StillRenderToBuffer(
   return NULL;
 }
 
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkPVWebApplication::StillRenderToBinary(
+  vtkSMViewProxy* view, unsigned long time, int quality)
+{
+  vtkUnsignedCharArray* array = this->StillRenderInternal(view, quality, ENCODING_NONE);
+  if (array && array->GetMTime() != time)
+  {
+    this->LastStillRenderToMTime = array->GetMTime();
+    return array;
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+const char* vtkPVWebApplication::InteractiveRenderToString(
+  vtkSMViewProxy* view, unsigned long time, int quality)
+{
+  vtkUnsignedCharArray* array = this->InteractiveRender(view, quality);
+  if (array && array->GetMTime() != time)
+  {
+    this->LastStillRenderToMTime = array->GetMTime();
+    return reinterpret_cast<char*>(array->GetPointer(0));
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkPVWebApplication::InteractiveRenderToBuffer(
+  vtkSMViewProxy* view, unsigned long time, int quality)
+{
+  vtkUnsignedCharArray* array = this->InteractiveRender(view, quality);
+  if (array && array->GetMTime() != time)
+  {
+    this->LastStillRenderToMTime = array->GetMTime();
+    return array;
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkPVWebApplication::InteractiveRenderToBinary(
+  vtkSMViewProxy* view, unsigned long time, int quality)
+{
+  vtkUnsignedCharArray* array = this->InteractiveRenderInternal(view, quality, ENCODING_NONE);
+  if (array && array->GetMTime() != time)
+  {
+    this->LastStillRenderToMTime = array->GetMTime();
+    return array;
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVWebApplication::SetNumberOfEncoderThreads(int numThreads)
+{
+  numThreads = std::max(numThreads, 1);
+  if (static_cast<int>(this->Internals->Encoder->GetMaxThreads()) != numThreads)
+  {
+    this->Internals->Encoder->SetMaxThreads(static_cast<vtkTypeUInt32>(numThreads));
+    // restart the worker threads. This drops any pending frames, so make sure
+    // the next request for every view renders a new image.
+    this->Internals->Encoder->Initialize();
+    for (vtkInternals::ImageCacheType::iterator iter = this->Internals->ImageCache.begin();
+         iter != this->Internals->ImageCache.end(); ++iter)
+    {
+      iter->second.Data = NULL;
+      iter->second.NeedsRender = true;
+      iter->second.HasImagesBeingProcessed = false;
+      iter->second.PushTime = 0.0;
+    }
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkPVWebApplication::GetNumberOfEncoderThreads()
+{
+  return static_cast<int>(this->Internals->Encoder->GetMaxThreads());
+}
+
+//----------------------------------------------------------------------------
+int vtkPVWebApplication::GetNumberOfRenderedFrames(vtkSMViewProxy* view)
+{
+  return this->Internals->GetStatistics(view).NumberOfRenderedFrames;
+}
+
+//----------------------------------------------------------------------------
+int vtkPVWebApplication::GetNumberOfSkippedFrames(vtkSMViewProxy* view)
+{
+  return this->Internals->GetStatistics(view).NumberOfSkippedFrames;
+}
+
+//----------------------------------------------------------------------------
+double vtkPVWebApplication::GetLastRenderTime(vtkSMViewProxy* view)
+{
+  return this->Internals->GetStatistics(view).LastRenderTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkPVWebApplication::GetAverageRenderTime(vtkSMViewProxy* view)
+{
+  const vtkInternals::FrameStatisticsType& stats = this->Internals->GetStatistics(view);
+  return stats.NumberOfRenderedFrames > 0
+    ? stats.TotalRenderTime / stats.NumberOfRenderedFrames
+    : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkPVWebApplication::GetAverageEncodeLatency(vtkSMViewProxy* view)
+{
+  const vtkInternals::FrameStatisticsType& stats = this->Internals->GetStatistics(view);
+  return stats.NumberOfEncodedFrames > 0
+    ? stats.TotalEncodeLatency / stats.NumberOfEncodedFrames
+    : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkPVWebApplication::GetFrameRate(vtkSMViewProxy* view)
+{
+  return this->Internals->GetStatistics(view).GetFrameRate();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVWebApplication::ResetFrameStatistics(vtkSMViewProxy* view)
+{
+  vtkInternals::ImageCacheType::iterator iter = this->Internals->ImageCache.find(view);
+  if (iter != this->Internals->ImageCache.end())
+  {
+    iter->second.Statistics.Reset();
+  }
+}
+
 //----------------------------------------------------------------------------
 bool vtkPVWebApplication::HandleInteractionEvent(
   vtkSMViewProxy* view, vtkWebInteractionEvent* event)
@@ -436,4 +754,7 @@ void vtkPVWebApplication::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "ImageEncoding: " << this->ImageEncoding << endl;
   os << indent << "ImageCompression: " << this->ImageCompression << endl;
+  os << indent << "NumberOfEncoderThreads: " << this->Internals->Encoder->GetMaxThreads() << endl;
+  os << indent << "InteractiveImageReductionFactor: " << this->InteractiveImageReductionFactor
+     << endl;
 }
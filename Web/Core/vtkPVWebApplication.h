@@ -65,17 +65,91 @@ public:
   vtkGetMacro(ImageCompression, int);
   //@}
 
+  //@{
+  /**
+   * Set the factor by which images produced by InteractiveRender() are
+   * sub-sampled in each dimension before being encoded. Set to 1 to deliver
+   * interactive frames at full resolution. Default is 2.
+   */
+  vtkSetClampMacro(InteractiveImageReductionFactor, int, 1, 20);
+  vtkGetMacro(InteractiveImageReductionFactor, int);
+  //@}
+
   //@{
   /**
    * Render a view and obtain the rendered image.
+   *
+   * InteractiveRender() renders using the view's interactive rendering path
+   * (LOD geometry, interactive image reduction) and delivers a sub-sampled
+   * image encoded at the requested, typically lower, quality. If the encoder
+   * has not yet caught up with the previous interactive frame, no new frame is
+   * rendered and the most recent available image is returned instead. The
+   * first StillRender() after an interactive frame always renders a new
+   * full-quality image, even if the view has not been modified since.
    */
   vtkUnsignedCharArray* StillRender(vtkSMViewProxy* view, int quality = 100);
   vtkUnsignedCharArray* InteractiveRender(vtkSMViewProxy* view, int quality = 50);
   const char* StillRenderToString(vtkSMViewProxy* view, unsigned long time = 0, int quality = 100);
   vtkUnsignedCharArray* StillRenderToBuffer(
     vtkSMViewProxy* view, unsigned long time = 0, int quality = 100);
+  const char* InteractiveRenderToString(
+    vtkSMViewProxy* view, unsigned long time = 0, int quality = 50);
+  vtkUnsignedCharArray* InteractiveRenderToBuffer(
+    vtkSMViewProxy* view, unsigned long time = 0, int quality = 50);
   //@}
 
+  //@{
+  /**
+   * Same as StillRenderToBuffer() and InteractiveRenderToBuffer() except that
+   * the returned buffer always holds the raw compressed image, irrespective
+   * of ImageEncoding. Use these to deliver images as binary messages and
+   * avoid the cost of base64 encoding on the server and decoding on the
+   * client.
+   */
+  vtkUnsignedCharArray* StillRenderToBinary(
+    vtkSMViewProxy* view, unsigned long time = 0, int quality = 100);
+  vtkUnsignedCharArray* InteractiveRenderToBinary(
+    vtkSMViewProxy* view, unsigned long time = 0, int quality = 50);
+  //@}
+
+  //@{
+  /**
+   * Set the number of threads used to encode rendered images. Images for
+   * different views are encoded concurrently and each view only keeps the
+   * most recent frame, older frames still waiting to be encoded are dropped.
+   * Changing the number of threads discards all pending frames.
+   */
+  void SetNumberOfEncoderThreads(int);
+  int GetNumberOfEncoderThreads();
+  //@}
+
+  //@{
+  /**
+   * Per-view frame statistics. Render times are the time taken to render and
+   * capture the image (in seconds), while the encode latency is the time
+   * between an image being handed to the encoder and its encoded output being
+   * picked up. Skipped frames are interactive renders that were not done
+   * since the encoder was still busy with the previous frame. The frame rate
+   * is the number of frames rendered per second since the statistics were
+   * last reset.
+   */
+  int GetNumberOfRenderedFrames(vtkSMViewProxy* view);
+  int GetNumberOfSkippedFrames(vtkSMViewProxy* view);
+  double GetLastRenderTime(vtkSMViewProxy* view);
+  double GetAverageRenderTime(vtkSMViewProxy* view);
+  double GetAverageEncodeLatency(vtkSMViewProxy* view);
+  double GetFrameRate(vtkSMViewProxy* view);
+  void ResetFrameStatistics(vtkSMViewProxy* view);
+  //@}
+
+  /**
+   * Returns true while a mouse button is held down in the view i.e. between
+   * the press and release events passed to HandleInteractionEvent(). Image
+   * delivery protocols use this to choose between InteractiveRender() and
+   * StillRender().
+   */
+  bool GetIsInteracting(vtkSMViewProxy* view);
+
   /**
    * StillRenderToString() need not necessary returns the most recently rendered
    * image. Use this method to get whether there are any pending images being
@@ -116,7 +190,8 @@ public:
 
   //@{
   /**
-   * Return the size of the last image exported.
+   * Return the size of the last image exported. For interactive renders, this
+   * is the size of the captured image before sub-sampling.
    */
   vtkGetVector2Macro(LastStillRenderImageSize, int);
   //@}
@@ -127,9 +202,19 @@ protected:
 
   int ImageEncoding;
   int ImageCompression;
+  int InteractiveImageReductionFactor;
   vtkMTimeType LastStillRenderToMTime;
   int LastStillRenderImageSize[3];
 
+  //@{
+  /**
+   * Implementations for the render methods, using the given encoding.
+   */
+  vtkUnsignedCharArray* StillRenderInternal(vtkSMViewProxy* view, int quality, int encoding);
+  vtkUnsignedCharArray* InteractiveRenderInternal(
+    vtkSMViewProxy* view, int quality, int encoding);
+  //@}
+
 private:
   vtkPVWebApplication(const vtkPVWebApplication&) = delete;
   void operator=(const vtkPVWebApplication&) = delete;
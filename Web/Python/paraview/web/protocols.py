@@ -368,6 +368,10 @@ class ParaViewWebViewPort(ParaViewWebProtocol):
 
 class ParaViewWebViewPortImageDelivery(ParaViewWebProtocol):
 
+    def __init__(self, **kwargs):
+        super(ParaViewWebViewPortImageDelivery, self).__init__()
+        self.interactiveQuality = 50
+
     # RpcName: stillRender => viewport.image.render
     @exportRpc("viewport.image.render")
     def stillRender(self, options):
@@ -392,7 +396,14 @@ class ParaViewWebViewPortImageDelivery(ParaViewWebProtocol):
             localTime = options["localTime"]
         reply = {}
         app = self.getApplication()
-        reply["image"] = app.StillRenderToString(view.SMProxy, t, quality)
+        if app.GetIsInteracting(view.SMProxy):
+            # Reduced size and quality while the user is dragging, a
+            # full-quality still is rendered once the interaction ends.
+            quality = min(quality, self.interactiveQuality)
+            stillRender = app.InteractiveRenderToString
+        else:
+            stillRender = app.StillRenderToString
+        reply["image"] = stillRender(view.SMProxy, t, quality)
 
         # Check that we are getting image size we have set if not wait until we
         # do.
@@ -400,12 +411,12 @@ class ParaViewWebViewPortImageDelivery(ParaViewWebProtocol):
         while resize and list(app.GetLastStillRenderImageSize()) != size \
               and size != [0, 0] and tries > 0:
             app.InvalidateCache(view.SMProxy)
-            reply["image"] = app.StillRenderToString(view.SMProxy, t, quality)
+            reply["image"] = stillRender(view.SMProxy, t, quality)
             tries -= 1
 
         if not resize and options and ("clearCache" in options) and options["clearCache"]:
             app.InvalidateCache(view.SMProxy)
-            reply["image"] = app.StillRenderToString(view.SMProxy, t, quality)
+            reply["image"] = stillRender(view.SMProxy, t, quality)
 
         reply["stale"] = app.GetHasImagesBeingProcessed(view.SMProxy)
         reply["mtime"] = app.GetLastStillRenderToMTime()
@@ -437,6 +448,7 @@ class ParaViewWebPublishImageDelivery(ParaViewWebProtocol):
         self.targetFrameRate = 30.0
         self.minFrameRate = 12.0
         self.maxFrameRate = 30.0
+        self.interactiveQuality = 50
 
 
     def pushRender(self, vId, ignoreAnimation = False):
@@ -588,10 +600,19 @@ class ParaViewWebPublishImageDelivery(ParaViewWebProtocol):
         app = self.getApplication()
         if t == 0:
             app.InvalidateCache(view.SMProxy)
-        if self.decode:
+        if app.GetIsInteracting(view.SMProxy):
+            # Reduced size and quality while the user is dragging; the
+            # application renders a full-quality still once the interaction
+            # ends.
+            quality = min(quality, self.interactiveQuality)
+            if self.decode:
+                stillRender = app.InteractiveRenderToString
+            else:
+                stillRender = app.InteractiveRenderToBinary
+        elif self.decode:
             stillRender = app.StillRenderToString
         else:
-            stillRender = app.StillRenderToBuffer
+            stillRender = app.StillRenderToBinary
         reply_image = stillRender(view.SMProxy, t, quality)
 
         # Check that we are getting image size we have set if not wait until we
@@ -626,6 +647,32 @@ class ParaViewWebPublishImageDelivery(ParaViewWebProtocol):
         return reply
 
 
+    @exportRpc("viewport.image.push.statistics")
+    def getFrameStatistics(self, viewId = '-1', reset = False):
+        """
+        RPC callback to obtain the frame statistics for a view. Times are
+        given in milliseconds.
+        """
+        sView = self.getView(viewId)
+        if not sView:
+            return { 'error': 'Unable to get view with id %s' % viewId }
+
+        app = self.getApplication()
+        stats = {
+            'id': sView.GetGlobalIDAsString(),
+            'renderedFrames': app.GetNumberOfRenderedFrames(sView.SMProxy),
+            'skippedFrames': app.GetNumberOfSkippedFrames(sView.SMProxy),
+            'lastRenderTime': app.GetLastRenderTime(sView.SMProxy) * 1000,
+            'averageRenderTime': app.GetAverageRenderTime(sView.SMProxy) * 1000,
+            'averageEncodeLatency': app.GetAverageEncodeLatency(sView.SMProxy) * 1000,
+            'encoderThreads': app.GetNumberOfEncoderThreads(),
+            'fps': app.GetFrameRate(sView.SMProxy)
+        }
+        if reset:
+            app.ResetFrameStatistics(sView.SMProxy)
+        return stats
+
+
     @exportRpc("viewport.image.push.observer.add")
     def addRenderObserver(self, viewId):
         sView = self.getView(viewId)
@@ -8,6 +8,10 @@ from paraview.web import protocols as pv_protocols
 
 class PVServerProtocol(vtk_wslink.ServerProtocol):
 
+    # Number of threads used to encode rendered images. When 0, the
+    # application's default is used.
+    encoderThreads = 0
+
     def __init__(self):
         vtk_wslink.ServerProtocol.__init__(self)
         # if (vtk_wslink.imageCapture):
@@ -17,4 +21,7 @@ class PVServerProtocol(vtk_wslink.ServerProtocol):
         # vtk_wslink.imageCapture.setApplication(self.getApplication())
 
     def initApplication(self):
-        return vtkPVWebApplication()
+        app = vtkPVWebApplication()
+        if self.encoderThreads > 0:
+            app.SetNumberOfEncoderThreads(self.encoderThreads)
+        return app